@@ -1,6 +1,7 @@
 #pragma once
 
 #include "geometrycentral/numerical/linear_algebra_types.h"
+#include "geometrycentral/utilities/mapped_file.h"
 #include "geometrycentral/utilities/utilities.h"
 
 #include <Eigen/Core>
@@ -9,9 +10,12 @@
 #include <Eigen/StdVector>
 
 #include <complex>
+#include <cstdint>
 #include <fstream> // ofsteam, ifstream
 #include <iomanip> // setprecision
 #include <iostream>
+#include <memory>
+#include <vector>
 
 // === Various helper functions and sanity checks which are useful for linear algebra code
 
@@ -121,6 +125,137 @@ DenseMatrix<T> loadDenseMatrix(std::string filename);
 template <typename T>
 DenseMatrix<T> loadDenseMatrix(std::istream& in);
 
+// === Binary IO
+
+// Matrices can also be stored in a binary format (files conventionally named .gcmat), which is many times smaller and
+// faster to read and write than the text files above. A header records the dimensions, the number of nonzeros, the
+// scalar type, and the storage order. It is followed by the compressed (CSC or CSR) arrays of a sparse matrix, 0-indexed,
+// or the column-major entries of a dense matrix. Files are written and read on little-endian machines.
+//
+// Files are read through a memory mapping, and uncompressed files can be used in place (see BinaryMatrixFile). In the
+// optional compressed mode, indices are delta coded, and the bytes each value shares with the previous value are
+// dropped. This is lossless, but compressed files must be decoded before use. Compression and decompression can run
+// in parallel over blocks of the matrix, on nThreads threads (0 means one per hardware thread); by default they are
+// serial.
+
+struct BinaryMatrixOptions {
+  bool compress = false;
+  bool rowMajor = false; // store a sparse matrix in CSR order, rather than the CSC order of SparseMatrix<T>
+  size_t nThreads = 1;   // threads used to compress the matrix (0: all hardware)
+};
+
+template <typename T>
+void saveSparseMatrixBinary(std::string filename, const SparseMatrix<T>& matrix,
+                            const BinaryMatrixOptions& options = BinaryMatrixOptions());
+template <typename T>
+void saveSparseMatrixBinary(std::ostream& out, const SparseMatrix<T>& matrix,
+                            const BinaryMatrixOptions& options = BinaryMatrixOptions());
+
+template <typename T>
+void saveDenseMatrixBinary(std::string filename, const DenseMatrix<T>& matrix, bool compress = false,
+                           size_t nThreads = 1);
+template <typename T>
+void saveDenseMatrixBinary(std::ostream& out, const DenseMatrix<T>& matrix, bool compress = false, size_t nThreads = 1);
+
+// Throw a std::runtime_error if the file is invalid, or holds a different kind of matrix or scalar type
+template <typename T>
+SparseMatrix<T> loadSparseMatrixBinary(std::string filename, size_t nThreads = 1);
+template <typename T>
+SparseMatrix<T> loadSparseMatrixBinary(std::istream& in, size_t nThreads = 1);
+
+template <typename T>
+DenseMatrix<T> loadDenseMatrixBinary(std::string filename, size_t nThreads = 1);
+template <typename T>
+DenseMatrix<T> loadDenseMatrixBinary(std::istream& in, size_t nThreads = 1);
+
+// The scalar types which can be stored in binary matrix files. Complex values are stored as two words.
+struct BinaryMatrixScalarInfo {
+  uint32_t code;
+  uint32_t wordBytes;
+  uint32_t nWords;
+};
+// clang-format off
+template <typename T> struct BinaryMatrixScalar;
+template <> struct BinaryMatrixScalar<float>                { static BinaryMatrixScalarInfo info() { return {1, 4, 1}; } };
+template <> struct BinaryMatrixScalar<double>               { static BinaryMatrixScalarInfo info() { return {2, 8, 1}; } };
+template <> struct BinaryMatrixScalar<std::complex<float>>  { static BinaryMatrixScalarInfo info() { return {3, 4, 2}; } };
+template <> struct BinaryMatrixScalar<std::complex<double>> { static BinaryMatrixScalarInfo info() { return {4, 8, 2}; } };
+template <> struct BinaryMatrixScalar<int32_t>              { static BinaryMatrixScalarInfo info() { return {5, 4, 1}; } };
+template <> struct BinaryMatrixScalar<int64_t>              { static BinaryMatrixScalarInfo info() { return {6, 8, 1}; } };
+// clang-format on
+
+// An open binary matrix file. The load functions above are shorthands for getSparseMatrix() and getDenseMatrix().
+class BinaryMatrixFile {
+public:
+  // Map a file into memory, and check its header and layout. Throws a std::runtime_error if it is not a valid file.
+  BinaryMatrixFile(std::string filename);
+  // Read a file from a stream into memory
+  BinaryMatrixFile(std::istream& in);
+
+  bool isSparse() const { return sparse; }
+  bool isRowMajor() const { return rowMajor; }
+  bool isCompressed() const { return compressed; }
+  size_t rows() const { return nRows; }
+  size_t cols() const { return nCols; }
+  size_t nonZeros() const { return nNonZeros; }
+  std::string scalarTypeName() const;
+
+  // Copy or decode the matrix, on nThreads threads (0 means one per hardware thread)
+  template <typename T>
+  SparseMatrix<T> getSparseMatrix(size_t nThreads = 1) const;
+  template <typename T>
+  DenseMatrix<T> getDenseMatrix(size_t nThreads = 1) const;
+
+  // Use the matrix in place, without copying it out of the file; the view is valid as long as this object is. Only for
+  // uncompressed files (and, for sparse matrices, in the default CSC order). Beware that while the structure of a
+  // sparse matrix is checked when the file is opened, its row indices are not, since that would read the whole file.
+  template <typename T>
+  Eigen::Map<const SparseMatrix<T>> sparseView() const;
+  template <typename T>
+  Eigen::Map<const DenseMatrix<T>> denseView() const;
+
+  // Encode matrix data. Sparse matrices are given by their compressed arrays, with outerSize + 1 outer offsets.
+  static void writeSparse(std::ostream& out, BinaryMatrixScalarInfo scalar, size_t nRows, size_t nCols, bool rowMajor,
+                          const int32_t* outerIndices, const int32_t* innerIndices, const char* values, bool compress,
+                          size_t nThreads = 1);
+  static void writeDense(std::ostream& out, BinaryMatrixScalarInfo scalar, size_t nRows, size_t nCols,
+                         const char* values, bool compress, size_t nThreads = 1);
+
+private:
+  void parse();
+  void checkScalarType(BinaryMatrixScalarInfo requested, bool wantSparse) const;
+  size_t outerSize() const { return rowMajor ? nRows : nCols; }
+  size_t innerSize() const { return rowMajor ? nCols : nRows; }
+
+  // Copy or decode the stored arrays into arrays of outerSize() + 1, nonZeros(), and nonZeros() entries
+  void readSparseArrays(int32_t* outerIndices, int32_t* innerIndices, char* values, size_t nThreads) const;
+  void readDenseValues(char* values, size_t nThreads) const;
+
+  std::string source; // for error messages
+  std::unique_ptr<MappedFile> file;
+  std::vector<char> ownedData;
+  const char* data = nullptr;
+  size_t dataSize = 0;
+
+  bool sparse = false;
+  bool rowMajor = false;
+  bool compressed = false;
+  BinaryMatrixScalarInfo scalar = {0, 0, 0};
+  size_t nRows = 0;
+  size_t nCols = 0;
+  size_t nNonZeros = 0;
+
+  // Locations of the stored arrays, for uncompressed files
+  const int32_t* outerPtr = nullptr;
+  const int32_t* innerPtr = nullptr;
+  const char* valuePtr = nullptr;
+
+  // Coded blocks, for compressed files: block i holds the outer indices (or, for dense matrices, the values)
+  // [blockBegins[i], blockBegins[i+1]), stored in bytes [blockOffsets[i], blockOffsets[i+1]) of the file
+  std::vector<size_t> blockBegins;
+  std::vector<size_t> blockOffsets;
+};
+
 
 #include "geometrycentral/numerical/linear_algebra_utilities.ipp"
 
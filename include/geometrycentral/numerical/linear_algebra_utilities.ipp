@@ -547,3 +547,125 @@ DenseMatrix<T> loadDenseMatrix(std::istream& in) {
 
   return M;
 }
+
+template <typename T>
+void saveSparseMatrixBinary(std::string filename, const SparseMatrix<T>& matrix, const BinaryMatrixOptions& options) {
+  std::ofstream outFile(filename, std::ios::binary);
+  if (!outFile) {
+    throw std::runtime_error("failed to open output file " + filename);
+  }
+  saveSparseMatrixBinary(outFile, matrix, options);
+  outFile.close();
+  if (!outFile) {
+    throw std::runtime_error("failed to write output file " + filename);
+  }
+}
+
+template <typename T>
+void saveSparseMatrixBinary(std::ostream& out, const SparseMatrix<T>& matrix, const BinaryMatrixOptions& options) {
+  static_assert(sizeof(typename SparseMatrix<T>::StorageIndex) == sizeof(int32_t), "indices must be 32-bit");
+
+  if (options.rowMajor) {
+    Eigen::SparseMatrix<T, Eigen::RowMajor> rowMatrix(matrix);
+    rowMatrix.makeCompressed();
+    BinaryMatrixFile::writeSparse(out, BinaryMatrixScalar<T>::info(), matrix.rows(), matrix.cols(), true,
+                                  rowMatrix.outerIndexPtr(), rowMatrix.innerIndexPtr(),
+                                  reinterpret_cast<const char*>(rowMatrix.valuePtr()), options.compress,
+                                  options.nThreads);
+  } else if (!matrix.isCompressed()) {
+    SparseMatrix<T> compressedMatrix(matrix);
+    compressedMatrix.makeCompressed();
+    saveSparseMatrixBinary(out, compressedMatrix, options);
+  } else {
+    BinaryMatrixFile::writeSparse(out, BinaryMatrixScalar<T>::info(), matrix.rows(), matrix.cols(), false,
+                                  matrix.outerIndexPtr(), matrix.innerIndexPtr(),
+                                  reinterpret_cast<const char*>(matrix.valuePtr()), options.compress, options.nThreads);
+  }
+}
+
+template <typename T>
+void saveDenseMatrixBinary(std::string filename, const DenseMatrix<T>& matrix, bool compress, size_t nThreads) {
+  std::ofstream outFile(filename, std::ios::binary);
+  if (!outFile) {
+    throw std::runtime_error("failed to open output file " + filename);
+  }
+  saveDenseMatrixBinary(outFile, matrix, compress, nThreads);
+  outFile.close();
+  if (!outFile) {
+    throw std::runtime_error("failed to write output file " + filename);
+  }
+}
+
+template <typename T>
+void saveDenseMatrixBinary(std::ostream& out, const DenseMatrix<T>& matrix, bool compress, size_t nThreads) {
+  BinaryMatrixFile::writeDense(out, BinaryMatrixScalar<T>::info(), matrix.rows(), matrix.cols(),
+                               reinterpret_cast<const char*>(matrix.data()), compress, nThreads);
+}
+
+template <typename T>
+SparseMatrix<T> loadSparseMatrixBinary(std::string filename, size_t nThreads) {
+  return BinaryMatrixFile(filename).getSparseMatrix<T>(nThreads);
+}
+
+template <typename T>
+SparseMatrix<T> loadSparseMatrixBinary(std::istream& in, size_t nThreads) {
+  return BinaryMatrixFile(in).getSparseMatrix<T>(nThreads);
+}
+
+template <typename T>
+DenseMatrix<T> loadDenseMatrixBinary(std::string filename, size_t nThreads) {
+  return BinaryMatrixFile(filename).getDenseMatrix<T>(nThreads);
+}
+
+template <typename T>
+DenseMatrix<T> loadDenseMatrixBinary(std::istream& in, size_t nThreads) {
+  return BinaryMatrixFile(in).getDenseMatrix<T>(nThreads);
+}
+
+template <typename T>
+SparseMatrix<T> BinaryMatrixFile::getSparseMatrix(size_t nThreads) const {
+  checkScalarType(BinaryMatrixScalar<T>::info(), true);
+
+  // Fill the arrays of a matrix with the stored order, converting afterwards if needed
+  if (rowMajor) {
+    Eigen::SparseMatrix<T, Eigen::RowMajor> rowMatrix(nRows, nCols);
+    rowMatrix.resizeNonZeros(nNonZeros);
+    readSparseArrays(rowMatrix.outerIndexPtr(), rowMatrix.innerIndexPtr(),
+                     reinterpret_cast<char*>(rowMatrix.valuePtr()), nThreads);
+    return SparseMatrix<T>(rowMatrix);
+  }
+
+  SparseMatrix<T> matrix(nRows, nCols);
+  matrix.resizeNonZeros(nNonZeros);
+  readSparseArrays(matrix.outerIndexPtr(), matrix.innerIndexPtr(), reinterpret_cast<char*>(matrix.valuePtr()),
+                   nThreads);
+  return matrix;
+}
+
+template <typename T>
+DenseMatrix<T> BinaryMatrixFile::getDenseMatrix(size_t nThreads) const {
+  checkScalarType(BinaryMatrixScalar<T>::info(), false);
+  DenseMatrix<T> matrix(nRows, nCols);
+  readDenseValues(reinterpret_cast<char*>(matrix.data()), nThreads);
+  return matrix;
+}
+
+template <typename T>
+Eigen::Map<const SparseMatrix<T>> BinaryMatrixFile::sparseView() const {
+  checkScalarType(BinaryMatrixScalar<T>::info(), true);
+  if (compressed || rowMajor) {
+    throw std::runtime_error("binary matrix " + source + " cannot be viewed in place, since it is " +
+                             (compressed ? "compressed" : "stored in row-major order"));
+  }
+  return Eigen::Map<const SparseMatrix<T>>(nRows, nCols, nNonZeros, outerPtr, innerPtr,
+                                           reinterpret_cast<const T*>(valuePtr));
+}
+
+template <typename T>
+Eigen::Map<const DenseMatrix<T>> BinaryMatrixFile::denseView() const {
+  checkScalarType(BinaryMatrixScalar<T>::info(), false);
+  if (compressed) {
+    throw std::runtime_error("binary matrix " + source + " cannot be viewed in place, since it is compressed");
+  }
+  return Eigen::Map<const DenseMatrix<T>>(reinterpret_cast<const T*>(valuePtr), nRows, nCols);
+}
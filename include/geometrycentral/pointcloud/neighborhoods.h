@@ -23,6 +23,9 @@ public:
 
   // == Functions
 
+  // Memory held by the neighbor lists
+  size_t bufferBytes() const { return neighbors.bufferBytes(); }
+
 protected:
   // TODO
   // PointData<size_t> listIndEnd;
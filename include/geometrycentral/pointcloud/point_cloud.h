@@ -7,6 +7,7 @@
 
 #include <list>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 // NOTE: ipp includes at bottom of file
@@ -77,6 +78,14 @@ public:
   // need to know not to try to de-register them if the cloud has been deleted)
   std::list<std::function<void()>> meshDeleteCallbackList;
 
+  // Memory accounting callbacks
+  // Each MeshData<> container registered on this cloud reports the number of bytes held by its buffer
+  std::list<std::function<size_t()>> meshDataMemoryCallbackList;
+
+  // Guards registration of the callbacks above, so that containers can be created and destroyed from many threads at
+  // once
+  mutable std::mutex callbackRegistrationMutex;
+
   // Check capacity. Needed when implementing expandable containers for mutable meshes to ensure the contain can
   // hold a sufficient number of elements before the next resize event.
   size_t nPointsCapacity() const;
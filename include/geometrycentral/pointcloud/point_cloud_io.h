@@ -25,5 +25,7 @@ void writePointCloud(PointCloud& cloud, PointPositionGeometry& geometry, std::st
 // Same as above, to to an ostream. Must specify type.
 void writePointCloud(PointCloud& cloud, PointPositionGeometry& geometry, std::ostream& out, std::string type);
 
+// (to read or write clouds a chunk at a time, without holding them in memory, see point_cloud_stream.h)
+
 } // namespace pointcloud
 } // namespace geometrycentral
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "geometrycentral/pointcloud/point_cloud.h"
+#include "geometrycentral/pointcloud/point_position_geometry.h"
+#include "geometrycentral/utilities/binary_ply.h"
+#include "geometrycentral/utilities/vector3.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace geometrycentral {
+namespace pointcloud {
+
+// Read and write point clouds a chunk at a time, so that clouds much larger than memory can be processed in tiles.
+// Only one chunk is held in memory at once.
+//
+// Supported formats:
+//   - "ply": binary little-endian .ply files with a "vertex" element holding x, y, z (of any numeric type), and
+//     optionally normals nx, ny, nz and colors red, green, blue. Other properties are skipped.
+//   - "xyz": text files with one point per line, as "x y z", "x y z nx ny nz", or "x y z nx ny nz r g b", where colors
+//     are integers from 0 to 255. Blank lines and lines beginning with '#' are skipped.
+
+// One chunk of points. Normals and colors are empty if the file does not have them.
+struct PointCloudChunk {
+  size_t firstIndex = 0; // index of the first point of the chunk in the whole file
+  std::vector<Vector3> positions;
+  std::vector<Vector3> normals;
+  std::vector<std::array<uint8_t, 3>> colors;
+
+  size_t size() const { return positions.size(); }
+  void clear();
+};
+
+// Make an in-memory cloud and geometry from the positions of a chunk
+std::tuple<std::unique_ptr<PointCloud>, std::unique_ptr<PointPositionGeometry>>
+makePointCloudAndGeometry(const PointCloudChunk& chunk);
+
+class PointCloudReader {
+public:
+  // Open a file, and read its header (for .ply) or first line (for .xyz). The type is inferred from the extension if
+  // not given. Throws a std::runtime_error if the file cannot be read in this format.
+  PointCloudReader(std::string filename, std::string type = "");
+  PointCloudReader(std::istream& in, std::string type);
+
+  // Whether a file can be read as a point cloud of the given type (or the type of its extension)
+  static bool canRead(std::string filename, std::string type = "");
+
+  bool hasNormals() const { return normalsPresent; }
+  bool hasColors() const { return colorsPresent; }
+
+  // The number of points in the file. For .xyz files this is not known until the end of the file has been reached, and
+  // INVALID_IND is returned before then.
+  size_t nPoints() const;
+  size_t nPointsRead() const { return nRead; }
+
+  // Replace the contents of chunk with the next (at most) maxPoints points. Returns false, leaving chunk empty, once
+  // every point has been read.
+  bool readChunk(PointCloudChunk& chunk, size_t maxPoints = 1 << 20);
+
+  // Threads used to parse each chunk (0 means one per hardware thread)
+  size_t nThreads = 1;
+
+private:
+  void readPlyHeader();
+  void readXyzFirstLine();
+  bool readPlyChunk(PointCloudChunk& chunk, size_t maxPoints);
+  bool readXyzChunk(PointCloudChunk& chunk, size_t maxPoints);
+
+  // Move unparsed text to the front of the buffer and read more after it; returns false at the end of the stream
+  bool fillTextBuffer();
+
+  std::unique_ptr<std::ifstream> file; // if opened by name
+  std::istream& in;
+  std::string type;
+  bool normalsPresent = false;
+  bool colorsPresent = false;
+  size_t nRead = 0;
+
+  // .ply layout: byte offsets of each property in a vertex row, or INVALID_IND if absent
+  size_t nVertexRows = 0;
+  size_t rowStride = 0;
+  std::array<size_t, 9> propertyOffsets;
+  std::array<PlyType, 9> propertyTypes;
+  std::vector<char> buffer;
+
+  // .xyz text which has been read but not yet parsed is buffer[textBegin, textEnd)
+  size_t textBegin = 0;
+  size_t textEnd = 0;
+  size_t nColumns = 0;
+  bool endOfText = false;     // the stream has been read to the end
+  bool allPointsRead = false; // ... and all of its text parsed
+};
+
+class PointCloudWriter {
+public:
+  // Open a file for writing, with or without normals and colors. The type is inferred from the extension if not
+  // given. For .ply files, the number of points is only written to the header when the writer is closed, so streams
+  // must be seekable.
+  PointCloudWriter(std::string filename, bool withNormals = false, bool withColors = false, std::string type = "");
+  PointCloudWriter(std::ostream& out, std::string type, bool withNormals = false, bool withColors = false);
+
+  // Closes the writer if close() has not been called, ignoring errors
+  ~PointCloudWriter();
+
+  PointCloudWriter(const PointCloudWriter& other) = delete;
+  PointCloudWriter& operator=(const PointCloudWriter& other) = delete;
+
+  // Append points. The chunk must have normals and colors (one per point) if and only if the writer was opened with
+  // them; its firstIndex is ignored.
+  void writeChunk(const PointCloudChunk& chunk);
+  void writeChunk(PointCloud& cloud, PointPositionGeometry& geometry); // positions only
+
+  size_t nPointsWritten() const { return nWritten; }
+
+  // Threads used to format each chunk (0 means one per hardware thread)
+  size_t nThreads = 1;
+
+  // Finish the file. Throws a std::runtime_error if writing failed.
+  void close();
+
+private:
+  void writePlyHeader();
+  void writeRows(size_t n, const Vector3* positions, const Vector3* normals, const std::array<uint8_t, 3>* colors);
+
+  std::unique_ptr<std::ofstream> file; // if opened by name
+  std::ostream& out;
+  std::string type;
+  bool withNormals;
+  bool withColors;
+  size_t nWritten = 0;
+  bool closed = false;
+  std::streampos countPos; // where the vertex count goes in a .ply header
+};
+
+} // namespace pointcloud
+} // namespace geometrycentral
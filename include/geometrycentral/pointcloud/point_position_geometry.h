@@ -30,6 +30,26 @@ public:
   // Clear out any cached quantities which were previously computed but are not currently required.
   void purgeQuantities();
 
+  // Diagnostics for all of the cached quantities: how often each has been computed, the time spent computing it, and
+  // the memory it currently holds
+  std::vector<QuantityStatistics> getQuantityStatistics() const;
+  size_t quantitiesBufferBytes() const; // total memory held by all cached quantities
+
+  // Limit the memory held by cached quantities. Whenever a quantity is computed, quantities which are not currently
+  // require()'d are cleared (operators first, then least-recently used) until the total fits within the budget. They
+  // will be recomputed transparently if they are require()'d again.
+  void setQuantityMemoryBudget(size_t maxBytes);
+  void removeQuantityMemoryBudget();
+
+  // Make the geometry read-only, so that it can be shared by many threads at once. require() the quantities you need
+  // before freezing. While frozen, require()/unrequire() only update (atomic) counts, so they may be paired across a
+  // freeze or unfreeze; missing quantities are computed (once, under a lock) when first required, and
+  // refreshQuantities()/purgeQuantities() throw. The underlying inputs (e.g. vertex positions) and mesh must not be
+  // modified while frozen.
+  void freeze();
+  void unfreeze();
+  bool isFrozen() const;
+
   // Construct a geometry object on another point cloud identical to this one
   std::unique_ptr<PointPositionGeometry> reinterpretTo(PointCloud& targetCloud);
 
@@ -114,6 +134,8 @@ protected:
   // Note that this is a vector of non-owning pointers; the quantities are generally value members in the class, so
   // there is no need to delete these.
   std::vector<DependentQuantity*> quantities;
+  std::unique_ptr<QuantityMemoryBudget> quantityMemoryBudget;
+  std::unique_ptr<std::recursive_mutex> freezeLock; // non-null while frozen
 
   // === Implementation details for quantities
 
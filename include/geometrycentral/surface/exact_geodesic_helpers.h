@@ -207,8 +207,10 @@ public:
   }
   ~MemoryAllocator(){};
 
+  // release all units, but keep the underlying blocks for reuse
   void clear();
 
+  // release all units and free all blocks but the first
   void reset(unsigned block_size, unsigned max_number_of_blocks);
 
   // allocates single unit of memory
@@ -221,12 +223,59 @@ protected:
   std::vector<std::vector<T>> m_storage;
   unsigned m_block_size;           // size of a single block
   unsigned m_max_number_of_blocks; // maximum allowed number of blocks
+  size_t m_current_block;          // index of the block currently being filled
   unsigned m_current_position;     // first unused element inside the current
                                    // block
 
   std::vector<pointer> m_deleted; // pointers to deleted elemets
 };
 
+//== Recycles fixed-size nodes
+// the interval queue is repeatedly filled and emptied; once it has reached its peak size, it should not allocate again
+class NodePool {
+public:
+  NodePool() {}
+  NodePool(const NodePool& other) = delete;
+  NodePool& operator=(const NodePool& other) = delete;
+
+  // requests of any size other than the first one are passed through to operator new
+  void* allocate(size_t bytes);
+  void deallocate(void* p, size_t bytes);
+
+protected:
+  size_t m_node_size = 0;
+  std::vector<void*> m_free;
+  std::vector<std::unique_ptr<char[]>> m_blocks;
+};
+
+// Allocator for node-based standard containers which draws from a NodePool. Copies (and rebound copies) share the same
+// pool, but a copied container gets its own.
+template <class T>
+class NodePoolAllocator {
+public:
+  typedef T value_type;
+
+  NodePoolAllocator() : m_pool(std::make_shared<NodePool>()) {}
+  template <class U>
+  NodePoolAllocator(const NodePoolAllocator<U>& other) : m_pool(other.m_pool) {}
+
+  T* allocate(size_t n) { return static_cast<T*>(m_pool->allocate(n * sizeof(T))); }
+  void deallocate(T* p, size_t n) { m_pool->deallocate(p, n * sizeof(T)); }
+
+  NodePoolAllocator select_on_container_copy_construction() const { return NodePoolAllocator(); }
+
+  template <class U>
+  bool operator==(const NodePoolAllocator<U>& other) const {
+    return m_pool == other.m_pool;
+  }
+  template <class U>
+  bool operator!=(const NodePoolAllocator<U>& other) const {
+    return m_pool != other.m_pool;
+  }
+
+  std::shared_ptr<NodePool> m_pool;
+};
+
 } // namespace surface
 } // namespace geometrycentral
 
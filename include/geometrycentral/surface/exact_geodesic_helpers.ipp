@@ -6,7 +6,10 @@ namespace surface {
 
 template <class T>
 void MemoryAllocator<T>::clear() {
-  reset(m_block_size, m_max_number_of_blocks);
+  // Keep any blocks which have already been allocated, so that repeated propagations can reuse them
+  m_current_block = 0;
+  m_current_position = 0;
+  m_deleted.clear();
 }
 
 template <class T>
@@ -17,6 +20,7 @@ void MemoryAllocator<T>::reset(unsigned block_size, unsigned max_number_of_block
   assert(m_block_size > 0);
   assert(m_max_number_of_blocks > 0);
 
+  m_current_block = 0;
   m_current_position = 0;
 
   m_storage.reserve(max_number_of_blocks);
@@ -32,11 +36,14 @@ typename MemoryAllocator<T>::pointer MemoryAllocator<T>::allocate() {
   pointer result;
   if (m_deleted.empty()) {
     if (m_current_position + 1 >= m_block_size) {
-      m_storage.push_back(std::vector<T>());
-      m_storage.back().resize(m_block_size);
+      m_current_block++;
+      if (m_current_block == m_storage.size()) {
+        m_storage.push_back(std::vector<T>());
+        m_storage.back().resize(m_block_size);
+      }
       m_current_position = 0;
     }
-    result = &m_storage.back()[m_current_position];
+    result = &m_storage[m_current_block][m_current_position];
     ++m_current_position;
   } else {
     result = m_deleted.back();
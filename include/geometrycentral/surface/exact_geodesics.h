@@ -19,6 +19,17 @@ namespace surface {
 // One-off function to compute distance from a vertex
 VertexData<double> exactGeodesicDistance(SurfaceMesh& mesh, IntrinsicGeometryInterface& geom, Vertex v);
 
+// Exact distances from each source to each target, as a (#sources) x (#targets) matrix. Independent propagations are
+// run on nThreads threads (0 means one per hardware thread), each of which reuses a single solver. By default, they
+// run serially.
+DenseMatrix<double> exactGeodesicDistanceMatrix(SurfaceMesh& mesh, IntrinsicGeometryInterface& geom,
+                                                const std::vector<Vertex>& sources, const std::vector<Vertex>& targets,
+                                                size_t nThreads = 1);
+
+// All-pairs exact distances between the given vertices, as a symmetric matrix (computed in parallel, as above)
+DenseMatrix<double> exactGeodesicDistanceMatrix(SurfaceMesh& mesh, IntrinsicGeometryInterface& geom,
+                                                const std::vector<Vertex>& vertices, size_t nThreads = 1);
+
 class GeodesicAlgorithmExact {
 public:
   GeodesicAlgorithmExact(SurfaceMesh& mesh_, IntrinsicGeometryInterface& geom_);
@@ -35,6 +46,13 @@ public:
   void propagate(const Vertex& source, double max_propagation_distance = GEODESIC_INF,
                  const std::vector<Vertex>& stop_points = {});
 
+  // Propagate from a single source out to maxDistance, and report every vertex within that distance along with its
+  // distance. Intended for a stream of queries on the same solver: all storage from previous propagations (intervals,
+  // queue nodes, per-edge lists) is reset in place and reused, and only the part of the mesh reached by the previous
+  // propagation is cleared. Afterwards, the solver can be queried as after propagate().
+  std::vector<std::pair<Vertex, double>> queryDistance(const SurfacePoint& source, double maxDistance = GEODESIC_INF);
+  void queryDistance(const SurfacePoint& source, double maxDistance, std::vector<std::pair<Vertex, double>>& result);
+
   // trace back piecewise-linear path
   // the resulting path starts at "point" and ends at the closest source
   // optionally also returns the length of the path via the pathLength argument
@@ -68,7 +86,7 @@ public:
   IntervalList getEdgeIntervals(Edge e) const;
 
 protected:
-  typedef std::set<interval_pointer, Interval> IntervalQueue;
+  typedef std::set<interval_pointer, Interval, NodePoolAllocator<interval_pointer>> IntervalQueue;
 
   void update_list_and_queue(list_pointer list,
                              IntervalWithStop* candidates, // up to two candidates
@@ -141,6 +159,7 @@ protected:
 
   MemoryAllocator<Interval> m_memory_allocator; // quickly allocate and deallocate intervals
   EdgeData<IntervalList> m_edge_interval_lists; // every edge has its interval data
+  std::vector<Edge> m_touched_edges;            // edges whose lists are nonempty, so clear() can skip the rest
 
   enum class MapType { OLD, NEW }; // used for interval intersection
   MapType map[5];
@@ -153,6 +172,11 @@ protected:
   SortedSources m_sources;
 
   VertexData<bool> vertexIsManifold, vertexIsBoundary;
+
+  // scratch storage for queryDistance()
+  std::vector<SurfacePoint> m_query_sources;
+  std::vector<Vertex> m_query_vertices;
+  VertexData<char> m_vertex_reported;
 };
 
 } // namespace surface
@@ -4,6 +4,8 @@
 #include "geometrycentral/utilities/utilities.h"
 
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <utility>
 #include <vector>
 
@@ -14,6 +16,67 @@ namespace surface {
 VertexData<double> FMMDistance(IntrinsicGeometryInterface& geometry,
                                const std::vector<std::pair<Vertex, double>>& initialDistances);
 
+// Parallel alternative to FMMDistance(), using the fast iterative method: the vertices on the active band are updated in
+// parallel from their neighbors' current values (with the same triangle update as fast marching), until no value
+// changes. Converges to the same first-order solution, up to rounding. nThreads = 0 uses one thread per hardware thread;
+// by default it runs serially.
+VertexData<double> FIMDistance(IntrinsicGeometryInterface& geometry,
+                               const std::vector<std::pair<Vertex, double>>& initialDistances, size_t nThreads = 1);
+
+
+// Stateful class. Allows efficient repeated (and truncated) fast marching solves.
+//
+// The front is an indexed binary heap with decrease-key, and all per-vertex buffers are kept between solves. Each solve
+// only touches the vertices it reaches, so local queries on a large mesh cost time proportional to the size of the
+// neighborhood rather than the mesh.
+class FastMarchingSolver {
+
+public:
+  // === Constructor
+  FastMarchingSolver(IntrinsicGeometryInterface& geom);
+
+  // === Methods
+
+  // March outward from the given initial distances. Marching stops once every vertex within maxDistance has been
+  // finalized, or once all of the targets have been finalized (if any are given), whichever comes first.
+  void compute(const std::vector<std::pair<Vertex, double>>& initialDistances,
+               double maxDistance = std::numeric_limits<double>::infinity(), const std::vector<Vertex>& targets = {});
+
+  // Distance at a vertex finalized by the last solve, or infinity for any other vertex
+  double getDistance(Vertex v) const;
+  bool isFinalized(Vertex v) const;
+
+  // The vertices finalized by the last solve, in order of increasing distance
+  const std::vector<Vertex>& getFinalizedVertices() const;
+
+  // Distance at all vertices (infinity where not finalized)
+  VertexData<double> getDistanceFunction() const;
+
+private:
+  // === Members
+  SurfaceMesh& mesh;
+  IntrinsicGeometryInterface& geom;
+
+  // Per-vertex state is only valid when its stamp matches the current solve, so nothing needs to be reset between
+  // solves
+  uint32_t currentStamp = 0;
+  VertexData<uint32_t> vertexStamp;
+  VertexData<uint32_t> targetStamp;
+  VertexData<double> distances;
+  VertexData<char> finalized;
+  VertexData<size_t> heapIndex; // position in the heap, or INVALID_IND
+
+  std::vector<Vertex> heap; // binary min-heap on distances
+  std::vector<Vertex> finalizedVertices;
+
+  // === Helpers
+  void touch(Vertex v);
+  void relax(Vertex v, double newDist);
+  Vertex popMin();
+  void siftUp(size_t i);
+  void siftDown(size_t i);
+};
+
 
 } // namespace surface
 } // namespace geometrycentral
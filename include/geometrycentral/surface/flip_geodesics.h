@@ -251,5 +251,14 @@ public:
   void purgeStaleQueueEntries(); // stop too many stale entries from accumulating
 };
 
+// Compute geodesic paths between many pairs of vertices, in parallel. Each path is initialized with a Dijkstra path and
+// shortened with iterativeShorten(). Each thread keeps a single network (with rewinding enabled), which is rewound and
+// reused between queries rather than rebuilt. Returns each path as a polyline along the input mesh, or an empty
+// polyline if the endpoints are not connected or are the same vertex. nThreads = 0 uses one thread per hardware thread;
+// by default the paths are computed serially.
+std::vector<std::vector<SurfacePoint>> computeGeodesicPaths(ManifoldSurfaceMesh& mesh, IntrinsicGeometryInterface& geom,
+                                                            const std::vector<std::pair<Vertex, Vertex>>& endpoints,
+                                                            size_t nThreads = 1);
+
 } // namespace surface
 } // namespace geometrycentral
@@ -135,6 +135,14 @@ public:
   // face Otherwise return Face()
   Face getParentFace(Face f) const;
 
+protected:
+  // Checkpoint storage for normal coordinates, see IntrinsicTriangulation::checkpoint()
+  Eigen::Matrix<int, Eigen::Dynamic, 1> checkpointEdgeCoords;
+  Eigen::Matrix<int, Eigen::Dynamic, 1> checkpointRoundabouts;
+  Eigen::Matrix<int, Eigen::Dynamic, 1> checkpointRoundaboutDegrees;
+  void saveCheckpointData() override;
+  void restoreCheckpointData() override;
+
 private:
   // Implementation details
 
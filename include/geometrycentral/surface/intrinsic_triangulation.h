@@ -73,6 +73,7 @@ public:
 
   // Parameters
   double triangleTestEPS = 1e-6; // used for numerical checks in mesh operations
+  size_t traceThreads = 1; // threads used to trace all edges at once, e.g. for the common subdivision (0: all hardware)
 
 
   // ======================================================
@@ -141,24 +142,32 @@ public:
   //
   // Call once to build a useful triangulation
 
-  // Flips edges in the intrinsic triangulation until is satisfies the intrinsic Delaunay criterion
-  void flipToDelaunay();
+  // Flips edges in the intrinsic triangulation until is satisfies the intrinsic Delaunay criterion.
+  // With nThreads != 1 (0 means one per hardware thread), edges are flipped concurrently in rounds, where each round
+  // flips a set of non-Delaunay edges whose diamonds share no vertices. The rounds do not depend on the number of
+  // threads. Flip callbacks are invoked from the calling thread, after each round.
+  void flipToDelaunay(size_t nThreads = 1);
 
   // Perform intrinsic Delaunay refinement the intrinsic triangulation until it simultaneously:
   //   - satisfies the intrinsic Delaunay criterion
   //   - has no angles smaller than `angleThreshDegrees` (values > 30 degrees may not terminate)
   //   - has no triangles larger than `circumradiusThresh`
   // Terminates no matter what after maxInsertions insertions (infinite by default)
+  // With nThreads != 1 (0 means one per hardware thread), refinement proceeds in batches: each round locates the
+  // circumcenters of all faces which need refinement in parallel, then inserts those whose neighborhoods share no
+  // vertices, and flips back to Delaunay in parallel rounds (as in flipToDelaunay()).
   void delaunayRefine(double angleThreshDegrees = 25.,
                       double circumradiusThresh = std::numeric_limits<double>::infinity(),
-                      size_t maxInsertions = INVALID_IND);
+                      size_t maxInsertions = INVALID_IND, size_t nThreads = 1);
 
 
   // General version of intrinsic Delaunay refinement, taking a function which will be called
   // to determine if a triangle should be refined.
   // Will return only when all triangles pass this function, or maxInsertions is exceeded, so
   // be sure to chose arguments such that the function terminates.
-  void delaunayRefine(const std::function<bool(Face)>& shouldRefine, size_t maxInsertions = INVALID_IND);
+  // The shouldRefine function is only ever called from the calling thread.
+  void delaunayRefine(const std::function<bool(Face)>& shouldRefine, size_t maxInsertions = INVALID_IND,
+                      size_t nThreads = 1);
 
 
   // ======================================================
@@ -193,6 +202,28 @@ public:
   virtual Halfedge splitEdge(Halfedge he, double tSplit) = 0;
 
 
+  // ======================================================
+  // ======== Checkpoints
+  // ======================================================
+  //
+  // Save the current state of the triangulation, and return to it later. This is much cheaper than constructing a new
+  // triangulation (and repeating any flips or refinement), so it is useful for running several independent experiments
+  // from a common starting point.
+  //
+  // A rollback restores the intrinsic mesh in place, with the same element indices, along with all data maintained by
+  // this class (edge lengths, vertex locations, marked edges, and the data of the subclass), then refreshes quantities.
+  // Any other containers on the intrinsic mesh are left as-is, and no callbacks are invoked.
+
+  // Save the current state, replacing any earlier checkpoint
+  void checkpoint();
+
+  // Return to the state saved by the last checkpoint(). The checkpoint is kept, so this can be called repeatedly.
+  void rollback();
+
+  bool hasCheckpoint() const;
+  void clearCheckpoint();
+
+
   // ==== Misc
   // Recover t-values after tracing
   // Note that really we ought to just report these back from the tracing routine itself, which computes them
@@ -242,7 +273,29 @@ protected:
   // Must be called any time the intrinsic triangulation is modified.
   void triangulationChanged();
 
+  // Parallel implementation of flipToDelaunay(), starting from the given edges. Does not refresh quantities.
+  void flipToDelaunayInRounds(std::vector<Edge> edgesToCheck, size_t nThreads);
+
+  // Find the point where insertCircumcenter() would insert a vertex, without modifying the triangulation
+  SurfacePoint locateCircumcenter(Face f);
+
+  // Call func(i) for each i in [0, n) in parallel, with both this geometry and the input geometry frozen, so that
+  // read-only queries such as tracing may be run concurrently
+  template <typename F>
+  void parallelForFrozen(size_t n, size_t nThreads, F&& func);
+
+  // Checkpoint storage. Per-element data is saved as raw buffers, in the index space of checkpointMesh.
+  // Subclasses which store additional per-element data should extend the save/restore methods.
+  std::unique_ptr<ManifoldSurfaceMesh> checkpointMesh;
+  Eigen::Matrix<double, Eigen::Dynamic, 1> checkpointEdgeLengths;
+  Eigen::Matrix<SurfacePoint, Eigen::Dynamic, 1> checkpointVertexLocations;
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> checkpointMarkedEdges;
+  bool checkpointHasMarkedEdges = false;
+  virtual void saveCheckpointData();
+  virtual void restoreCheckpointData();
+
   // Callback helpers
+  bool flipCallbacksDeferred = false; // if true, invokeEdgeFlipCallbacks() does nothing (the caller invokes them later)
   void invokeEdgeFlipCallbacks(Edge e);
   void invokeFaceInsertionCallbacks(Face f, Vertex v);
   void invokeEdgeSplitCallbacks(Edge e, Halfedge he1, Halfedge he2);
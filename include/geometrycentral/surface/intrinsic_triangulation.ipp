@@ -1,6 +1,7 @@
 #pragma once
 
 #include "geometrycentral/surface/intrinsic_triangulation.h"
+#include "geometrycentral/utilities/parallel.h"
 
 namespace geometrycentral {
 namespace surface {
@@ -18,6 +19,22 @@ inline bool IntrinsicTriangulation::isOnFixedEdge(Vertex v) const {
   return false;
 }
 
+template <typename F>
+void IntrinsicTriangulation::parallelForFrozen(size_t n, size_t nThreads, F&& func) {
+  bool wasFrozen = isFrozen();
+  bool inputWasFrozen = inputGeom.isFrozen();
+  freeze();
+  inputGeom.freeze();
+  try {
+    parallelFor(n, nThreads, func, 16);
+  } catch (...) {
+    if (!wasFrozen) unfreeze();
+    if (!inputWasFrozen) inputGeom.unfreeze();
+    throw;
+  }
+  if (!wasFrozen) unfreeze();
+  if (!inputWasFrozen) inputGeom.unfreeze();
+}
 
 template <typename T>
 VertexData<T> IntrinsicTriangulation::sampleFromInput(const VertexData<T>& dataOnInput) {
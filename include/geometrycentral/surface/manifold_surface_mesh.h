@@ -24,6 +24,11 @@ public:
   ManifoldSurfaceMesh(const std::vector<std::vector<size_t>>& polygons,
                       const std::vector<std::vector<std::tuple<size_t, size_t>>>& twins);
 
+  // Build from a flat list of face indices, where every face has the same degree (e.g. faceDegree=3 for triangles).
+  // Face i is given by faceVertexIndices[faceDegree*i] ... faceVertexIndices[faceDegree*i + faceDegree-1]. Avoids
+  // nested lists and hashing, so temporary storage stays small; prefer this for very large meshes.
+  ManifoldSurfaceMesh(const std::vector<size_t>& faceVertexIndices, size_t faceDegree);
+
   virtual ~ManifoldSurfaceMesh();
 
   int eulerCharacteristic() const; // compute the Euler characteristic [O(1)]
@@ -99,18 +104,21 @@ public:
   bool hasBoundary() override;
 
 protected:
-  // Construct directly from internal arrays
-  ManifoldSurfaceMesh(const std::vector<size_t>& heNextArr, const std::vector<size_t>& heVertexArr,
-                      const std::vector<size_t>& heFaceArr, const std::vector<size_t>& vHalfedgeArr,
-                      const std::vector<size_t>& fHalfedgeArr, size_t nBoundaryLoopFillCount);
+  // Construct directly from internal arrays (taken by value, so callers can move them in)
+  ManifoldSurfaceMesh(std::vector<size_t> heNextArr, std::vector<size_t> heVertexArr, std::vector<size_t> heFaceArr,
+                      std::vector<size_t> vHalfedgeArr, std::vector<size_t> fHalfedgeArr,
+                      size_t nBoundaryLoopFillCount);
 
   // Helpers
+  void resolveBoundaryLoops();        // create boundary loops along halfedges which have no face, used in construction
+  void validateVertexNeighborhoods(); // throw if some vertex does not have a single connected fan of faces
   bool ensureEdgeHasInteriorHalfedge(Edge e);     // impose invariant that e.halfedge is interior
   void ensureVertexHasBoundaryHalfedge(Vertex v); // impose invariant that v.halfedge is start of half-disk
   Vertex collapseEdgeAlongBoundary(Edge e);
 
 
   friend class RichSurfaceMeshData;
+  friend class MeshArchive;
 };
 
 } // namespace surface
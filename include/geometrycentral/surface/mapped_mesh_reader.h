@@ -0,0 +1,50 @@
+#pragma once
+
+#include "geometrycentral/surface/manifold_surface_mesh.h"
+#include "geometrycentral/surface/vertex_position_geometry.h"
+#include "geometrycentral/utilities/vector3.h"
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace geometrycentral {
+namespace surface {
+
+// Fast loaders for binary .stl and binary little-endian .ply files. The file is memory-mapped and decoded in parallel
+// straight into flat position and face index arrays, which are handed to the mesh constructors without going through
+// a SimplePolygonMesh. The meshio.h readers use this path automatically for files it supports.
+
+// Mesh data decoded from a file, as flat arrays
+struct MappedMeshData {
+  std::vector<Vector3> vertexCoordinates;
+  std::vector<size_t> faceIndices; // the vertices of all faces, concatenated
+
+  // If every face has the same degree, faceDegree is that degree and faceStart is empty. Otherwise faceDegree is 0
+  // and face i is faceIndices[faceStart[i]] ... faceIndices[faceStart[i+1]-1].
+  size_t faceDegree = 0;
+  std::vector<size_t> faceStart;
+
+  size_t nFaces() const;
+  size_t nVertices() const { return vertexCoordinates.size(); }
+  std::vector<std::vector<size_t>> toPolygons() const;
+};
+
+// Load a mesh from a binary .stl or binary little-endian .ply file. As with the other loaders, vertices which appear
+// in no face are removed, and the exactly colocated vertices of .stl files are merged. The type is inferred from the
+// extension if not given.
+//
+// Returns false, leaving data empty, if the file is not in one of the supported encodings (e.g. an ascii file, or a
+// .ply with unusual properties); the caller should then fall back on the general-purpose readers. Throws if the file
+// is in a supported encoding but is truncated or otherwise invalid.
+bool readMappedMesh(std::string filename, std::string type, MappedMeshData& data, size_t nThreads = 1);
+
+// Build a mesh and geometry from decoded data, consuming it
+std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeSurfaceMeshAndGeometry(MappedMeshData&& data, size_t nThreads = 1);
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeManifoldSurfaceMeshAndGeometry(MappedMeshData&& data, size_t nThreads = 1);
+
+} // namespace surface
+} // namespace geometrycentral
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "geometrycentral/surface/manifold_surface_mesh.h"
+#include "geometrycentral/surface/surface_mesh.h"
+#include "geometrycentral/surface/vertex_position_geometry.h"
+#include "geometrycentral/utilities/mapped_file.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace geometrycentral {
+namespace surface {
+
+// A native binary container for a mesh, its vertex positions, and any number of named MeshData<> attributes.
+//
+// The file stores the internal connectivity arrays of the SurfaceMesh (the halfedge permutations, and the boundary loop
+// faces) directly, so loading does not re-derive twins or boundary loops. It is read through a memory mapping: only
+// the connectivity is decoded on open, and attributes are copied out of the mapping when requested. Each chunk of the
+// file carries a checksum, and the format is versioned.
+//
+// Like RichSurfaceMeshData, no operations are valid if the mesh is modified after the creation of the archive.
+class MeshArchive {
+
+public:
+  // Create an archive for writing the given mesh. Connectivity is always included; geometry and other data can be added.
+  MeshArchive(SurfaceMesh& mesh);
+
+  // Open an archive, mapping its attributes onto an existing mesh, which must have the connectivity that was written.
+  // Checksums and index ranges are verified using nThreads threads (0 means one per hardware thread).
+  MeshArchive(SurfaceMesh& mesh, std::string filename, bool verifyChecksums = true, size_t nThreads = 1);
+
+  // Open an archive and construct the mesh it holds
+  static std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<MeshArchive>>
+  readMeshAndData(std::string filename, bool verifyChecksums = true, size_t nThreads = 1);
+  static std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<MeshArchive>>
+  readManifoldMeshAndData(std::string filename, bool verifyChecksums = true, size_t nThreads = 1);
+
+  // Write this object out to file, computing checksums using nThreads threads
+  void write(std::string filename, size_t nThreads = 1);
+
+  // === Attributes
+
+  // Attributes may hold any of the types with a MeshArchiveTypeName<> below
+  template <typename E, typename T>
+  void addElementProperty(std::string propertyName, const MeshData<E, T>& data);
+  template <typename E, typename T>
+  MeshData<E, T> getElementProperty(std::string propertyName) const;
+
+  bool hasProperty(std::string propertyName) const;
+  std::vector<std::string> getPropertyNames() const;
+
+  // Store the vertex positions of a geometry, and build a geometry from stored positions
+  void addGeometry(EmbeddedGeometryInterface& geometry);
+  std::unique_ptr<VertexPositionGeometry> getGeometry() const;
+
+  // Format version written by this class; files with a newer version cannot be read
+  static const uint32_t VERSION = 1;
+
+private:
+  // Open the file and read (and optionally verify) the chunk listing
+  MeshArchive(std::string filename, bool verifyChecksums, size_t nThreads);
+  void loadMeshFromFile(size_t nThreads);
+
+  struct Chunk {
+    std::string name;
+    std::string typeName;
+    uint32_t elementType = 0; // 0 for connectivity, or meshArchiveElementCode<E>() for attributes
+    uint32_t valueBytes = 0;
+    uint64_t count = 0;
+    const char* mappedData = nullptr; // points into the mapped file for chunks that were read
+    std::vector<char> ownedData;      // holds the values of chunks that were added
+
+    const char* data() const { return mappedData != nullptr ? mappedData : ownedData.data(); }
+  };
+
+  const Chunk& getChunk(std::string name) const;
+  void addChunk(std::string name, std::string typeName, uint32_t elementType, uint32_t valueBytes, uint64_t count,
+                std::vector<char>&& data);
+  void addConnectivityChunks();
+
+  // The mesh on which the properties in this file are presumed to exist
+  SurfaceMesh* mesh = nullptr;
+
+  std::unique_ptr<MappedFile> file;
+  std::vector<Chunk> chunks;
+};
+
+// Type names recorded with attributes, checked when reading them back
+// clang-format off
+template <typename T> struct MeshArchiveTypeName;
+template <> struct MeshArchiveTypeName<char>               { static std::string name() { return "char"; } };
+template <> struct MeshArchiveTypeName<bool>               { static std::string name() { return "bool"; } };
+template <> struct MeshArchiveTypeName<int8_t>             { static std::string name() { return "int8"; } };
+template <> struct MeshArchiveTypeName<uint8_t>            { static std::string name() { return "uint8"; } };
+template <> struct MeshArchiveTypeName<int16_t>            { static std::string name() { return "int16"; } };
+template <> struct MeshArchiveTypeName<uint16_t>           { static std::string name() { return "uint16"; } };
+template <> struct MeshArchiveTypeName<int32_t>            { static std::string name() { return "int32"; } };
+template <> struct MeshArchiveTypeName<uint32_t>           { static std::string name() { return "uint32"; } };
+template <> struct MeshArchiveTypeName<int64_t>            { static std::string name() { return "int64"; } };
+template <> struct MeshArchiveTypeName<uint64_t>           { static std::string name() { return "uint64"; } };
+template <> struct MeshArchiveTypeName<float>              { static std::string name() { return "float"; } };
+template <> struct MeshArchiveTypeName<double>             { static std::string name() { return "double"; } };
+template <> struct MeshArchiveTypeName<Vector2>            { static std::string name() { return "Vector2"; } };
+template <> struct MeshArchiveTypeName<Vector3>            { static std::string name() { return "Vector3"; } };
+// clang-format on
+
+} // namespace surface
+} // namespace geometrycentral
+
+#include "geometrycentral/surface/mesh_archive.ipp"
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstring>
+#include <stdexcept>
+
+namespace geometrycentral {
+namespace surface {
+
+// Codes for the element type of each attribute
+// clang-format off
+template <typename E> uint32_t meshArchiveElementCode() { return 0; }
+template<> inline uint32_t meshArchiveElementCode<Vertex       >() { return 1; }
+template<> inline uint32_t meshArchiveElementCode<Halfedge     >() { return 2; }
+template<> inline uint32_t meshArchiveElementCode<Corner       >() { return 3; }
+template<> inline uint32_t meshArchiveElementCode<Edge         >() { return 4; }
+template<> inline uint32_t meshArchiveElementCode<Face         >() { return 5; }
+template<> inline uint32_t meshArchiveElementCode<BoundaryLoop >() { return 6; }
+// clang-format on
+
+template <typename E, typename T>
+void MeshArchive::addElementProperty(std::string propertyName, const MeshData<E, T>& data) {
+
+  // Pack the values densely, in element iteration order
+  size_t count = nElements<E>(mesh);
+  std::vector<char> bytes(count * sizeof(T));
+  size_t i = 0;
+  for (E e : iterateElements<E>(mesh)) {
+    std::memcpy(&bytes[i * sizeof(T)], &data[e], sizeof(T));
+    i++;
+  }
+
+  addChunk(propertyName, MeshArchiveTypeName<T>::name(), meshArchiveElementCode<E>(), sizeof(T), count,
+           std::move(bytes));
+}
+
+template <typename E, typename T>
+MeshData<E, T> MeshArchive::getElementProperty(std::string propertyName) const {
+  const Chunk& chunk = getChunk(propertyName);
+
+  if (chunk.elementType != meshArchiveElementCode<E>()) {
+    throw std::runtime_error("Property " + propertyName + " is not defined on " + typeShortName<E>());
+  }
+  if (chunk.typeName != MeshArchiveTypeName<T>::name() || chunk.valueBytes != sizeof(T)) {
+    throw std::runtime_error("Property " + propertyName + " has type " + chunk.typeName + ", not " +
+                             MeshArchiveTypeName<T>::name());
+  }
+  if (chunk.count != nElements<E>(mesh)) {
+    throw std::runtime_error("Property " + propertyName + " does not have size equal to number of " +
+                             typeShortName<E>());
+  }
+
+  MeshData<E, T> result(*mesh);
+  size_t i = 0;
+  for (E e : iterateElements<E>(mesh)) {
+    std::memcpy(&result[e], chunk.data() + i * sizeof(T), sizeof(T));
+    i++;
+  }
+
+  return result;
+}
+
+} // namespace surface
+} // namespace geometrycentral
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "geometrycentral/surface/manifold_surface_mesh.h"
+#include "geometrycentral/surface/vertex_position_geometry.h"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace geometrycentral {
+namespace surface {
+
+// A compact lossy encoding of a manifold mesh and its vertex positions, for archiving and transfer (files with the
+// extension .gcz).
+//
+// Connectivity is coded exactly, by a traversal in the style of Edgebreaker: faces are visited across the halfedges of
+// a growing front, and each step is recorded as one of a few operations (reach a new face or boundary loop, or zip the
+// gate to another halfedge of the front), which are entropy coded. This handles polygonal faces, boundary, any genus,
+// and any number of connected components. Vertex positions are quantized to a grid over the bounding box, predicted from
+// their neighbors in the traversal, and the residuals entropy coded.
+//
+// The data is split into independently coded streams, one per connected component and one per block of vertex
+// positions, so both encoding and decoding run in parallel.
+
+struct MeshCompressionOptions {
+  int positionBits = 16;             // bits per coordinate of the quantized positions, from 1 to 31
+  bool preserveElementOrder = false; // if false, vertices and faces come back in traversal order (the same mesh, with
+                                     // its elements renumbered); if true, indices and the starting vertex of each face
+                                     // are stored too, at some cost in size
+  size_t nThreads = 1;               // 0 means one per hardware thread
+};
+extern const MeshCompressionOptions defaultMeshCompressionOptions;
+
+struct MeshCompressionStats {
+  size_t compressedBytes = 0;
+  size_t connectivityBytes = 0;
+  size_t positionBytes = 0;
+  size_t orderBytes = 0;        // element order, if preserved
+  size_t uncompressedBytes = 0; // the same data as double positions and 32-bit face indices, as in a binary .ply
+  double compressionRatio = 0.; // uncompressedBytes / compressedBytes
+  double maxPositionError = 0.; // largest distance between an input position and its quantized value
+};
+
+// Encode a mesh to bytes. Throws a std::runtime_error if a position is not finite, or if the mesh has vertices in no
+// face or several edges between the same pair of vertices. If stats is not null, it is filled with the sizes of the
+// parts of the encoding.
+std::vector<char> compressSurfaceMesh(ManifoldSurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                      const MeshCompressionOptions& options = defaultMeshCompressionOptions,
+                                      MeshCompressionStats* stats = nullptr);
+
+// Decode a mesh from bytes. Throws a std::runtime_error if the data is not a valid encoding.
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+decompressSurfaceMesh(const char* data, size_t nBytes, size_t nThreads = 1);
+
+// Read and write encoded meshes. The meshio.h readers and writers also use these for the "gcz" type.
+MeshCompressionStats writeCompressedSurfaceMesh(ManifoldSurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                                std::string filename,
+                                                const MeshCompressionOptions& options = defaultMeshCompressionOptions);
+MeshCompressionStats writeCompressedSurfaceMesh(ManifoldSurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                                std::ostream& out,
+                                                const MeshCompressionOptions& options = defaultMeshCompressionOptions);
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+readCompressedSurfaceMesh(std::string filename, size_t nThreads = 1);
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+readCompressedSurfaceMesh(std::istream& in, size_t nThreads = 1);
+
+} // namespace surface
+} // namespace geometrycentral
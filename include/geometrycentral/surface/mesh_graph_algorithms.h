@@ -1,9 +1,13 @@
 #pragma once
 
+#include "geometrycentral/surface/embedded_geometry_interface.h"
 #include "geometrycentral/surface/intrinsic_geometry_interface.h"
 #include "geometrycentral/surface/manifold_surface_mesh.h"
 
+#include <cstdint>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace geometrycentral {
 namespace surface {
@@ -16,6 +20,54 @@ std::vector<Halfedge> shortestEdgePath(IntrinsicGeometryInterface& geom, Vertex
 // Return the Dijstra distance to all vertices within the ball radius
 std::unordered_map<Vertex, double> vertexDijkstraDistanceWithinRadius(IntrinsicGeometryInterface& geom, Vertex startVert, double ballRad);
 
+// Stateful Dijkstra search along the edges of a mesh, for efficient repeated queries.
+// Per-vertex distances and parents are stored in flat arrays which are kept between searches, and invalidated with a
+// per-search stamp rather than cleared, so each search only touches the vertices it visits. If the geometry is an
+// embedded geometry, point-to-point searches use A* with the Euclidean distance to the target as a heuristic.
+// The mesh may be modified between searches.
+class GraphDistanceEngine {
+public:
+  GraphDistanceEngine(IntrinsicGeometryInterface& geom);
+  ~GraphDistanceEngine();
+
+  // Returns the shortest path between two vertices, or an empty vector if the target is unreachable
+  std::vector<Halfedge> shortestEdgePath(Vertex startVert, Vertex endVert);
+
+  // Returns the shortest paths from one vertex to each of the targets, all found with a single search
+  std::vector<std::vector<Halfedge>> shortestEdgePaths(Vertex startVert, const std::vector<Vertex>& targets);
+
+  // Returns all vertices within the ball radius, in order of increasing distance (see getDistance())
+  const std::vector<Vertex>& verticesWithinRadius(Vertex startVert, double ballRad);
+
+  // Distance to a vertex reached by the last search, or infinity
+  double getDistance(Vertex v) const;
+
+  // Is the A* heuristic in use?
+  bool usesEuclideanHeuristic() const;
+
+private:
+  IntrinsicGeometryInterface& geom;
+  EmbeddedGeometryInterface* embeddedGeom; // null if the geometry is not embedded
+
+  // Search state, valid where the stamp matches the current search
+  uint32_t currentStamp = 0;
+  VertexData<uint32_t> discoveredStamp;
+  VertexData<uint32_t> finalizedStamp;
+  VertexData<uint32_t> targetStamp;
+  VertexData<double> distance;
+  VertexData<Halfedge> incomingHalfedge;
+
+  typedef std::pair<double, Vertex> WeightedVertex;
+  std::vector<WeightedVertex> heap; // min-heap, with stale entries
+  std::vector<Vertex> finalizedVertices;
+
+  // Run a search, stopping once the ball radius is exhausted or nTargets marked targets have been finalized. If
+  // heuristicTarget is not null, the A* heuristic is used for that target.
+  void search(Vertex startVert, double ballRad, size_t nTargets, Vertex heuristicTarget);
+  void startSearch();
+  std::vector<Halfedge> pathTo(Vertex startVert, Vertex endVert) const;
+};
+
 // Find a subset of edges which connects all vertices
 // Return value holds 'true' for an edge if it is in the tree
 EdgeData<char> minimalSpanningTree(IntrinsicGeometryInterface& geom);
@@ -6,6 +6,7 @@
 #include "geometrycentral/surface/vertex_position_geometry.h"
 
 #include <fstream>
+#include <future>
 #include <string>
 
 namespace geometrycentral {
@@ -39,7 +40,12 @@ std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionG
 loadMesh(std::string filename, std::string type = "");
 
 
-// Write a surface mesh
+// Write a surface mesh.
+//
+// Note that .gcz files are lossy: positions are quantized to 16 bits per coordinate over the bounding box, and vertices
+// and faces are renumbered. Only a ManifoldSurfaceMesh without repeated edges (several edges between the same pair of
+// vertices) can be written as .gcz. Use writeCompressedSurfaceMesh() in mesh_compression.h to choose the precision or
+// keep the element order.
 void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, std::string filename,
                       std::string type = "");
 void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, CornerData<Vector2>& texCoords,
@@ -48,6 +54,16 @@ void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, st
 void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, CornerData<Vector2>& texCoords,
                       std::ostream& out, std::string type);
 
+// Write a surface mesh in the background. The connectivity, positions, and texture coordinates are copied before
+// returning, so the mesh and geometry may be modified (or destroyed) right away; formatting and writing then happen on
+// another thread. Call get() on the returned future to wait for the write to finish, and to rethrow any error. Note
+// that the destructor of the returned future also waits for the write to finish, so a future which is discarded (or
+// goes out of scope) blocks right there, and any error is lost. Texture coordinates cannot be written to .gcz files.
+std::future<void> writeSurfaceMeshAsync(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, std::string filename,
+                                        std::string type = "");
+std::future<void> writeSurfaceMeshAsync(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                        CornerData<Vector2>& texCoords, std::string filename, std::string type = "");
+
 // Helpers to map vertex data
 CornerData<Vector2> packToParam(SurfaceMesh& mesh, VertexData<double>& vals); // 0 in Y coord
 CornerData<Vector2> packToParam(SurfaceMesh& mesh, VertexData<double>& valsX, VertexData<double>& valsY);
@@ -72,7 +88,7 @@ protected:
 };
 
 
-// TODO write halfedge mesh as a permutation, in binary format (for quicker loading/smaller files)
+// (to write the halfedge mesh directly in a binary format, for quicker loading, see mesh_archive.h)
 
 
 // === Integrations with other libraries and formats
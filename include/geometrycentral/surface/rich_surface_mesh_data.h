@@ -4,6 +4,7 @@
 #include "geometrycentral/surface/surface_mesh.h"
 #include "geometrycentral/surface/vertex_position_geometry.h"
 #include "geometrycentral/surface/edge_length_geometry.h"
+#include "geometrycentral/utilities/binary_ply.h"
 
 #include "happly.h"
 
@@ -18,6 +19,11 @@ namespace surface {
 // A reader/writer class supporting direct interop between the GeometryCentral mesh types and the .ply file
 // format. Allows storing and retriving of VertexData<> etc containers.
 // No operations are valid if the mesh is modified after the creation of the reader/writer.
+//
+// Binary files opened by name are memory-mapped, and each property is decoded only when it is requested. Properties
+// added to this object are serialized to a temporary file as they are added, and the output file is streamed from
+// those (and from the mapped input) by write(). So at most one property is held in memory at a time, rather than the
+// entire file.
 class RichSurfaceMeshData {
 
   // TODO give helpers to store Vector2 and Vector3 types easily, rather than having to store each component manually.
@@ -41,7 +47,9 @@ public:
   static std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<RichSurfaceMeshData>>
   readManifoldMeshAndData(std::istream& in);
 
-  // The underlying reader/writer object
+  // The underlying reader/writer object, for files read from streams or in ascii.
+  // Binary files read by name, and properties added through this class, are not held here; if anything is added to
+  // plyData directly, write() merges everything in to it, and writes it out with happly.
   happly::PLYData plyData;
 
   // Write this object out to file
@@ -133,6 +141,21 @@ private:
   RichSurfaceMeshData(std::istream& in);
   void loadMeshFromFile();
 
+  // Map the file if it is binary, or read it with happly otherwise
+  void openFile(std::string filename);
+
+  // Properties are looked up in streamData first, then plyData
+  bool hasFileElement(std::string elementName);
+  bool hasFileProperty(std::string elementName, std::string propertyName);
+  template <typename T>
+  std::vector<T> readFileProperty(std::string elementName, std::string propertyName);
+
+  // Move everything in streamData in to plyData, to write with happly
+  void mergeIntoPlyData();
+
+  // Properties from a mapped input file, and properties which have been added, to be streamed out by write()
+  PlyStreamWriter streamData;
+
   // The mesh on which the properties in this file are presumed to exist
   SurfaceMesh* mesh = nullptr;
 
@@ -15,13 +15,22 @@ template<> inline std::string plyElementName<BoundaryLoop >()            { retur
 // clang-format on
 
 
+template <typename T>
+std::vector<T> RichSurfaceMeshData::readFileProperty(std::string elementName, std::string propertyName) {
+  if (streamData.hasProperty(elementName, propertyName)) {
+    return streamData.getProperty<T>(elementName, propertyName);
+  }
+  return plyData.getElement(elementName).getProperty<T>(propertyName);
+}
+
+
 // Generic implementations which handle all element types
 
 template <typename E, typename T>
 MeshData<E, T> RichSurfaceMeshData::getElementProperty(std::string propertyName) {
 
   std::string eName = plyElementName<E>();
-  std::vector<T> rawData = plyData.getElement(eName).getProperty<T>(propertyName);
+  std::vector<T> rawData = readFileProperty<T>(eName, propertyName);
 
   if (rawData.size() != nElements<E>(mesh)) {
     throw std::runtime_error("Property " + propertyName + " does not have size equal to number of " + eName);
@@ -42,18 +51,14 @@ void RichSurfaceMeshData::addElementProperty(std::string propertyName, const Mes
 
   std::string eName = plyElementName<E>();
 
-  // Make sure the element exists
-  if (!plyData.hasElement(eName)) {
-    plyData.addElement(eName, nElements<E>(mesh));
-  }
-
   std::vector<T> vec;
   vec.reserve(nElements<E>(mesh));
   for (E e : iterateElements<E>(mesh)) {
     vec.push_back(data[e]);
   }
 
-  plyData.getElement(eName).addProperty<T>(propertyName, vec);
+  // Written to a temporary file straight away, so only this one property is held in memory
+  streamData.addProperty<T>(eName, propertyName, vec);
 }
 
 
@@ -78,6 +78,12 @@ public:
   Halfedge splitEdge(Halfedge he, double tSplit) override;
 
 protected:
+  // Checkpoint storage for signposts, see IntrinsicTriangulation::checkpoint()
+  Eigen::Matrix<double, Eigen::Dynamic, 1> checkpointSignpostAngle;
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> checkpointEdgeIsOriginal;
+  void saveCheckpointData() override;
+  void restoreCheckpointData() override;
+
 private:
   // ======================================================
   // ======== Geometry Interface
@@ -11,10 +11,12 @@ namespace surface {
 // A simplified interface for flip-based intrinsic Delaunay triangulations, which only supports a length-based
 // representation. See signpost_intrinsic_triangulation.h for much more advanced functionality
 
-// Modifies both the underlying mesh and edge lengths to make the intrinsic Delaunay
+// Modifies both the underlying mesh and edge lengths to make the intrinsic Delaunay. Returns the number of flips.
+// With nThreads != 1 (0 means one per hardware thread), edges whose faces share no vertices are flipped concurrently, in
+// rounds which do not depend on the number of threads.
 enum class FlipType { Euclidean = 0, Hyperbolic };
 size_t flipToDelaunay(SurfaceMesh& mesh, EdgeData<double>& edgeLengths, FlipType flipType = FlipType::Euclidean,
-                      double delaunayEPS = 1e-6);
+                      double delaunayEPS = 1e-6, size_t nThreads = 1);
 
 } // namespace surface
 } // namespace geometrycentral
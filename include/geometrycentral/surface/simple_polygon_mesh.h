@@ -28,6 +28,9 @@ public:
   std::vector<Vector3> vertexCoordinates;
   std::vector<std::vector<Vector2>> paramCoordinates; // optional UV coords, in correspondence with polygons array
 
+  // == Options
+  size_t nThreads = 1; // threads used to read and write files, and by the mutators below (0: all hardware)
+
   // == Accessors
   inline size_t nFaces() const { return polygons.size(); }
   inline size_t nVertices() const { return vertexCoordinates.size(); }
@@ -37,8 +40,9 @@ public:
 
   // Mutate this mesh by merging vertices with identical floating point positions.
   // Useful for loading .stl files, which don't contain information about which
-  // triangle corners meet at vertices.
-  void mergeIdenticalVertices();
+  // triangle corners meet at vertices. If tolerance > 0, vertices which fall in the
+  // same cell of a grid with that spacing are merged instead (see vertex_welding.h). Runs on nThreads threads.
+  void mergeIdenticalVertices(double tolerance = 0.);
 
   // Mutate this mesh by removing any entries in vertexCoordinates which appear in any polygon. Update polygon indexing
   // accordingly.
@@ -58,6 +62,8 @@ public:
 
   // === Input & ouput
 
+  // .obj files are parsed and written in chunks, which are spread across nThreads threads. The result does not depend
+  // on the number of threads.
   void readMeshFromFile(std::istream& in, std::string type);
   void readMeshFromFile(std::string filename, std::string type = "");
   void readMeshFromFile(std::string filename, std::string type,
@@ -79,6 +85,7 @@ private:
 
   // Write helpers
   void writeMeshObj(std::ostream& out);
+  void writeMeshPly(std::ostream& out); // binary
 };
 
 std::unique_ptr<SimplePolygonMesh> unionMeshes(const std::vector<SimplePolygonMesh>& meshes);
@@ -5,8 +5,10 @@
 #include "geometrycentral/utilities/mesh_data.h"
 #include "geometrycentral/utilities/utilities.h"
 
+#include <atomic>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 // NOTE: ipp includes at bottom of file
@@ -32,6 +34,15 @@ using BoundaryLoopData = MeshData<BoundaryLoop, T>;
 class ManifoldSurfaceMesh;
 class RichSurfaceMeshData;
 
+// Memory held by a mesh and the containers defined on it, see SurfaceMesh::getMemoryReport()
+struct SurfaceMeshMemoryReport {
+  size_t connectivityBytes = 0; // connectivity arrays (including reserved capacity)
+  size_t nMeshData = 0;         // number of MeshData<> containers currently defined on the mesh
+  size_t meshDataBytes = 0;     // total size of the buffers held by those containers
+
+  size_t totalBytes() const { return connectivityBytes + meshDataBytes; }
+};
+
 
 // ==========================================================
 // ===================    Surface Mesh   ====================
@@ -58,6 +69,15 @@ public:
   SurfaceMesh(const std::vector<std::vector<size_t>>& polygons,
               const std::vector<std::vector<std::tuple<size_t, size_t>>>& twins);
 
+  // Build from a flat list of face indices, producing the same mesh as the polygon list constructor above. Avoids
+  // nested lists and hashing, so temporary storage stays small; prefer these for very large meshes.
+  // - with `faceDegree`, every face has that degree, and face i is faceVertexIndices[faceDegree*i] ...
+  //   faceVertexIndices[faceDegree*i + faceDegree-1]
+  // - with `faceStart`, which holds nFaces+1 offsets, face i is faceVertexIndices[faceStart[i]] ...
+  //   faceVertexIndices[faceStart[i+1]-1]
+  SurfaceMesh(const std::vector<size_t>& faceVertexIndices, size_t faceDegree);
+  SurfaceMesh(const std::vector<size_t>& faceVertexIndices, const std::vector<size_t>& faceStart);
+
   virtual ~SurfaceMesh();
 
 
@@ -118,6 +138,8 @@ public:
   virtual bool isEdgeManifold();
   virtual bool isOriented();
   void printStatistics() const; // print info about element counts to std::cout
+  SurfaceMeshMemoryReport getMemoryReport() const; // memory used by connectivity and all MeshData<> on this mesh
+  size_t bufferBytes() const;                      // getMemoryReport().totalBytes()
 
   virtual VertexData<bool> getVertexManifoldStatus();
   virtual EdgeData<bool> getEdgeManifoldStatus();
@@ -137,6 +159,11 @@ public:
   virtual std::unique_ptr<SurfaceMesh> copyToSurfaceMesh() const;
   std::unique_ptr<ManifoldSurfaceMesh> toManifoldMesh();
 
+  // Overwrite the connectivity of this mesh with that of `savedCopy`, which should be an earlier copy() of this mesh.
+  // The mesh is modified in place, so containers on this mesh stay attached (and are resized if needed), but their
+  // values are not changed. Element indices become those of the copy.
+  void restoreConnectivity(const SurfaceMesh& savedCopy);
+
   // Compress the mesh
   bool isCompressed() const;
   void compress();
@@ -200,6 +227,14 @@ public:
   // need to know not to try to de-register them if the mesh has been deleted)
   std::list<std::function<void()>> meshDeleteCallbackList;
 
+  // Memory accounting callbacks
+  // Each MeshData<> container registered on this mesh reports the number of bytes held by its buffer
+  std::list<std::function<size_t()>> meshDataMemoryCallbackList;
+
+  // Guards registration of the callbacks above, so that containers can be created and destroyed from many threads at
+  // once (e.g. queries against a shared, frozen geometry)
+  mutable std::mutex callbackRegistrationMutex;
+
   // Check capacity. Needed when implementing expandable containers for mutable meshes to ensure the contain can
   // hold a sufficient number of elements before the next resize event.
   size_t nHalfedgesCapacity() const;
@@ -223,11 +258,11 @@ protected:
   SurfaceMesh(bool useImplicitTwin = false);
 
   // Construct directly from internal arrays
-  SurfaceMesh(const std::vector<size_t>& heNextArr, const std::vector<size_t>& heVertexArr,
-              const std::vector<size_t>& heFaceArr, const std::vector<size_t>& vHalfedgeArr,
-              const std::vector<size_t>& fHalfedgeArr, const std::vector<size_t>& heSiblingArr,
-              const std::vector<size_t>& heEdgeArr, const std::vector<char>& heOrientArr,
-              const std::vector<size_t>& eHalfedgeArr, size_t nBoundaryLoopFillCount);
+  // (arrays are taken by value, so callers can move them in)
+  SurfaceMesh(std::vector<size_t> heNextArr, std::vector<size_t> heVertexArr, std::vector<size_t> heFaceArr,
+              std::vector<size_t> vHalfedgeArr, std::vector<size_t> fHalfedgeArr, std::vector<size_t> heSiblingArr,
+              std::vector<size_t> heEdgeArr, std::vector<char> heOrientArr, std::vector<size_t> eHalfedgeArr,
+              size_t nBoundaryLoopFillCount);
 
   // = Core arrays which hold the connectivity
   // Note: it should always be true that heFace.size() == nHalfedgesCapacityCount, but any elements after
@@ -328,7 +363,9 @@ protected:
   // Call compress() to re-index and return to usual dense indexing.
   bool isCompressedFlag = true;
 
-  uint64_t modificationTick = 1; // Increment every time the mesh is mutated in any way. Used to track staleness.
+  // Increment every time the mesh is mutated in any way. Used to track staleness. (Atomic, since disjoint local
+  // mutations may run concurrently, as in IntrinsicTriangulation::flipToDelaunay().)
+  std::atomic<uint64_t> modificationTick{1};
 
   // Hide copy and move constructors, we don't wanna mess with that
   SurfaceMesh(const SurfaceMesh& other) = delete;
@@ -371,6 +408,8 @@ protected:
   // = =Helpers for mutation methods and similar things
 
   void initializeHalfedgeNeighbors();
+  void initializeFromFlatFaces(const std::vector<size_t>& faceVertexIndices, size_t faceDegree,
+                               const std::vector<size_t>& faceStart);
   void copyInternalFields(SurfaceMesh& target) const;
 
   // replace values of i in arr with oldToNew[i] (skipping INVALID_IND)
@@ -407,6 +446,7 @@ protected:
   friend struct VertexNeighborIteratorState;
 
   friend class RichSurfaceMeshData;
+  friend class MeshArchive;
 };
 
 } // namespace surface
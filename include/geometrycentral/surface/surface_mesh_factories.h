@@ -63,6 +63,35 @@ template <typename Scalar_V, typename Scalar_F>
 std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
 makeSurfaceMeshAndGeometry(const Eigen::MatrixBase<Scalar_V>& vMat, const Eigen::MatrixBase<Scalar_F>& fMat);
 
+
+// == Procedural meshes
+// These generate meshes of arbitrary resolution, e.g. for testing and scaling studies. Connectivity is assembled from
+// flat index buffers, so construction remains fast and memory-lean even for 100M+ face meshes.
+
+// A planar grid of nX x nY quads in the xy-plane, spanning [0,1]x[0,1]. If `triangulate` is true, each quad is split
+// into two triangles. Vertex (i,j) has index i + (nX+1)*j.
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeGridMeshAndGeometry(size_t nX, size_t nY, bool triangulate = true);
+
+// A torus of revolution about the z-axis, with nMajor x nMinor quads (each at least 3). If `triangulate` is true, each
+// quad is split into two triangles.
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeTorusMeshAndGeometry(size_t nMajor, size_t nMinor, double majorRadius = 1., double minorRadius = 0.25,
+                         bool triangulate = true);
+
+// A unit sphere, made by dividing each edge of an icosahedron into `frequency` segments, filling each face with the
+// resulting triangular lattice, and projecting to the sphere. Has 20*frequency^2 faces and 10*frequency^2+2 vertices.
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeIcosphereMeshAndGeometry(size_t frequency);
+
+// Randomly displace every vertex position by up to `amplitude` along each coordinate axis. Deterministic for a given
+// seed.
+void perturbVertexPositions(VertexPositionGeometry& geometry, double amplitude, unsigned int seed = 0);
+
+// Snap a random `fraction` of vertices exactly on to the position of one of their neighbors, producing zero-length
+// edges and zero-area faces. Useful to exercise degenerate cases. Deterministic for a given seed.
+void degenerateVertexPositions(VertexPositionGeometry& geometry, double fraction, unsigned int seed = 0);
+
 } // namespace surface
 } // namespace geometrycentral
 
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "geometrycentral/utilities/mapped_file.h"
+#include "geometrycentral/utilities/utilities.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace geometrycentral {
+
+// Direct access to binary little-endian .ply files, one property at a time. These are used by the readers and writers
+// which avoid loading entire files through happly (see mapped_mesh_reader.h and RichSurfaceMeshData).
+
+// === Layout
+
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+bool parsePlyType(const std::string& name, PlyType& type);
+std::string plyTypeName(PlyType type);
+size_t plyTypeSize(PlyType type);
+
+// Whether values stored as `from` can be read as `to` without loss. As in happly, integers may be widened within the
+// signed or the unsigned types, and floats may be widened to doubles.
+bool plyTypeConvertible(PlyType from, PlyType to);
+
+// The ply type used to store each C++ type
+// clang-format off
+template <typename T> struct PlyTypeOf;
+template <> struct PlyTypeOf<char>           { static const PlyType type = PlyType::Int8;    };
+template <> struct PlyTypeOf<signed char>    { static const PlyType type = PlyType::Int8;    };
+template <> struct PlyTypeOf<unsigned char>  { static const PlyType type = PlyType::UInt8;   };
+template <> struct PlyTypeOf<int16_t>        { static const PlyType type = PlyType::Int16;   };
+template <> struct PlyTypeOf<uint16_t>       { static const PlyType type = PlyType::UInt16;  };
+template <> struct PlyTypeOf<int32_t>        { static const PlyType type = PlyType::Int32;   };
+template <> struct PlyTypeOf<uint32_t>       { static const PlyType type = PlyType::UInt32;  };
+template <> struct PlyTypeOf<float>          { static const PlyType type = PlyType::Float32; };
+template <> struct PlyTypeOf<double>         { static const PlyType type = PlyType::Float64; };
+// clang-format on
+
+// Read a little-endian value stored with the given type, from a possibly-unaligned location
+template <typename T>
+T readPlyValue(const char* p, PlyType type);
+
+struct PlyProperty {
+  std::string name;
+  bool isList = false;
+  PlyType type = PlyType::Float64; // value type
+  PlyType countType = PlyType::UInt8; // only for lists
+};
+
+struct PlyElement {
+  std::string name;
+  size_t count = 0;
+  std::vector<PlyProperty> properties;
+
+  bool allScalar() const;
+  size_t scalarStride() const; // bytes per row, when allScalar()
+  size_t propertyIndex(const std::string& propertyName) const; // INVALID_IND if there is no such property
+};
+
+// Parse the header of a .ply file held in [begin, end). Returns false if it is not a well-formed ply header. On
+// success, `format` holds the format keyword (like "binary_little_endian"), and `headerSize` the number of bytes up
+// to and including the "end_header" line.
+bool parsePlyHeader(const char* begin, const char* end, std::string& format, std::vector<PlyElement>& elements,
+                    size_t& headerSize);
+
+// Whether this machine stores values in the byte order of binary_little_endian files
+bool plyHostIsLittleEndian();
+
+// Throw a std::runtime_error unless a property can be read as a (list of) values of the requested type
+void checkPlyPropertyReadable(const PlyProperty& prop, PlyType requestedType, bool requestedList);
+
+
+// === Reading
+
+// Random access to the properties of a binary little-endian .ply file, through a memory mapping. Only the header is
+// parsed when the file is opened; each property is decoded from the mapping when it is requested, so properties which
+// are never read never occupy memory.
+class MappedPlyFile {
+public:
+  // Throws a std::runtime_error if the file cannot be mapped, or is not a binary ply file which canRead() accepts
+  MappedPlyFile(std::string filename);
+
+  // Whether a file is a binary little-endian ply file (and this machine is little-endian). Only reads the header.
+  static bool canRead(std::string filename);
+
+  const std::vector<PlyElement>& getElements() const { return elements; }
+  bool hasElement(std::string elementName) const;
+  bool hasProperty(std::string elementName, std::string propertyName) const;
+  const PlyElement& getElement(std::string elementName) const;
+  const PlyProperty& getPropertyLayout(std::string elementName, std::string propertyName) const;
+
+  // Decode one property of every row of an element. The stored type must be convertible to T (see
+  // plyTypeConvertible()); throws a std::runtime_error otherwise, or if the file is truncated.
+  template <typename T>
+  std::vector<T> getProperty(std::string elementName, std::string propertyName);
+  template <typename T>
+  std::vector<std::vector<T>> getListProperty(std::string elementName, std::string propertyName);
+
+  // Call visit(iRow, bytes) with a pointer to the stored bytes of the property in each row, in order. For lists, the
+  // bytes begin with the count. Rows of elements with only scalar properties are located directly, and visited in
+  // parallel; elements with lists are scanned serially.
+  template <typename F>
+  void forEachRow(std::string elementName, std::string propertyName, F&& visit);
+
+private:
+  // Byte offset of the first row of an element, found (and cached) by scanning earlier elements with lists
+  size_t elementDataOffset(size_t iElement);
+
+  // The size in bytes of the row of `elem` beginning at rowOffset, checking that it lies within the file. Also finds
+  // the offset of property iProperty in the row.
+  size_t rowSize(const PlyElement& elem, size_t rowOffset, size_t iProperty, size_t& propertyOffset) const;
+
+  size_t findElement(const std::string& elementName) const;
+  size_t listCountAt(size_t offset, PlyType countType) const;
+
+  std::unique_ptr<MappedFile> file;
+  std::string filename;
+  std::vector<PlyElement> elements;
+  std::vector<size_t> dataOffsets; // INVALID_IND where not yet known
+
+  friend class PlyStreamWriter;
+};
+
+
+// === Writing
+
+// Writes a binary little-endian .ply file which is built up one property at a time, without holding every property
+// in memory: each added property is serialized to a temporary file straight away, and rows are interleaved from these
+// columns in blocks when the file is written. Properties can also be taken from a MappedPlyFile, in which case they
+// are only read from its mapping at write time.
+class PlyStreamWriter {
+public:
+  PlyStreamWriter();
+  ~PlyStreamWriter();
+
+  PlyStreamWriter(const PlyStreamWriter& other) = delete;
+  PlyStreamWriter& operator=(const PlyStreamWriter& other) = delete;
+  PlyStreamWriter(PlyStreamWriter&& other);
+  PlyStreamWriter& operator=(PlyStreamWriter&& other);
+
+  // Elements are written in the order they are first added. Adding an element which exists checks its count.
+  void addElement(std::string elementName, size_t count);
+
+  // Add a property to an element (adding the element if needed). A property with the same name is replaced.
+  template <typename T>
+  void addProperty(std::string elementName, std::string propertyName, const std::vector<T>& values);
+  template <typename T>
+  void addListProperty(std::string elementName, std::string propertyName, const std::vector<std::vector<T>>& values);
+  void addPropertyFromFile(std::shared_ptr<MappedPlyFile> source, std::string elementName, std::string propertyName);
+
+  void addComment(std::string comment);
+  const std::vector<std::string>& getComments() const { return comments; }
+
+  const std::vector<PlyElement>& getElements() const { return elements; }
+  bool hasElement(std::string elementName) const;
+  bool hasProperty(std::string elementName, std::string propertyName) const;
+
+  // Read back a property which was added, with the same conversions as MappedPlyFile
+  template <typename T>
+  std::vector<T> getProperty(std::string elementName, std::string propertyName);
+  template <typename T>
+  std::vector<std::vector<T>> getListProperty(std::string elementName, std::string propertyName);
+
+  void write(std::ostream& out);
+
+  // Remove all elements, properties, and comments
+  void clear();
+
+private:
+  // Each column is a property's serialized rows, either in the spill file or in a mapped source file
+  struct Column {
+    uint64_t spillOffset = 0;
+    uint64_t spillBytes = 0;
+    std::shared_ptr<MappedPlyFile> source;
+  };
+  class ColumnCursor;
+
+  size_t findElement(const std::string& elementName) const;
+  void addColumn(std::string elementName, size_t count, PlyProperty layout, Column column);
+  uint64_t appendToSpill(const char* bytes, size_t nBytes); // returns the offset of the bytes
+  std::vector<char> readColumnBytes(size_t iElement, size_t iProperty);
+
+  // Call visit(iRow, bytes) for the stored bytes of each row of a column
+  template <typename F>
+  void forEachRow(std::string elementName, std::string propertyName, F&& visit);
+
+  std::vector<PlyElement> elements;
+  std::vector<std::vector<Column>> columns; // parallel to elements[i].properties
+  std::vector<std::string> comments;
+  std::FILE* spill = nullptr;
+  uint64_t spillSize = 0;
+};
+
+} // namespace geometrycentral
+
+#include "geometrycentral/utilities/binary_ply.ipp"
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace geometrycentral {
+
+template <typename S>
+inline S readPlyRaw(const char* p) {
+  S val;
+  std::memcpy(&val, p, sizeof(S));
+  return val;
+}
+
+template <typename T>
+T readPlyValue(const char* p, PlyType type) {
+  switch (type) {
+  case PlyType::Int8:
+    return static_cast<T>(readPlyRaw<int8_t>(p));
+  case PlyType::UInt8:
+    return static_cast<T>(readPlyRaw<uint8_t>(p));
+  case PlyType::Int16:
+    return static_cast<T>(readPlyRaw<int16_t>(p));
+  case PlyType::UInt16:
+    return static_cast<T>(readPlyRaw<uint16_t>(p));
+  case PlyType::Int32:
+    return static_cast<T>(readPlyRaw<int32_t>(p));
+  case PlyType::UInt32:
+    return static_cast<T>(readPlyRaw<uint32_t>(p));
+  case PlyType::Float32:
+    return static_cast<T>(readPlyRaw<float>(p));
+  case PlyType::Float64:
+    return static_cast<T>(readPlyRaw<double>(p));
+  }
+  return T();
+}
+
+// === MappedPlyFile
+
+template <typename F>
+void MappedPlyFile::forEachRow(std::string elementName, std::string propertyName, F&& visit) {
+  size_t iElement = findElement(elementName);
+  const PlyElement& elem = elements[iElement];
+  size_t iProperty = elem.propertyIndex(propertyName);
+  if (iProperty == INVALID_IND) {
+    throw std::runtime_error("ply file " + filename + " has no property " + propertyName + " on element " +
+                             elementName);
+  }
+  size_t offset = elementDataOffset(iElement);
+  const char* data = file->data();
+
+  if (elem.allScalar()) {
+    size_t stride = elem.scalarStride();
+    if (elem.count > (file->size() - offset) / stride) {
+      throw std::runtime_error("ply file " + filename + " is truncated while reading element " + elementName);
+    }
+    size_t propertyOffset = 0;
+    for (size_t i = 0; i < iProperty; i++) propertyOffset += plyTypeSize(elem.properties[i].type);
+    parallelFor(
+        elem.count, 0, [&](size_t iRow) { visit(iRow, data + offset + iRow * stride + propertyOffset); }, 16384);
+  } else {
+    for (size_t iRow = 0; iRow < elem.count; iRow++) {
+      size_t propertyOffset;
+      size_t size = rowSize(elem, offset, iProperty, propertyOffset);
+      visit(iRow, data + propertyOffset);
+      offset += size;
+    }
+  }
+}
+
+template <typename T>
+std::vector<T> MappedPlyFile::getProperty(std::string elementName, std::string propertyName) {
+  const PlyProperty& prop = getPropertyLayout(elementName, propertyName);
+  checkPlyPropertyReadable(prop, PlyTypeOf<T>::type, false);
+
+  std::vector<T> result(getElement(elementName).count);
+  forEachRow(elementName, propertyName,
+             [&](size_t iRow, const char* bytes) { result[iRow] = readPlyValue<T>(bytes, prop.type); });
+  return result;
+}
+
+template <typename T>
+std::vector<std::vector<T>> MappedPlyFile::getListProperty(std::string elementName, std::string propertyName) {
+  const PlyProperty& prop = getPropertyLayout(elementName, propertyName);
+  checkPlyPropertyReadable(prop, PlyTypeOf<T>::type, true);
+
+  size_t countSize = plyTypeSize(prop.countType);
+  size_t valueSize = plyTypeSize(prop.type);
+  std::vector<std::vector<T>> result(getElement(elementName).count);
+  forEachRow(elementName, propertyName, [&](size_t iRow, const char* bytes) {
+    std::vector<T>& row = result[iRow];
+    row.resize(readPlyValue<size_t>(bytes, prop.countType));
+    for (size_t j = 0; j < row.size(); j++) {
+      row[j] = readPlyValue<T>(bytes + countSize + j * valueSize, prop.type);
+    }
+  });
+  return result;
+}
+
+// === PlyStreamWriter
+
+template <typename T>
+void PlyStreamWriter::addProperty(std::string elementName, std::string propertyName, const std::vector<T>& values) {
+  PlyProperty layout;
+  layout.name = propertyName;
+  layout.type = PlyTypeOf<T>::type;
+
+  Column column;
+  column.spillBytes = values.size() * sizeof(T);
+  column.spillOffset = appendToSpill(reinterpret_cast<const char*>(values.data()), column.spillBytes);
+  addColumn(elementName, values.size(), layout, column);
+}
+
+template <typename T>
+void PlyStreamWriter::addListProperty(std::string elementName, std::string propertyName,
+                                      const std::vector<std::vector<T>>& values) {
+  PlyProperty layout;
+  layout.name = propertyName;
+  layout.isList = true;
+  layout.type = PlyTypeOf<T>::type;
+
+  // Use the smallest count type which fits every list
+  size_t maxCount = 0;
+  for (const std::vector<T>& row : values) maxCount = std::max(maxCount, row.size());
+  if (maxCount <= 0xFF) {
+    layout.countType = PlyType::UInt8;
+  } else if (maxCount <= 0xFFFF) {
+    layout.countType = PlyType::UInt16;
+  } else {
+    layout.countType = PlyType::UInt32;
+  }
+
+  // Serialize the rows
+  size_t countSize = plyTypeSize(layout.countType);
+  std::vector<char> bytes;
+  for (const std::vector<T>& row : values) {
+    size_t rowStart = bytes.size();
+    bytes.resize(rowStart + countSize + row.size() * sizeof(T));
+    uint32_t count = static_cast<uint32_t>(row.size());
+    std::memcpy(&bytes[rowStart], &count, countSize); // low bytes, on a little-endian machine
+    if (!row.empty()) std::memcpy(&bytes[rowStart + countSize], row.data(), row.size() * sizeof(T));
+  }
+
+  Column column;
+  column.spillBytes = bytes.size();
+  column.spillOffset = appendToSpill(bytes.data(), bytes.size());
+  addColumn(elementName, values.size(), layout, column);
+}
+
+template <typename F>
+void PlyStreamWriter::forEachRow(std::string elementName, std::string propertyName, F&& visit) {
+  size_t iElement = findElement(elementName);
+  const PlyElement& elem = elements[iElement];
+  size_t iProperty = elem.propertyIndex(propertyName);
+  if (iProperty == INVALID_IND) {
+    throw std::runtime_error("ply data has no property " + propertyName + " on element " + elementName);
+  }
+
+  const Column& column = columns[iElement][iProperty];
+  if (column.source) {
+    column.source->forEachRow(elementName, propertyName, visit);
+    return;
+  }
+
+  const PlyProperty& prop = elem.properties[iProperty];
+  std::vector<char> bytes = readColumnBytes(iElement, iProperty);
+  size_t offset = 0;
+  for (size_t iRow = 0; iRow < elem.count; iRow++) {
+    visit(iRow, bytes.data() + offset);
+    if (prop.isList) {
+      offset += plyTypeSize(prop.countType) + readPlyValue<size_t>(&bytes[offset], prop.countType) * plyTypeSize(prop.type);
+    } else {
+      offset += plyTypeSize(prop.type);
+    }
+  }
+}
+
+template <typename T>
+std::vector<T> PlyStreamWriter::getProperty(std::string elementName, std::string propertyName) {
+  size_t iElement = findElement(elementName);
+  size_t iProperty = elements[iElement].propertyIndex(propertyName);
+  if (iProperty == INVALID_IND) {
+    throw std::runtime_error("ply data has no property " + propertyName + " on element " + elementName);
+  }
+  PlyProperty prop = elements[iElement].properties[iProperty];
+  checkPlyPropertyReadable(prop, PlyTypeOf<T>::type, false);
+
+  std::vector<T> result(elements[iElement].count);
+  forEachRow(elementName, propertyName,
+             [&](size_t iRow, const char* bytes) { result[iRow] = readPlyValue<T>(bytes, prop.type); });
+  return result;
+}
+
+template <typename T>
+std::vector<std::vector<T>> PlyStreamWriter::getListProperty(std::string elementName, std::string propertyName) {
+  size_t iElement = findElement(elementName);
+  size_t iProperty = elements[iElement].propertyIndex(propertyName);
+  if (iProperty == INVALID_IND) {
+    throw std::runtime_error("ply data has no property " + propertyName + " on element " + elementName);
+  }
+  PlyProperty prop = elements[iElement].properties[iProperty];
+  checkPlyPropertyReadable(prop, PlyTypeOf<T>::type, true);
+
+  size_t countSize = plyTypeSize(prop.countType);
+  size_t valueSize = plyTypeSize(prop.type);
+  std::vector<std::vector<T>> result(elements[iElement].count);
+  forEachRow(elementName, propertyName, [&](size_t iRow, const char* bytes) {
+    std::vector<T>& row = result[iRow];
+    row.resize(readPlyValue<size_t>(bytes, prop.countType));
+    for (size_t j = 0; j < row.size(); j++) {
+      row[j] = readPlyValue<T>(bytes + countSize + j * valueSize, prop.type);
+    }
+  });
+  return result;
+}
+
+} // namespace geometrycentral
@@ -4,28 +4,59 @@
 // for an easy workaround are welcome.
 #include <Eigen/SparseCore>
 
+#include "geometrycentral/utilities/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
-#include <array>
 
 
 namespace geometrycentral {
 
+// Diagnostic information about a cached quantity, see DependentQuantity::getStatistics()
+struct QuantityStatistics {
+  std::string name;
+  bool computed;         // is the quantity currently populated?
+  int requireCount;      // number of outstanding require()s
+  size_t computeCount;   // number of times the quantity has been computed
+  double computeSeconds; // total time spent computing the quantity (including dependencies computed along the way)
+  size_t bufferBytes;    // memory currently held by the quantity's buffer
+};
+
+class QuantityMemoryBudget;
+
 class DependentQuantity {
 
 public:
-  DependentQuantity(std::function<void()> evaluateFunc_, std::vector<DependentQuantity*>& listToJoin)
-      : evaluateFunc(evaluateFunc_) {
+  DependentQuantity(std::function<void()> evaluateFunc_, std::vector<DependentQuantity*>& listToJoin,
+                    const char* name_ = "unnamed quantity")
+      : evaluateFunc(evaluateFunc_), name(name_) {
     listToJoin.push_back(this);
   }
 
   virtual ~DependentQuantity(){};
 
   std::function<void()> evaluateFunc;
-  bool computed = false;
-  int requireCount = 0;
+  const char* name = "unnamed quantity"; // static string naming the quantity, used for diagnostics
+  std::atomic<bool> computed{false};
+  std::atomic<int> requireCount{0}; // atomic, since frozen quantities may be required from many threads at once
   bool clearable = true; // if false, clearing does nothing
+  size_t computeCount = 0;
+  double computeSeconds = 0.;
+  QuantityMemoryBudget* budget = nullptr; // if set, computing this quantity may evict others to respect the budget
+  uint64_t lastUse = 0;                   // recency stamp from the budget, used for LRU eviction
+
+  // If set, the quantity is frozen: a missing quantity is computed while holding this lock, so that many threads can
+  // use the quantity concurrently. require() and unrequire() still count, so they may be paired across a freeze.
+  std::recursive_mutex* freezeLock = nullptr;
 
   // Compute the quantity, if we don't have it already
   void ensureHave();
@@ -42,6 +73,18 @@ public:
 
   // Clear out the underlying quantity to reduce memory usage
   virtual void clearIfNotRequired() = 0;
+
+  // Number of bytes of memory currently held by the underlying quantity
+  virtual size_t bufferBytes() const = 0;
+
+  // Quantities with lower rank are evicted first when enforcing a memory budget (operators before per-element arrays)
+  virtual int evictionRank() const = 0;
+
+  QuantityStatistics getStatistics() const;
+
+protected:
+  // Evaluate the quantity and record statistics (no checks)
+  void compute();
 };
 
 // Wrapper class which manages a dependency graph of quantities. Templated on the underlying type of the data.
@@ -52,13 +95,50 @@ public:
   DependentQuantityD(){};
   virtual ~DependentQuantityD(){};
 
-  DependentQuantityD(D* dataBuffer_, std::function<void()> evaluateFunc_, std::vector<DependentQuantity*>& listToJoin)
-      : DependentQuantity(evaluateFunc_, listToJoin), dataBuffer(dataBuffer_) {}
+  DependentQuantityD(D* dataBuffer_, std::function<void()> evaluateFunc_, std::vector<DependentQuantity*>& listToJoin,
+                     const char* name_ = "unnamed quantity")
+      : DependentQuantity(evaluateFunc_, listToJoin, name_), dataBuffer(dataBuffer_) {}
 
   D* dataBuffer = nullptr;
 
   // Clear out the underlying quantity to reduce memory usage
   virtual void clearIfNotRequired() override;
+
+  virtual size_t bufferBytes() const override;
+
+  virtual int evictionRank() const override;
+};
+
+// A memory budget shared by a list of quantities (e.g. all of the quantities of a geometry object). After any quantity
+// is computed, cached quantities which are not currently require()'d are cleared, in order of eviction rank and then
+// least-recent use, until the total memory held fits in the budget. Cleared quantities are simply recomputed the next
+// time they are needed. Quantities which are require()'d are never evicted, so the budget may still be exceeded.
+class QuantityMemoryBudget {
+
+public:
+  // Attaches the budget to all quantities in the list. The budget must be detach()'d before the quantities are
+  // destroyed, or must outlive them.
+  QuantityMemoryBudget(std::vector<DependentQuantity*>& quantities, size_t maxBytes);
+  void detach();
+
+  size_t maxBytes;
+  size_t evictionCount = 0; // number of quantities cleared to respect the budget
+
+  // Note a use of a quantity, for LRU bookkeeping
+  void markUsed(DependentQuantity& q);
+
+  // Called around each computation; the budget is only enforced once the outermost computation finishes, since
+  // computations may use unrequired dependencies
+  void beginCompute();
+  void endCompute();
+
+  // Clear unrequired quantities until memory usage fits within the budget (if possible)
+  void enforce();
+
+private:
+  std::vector<DependentQuantity*>& quantities;
+  uint64_t useClock = 0;
+  int computeDepth = 0;
 };
 
 } // namespace geometrycentral
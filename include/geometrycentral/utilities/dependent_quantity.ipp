@@ -8,16 +8,42 @@ inline void DependentQuantity::ensureHaveIfRequired() {
 
 inline void DependentQuantity::ensureHave() {
 
+  // Frozen quantities may be shared between threads: populated quantities are only ever read, and missing quantities
+  // are computed at most once, while holding the lock
+  if (freezeLock != nullptr) {
+    if (computed) return;
+    std::lock_guard<std::recursive_mutex> lock(*freezeLock);
+    if (!computed) compute();
+    return;
+  }
+
+  if (budget != nullptr) budget->markUsed(*this);
+
   // If the quantity is already populated, early out
   if (computed) {
     return;
   }
 
   // Compute this quantity
+  if (budget != nullptr) budget->beginCompute();
+  try {
+    compute();
+  } catch (...) {
+    if (budget != nullptr) budget->endCompute();
+    throw;
+  }
+  if (budget != nullptr) budget->endCompute();
+};
+
+inline void DependentQuantity::compute() {
+  GC_PROFILE_SCOPE(name);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
   evaluateFunc();
+  computeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  computeCount++;
 
   computed = true;
-};
+}
 
 inline void DependentQuantity::require() {
   requireCount++;
@@ -25,14 +51,16 @@ inline void DependentQuantity::require() {
 }
 
 inline void DependentQuantity::unrequire() {
-  requireCount--;
-
-  if (requireCount < 0) {
+  if (--requireCount < 0) {
+    requireCount++;
     throw std::logic_error("Quantity was unrequire()'d more than than it was require()'d");
-    requireCount = 0;
   }
 }
 
+inline QuantityStatistics DependentQuantity::getStatistics() const {
+  return QuantityStatistics{name, computed, requireCount, computeCount, computeSeconds, bufferBytes()};
+}
+
 // Helper functions to clear data
 // Note: if/when we start using more types in these quantities, we might need to generalize this mechanism. But for the
 // current set of uses (scalars, MeshData<>, Eigen types), this works just fine.
@@ -81,14 +109,158 @@ void clearBuffer(std::pair<A, B>* buffer) {
   clearBuffer(elemB);
 }
 
+// Helper functions to measure the memory held by data, mirroring clearBuffer() above
+
+// General method: ask the container (e.g. MeshData<>)
+template <typename T>
+size_t measureBuffer(const T* buffer) {
+  return buffer->bufferBytes();
+}
+
+// Scalars
+inline size_t measureBuffer(const double* buffer) { return sizeof(double); }
+inline size_t measureBuffer(const size_t* buffer) { return sizeof(size_t); }
+inline size_t measureBuffer(const int* buffer) { return sizeof(int); }
+
+// Eigen sparse matrices
+template <typename F>
+size_t measureBuffer(const Eigen::SparseMatrix<F>* buffer) {
+  using StorageIndex = typename Eigen::SparseMatrix<F>::StorageIndex;
+  if (buffer->outerSize() == 0) return 0;
+  return buffer->data().allocatedSize() * (sizeof(F) + sizeof(StorageIndex)) +
+         (buffer->outerSize() + 1) * sizeof(StorageIndex);
+}
+
+// Memory held by an object beyond its sizeof(): found with its bufferBytes() method if it has one, otherwise 0
+template <typename P>
+auto measureHeldBytes(const P* object, int) -> decltype(object->bufferBytes()) {
+  return object->bufferBytes();
+}
+template <typename P>
+size_t measureHeldBytes(const P* object, long) {
+  return 0;
+}
+
+// any unique_ptr<> type: the object itself, plus whatever it reports holding
+template <typename P>
+size_t measureBuffer(const std::unique_ptr<P>* buffer) {
+  if (!*buffer) return 0;
+  return sizeof(P) + measureHeldBytes(buffer->get(), 0);
+}
+
+// Array of any otherwise measurable type
+template <typename A, size_t N>
+size_t measureBuffer(const std::array<A*, N>* buffer) {
+  size_t bytes = 0;
+  for (size_t i = 0; i < N; i++) {
+    bytes += measureBuffer((*buffer)[i]);
+  }
+  return bytes;
+}
+
+// Pair of measurable types
+template <typename A, typename B>
+size_t measureBuffer(const std::pair<A, B>* buffer) {
+  return measureBuffer(buffer->first) + measureBuffer(buffer->second);
+}
+
+// Helper functions to rank data for eviction: operators and other derived objects (rank 0) are expensive to hold
+// on to and go before per-element arrays and scalars (rank 1)
+template <typename T>
+int rankBuffer(const T* buffer) {
+  return 1;
+}
+template <typename F>
+int rankBuffer(const Eigen::SparseMatrix<F>* buffer) {
+  return 0;
+}
+template <typename P>
+int rankBuffer(const std::unique_ptr<P>* buffer) {
+  return 0;
+}
+template <typename A, size_t N>
+int rankBuffer(const std::array<A*, N>* buffer) {
+  return rankBuffer(static_cast<const A*>(nullptr));
+}
+template <typename A, typename B>
+int rankBuffer(const std::pair<A, B>* buffer) {
+  return std::min(rankBuffer(static_cast<const A*>(nullptr)), rankBuffer(static_cast<const B*>(nullptr)));
+}
+
 } // namespace
 
+template <typename D>
+size_t DependentQuantityD<D>::bufferBytes() const {
+  if (dataBuffer == nullptr) return 0;
+  return measureBuffer(dataBuffer);
+}
+
+template <typename D>
+int DependentQuantityD<D>::evictionRank() const {
+  return rankBuffer(dataBuffer);
+}
+
 template <typename D>
 void DependentQuantityD<D>::clearIfNotRequired() {
-  if (clearable && requireCount <= 0 && dataBuffer != nullptr && computed) {
+  if (clearable && requireCount <= 0 && dataBuffer != nullptr) {
     clearBuffer(dataBuffer);
     computed = false;
   }
 }
 
+// === Memory budgets
+
+inline QuantityMemoryBudget::QuantityMemoryBudget(std::vector<DependentQuantity*>& quantities_, size_t maxBytes_)
+    : maxBytes(maxBytes_), quantities(quantities_) {
+  for (DependentQuantity* q : quantities) {
+    q->budget = this;
+    q->lastUse = 0;
+  }
+}
+
+inline void QuantityMemoryBudget::detach() {
+  for (DependentQuantity* q : quantities) {
+    if (q->budget == this) q->budget = nullptr;
+  }
+}
+
+inline void QuantityMemoryBudget::markUsed(DependentQuantity& q) { q.lastUse = ++useClock; }
+
+inline void QuantityMemoryBudget::beginCompute() { computeDepth++; }
+
+inline void QuantityMemoryBudget::endCompute() {
+  computeDepth--;
+  if (computeDepth == 0) enforce();
+}
+
+inline void QuantityMemoryBudget::enforce() {
+  if (computeDepth > 0) return;
+
+  size_t totalBytes = 0;
+  std::vector<std::pair<DependentQuantity*, size_t>> candidates;
+  for (DependentQuantity* q : quantities) {
+    size_t bytes = q->bufferBytes();
+    totalBytes += bytes;
+    if (q->clearable && q->requireCount <= 0 && bytes > 0) {
+      candidates.emplace_back(q, bytes);
+    }
+  }
+  if (totalBytes <= maxBytes) return;
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const std::pair<DependentQuantity*, size_t>& a, const std::pair<DependentQuantity*, size_t>& b) {
+              int rankA = a.first->evictionRank();
+              int rankB = b.first->evictionRank();
+              if (rankA != rankB) return rankA < rankB;
+              return a.first->lastUse < b.first->lastUse;
+            });
+
+  for (std::pair<DependentQuantity*, size_t>& c : candidates) {
+    if (totalBytes <= maxBytes) break;
+    c.first->clearIfNotRequired();
+    totalBytes -= c.second;
+    evictionCount++;
+  }
+}
+
 } // namespace geometrycentral
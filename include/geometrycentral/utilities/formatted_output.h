@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace geometrycentral {
+
+// Buffers passed to the formatting functions below must have room for at least this many characters
+const size_t FORMAT_BUFFER_SIZE = 32;
+
+// Write a decimal representation of val which reads back (with strtod() or >>) to exactly val, and is as short as
+// possible in all but rare cases, like "0.1", "-2", "1.5e-7" or "nan". Returns a pointer past the last character
+// written; no null terminator is added. Much faster than an iostream with setprecision(max_digits10), and the output
+// is usually shorter.
+char* formatDouble(char* buffer, double val);
+
+// Write the decimal digits of val, returning a pointer past the last character written
+char* formatInteger(char* buffer, uint64_t val);
+
+// Parse a decimal number starting at p (without skipping leading whitespace), advancing p past it. Returns false, and
+// leaves p unchanged, if there is no number at p. The text must be terminated by a character which cannot continue
+// the number, like a space, a newline, or a null character. For decimal input (and "inf" or "nan"), parseDouble()
+// gives exactly the same value as strtod(), and is several times faster on typical input. Unlike strtod(), it does not
+// accept hexadecimal numbers: "0x10" is read as 0, leaving p at the 'x'. parseInteger() also returns false if the
+// value does not fit in a long long.
+bool parseDouble(const char*& p, double& out);
+bool parseInteger(const char*& p, long long& out);
+
+// Write n items to out, in order, where formatItem(i, buffer) appends the text (or bytes) for item i to a
+// std::string. Items are formatted in blocks of blockSize, with blocks spread across nThreads threads (0 means one
+// per hardware thread); only a few blocks per thread are held in memory at once.
+template <typename F>
+void writeInParallel(std::ostream& out, size_t n, F&& formatItem, size_t nThreads = 1, size_t blockSize = 1 << 14);
+
+} // namespace geometrycentral
+
+#include "geometrycentral/utilities/formatted_output.ipp"
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace geometrycentral {
+
+template <typename F>
+void writeInParallel(std::ostream& out, size_t n, F&& formatItem, size_t nThreads, size_t blockSize) {
+  blockSize = std::max<size_t>(1, blockSize);
+  size_t nBlocks = (n + blockSize - 1) / blockSize;
+  size_t blocksPerBatch = std::min(nBlocks, 4 * resolveThreadCount(nThreads));
+
+  // Format a batch of blocks in parallel, then write them out in order
+  std::vector<std::string> buffers(blocksPerBatch);
+  for (size_t batchStart = 0; batchStart < nBlocks; batchStart += blocksPerBatch) {
+    size_t nInBatch = std::min(blocksPerBatch, nBlocks - batchStart);
+    parallelFor(nInBatch, nThreads, [&](size_t iBlock) {
+      std::string& buffer = buffers[iBlock];
+      buffer.clear();
+      size_t iStart = (batchStart + iBlock) * blockSize;
+      size_t iEnd = std::min(n, iStart + blockSize);
+      for (size_t i = iStart; i < iEnd; i++) {
+        formatItem(i, buffer);
+      }
+    });
+    for (size_t iBlock = 0; iBlock < nInBatch; iBlock++) {
+      out.write(buffers[iBlock].data(), buffers[iBlock].size());
+    }
+  }
+}
+
+} // namespace geometrycentral
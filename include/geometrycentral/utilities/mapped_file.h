@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace geometrycentral {
+
+// A read-only memory mapping of an entire file. The contents are paged in by the OS on demand, so large files can be
+// decoded in place (and from several threads at once) without first copying them into memory.
+class MappedFile {
+public:
+  // Throws a std::runtime_error if the file cannot be opened or mapped
+  MappedFile(std::string filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  const char* data() const { return dataPtr; }
+  size_t size() const { return dataSize; }
+
+private:
+  const char* dataPtr = nullptr;
+  size_t dataSize = 0;
+
+#ifdef _WIN32
+  void* fileHandle = nullptr;
+  void* mappingHandle = nullptr;
+#endif
+};
+
+// Create a new, empty file with a unique name in the same directory as `filename`, and return its name. Throws a
+// std::runtime_error on failure. Used to write a file alongside the one it will replace (see replaceFile()).
+std::string createFileAlongside(std::string filename);
+
+// Move the file `source` to `destination`, replacing destination if it exists. Throws a std::runtime_error on failure.
+// On Windows this fails if destination is still open or mapped, so release any MappedFile for it first.
+void replaceFile(std::string source, std::string destination);
+
+} // namespace geometrycentral
@@ -7,7 +7,9 @@
 #include "geometrycentral/surface/halfedge_element_types.h"
 
 #include <Eigen/Core>
+#include <algorithm>
 #include <cassert>
+#include <mutex>
 
 // === Datatypes which hold data stored on the mesh
 
@@ -50,6 +52,7 @@ protected:
   std::list<std::function<void(size_t)>>::iterator expandCallbackIt;
   std::list<std::function<void(const std::vector<size_t>&)>>::iterator permuteCallbackIt;
   std::list<std::function<void()>>::iterator deleteCallbackIt;
+  std::list<std::function<size_t()>>::iterator memoryCallbackIt;
   void registerWithMesh();
   void deregisterWithMesh();
 
@@ -87,6 +90,9 @@ public:
   DATA_T& raw();
   const DATA_T& raw() const;
 
+  // Number of bytes of memory held by the underlying buffer (including heap storage held by std::vector<> entries)
+  size_t bufferBytes() const;
+
   // Access to the underlying mesh object
   ParentMeshT* getMesh() const;
 
@@ -87,7 +87,7 @@ void MeshData<E, T>::registerWithMesh() {
 
   // Callback function on expansion
   std::function<void(size_t)> expandFunc = [&](size_t newSize) {
-    size_t oldSize = data.size();
+    size_t oldSize = std::min(static_cast<size_t>(data.size()), newSize); // (can shrink, see restoreConnectivity())
     Eigen::Matrix<T, Eigen::Dynamic, 1> newData(newSize);
     for (size_t i = 0; i < oldSize; i++) {
       newData[i] = data[i];
@@ -116,9 +116,14 @@ void MeshData<E, T>::registerWithMesh() {
     mesh = nullptr;
   };
 
+  // Callback function for memory accounting
+  std::function<size_t()> memoryFunc = [this]() { return bufferBytes(); };
+
+  std::lock_guard<std::mutex> lock(mesh->callbackRegistrationMutex);
   expandCallbackIt = getExpandCallbackList<E>(mesh).insert(getExpandCallbackList<E>(mesh).begin(), expandFunc);
   permuteCallbackIt = getPermuteCallbackList<E>(mesh).insert(getPermuteCallbackList<E>(mesh).end(), permuteFunc);
   deleteCallbackIt = mesh->meshDeleteCallbackList.insert(mesh->meshDeleteCallbackList.end(), deleteFunc);
+  memoryCallbackIt = mesh->meshDataMemoryCallbackList.insert(mesh->meshDataMemoryCallbackList.end(), memoryFunc);
 }
 
 template <typename E, typename T>
@@ -127,9 +132,11 @@ void MeshData<E, T>::deregisterWithMesh() {
   // Used during destruction of default-initializated object, for instance
   if (mesh == nullptr) return;
 
+  std::lock_guard<std::mutex> lock(mesh->callbackRegistrationMutex);
   getExpandCallbackList<E>(mesh).erase(expandCallbackIt);
   getPermuteCallbackList<E>(mesh).erase(permuteCallbackIt);
   mesh->meshDeleteCallbackList.erase(deleteCallbackIt);
+  mesh->meshDataMemoryCallbackList.erase(memoryCallbackIt);
 }
 
 template <typename E, typename T>
@@ -246,6 +253,27 @@ const typename MeshData<E,T>::DATA_T& MeshData<E, T>::raw() const {
   return data;
 }
 
+namespace {
+// Heap memory held by an entry of a MeshData<> buffer, beyond its sizeof()
+template <typename T>
+size_t entryHeapBytes(const T& entry) {
+  return 0;
+}
+template <typename T>
+size_t entryHeapBytes(const std::vector<T>& entry) {
+  return entry.capacity() * sizeof(T);
+}
+} // namespace
+
+template <typename E, typename T>
+size_t MeshData<E, T>::bufferBytes() const {
+  size_t bytes = data.size() * sizeof(T);
+  for (Eigen::Index i = 0; i < data.size(); i++) {
+    bytes += entryHeapBytes(data[i]);
+  }
+  return bytes;
+}
+
 template <typename E, typename T>
 typename MeshData<E, T>::ParentMeshT* MeshData<E, T>::getMesh() const {
   return mesh;
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace geometrycentral {
+
+// Number of threads to use for a requested thread count, where 0 means one per hardware thread
+inline size_t resolveThreadCount(size_t nThreads) {
+  if (nThreads == 0) nThreads = std::thread::hardware_concurrency();
+  return std::max<size_t>(1, nThreads);
+}
+
+// Call func(iThread, i) for each i in [0, n), spread across up to nThreads threads (0 means one per hardware thread).
+// iThread identifies the calling thread, and is less than min(resolveThreadCount(nThreads), n), so per-thread state
+// (like a solver whose buffers are reused between items) can be kept in an array of that size. Indices are handed out
+// in blocks of grainSize, and no more threads are started than there are blocks, so small loops run entirely on the
+// calling thread. If func throws, the remaining blocks are skipped and the first exception is rethrown once all threads
+// have finished.
+template <typename F>
+void parallelForWithThreadIndex(size_t n, size_t nThreads, F&& func, size_t grainSize = 1) {
+  grainSize = std::max<size_t>(1, grainSize);
+  size_t nBlocks = (n + grainSize - 1) / grainSize;
+  nThreads = std::min(resolveThreadCount(nThreads), nBlocks);
+
+  if (nThreads <= 1) {
+    for (size_t i = 0; i < n; i++) {
+      func(0, i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> nextBlock(0);
+  std::vector<std::exception_ptr> errors(nThreads);
+  auto worker = [&](size_t iThread) {
+    try {
+      for (size_t iBlock = nextBlock++; iBlock < nBlocks; iBlock = nextBlock++) {
+        size_t iEnd = std::min(n, (iBlock + 1) * grainSize);
+        for (size_t i = iBlock * grainSize; i < iEnd; i++) {
+          func(iThread, i);
+        }
+      }
+    } catch (...) {
+      errors[iThread] = std::current_exception();
+      nextBlock = nBlocks; // stop the other threads early
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t iThread = 1; iThread < nThreads; iThread++) {
+    threads.emplace_back(worker, iThread);
+  }
+  worker(0);
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  for (std::exception_ptr& err : errors) {
+    if (err) std::rethrow_exception(err);
+  }
+}
+
+// Call func(i) for each i in [0, n), as in parallelForWithThreadIndex()
+template <typename F>
+void parallelFor(size_t n, size_t nThreads, F&& func, size_t grainSize = 1) {
+  parallelForWithThreadIndex(n, nThreads, [&func](size_t, size_t i) { func(i); }, grainSize);
+}
+
+// Replace values[i] with the sum of values[0..i), in parallel over contiguous ranges, and return the total. Useful for
+// turning per-item counts into output offsets when compacting arrays.
+template <typename T>
+T parallelExclusiveScan(std::vector<T>& values, size_t nThreads = 1) {
+  const size_t minRangeSize = 1 << 16;
+  size_t nRanges = std::min(resolveThreadCount(nThreads), std::max<size_t>(1, values.size() / minRangeSize));
+  size_t rangeSize = (values.size() + nRanges - 1) / std::max<size_t>(1, nRanges);
+
+  // Sum each range, scan the range sums, then scan within each range starting from its offset
+  std::vector<T> rangeOffsets(nRanges, T(0));
+  parallelFor(nRanges, nRanges, [&](size_t iRange) {
+    size_t iEnd = std::min(values.size(), (iRange + 1) * rangeSize);
+    T sum(0);
+    for (size_t i = iRange * rangeSize; i < iEnd; i++) sum += values[i];
+    rangeOffsets[iRange] = sum;
+  });
+  T total(0);
+  for (T& offset : rangeOffsets) {
+    T sum = offset;
+    offset = total;
+    total += sum;
+  }
+  parallelFor(nRanges, nRanges, [&](size_t iRange) {
+    size_t iEnd = std::min(values.size(), (iRange + 1) * rangeSize);
+    T running = rangeOffsets[iRange];
+    for (size_t i = iRange * rangeSize; i < iEnd; i++) {
+      T val = values[i];
+      values[i] = running;
+      running += val;
+    }
+  });
+  return total;
+}
+
+} // namespace geometrycentral
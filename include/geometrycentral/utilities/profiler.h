@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// A lightweight hierarchical profiler. Zones are scoped regions of code, which may be nested and may be opened from any
+// thread; each thread records in to its own buffer. Results can be exported as a Chrome trace (chrome://tracing,
+// Perfetto) or as an aggregated JSON summary.
+//
+// Instrument code with the macros below. Unless GC_ENABLE_PROFILER is defined (cmake option GC_ENABLE_PROFILER), they
+// compile to nothing, so instrumentation costs nothing in ordinary builds.
+//
+// Example:
+//   void doWork() {
+//     GC_PROFILE_SCOPE("doWork");
+//     GC_PROFILE_COUNTER("work items", nItems);
+//   }
+//   ...
+//   geometrycentral::profiler::writeChromeTrace("trace.json");
+
+#define GC_PROFILE_CONCAT_INNER(a, b) a##b
+#define GC_PROFILE_CONCAT(a, b) GC_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef GC_ENABLE_PROFILER
+// Open a zone which lasts until the end of the enclosing scope. `name` must be a string with static lifetime (like a
+// literal).
+#define GC_PROFILE_SCOPE(name)                                                                                         \
+  ::geometrycentral::profiler::ScopedZone GC_PROFILE_CONCAT(gcProfileZone_, __LINE__)(name)
+#define GC_PROFILE_FUNCTION() GC_PROFILE_SCOPE(__func__)
+// Add `value` to a named counter. `name` must be a string with static lifetime (like a literal).
+#define GC_PROFILE_COUNTER(name, value) ::geometrycentral::profiler::incrementCounter(name, value)
+#else
+#define GC_PROFILE_SCOPE(name)
+#define GC_PROFILE_FUNCTION()
+#define GC_PROFILE_COUNTER(name, value)
+#endif
+
+namespace geometrycentral {
+namespace profiler {
+
+// Is profiling compiled in to the library?
+bool isEnabled();
+
+// RAII handle for a zone; prefer the GC_PROFILE_SCOPE() macro, which can be compiled out
+class ScopedZone {
+public:
+  ScopedZone(const char* name);
+  ~ScopedZone();
+
+  ScopedZone(const ScopedZone& other) = delete;
+  ScopedZone& operator=(const ScopedZone& other) = delete;
+};
+
+// Manually open and close zones. Calls must be properly nested within each thread.
+void beginZone(const char* name);
+void endZone();
+
+// Add to a named counter (totals are summed over all threads)
+void incrementCounter(const char* name, int64_t value = 1);
+
+// Aggregated timings for all zones with the same path of enclosing zones, summed over all threads.
+struct ZoneStatistics {
+  std::string path;    // names of enclosing zones and this zone, joined by '/'
+  size_t depth;        // number of enclosing zones
+  size_t count;        // number of times the zone was entered
+  double totalSeconds; // total time within the zone
+  double selfSeconds;  // total time within the zone, excluding time in nested zones
+};
+
+// Statistics for all completed zones, ordered by path
+std::vector<ZoneStatistics> getZoneStatistics();
+
+// Current value of all counters
+std::map<std::string, int64_t> getCounters();
+
+// Export everything recorded so far, in the Chrome trace event format
+void writeChromeTrace(std::ostream& out);
+void writeChromeTrace(std::string filename);
+
+// Export aggregated zone statistics and counters as JSON
+void writeSummaryJSON(std::ostream& out);
+void writeSummaryJSON(std::string filename);
+
+// Discard all recorded zones and counters (including the buffers of threads which have exited), and reset the dropped
+// zone count. Should not be called while zones are open on any thread.
+void clear();
+
+// At most this many zones are recorded (over all threads) between calls to clear(), so that memory use of long-running
+// programs stays bounded. The default is 2^22 zones, about 128MB. Further zones are dropped, and only counted. Counters
+// are unaffected.
+void setMaxZones(size_t maxZones);
+size_t getMaxZones();
+
+// Number of zones which were not recorded since the last clear(), because the limit was reached
+size_t getDroppedZoneCount();
+
+} // namespace profiler
+} // namespace geometrycentral
@@ -1,5 +1,9 @@
 #pragma once
 
+// DEPRECATED: these ad-hoc timers only print to stdout, and are no longer used within geometry-central. Use the scoped
+// zones in profiler.h instead (GC_PROFILE_SCOPE()), which nest, work across threads, and compile to nothing when
+// profiling is disabled. This header is kept only so that existing user code continues to build.
+
 #include <chrono>
 #include <stdio.h>
 #include <string>
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "geometrycentral/utilities/vector3.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace geometrycentral {
+
+// Merge ("weld") entries of a position list which coincide, compacting the list in place. Merged vertices take the
+// position of the first entry in their group, and the surviving entries keep their original relative order, so the
+// result is the same as a serial pass that keeps the first occurrence of each position.
+//
+// With tolerance == 0, positions are merged only if they are exactly equal (treating -0 and 0 as equal). With
+// tolerance > 0, positions are snapped to a grid of that spacing, and positions which fall in the same grid cell are
+// merged; note that nearby positions on opposite sides of a cell boundary are not merged.
+//
+// Runs on nThreads threads (0 means one per hardware thread), by radix sorting hashes of the positions and splitting
+// groups of equal hashes. With a single thread (the default) or a short list, a hash map is used instead; the result is
+// the same.
+//
+// Returns an index translation vector mapping old indices to new, such that vec[ind_old] == ind_new.
+std::vector<size_t> weldVertexPositions(std::vector<Vector3>& positions, double tolerance = 0., size_t nThreads = 1);
+
+} // namespace geometrycentral
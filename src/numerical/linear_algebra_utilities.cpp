@@ -1,5 +1,12 @@
 #include "geometrycentral/numerical/linear_algebra_utilities.h"
 
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
 namespace geometrycentral {
 
 SparseMatrix<double> complexToReal(const SparseMatrix<std::complex<double>>& m) {
@@ -59,4 +66,514 @@ Vector<std::complex<double>> realToComplex(const Vector<double>& v) {
   return cVec;
 }
 
+// === Binary IO
+
+namespace {
+
+// File layout (all values little-endian):
+//   header:  8 byte magic, uint32 version, uint32 flags, uint32 scalar code, uint32 bytes per scalar,
+//            uint64 rows, uint64 cols, uint64 nonzeros (rows * cols for dense matrices), 16 reserved bytes
+//   sparse:  int32 outer offsets (outer size + 1), int32 inner indices, values; each array padded to 16 bytes
+//   dense:   values, in column-major order
+// Compressed files instead hold a sequence of independently coded blocks, followed by a table locating them:
+//   sparse:  per block, uint64 first outer index and uint64 bytes; then uint64 block count
+//   dense:   per block, uint64 bytes; then uint64 values per block and uint64 block count
+const char MATRIX_MAGIC[8] = {'G', 'C', 'M', 'A', 'T', 'R', 'I', 'X'};
+const uint32_t MATRIX_VERSION = 1;
+const size_t MATRIX_HEADER_SIZE = 64;
+const uint32_t FLAG_SPARSE = 1;
+const uint32_t FLAG_ROW_MAJOR = 2;
+const uint32_t FLAG_COMPRESSED = 4;
+
+const size_t SPARSE_BLOCK_SIZE = 1 << 18; // a sparse block ends after this many nonzeros, or outer indices
+const size_t DENSE_BLOCK_SIZE = 1 << 16;  // values per dense block
+const size_t BLOCKS_PER_BATCH = 64;       // blocks encoded in parallel before being written out
+
+bool hostIsLittleEndian() {
+  uint16_t one = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 1;
+}
+
+template <typename T>
+inline T readRaw(const char* p) {
+  T val;
+  std::memcpy(&val, p, sizeof(T));
+  return val;
+}
+
+template <typename T>
+inline void writeRaw(std::ostream& out, T val) {
+  out.write(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+size_t paddedSize(size_t n) { return (n + 15) / 16 * 16; }
+
+void writePadded(std::ostream& out, const char* bytes, size_t n) {
+  static const char zeros[16] = {};
+  out.write(bytes, n);
+  out.write(zeros, paddedSize(n) - n);
+}
+
+std::string scalarName(uint32_t code) {
+  switch (code) {
+  case 1:
+    return "float";
+  case 2:
+    return "double";
+  case 3:
+    return "complex<float>";
+  case 4:
+    return "complex<double>";
+  case 5:
+    return "int32";
+  case 6:
+    return "int64";
+  }
+  return "unknown";
+}
+
+BinaryMatrixScalarInfo scalarInfo(uint32_t code) {
+  switch (code) {
+  case 1:
+    return BinaryMatrixScalar<float>::info();
+  case 2:
+    return BinaryMatrixScalar<double>::info();
+  case 3:
+    return BinaryMatrixScalar<std::complex<float>>::info();
+  case 4:
+    return BinaryMatrixScalar<std::complex<double>>::info();
+  case 5:
+    return BinaryMatrixScalar<int32_t>::info();
+  case 6:
+    return BinaryMatrixScalar<int64_t>::info();
+  }
+  return {0, 0, 0};
+}
+
+void writeHeader(std::ostream& out, uint32_t flags, BinaryMatrixScalarInfo scalar, size_t nRows, size_t nCols,
+                 size_t nNonZeros) {
+  if (!hostIsLittleEndian()) {
+    throw std::runtime_error("binary matrix files can only be written on little-endian hosts");
+  }
+  // Sparse matrices are stored with 32-bit indices, as in SparseMatrix<T>. Dense matrices have no such limit.
+  const size_t maxIndex = std::numeric_limits<int32_t>::max();
+  if ((flags & FLAG_SPARSE) && (nRows > maxIndex || nCols > maxIndex || nNonZeros > maxIndex)) {
+    throw std::runtime_error("sparse matrix is too large to be written as a binary matrix file");
+  }
+
+  out.write(MATRIX_MAGIC, sizeof(MATRIX_MAGIC));
+  writeRaw<uint32_t>(out, MATRIX_VERSION);
+  writeRaw<uint32_t>(out, flags);
+  writeRaw<uint32_t>(out, scalar.code);
+  writeRaw<uint32_t>(out, scalar.wordBytes * scalar.nWords);
+  writeRaw<uint64_t>(out, nRows);
+  writeRaw<uint64_t>(out, nCols);
+  writeRaw<uint64_t>(out, nNonZeros);
+  writeRaw<uint64_t>(out, 0);
+  writeRaw<uint64_t>(out, 0);
+}
+
+// Unsigned integers, 7 bits per byte
+void appendVarint(std::vector<char>& out, uint64_t val) {
+  while (val >= 0x80) {
+    out.push_back(static_cast<char>((val & 0x7f) | 0x80));
+    val >>= 7;
+  }
+  out.push_back(static_cast<char>(val));
+}
+
+uint64_t readVarint(const char*& p, const char* end) {
+  uint64_t val = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (p == end) throw std::runtime_error("block is truncated");
+    uint8_t byte = static_cast<uint8_t>(*p++);
+    val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return val;
+  }
+  throw std::runtime_error("block holds an invalid integer");
+}
+
+inline uint64_t zigzag(int64_t val) { return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63); }
+inline int64_t unzigzag(uint64_t val) { return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1); }
+
+// Values are coded one word at a time (two words for complex values), as the XOR with the previous word of the same
+// kind. Neighboring values tend to share their sign, exponent, and leading mantissa bits, so the XOR has zero high
+// bytes, which are dropped. The number of bytes kept for each word is stored in 4 bits, ahead of the bytes themselves.
+void encodeValues(const char* values, size_t nValues, BinaryMatrixScalarInfo scalar, std::vector<char>& out) {
+  size_t nWords = nValues * scalar.nWords;
+  size_t countsBegin = out.size();
+  out.resize(countsBegin + (nWords + 1) / 2, 0);
+  uint64_t prev[2] = {0, 0};
+  for (size_t i = 0; i < nWords; i++) {
+    uint64_t word = 0;
+    std::memcpy(&word, values + i * scalar.wordBytes, scalar.wordBytes);
+    uint64_t delta = word ^ prev[i % scalar.nWords];
+    prev[i % scalar.nWords] = word;
+
+    size_t nBytes = 0;
+    while (nBytes < 8 && (delta >> (8 * nBytes)) != 0) nBytes++;
+    out[countsBegin + i / 2] |= static_cast<char>(nBytes << (4 * (i % 2)));
+    const char* deltaBytes = reinterpret_cast<const char*>(&delta);
+    out.insert(out.end(), deltaBytes, deltaBytes + nBytes);
+  }
+}
+
+void decodeValues(const char*& p, const char* end, size_t nValues, BinaryMatrixScalarInfo scalar, char* values) {
+  size_t nWords = nValues * scalar.nWords;
+  size_t nCountBytes = (nWords + 1) / 2;
+  if (static_cast<size_t>(end - p) < nCountBytes) throw std::runtime_error("block is truncated");
+  const unsigned char* counts = reinterpret_cast<const unsigned char*>(p);
+  p += nCountBytes;
+
+  uint64_t prev[2] = {0, 0};
+  for (size_t i = 0; i < nWords; i++) {
+    size_t nBytes = (counts[i / 2] >> (4 * (i % 2))) & 0xf;
+    if (nBytes > scalar.wordBytes) throw std::runtime_error("block holds an invalid value");
+    if (static_cast<size_t>(end - p) < nBytes) throw std::runtime_error("block is truncated");
+    uint64_t delta = 0;
+    std::memcpy(&delta, p, nBytes);
+    p += nBytes;
+
+    uint64_t word = delta ^ prev[i % scalar.nWords];
+    prev[i % scalar.nWords] = word;
+    std::memcpy(values + i * scalar.wordBytes, &word, scalar.wordBytes);
+  }
+}
+
+// A sparse block holds the number of entries in each of its outer indices, then the gaps between successive inner
+// indices, then the values
+void encodeSparseBlock(const int32_t* outerIndices, const int32_t* innerIndices, const char* values,
+                       BinaryMatrixScalarInfo scalar, size_t outerBegin, size_t outerEnd, std::vector<char>& out) {
+  for (size_t k = outerBegin; k < outerEnd; k++) {
+    appendVarint(out, outerIndices[k + 1] - outerIndices[k]);
+  }
+  for (size_t k = outerBegin; k < outerEnd; k++) {
+    int64_t prev = -1;
+    for (int32_t j = outerIndices[k]; j < outerIndices[k + 1]; j++) {
+      appendVarint(out, zigzag(innerIndices[j] - prev - 1));
+      prev = innerIndices[j];
+    }
+  }
+  size_t scalarBytes = scalar.wordBytes * scalar.nWords;
+  encodeValues(values + outerIndices[outerBegin] * scalarBytes, outerIndices[outerEnd] - outerIndices[outerBegin],
+               scalar, out);
+}
+
+// Encode blocks in parallel batches and write them out in order, returning the size of each block
+template <typename F>
+std::vector<uint64_t> writeBlocks(std::ostream& out, size_t nBlocks, size_t nThreads, F&& encodeBlock) {
+  std::vector<uint64_t> blockBytes;
+  std::vector<std::vector<char>> encoded(std::min(nBlocks, BLOCKS_PER_BATCH));
+  for (size_t batchBegin = 0; batchBegin < nBlocks; batchBegin += BLOCKS_PER_BATCH) {
+    size_t batchSize = std::min(BLOCKS_PER_BATCH, nBlocks - batchBegin);
+    parallelFor(batchSize, nThreads, [&](size_t i) {
+      encoded[i].clear();
+      encodeBlock(batchBegin + i, encoded[i]);
+    });
+    for (size_t i = 0; i < batchSize; i++) {
+      out.write(encoded[i].data(), encoded[i].size());
+      blockBytes.push_back(encoded[i].size());
+    }
+  }
+  return blockBytes;
+}
+
+} // namespace
+
+void BinaryMatrixFile::writeSparse(std::ostream& out, BinaryMatrixScalarInfo scalar, size_t nRows, size_t nCols,
+                                   bool rowMajor, const int32_t* outerIndices, const int32_t* innerIndices,
+                                   const char* values, bool compress, size_t nThreads) {
+  size_t outerSize = rowMajor ? nRows : nCols;
+  size_t nNonZeros = outerIndices[outerSize];
+  size_t scalarBytes = scalar.wordBytes * scalar.nWords;
+  uint32_t flags = FLAG_SPARSE | (rowMajor ? FLAG_ROW_MAJOR : 0) | (compress ? FLAG_COMPRESSED : 0);
+  writeHeader(out, flags, scalar, nRows, nCols, nNonZeros);
+
+  if (!compress) {
+    writePadded(out, reinterpret_cast<const char*>(outerIndices), (outerSize + 1) * sizeof(int32_t));
+    writePadded(out, reinterpret_cast<const char*>(innerIndices), nNonZeros * sizeof(int32_t));
+    writePadded(out, values, nNonZeros * scalarBytes);
+    return;
+  }
+
+  std::vector<size_t> blockBegins;
+  for (size_t k = 0; k < outerSize; k++) {
+    if (blockBegins.empty() || k - blockBegins.back() >= SPARSE_BLOCK_SIZE ||
+        static_cast<size_t>(outerIndices[k] - outerIndices[blockBegins.back()]) >= SPARSE_BLOCK_SIZE) {
+      blockBegins.push_back(k);
+    }
+  }
+  size_t nBlocks = blockBegins.size();
+  blockBegins.push_back(outerSize);
+
+  std::vector<uint64_t> blockBytes =
+      writeBlocks(out, nBlocks, nThreads, [&](size_t iBlock, std::vector<char>& encoded) {
+        encodeSparseBlock(outerIndices, innerIndices, values, scalar, blockBegins[iBlock], blockBegins[iBlock + 1],
+                          encoded);
+      });
+  for (size_t iBlock = 0; iBlock < nBlocks; iBlock++) {
+    writeRaw<uint64_t>(out, blockBegins[iBlock]);
+    writeRaw<uint64_t>(out, blockBytes[iBlock]);
+  }
+  writeRaw<uint64_t>(out, nBlocks);
+}
+
+void BinaryMatrixFile::writeDense(std::ostream& out, BinaryMatrixScalarInfo scalar, size_t nRows, size_t nCols,
+                                  const char* values, bool compress, size_t nThreads) {
+  size_t nValues = nRows * nCols;
+  size_t scalarBytes = scalar.wordBytes * scalar.nWords;
+  writeHeader(out, compress ? FLAG_COMPRESSED : 0, scalar, nRows, nCols, nValues);
+
+  if (!compress) {
+    writePadded(out, values, nValues * scalarBytes);
+    return;
+  }
+
+  size_t nBlocks = (nValues + DENSE_BLOCK_SIZE - 1) / DENSE_BLOCK_SIZE;
+  std::vector<uint64_t> blockBytes =
+      writeBlocks(out, nBlocks, nThreads, [&](size_t iBlock, std::vector<char>& encoded) {
+        size_t begin = iBlock * DENSE_BLOCK_SIZE;
+        size_t end = std::min(nValues, begin + DENSE_BLOCK_SIZE);
+        encodeValues(values + begin * scalarBytes, end - begin, scalar, encoded);
+      });
+  for (uint64_t nBytes : blockBytes) {
+    writeRaw<uint64_t>(out, nBytes);
+  }
+  writeRaw<uint64_t>(out, DENSE_BLOCK_SIZE);
+  writeRaw<uint64_t>(out, nBlocks);
+}
+
+BinaryMatrixFile::BinaryMatrixFile(std::string filename) : source(filename) {
+  file.reset(new MappedFile(filename));
+  data = file->data();
+  dataSize = file->size();
+  parse();
+}
+
+BinaryMatrixFile::BinaryMatrixFile(std::istream& in) : source("stream") {
+  const size_t chunkSize = 1 << 20;
+  size_t nRead = 0;
+  while (in) {
+    ownedData.resize(nRead + chunkSize);
+    in.read(ownedData.data() + nRead, chunkSize);
+    nRead += in.gcount();
+  }
+  ownedData.resize(nRead);
+  data = ownedData.data();
+  dataSize = ownedData.size();
+  parse();
+}
+
+void BinaryMatrixFile::parse() {
+  if (!hostIsLittleEndian()) {
+    throw std::runtime_error("binary matrix files can only be read on little-endian hosts");
+  }
+  std::string prefix = "binary matrix " + source;
+  if (dataSize < MATRIX_HEADER_SIZE || std::memcmp(data, MATRIX_MAGIC, sizeof(MATRIX_MAGIC)) != 0) {
+    throw std::runtime_error(source + " is not a binary matrix file");
+  }
+  uint32_t version = readRaw<uint32_t>(data + 8);
+  if (version > MATRIX_VERSION) {
+    throw std::runtime_error(prefix + " has version " + std::to_string(version) +
+                             ", but this build can only read up to version " + std::to_string(MATRIX_VERSION));
+  }
+  uint32_t flags = readRaw<uint32_t>(data + 12);
+  uint32_t scalarCode = readRaw<uint32_t>(data + 16);
+  uint32_t scalarBytes = readRaw<uint32_t>(data + 20);
+  uint64_t rows = readRaw<uint64_t>(data + 24);
+  uint64_t cols = readRaw<uint64_t>(data + 32);
+  uint64_t nonZeros = readRaw<uint64_t>(data + 40);
+
+  scalar = scalarInfo(scalarCode);
+  if (scalar.code == 0 || scalarBytes != scalar.wordBytes * scalar.nWords) {
+    throw std::runtime_error(prefix + " has an unknown scalar type");
+  }
+  if ((flags & ~(FLAG_SPARSE | FLAG_ROW_MAJOR | FLAG_COMPRESSED)) != 0) {
+    throw std::runtime_error(prefix + " has unknown flags");
+  }
+  bool validDimensions;
+  if (flags & FLAG_SPARSE) {
+    const uint64_t maxIndex = std::numeric_limits<int32_t>::max();
+    validDimensions = rows <= maxIndex && cols <= maxIndex && nonZeros <= maxIndex && nonZeros <= rows * cols;
+  } else {
+    // Every entry is stored, and the size of the values must not overflow
+    const uint64_t maxValues = (std::numeric_limits<size_t>::max() - MATRIX_HEADER_SIZE) / scalarBytes;
+    validDimensions = (cols == 0 || rows <= maxValues / cols) && nonZeros == rows * cols;
+  }
+  if (!validDimensions) {
+    throw std::runtime_error(prefix + " has invalid dimensions");
+  }
+  sparse = flags & FLAG_SPARSE;
+  rowMajor = flags & FLAG_ROW_MAJOR;
+  compressed = flags & FLAG_COMPRESSED;
+  nRows = rows;
+  nCols = cols;
+  nNonZeros = nonZeros;
+
+  std::string truncatedMessage = prefix + " is truncated";
+  if (!compressed) {
+    size_t offset = MATRIX_HEADER_SIZE;
+    if (sparse) {
+      outerPtr = reinterpret_cast<const int32_t*>(data + offset);
+      offset += paddedSize((outerSize() + 1) * sizeof(int32_t));
+      innerPtr = reinterpret_cast<const int32_t*>(data + offset);
+      offset += paddedSize(nNonZeros * sizeof(int32_t));
+    }
+    valuePtr = data + offset;
+    offset += nNonZeros * scalarBytes;
+    if (dataSize < offset) throw std::runtime_error(truncatedMessage);
+
+    if (sparse) {
+      bool valid = outerPtr[0] == 0 && static_cast<size_t>(outerPtr[outerSize()]) == nNonZeros;
+      for (size_t k = 0; valid && k < outerSize(); k++) {
+        valid = outerPtr[k] <= outerPtr[k + 1];
+      }
+      if (!valid) throw std::runtime_error(prefix + " has invalid outer indices");
+    }
+    return;
+  }
+
+  // Locate the coded blocks from the table at the end of the file
+  size_t tableEntryBytes = sparse ? 16 : 8;
+  size_t tableTrailerBytes = sparse ? 8 : 16;
+  if (dataSize - MATRIX_HEADER_SIZE < tableTrailerBytes) throw std::runtime_error(truncatedMessage);
+  uint64_t nBlocks = readRaw<uint64_t>(data + dataSize - 8);
+  if (nBlocks > (dataSize - MATRIX_HEADER_SIZE - tableTrailerBytes) / tableEntryBytes) {
+    throw std::runtime_error(truncatedMessage);
+  }
+  size_t tableBegin = dataSize - tableTrailerBytes - nBlocks * tableEntryBytes;
+  size_t blockSize = 0;
+  if (!sparse) {
+    blockSize = readRaw<uint64_t>(data + dataSize - 16);
+    if (blockSize == 0 || nBlocks != (nNonZeros + blockSize - 1) / blockSize) {
+      throw std::runtime_error(prefix + " has an invalid block table");
+    }
+  }
+
+  blockBegins.resize(nBlocks + 1);
+  blockOffsets.resize(nBlocks + 1);
+  blockOffsets[0] = MATRIX_HEADER_SIZE;
+  for (size_t iBlock = 0; iBlock < nBlocks; iBlock++) {
+    const char* entry = data + tableBegin + iBlock * tableEntryBytes;
+    uint64_t nBytes = readRaw<uint64_t>(entry + (sparse ? 8 : 0));
+    if (nBytes > tableBegin - blockOffsets[iBlock]) throw std::runtime_error(truncatedMessage);
+    blockOffsets[iBlock + 1] = blockOffsets[iBlock] + nBytes;
+    blockBegins[iBlock] = sparse ? readRaw<uint64_t>(entry) : iBlock * blockSize;
+  }
+  blockBegins[nBlocks] = sparse ? outerSize() : nNonZeros;
+
+  bool valid = blockOffsets[nBlocks] == tableBegin && blockBegins[0] == 0;
+  for (size_t iBlock = 0; valid && iBlock < nBlocks; iBlock++) {
+    valid = blockBegins[iBlock] < blockBegins[iBlock + 1];
+  }
+  if (!valid) throw std::runtime_error(prefix + " has an invalid block table");
+}
+
+std::string BinaryMatrixFile::scalarTypeName() const { return scalarName(scalar.code); }
+
+void BinaryMatrixFile::checkScalarType(BinaryMatrixScalarInfo requested, bool wantSparse) const {
+  std::string prefix = "binary matrix " + source;
+  if (sparse != wantSparse) {
+    throw std::runtime_error(prefix + (sparse ? " holds a sparse matrix, not a dense one"
+                                              : " holds a dense matrix, not a sparse one"));
+  }
+  if (requested.code != scalar.code) {
+    throw std::runtime_error(prefix + " holds " + scalarName(scalar.code) + " values, but " +
+                             scalarName(requested.code) + " values were requested");
+  }
+}
+
+void BinaryMatrixFile::readSparseArrays(int32_t* outerIndices, int32_t* innerIndices, char* values,
+                                        size_t nThreads) const {
+  size_t scalarBytes = scalar.wordBytes * scalar.nWords;
+  size_t nOuter = outerSize();
+  int64_t nInner = innerSize();
+
+  if (!compressed) {
+    std::memcpy(outerIndices, outerPtr, (nOuter + 1) * sizeof(int32_t));
+    std::memcpy(innerIndices, innerPtr, nNonZeros * sizeof(int32_t));
+    std::memcpy(values, valuePtr, nNonZeros * scalarBytes);
+
+    const size_t checkBlockSize = 1 << 16;
+    parallelFor((nNonZeros + checkBlockSize - 1) / checkBlockSize, nThreads, [&](size_t iBlock) {
+      size_t end = std::min(nNonZeros, (iBlock + 1) * checkBlockSize);
+      for (size_t j = iBlock * checkBlockSize; j < end; j++) {
+        if (innerIndices[j] < 0 || innerIndices[j] >= nInner) {
+          throw std::runtime_error("binary matrix " + source + " has an index out of range");
+        }
+      }
+    });
+    return;
+  }
+
+  try {
+    // Read the entry counts of each block, and sum them to find where each outer index begins
+    size_t nBlocks = blockBegins.size() - 1;
+    std::vector<uint64_t> counts(nOuter);
+    parallelFor(nBlocks, nThreads, [&](size_t iBlock) {
+      const char* p = data + blockOffsets[iBlock];
+      const char* end = data + blockOffsets[iBlock + 1];
+      for (size_t k = blockBegins[iBlock]; k < blockBegins[iBlock + 1]; k++) {
+        counts[k] = readVarint(p, end);
+        if (counts[k] > static_cast<uint64_t>(nInner)) throw std::runtime_error("block holds an invalid count");
+      }
+    });
+    uint64_t total = parallelExclusiveScan(counts, nThreads);
+    if (total != nNonZeros) throw std::runtime_error("blocks hold the wrong number of entries");
+    for (size_t k = 0; k < nOuter; k++) {
+      outerIndices[k] = static_cast<int32_t>(counts[k]);
+    }
+    outerIndices[nOuter] = static_cast<int32_t>(nNonZeros);
+
+    // Decode each block's indices and values into place
+    parallelFor(nBlocks, nThreads, [&](size_t iBlock) {
+      const char* p = data + blockOffsets[iBlock];
+      const char* end = data + blockOffsets[iBlock + 1];
+      size_t outerBegin = blockBegins[iBlock];
+      size_t outerEnd = blockBegins[iBlock + 1];
+      for (size_t k = outerBegin; k < outerEnd; k++) {
+        readVarint(p, end);
+      }
+      for (size_t k = outerBegin; k < outerEnd; k++) {
+        int64_t prev = -1;
+        for (int32_t j = outerIndices[k]; j < outerIndices[k + 1]; j++) {
+          uint64_t gap = readVarint(p, end);
+          if (gap >= static_cast<uint64_t>(2 * nInner)) throw std::runtime_error("block holds an invalid index");
+          int64_t index = prev + 1 + unzigzag(gap);
+          if (index < 0 || index >= nInner) throw std::runtime_error("block holds an invalid index");
+          innerIndices[j] = static_cast<int32_t>(index);
+          prev = index;
+        }
+      }
+      size_t valuesBegin = outerIndices[outerBegin];
+      decodeValues(p, end, outerIndices[outerEnd] - valuesBegin, scalar, values + valuesBegin * scalarBytes);
+      if (p != end) throw std::runtime_error("block has trailing data");
+    });
+  } catch (const std::runtime_error& e) {
+    throw std::runtime_error("binary matrix " + source + " is corrupt: " + e.what());
+  }
+}
+
+void BinaryMatrixFile::readDenseValues(char* values, size_t nThreads) const {
+  size_t scalarBytes = scalar.wordBytes * scalar.nWords;
+  if (!compressed) {
+    std::memcpy(values, valuePtr, nNonZeros * scalarBytes);
+    return;
+  }
+
+  try {
+    parallelFor(blockBegins.size() - 1, nThreads, [&](size_t iBlock) {
+      const char* p = data + blockOffsets[iBlock];
+      const char* end = data + blockOffsets[iBlock + 1];
+      size_t begin = blockBegins[iBlock];
+      decodeValues(p, end, blockBegins[iBlock + 1] - begin, scalar, values + begin * scalarBytes);
+      if (p != end) throw std::runtime_error("block has trailing data");
+    });
+  } catch (const std::runtime_error& e) {
+    throw std::runtime_error("binary matrix " + source + " is corrupt: " + e.what());
+  }
+}
+
 } // namespace geometrycentral
@@ -1,6 +1,7 @@
 #include "geometrycentral/numerical/linear_solvers.h"
 
 #include "geometrycentral/numerical/linear_algebra_utilities.h"
+#include "geometrycentral/utilities/profiler.h"
 
 #ifdef GC_HAVE_SUITESPARSE
 #include "geometrycentral/numerical/suitesparse_utilities.h"
@@ -35,6 +36,7 @@ PositiveDefiniteSolver<T>::~PositiveDefiniteSolver() {
 template <typename T>
 PositiveDefiniteSolver<T>::PositiveDefiniteSolver(SparseMatrix<T>& mat)
     : LinearSolver<T>(mat), internals(new PSDSolverInternals<T>()) {
+  GC_PROFILE_SCOPE("PositiveDefiniteSolver factorization");
 
 
   // Check some sanity
@@ -1,6 +1,7 @@
 #include "geometrycentral/numerical/linear_solvers.h"
 
 #include "geometrycentral/numerical/linear_algebra_utilities.h"
+#include "geometrycentral/utilities/profiler.h"
 
 #ifdef GC_HAVE_SUITESPARSE
 #include "geometrycentral/numerical/suitesparse_utilities.h"
@@ -43,6 +44,7 @@ Solver<T>::~Solver() {
 
 template <typename T>
 Solver<T>::Solver(SparseMatrix<T>& mat) : LinearSolver<T>(mat), internals(new QRSolverInternals<T>()) {
+  GC_PROFILE_SCOPE("QR Solver factorization");
 
   // Is the system underdetermined?
   if (this->nRows < this->nCols) {
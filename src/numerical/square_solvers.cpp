@@ -1,6 +1,7 @@
 #include "geometrycentral/numerical/linear_solvers.h"
 
 #include "geometrycentral/numerical/linear_algebra_utilities.h"
+#include "geometrycentral/utilities/profiler.h"
 
 #ifdef GC_HAVE_SUITESPARSE
 #include "geometrycentral/numerical/suitesparse_utilities.h"
@@ -115,6 +116,7 @@ void umfSolve<std::complex<double>>(size_t N, cholmod_sparse* mat, void* numeric
 
 template <typename T>
 SquareSolver<T>::SquareSolver(SparseMatrix<T>& mat) : LinearSolver<T>(mat), internals(new SquareSolverInternals<T>()) {
+  GC_PROFILE_SCOPE("SquareSolver factorization");
 
   // Check some sanity
   if (this->nRows != this->nCols) {
@@ -1,5 +1,6 @@
 #include "geometrycentral/pointcloud/point_cloud_io.h"
 
+#include "geometrycentral/pointcloud/point_cloud_stream.h"
 #include "geometrycentral/surface/simple_polygon_mesh.h"
 
 
@@ -11,7 +12,7 @@ namespace pointcloud {
 // Anonymous helpers
 namespace {
 
-std::vector<std::string> supportedPointCloudTypes = {"obj", "ply"};
+std::vector<std::string> supportedPointCloudTypes = {"obj", "ply", "xyz"};
 
 std::string typeFromFilename(std::string filename) {
 
@@ -76,6 +77,17 @@ std::tuple<std::unique_ptr<PointCloud>, std::unique_ptr<PointPositionGeometry>>
   return std::make_tuple(std::move(cloud), std::move(geom));
 }
 
+// Read all points through the streaming reader, which is used for .xyz files and binary .ply files
+std::tuple<std::unique_ptr<PointCloud>, std::unique_ptr<PointPositionGeometry>>
+readPointCloud_streamed(PointCloudReader& reader) {
+  PointCloudChunk allPoints, chunk;
+  if (reader.nPoints() != INVALID_IND) allPoints.positions.reserve(reader.nPoints());
+  while (reader.readChunk(chunk)) {
+    allPoints.positions.insert(allPoints.positions.end(), chunk.positions.begin(), chunk.positions.end());
+  }
+  return makePointCloudAndGeometry(allPoints);
+}
+
 } // namespace
 
 std::tuple<std::unique_ptr<PointCloud>, std::unique_ptr<PointPositionGeometry>> readPointCloud(std::string filename,
@@ -92,6 +104,11 @@ std::tuple<std::unique_ptr<PointCloud>, std::unique_ptr<PointPositionGeometry>>
   // others are binary.  The only real difference is that non-binary mode performs automatic translation of line ending
   // characters (e.g. \r\n --> \n from DOS). However, this behavior is platform-dependent and having platform-dependent
   // behavior seems more confusing then just handling the newlines properly in the parsers.
+  if (type == "xyz" || (type == "ply" && PointCloudReader::canRead(filename, type))) {
+    PointCloudReader reader(filename, type);
+    return readPointCloud_streamed(reader);
+  }
+
   std::ifstream inStream(filename, std::ios::binary);
   if (!inStream) throw std::runtime_error("couldn't open file " + filename);
 
@@ -105,6 +122,9 @@ std::tuple<std::unique_ptr<PointCloud>, std::unique_ptr<PointPositionGeometry>>
     return readPointCloud_obj(in);
   } else if (type == "ply") {
     return readPointCloud_ply(in);
+  } else if (type == "xyz") {
+    PointCloudReader reader(in, type);
+    return readPointCloud_streamed(reader);
   } else {
     throw std::runtime_error("Did not recognize point cloud file type " + type);
   }
@@ -160,6 +180,13 @@ void writePointCloud(PointCloud& cloud, PointPositionGeometry& geometry, std::st
   // others are binary.  The only real difference is that non-binary mode performs automatic translation of line ending
   // characters (e.g. \r\n --> \n from DOS). However, this behavior is platform-dependent and having platform-dependent
   // behavior seems more confusing then just handling the newlines properly in the parsers.
+  if (type == "xyz" || (type == "ply" && plyHostIsLittleEndian())) {
+    PointCloudWriter writer(filename, false, false, type);
+    writer.writeChunk(cloud, geometry);
+    writer.close();
+    return;
+  }
+
   std::ofstream outStream(filename, std::ios::binary);
   if (!outStream) throw std::runtime_error("couldn't open file " + filename);
 
@@ -172,6 +199,10 @@ void writePointCloud(PointCloud& cloud, PointPositionGeometry& geometry, std::os
     return writePointCloud_obj(cloud, geometry, out);
   } else if (type == "ply") {
     return writePointCloud_ply(cloud, geometry, out);
+  } else if (type == "xyz") {
+    PointCloudWriter writer(out, type);
+    writer.writeChunk(cloud, geometry);
+    writer.close();
   } else {
     throw std::runtime_error("Did not recognize point cloud file type " + type);
   }
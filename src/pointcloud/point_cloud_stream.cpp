@@ -0,0 +1,469 @@
+#include "geometrycentral/pointcloud/point_cloud_stream.h"
+
+#include "geometrycentral/utilities/formatted_output.h"
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace geometrycentral {
+namespace pointcloud {
+
+namespace {
+
+const size_t XYZ_READ_BLOCK_SIZE = 1 << 22;
+const size_t PLY_MAX_HEADER_SIZE = 1 << 20;
+const size_t PARSE_GRAIN_SIZE = 1 << 12;
+
+// Width reserved for the vertex count in a streamed .ply header, which is padded with trailing spaces
+const size_t PLY_COUNT_WIDTH = 20;
+
+// The .ply properties read for each point, in the order of PointCloudReader::propertyOffsets
+const char* const plyPropertyNames[9] = {"x", "y", "z", "nx", "ny", "nz", "red", "green", "blue"};
+
+std::string streamTypeFromFilename(std::string filename, std::string type) {
+  if (type == "") {
+    size_t sepInd = filename.rfind('.');
+    if (sepInd == std::string::npos) {
+      throw std::runtime_error("Could not auto-detect file type to stream point cloud from " + filename);
+    }
+    type = filename.substr(sepInd + 1);
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+  }
+  if (type != "ply" && type != "xyz") {
+    throw std::runtime_error("point clouds can only be streamed from .ply or .xyz files, not " + type);
+  }
+  return type;
+}
+
+inline bool isLineEnd(char c) { return c == '\n' || c == '\r' || c == '\0'; }
+inline bool isSeparator(char c) { return c == ' ' || c == '\t' || c == ','; }
+
+inline void skipSeparators(const char*& p) {
+  while (isSeparator(*p)) p++;
+}
+
+// Whether a line of an .xyz file holds a point, rather than being blank or a comment
+inline bool isDataLine(const char* p) {
+  skipSeparators(p);
+  return !isLineEnd(*p) && *p != '#';
+}
+
+// Parse the numbers on one line of an .xyz file, returning how many there were. Returns maxValues + 1 if the line has
+// more values, or anything other than numbers.
+size_t parseXyzLine(const char* p, double* values, size_t maxValues) {
+  size_t n = 0;
+  skipSeparators(p);
+  while (n < maxValues && !isLineEnd(*p)) {
+    if (!parseDouble(p, values[n])) return maxValues + 1;
+    n++;
+    if (!isSeparator(*p) && !isLineEnd(*p)) return maxValues + 1;
+    skipSeparators(p);
+  }
+  return isLineEnd(*p) ? n : maxValues + 1;
+}
+
+uint8_t colorFromValue(double val, bool isFloat) {
+  if (isFloat) val *= 255.;
+  if (!(val > 0.)) return 0;
+  if (val >= 255.) return 255;
+  return static_cast<uint8_t>(std::round(val));
+}
+
+} // namespace
+
+void PointCloudChunk::clear() {
+  firstIndex = 0;
+  positions.clear();
+  normals.clear();
+  colors.clear();
+}
+
+std::tuple<std::unique_ptr<PointCloud>, std::unique_ptr<PointPositionGeometry>>
+makePointCloudAndGeometry(const PointCloudChunk& chunk) {
+  std::unique_ptr<PointCloud> cloud(new PointCloud(chunk.size()));
+  std::unique_ptr<PointPositionGeometry> geom(new PointPositionGeometry(*cloud));
+  for (size_t i = 0; i < chunk.size(); i++) {
+    geom->positions[i] = chunk.positions[i];
+  }
+  return std::make_tuple(std::move(cloud), std::move(geom));
+}
+
+// ======= Reading =======
+
+PointCloudReader::PointCloudReader(std::string filename, std::string type_)
+    : file(new std::ifstream(filename, std::ios::binary)), in(*file), type(streamTypeFromFilename(filename, type_)) {
+  if (!*file) throw std::runtime_error("couldn't open file " + filename);
+  if (type == "ply") {
+    readPlyHeader();
+  } else {
+    readXyzFirstLine();
+  }
+}
+
+PointCloudReader::PointCloudReader(std::istream& in_, std::string type_)
+    : in(in_), type(streamTypeFromFilename("", type_)) {
+  if (type == "ply") {
+    readPlyHeader();
+  } else {
+    readXyzFirstLine();
+  }
+}
+
+bool PointCloudReader::canRead(std::string filename, std::string type) {
+  try {
+    PointCloudReader reader(filename, type);
+    return true;
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+}
+
+size_t PointCloudReader::nPoints() const {
+  if (type == "ply") return nVertexRows;
+  return allPointsRead ? nRead : INVALID_IND;
+}
+
+bool PointCloudReader::readChunk(PointCloudChunk& chunk, size_t maxPoints) {
+  chunk.clear();
+  if (maxPoints == 0) throw std::runtime_error("point cloud chunks must hold at least one point");
+  return type == "ply" ? readPlyChunk(chunk, maxPoints) : readXyzChunk(chunk, maxPoints);
+}
+
+void PointCloudReader::readPlyHeader() {
+  std::string header;
+  std::string line;
+  while (true) {
+    if (!std::getline(in, line)) throw std::runtime_error("point cloud .ply file ended before its header did");
+    header += line;
+    header += '\n';
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line == "end_header") break;
+    if (header.size() > PLY_MAX_HEADER_SIZE) throw std::runtime_error("point cloud .ply header is too long");
+  }
+
+  std::string format;
+  std::vector<PlyElement> elements;
+  size_t headerSize;
+  if (!parsePlyHeader(header.data(), header.data() + header.size(), format, elements, headerSize)) {
+    throw std::runtime_error("could not parse point cloud .ply header");
+  }
+  if (format != "binary_little_endian" || !plyHostIsLittleEndian()) {
+    throw std::runtime_error("only binary little-endian .ply files can be streamed (on little-endian machines)");
+  }
+
+  // Skip any elements before the vertices
+  size_t iVertex = 0;
+  while (iVertex < elements.size() && elements[iVertex].name != "vertex") {
+    const PlyElement& elem = elements[iVertex];
+    if (!elem.allScalar()) {
+      throw std::runtime_error("cannot stream a .ply file with list element " + elem.name + " before its vertices");
+    }
+    size_t nBytes = elem.count * elem.scalarStride();
+    in.ignore(static_cast<std::streamsize>(nBytes));
+    if (static_cast<size_t>(in.gcount()) != nBytes) throw std::runtime_error("point cloud .ply file is truncated");
+    iVertex++;
+  }
+  if (iVertex == elements.size()) throw std::runtime_error("point cloud .ply file has no vertex element");
+  const PlyElement& vertexElem = elements[iVertex];
+  if (!vertexElem.allScalar()) throw std::runtime_error("cannot stream a .ply file with list properties on vertices");
+
+  nVertexRows = vertexElem.count;
+  rowStride = vertexElem.scalarStride();
+  for (size_t j = 0; j < 9; j++) {
+    propertyOffsets[j] = INVALID_IND;
+    propertyTypes[j] = PlyType::Float64;
+  }
+  size_t offset = 0;
+  for (const PlyProperty& prop : vertexElem.properties) {
+    for (size_t j = 0; j < 9; j++) {
+      if (prop.name == plyPropertyNames[j]) {
+        propertyOffsets[j] = offset;
+        propertyTypes[j] = prop.type;
+      }
+    }
+    offset += plyTypeSize(prop.type);
+  }
+
+  std::array<bool, 3> present;
+  for (size_t k = 0; k < 3; k++) {
+    present[k] = true;
+    for (size_t j = 3 * k; j < 3 * k + 3; j++) {
+      present[k] = present[k] && propertyOffsets[j] != INVALID_IND;
+    }
+  }
+  if (!present[0]) throw std::runtime_error("point cloud .ply file does not have x, y, and z vertex properties");
+  normalsPresent = present[1];
+  colorsPresent = present[2];
+}
+
+bool PointCloudReader::readPlyChunk(PointCloudChunk& chunk, size_t maxPoints) {
+  size_t n = std::min(maxPoints, nVertexRows - nRead);
+  if (n == 0) return false;
+
+  buffer.resize(n * rowStride);
+  in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  if (static_cast<size_t>(in.gcount()) != buffer.size()) throw std::runtime_error("point cloud .ply file is truncated");
+
+  chunk.firstIndex = nRead;
+  chunk.positions.resize(n);
+  if (normalsPresent) chunk.normals.resize(n);
+  if (colorsPresent) chunk.colors.resize(n);
+  parallelFor(
+      n, nThreads,
+      [&](size_t i) {
+        const char* row = &buffer[i * rowStride];
+        for (int k = 0; k < 3; k++) {
+          chunk.positions[i][k] = readPlyValue<double>(row + propertyOffsets[k], propertyTypes[k]);
+        }
+        if (normalsPresent) {
+          for (int k = 0; k < 3; k++) {
+            chunk.normals[i][k] = readPlyValue<double>(row + propertyOffsets[3 + k], propertyTypes[3 + k]);
+          }
+        }
+        if (colorsPresent) {
+          for (int k = 0; k < 3; k++) {
+            PlyType colorType = propertyTypes[6 + k];
+            bool isFloat = colorType == PlyType::Float32 || colorType == PlyType::Float64;
+            chunk.colors[i][k] = colorFromValue(readPlyValue<double>(row + propertyOffsets[6 + k], colorType), isFloat);
+          }
+        }
+      },
+      PARSE_GRAIN_SIZE);
+
+  nRead += n;
+  return true;
+}
+
+bool PointCloudReader::fillTextBuffer() {
+  if (endOfText) return false;
+  if (textBegin > 0) {
+    std::memmove(buffer.data(), buffer.data() + textBegin, textEnd - textBegin);
+    textEnd -= textBegin;
+    textBegin = 0;
+  }
+  buffer.resize(textEnd + XYZ_READ_BLOCK_SIZE + 1);
+  in.read(&buffer[textEnd], XYZ_READ_BLOCK_SIZE);
+  size_t nNew = static_cast<size_t>(in.gcount());
+  textEnd += nNew;
+  buffer[textEnd] = '\0'; // so that parsing stops at the end of the text
+  if (nNew == 0) endOfText = true;
+  return nNew > 0;
+}
+
+void PointCloudReader::readXyzFirstLine() {
+  buffer.assign(1, '\0');
+
+  // Count the numbers on the first line which holds a point
+  size_t lineStart = 0;
+  while (true) {
+    const char* text = buffer.data();
+    const char* lineEnd = static_cast<const char*>(std::memchr(text + lineStart, '\n', textEnd - lineStart));
+    if (lineEnd == nullptr && !endOfText) {
+      size_t shift = textBegin;
+      fillTextBuffer();
+      lineStart -= shift;
+      continue;
+    }
+    if (lineStart == textEnd) {
+      nColumns = 3; // no points at all
+      return;
+    }
+    if (isDataLine(text + lineStart)) break;
+    if (lineEnd == nullptr) {
+      nColumns = 3;
+      return;
+    }
+    lineStart = lineEnd + 1 - text;
+  }
+
+  double values[9];
+  nColumns = parseXyzLine(buffer.data() + lineStart, values, 9);
+  if (nColumns != 3 && nColumns != 6 && nColumns != 9) {
+    throw std::runtime_error("lines of .xyz files must have 3, 6, or 9 values (positions, normals, and colors)");
+  }
+  normalsPresent = nColumns >= 6;
+  colorsPresent = nColumns == 9;
+}
+
+bool PointCloudReader::readXyzChunk(PointCloudChunk& chunk, size_t maxPoints) {
+  // Find the starts of the next maxPoints lines holding points. The text for the chunk is kept in the buffer
+  // (starting from textBegin) until it is parsed, so offsets are shifted whenever the buffer is refilled.
+  std::vector<size_t> lineStarts;
+  size_t pos = textBegin;
+  while (lineStarts.size() < maxPoints) {
+    const char* text = buffer.data();
+    const char* lineEnd = static_cast<const char*>(std::memchr(text + pos, '\n', textEnd - pos));
+    if (lineEnd == nullptr) {
+      if (!endOfText) {
+        size_t shift = textBegin;
+        fillTextBuffer();
+        pos -= shift;
+        for (size_t& start : lineStarts) start -= shift;
+        continue;
+      }
+      // The last line may not end with a newline
+      if (pos < textEnd && isDataLine(text + pos)) lineStarts.push_back(pos);
+      pos = textEnd;
+      allPointsRead = true;
+      break;
+    }
+    if (isDataLine(text + pos)) lineStarts.push_back(pos);
+    pos = lineEnd + 1 - text;
+  }
+  textBegin = pos;
+
+  size_t n = lineStarts.size();
+  if (n == 0) return false;
+  chunk.firstIndex = nRead;
+  chunk.positions.resize(n);
+  if (normalsPresent) chunk.normals.resize(n);
+  if (colorsPresent) chunk.colors.resize(n);
+  parallelFor(
+      n, nThreads,
+      [&](size_t i) {
+        double values[9];
+        if (parseXyzLine(buffer.data() + lineStarts[i], values, nColumns) != nColumns) {
+          throw std::runtime_error("could not parse point " + std::to_string(nRead + i) + " of .xyz file");
+        }
+        chunk.positions[i] = Vector3{values[0], values[1], values[2]};
+        if (normalsPresent) chunk.normals[i] = Vector3{values[3], values[4], values[5]};
+        if (colorsPresent) {
+          for (int k = 0; k < 3; k++) chunk.colors[i][k] = colorFromValue(values[6 + k], false);
+        }
+      },
+      PARSE_GRAIN_SIZE);
+
+  nRead += n;
+  return true;
+}
+
+// ======= Writing =======
+
+PointCloudWriter::PointCloudWriter(std::string filename, bool withNormals_, bool withColors_, std::string type_)
+    : file(new std::ofstream(filename, std::ios::binary)), out(*file), type(streamTypeFromFilename(filename, type_)),
+      withNormals(withNormals_), withColors(withColors_) {
+  if (!*file) throw std::runtime_error("couldn't open output file " + filename);
+  if (type == "ply") writePlyHeader();
+}
+
+PointCloudWriter::PointCloudWriter(std::ostream& out_, std::string type_, bool withNormals_, bool withColors_)
+    : out(out_), type(streamTypeFromFilename("", type_)), withNormals(withNormals_), withColors(withColors_) {
+  if (type == "ply") writePlyHeader();
+}
+
+PointCloudWriter::~PointCloudWriter() {
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+void PointCloudWriter::writePlyHeader() {
+  if (!plyHostIsLittleEndian()) {
+    throw std::runtime_error("binary ply files can only be streamed on little-endian machines");
+  }
+  out << "ply\n";
+  out << "format binary_little_endian 1.0\n";
+  out << "element vertex ";
+  countPos = out.tellp();
+  if (countPos == std::streampos(-1)) {
+    throw std::runtime_error("point cloud .ply files can only be streamed to a seekable output");
+  }
+  out << std::string(PLY_COUNT_WIDTH, ' ') << "\n";
+  out << "property double x\nproperty double y\nproperty double z\n";
+  if (withNormals) out << "property float nx\nproperty float ny\nproperty float nz\n";
+  if (withColors) out << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+  out << "end_header\n";
+}
+
+void PointCloudWriter::writeChunk(const PointCloudChunk& chunk) {
+  size_t n = chunk.size();
+  if (chunk.normals.size() != (withNormals ? n : 0) || chunk.colors.size() != (withColors ? n : 0)) {
+    throw std::runtime_error("point cloud chunk does not have the normals and colors the writer was opened with");
+  }
+  writeRows(n, chunk.positions.data(), chunk.normals.data(), chunk.colors.data());
+}
+
+void PointCloudWriter::writeChunk(PointCloud& cloud, PointPositionGeometry& geometry) {
+  if (withNormals || withColors) {
+    throw std::runtime_error("point cloud writer was opened with normals or colors, which a geometry does not have");
+  }
+  std::vector<Vector3> positions(cloud.nPoints());
+  for (size_t i = 0; i < positions.size(); i++) {
+    positions[i] = geometry.positions[i];
+  }
+  writeRows(positions.size(), positions.data(), nullptr, nullptr);
+}
+
+void PointCloudWriter::writeRows(size_t n, const Vector3* positions, const Vector3* normals,
+                                 const std::array<uint8_t, 3>* colors) {
+  if (closed) throw std::runtime_error("cannot write to a closed point cloud writer");
+
+  if (type == "ply") {
+    writeInParallel(out, n, [&](size_t i, std::string& buffer) {
+      char row[3 * sizeof(double) + 3 * sizeof(float) + 3];
+      char* p = row;
+      for (int k = 0; k < 3; k++) {
+        double val = positions[i][k];
+        std::memcpy(p, &val, sizeof(double));
+        p += sizeof(double);
+      }
+      if (withNormals) {
+        for (int k = 0; k < 3; k++) {
+          float val = static_cast<float>(normals[i][k]);
+          std::memcpy(p, &val, sizeof(float));
+          p += sizeof(float);
+        }
+      }
+      if (withColors) {
+        for (int k = 0; k < 3; k++) *p++ = static_cast<char>(colors[i][k]);
+      }
+      buffer.append(row, p);
+    }, nThreads);
+  } else {
+    writeInParallel(out, n, [&](size_t i, std::string& buffer) {
+      char line[9 * FORMAT_BUFFER_SIZE];
+      char* p = line;
+      for (int k = 0; k < 3; k++) {
+        if (k > 0) *p++ = ' ';
+        p = formatDouble(p, positions[i][k]);
+      }
+      if (withNormals) {
+        for (int k = 0; k < 3; k++) {
+          *p++ = ' ';
+          p = formatDouble(p, normals[i][k]);
+        }
+      }
+      if (withColors) {
+        for (int k = 0; k < 3; k++) {
+          *p++ = ' ';
+          p = formatInteger(p, colors[i][k]);
+        }
+      }
+      *p++ = '\n';
+      buffer.append(line, p);
+    }, nThreads);
+  }
+  nWritten += n;
+}
+
+void PointCloudWriter::close() {
+  if (closed) return;
+  closed = true;
+
+  if (type == "ply") {
+    std::string count = std::to_string(nWritten);
+    out.seekp(countPos);
+    out.write(count.data(), count.size());
+    out.seekp(0, std::ios::end);
+  }
+  out.flush();
+  if (file) file->close();
+  if (!out) throw std::runtime_error("failed to write point cloud");
+}
+
+} // namespace pointcloud
+} // namespace geometrycentral
@@ -17,20 +17,20 @@ PointPositionGeometry::PointPositionGeometry(PointCloud& cloud_, const PointData
       
   // Construct the dependency graph of managed quantities and their callbacks
 
-  pointIndicesQ             (&pointIndices,             std::bind(&PointPositionGeometry::computePointIndices, this),          quantities),
-  neighborsQ                (&neighbors,                std::bind(&PointPositionGeometry::computeNeighbors, this),             quantities),
-  normalsQ                  (&normals,                  std::bind(&PointPositionGeometry::computeNormals, this),               quantities),
-  tangentBasisQ             (&tangentBasis,             std::bind(&PointPositionGeometry::computeTangentBasis, this),          quantities),
-  tangentCoordinatesQ       (&tangentCoordinates,       std::bind(&PointPositionGeometry::computeTangentCoordinates, this),             quantities),
-  tangentTransportQ         (&tangentTransport,         std::bind(&PointPositionGeometry::computeTangentTransport, this),             quantities),
+  pointIndicesQ             (&pointIndices,             std::bind(&PointPositionGeometry::computePointIndices, this),          quantities, "pointIndices"),
+  neighborsQ                (&neighbors,                std::bind(&PointPositionGeometry::computeNeighbors, this),             quantities, "neighbors"),
+  normalsQ                  (&normals,                  std::bind(&PointPositionGeometry::computeNormals, this),               quantities, "normals"),
+  tangentBasisQ             (&tangentBasis,             std::bind(&PointPositionGeometry::computeTangentBasis, this),          quantities, "tangentBasis"),
+  tangentCoordinatesQ       (&tangentCoordinates,       std::bind(&PointPositionGeometry::computeTangentCoordinates, this),             quantities, "tangentCoordinates"),
+  tangentTransportQ         (&tangentTransport,         std::bind(&PointPositionGeometry::computeTangentTransport, this),             quantities, "tangentTransport"),
 
   tuftedTriPair{&tuftedMesh, &tuftedGeom},
-  tuftedTriangulationQ      (&tuftedTriPair,            std::bind(&PointPositionGeometry::computeTuftedTriangulation, this),   quantities),
+  tuftedTriangulationQ      (&tuftedTriPair,            std::bind(&PointPositionGeometry::computeTuftedTriangulation, this),   quantities, "tuftedTriangulation"),
 
   // operators
-  laplacianQ                (&laplacian,                std::bind(&PointPositionGeometry::computeLaplacian, this),             quantities),
-  connectionLaplacianQ      (&connectionLaplacian,      std::bind(&PointPositionGeometry::computeConnectionLaplacian, this),   quantities),
-  gradientQ                 (&gradient,                 std::bind(&PointPositionGeometry::computeGradient, this),              quantities)
+  laplacianQ                (&laplacian,                std::bind(&PointPositionGeometry::computeLaplacian, this),             quantities, "laplacian"),
+  connectionLaplacianQ      (&connectionLaplacian,      std::bind(&PointPositionGeometry::computeConnectionLaplacian, this),   quantities, "connectionLaplacian"),
+  gradientQ                 (&gradient,                 std::bind(&PointPositionGeometry::computeGradient, this),              quantities, "gradient")
 
   {
   }
@@ -42,6 +42,7 @@ PointPositionGeometry::PointPositionGeometry(PointCloud& cloud_)
 PointPositionGeometry::~PointPositionGeometry() {}
 
 void PointPositionGeometry::refreshQuantities() {
+  if (isFrozen()) throw std::runtime_error("cannot refreshQuantities() while geometry is frozen");
   for (DependentQuantity* q : quantities) {
     q->computed = false;
   }
@@ -51,11 +52,62 @@ void PointPositionGeometry::refreshQuantities() {
 }
 
 void PointPositionGeometry::purgeQuantities() {
+  if (isFrozen()) throw std::runtime_error("cannot purgeQuantities() while geometry is frozen");
   for (DependentQuantity* q : quantities) {
     q->clearIfNotRequired();
   }
 }
 
+std::vector<QuantityStatistics> PointPositionGeometry::getQuantityStatistics() const {
+  std::vector<QuantityStatistics> stats;
+  for (DependentQuantity* q : quantities) {
+    stats.push_back(q->getStatistics());
+  }
+  return stats;
+}
+
+size_t PointPositionGeometry::quantitiesBufferBytes() const {
+  size_t bytes = 0;
+  for (DependentQuantity* q : quantities) {
+    bytes += q->bufferBytes();
+  }
+  return bytes;
+}
+
+void PointPositionGeometry::setQuantityMemoryBudget(size_t maxBytes) {
+  if (isFrozen()) throw std::runtime_error("cannot setQuantityMemoryBudget() while geometry is frozen");
+  if (quantityMemoryBudget) {
+    quantityMemoryBudget->maxBytes = maxBytes;
+  } else {
+    quantityMemoryBudget.reset(new QuantityMemoryBudget(quantities, maxBytes));
+  }
+  quantityMemoryBudget->enforce();
+}
+
+void PointPositionGeometry::removeQuantityMemoryBudget() {
+  if (!quantityMemoryBudget) return;
+  quantityMemoryBudget->detach();
+  quantityMemoryBudget.reset();
+}
+
+void PointPositionGeometry::freeze() {
+  if (freezeLock) return;
+  freezeLock.reset(new std::recursive_mutex());
+  for (DependentQuantity* q : quantities) {
+    q->freezeLock = freezeLock.get();
+  }
+}
+
+void PointPositionGeometry::unfreeze() {
+  if (!freezeLock) return;
+  for (DependentQuantity* q : quantities) {
+    q->freezeLock = nullptr;
+  }
+  freezeLock.reset();
+}
+
+bool PointPositionGeometry::isFrozen() const { return freezeLock != nullptr; }
+
 
 // Point indices
 void PointPositionGeometry::computePointIndices() { pointIndices = cloud.getPointIndices(); }
@@ -10,13 +10,13 @@ BaseGeometryInterface::BaseGeometryInterface(SurfaceMesh& mesh_)
       
   // Construct the dependency graph of managed quantities and their callbacks
 
-  vertexIndicesQ           (&vertexIndices,         std::bind(&BaseGeometryInterface::computeVertexIndices, this),          quantities),
-  interiorVertexIndicesQ   (&interiorVertexIndices, std::bind(&BaseGeometryInterface::computeInteriorVertexIndices, this),  quantities),
-  edgeIndicesQ             (&edgeIndices,           std::bind(&BaseGeometryInterface::computeEdgeIndices, this),            quantities),
-  halfedgeIndicesQ         (&halfedgeIndices,       std::bind(&BaseGeometryInterface::computeHalfedgeIndices, this),        quantities),
-  cornerIndicesQ           (&cornerIndices,         std::bind(&BaseGeometryInterface::computeCornerIndices, this),          quantities),
-  faceIndicesQ             (&faceIndices,           std::bind(&BaseGeometryInterface::computeFaceIndices, this),            quantities),
-  boundaryLoopIndicesQ     (&boundaryLoopIndices,   std::bind(&BaseGeometryInterface::computeBoundaryLoopIndices, this),    quantities)
+  vertexIndicesQ           (&vertexIndices,         std::bind(&BaseGeometryInterface::computeVertexIndices, this),          quantities, "vertexIndices"),
+  interiorVertexIndicesQ   (&interiorVertexIndices, std::bind(&BaseGeometryInterface::computeInteriorVertexIndices, this),  quantities, "interiorVertexIndices"),
+  edgeIndicesQ             (&edgeIndices,           std::bind(&BaseGeometryInterface::computeEdgeIndices, this),            quantities, "edgeIndices"),
+  halfedgeIndicesQ         (&halfedgeIndices,       std::bind(&BaseGeometryInterface::computeHalfedgeIndices, this),        quantities, "halfedgeIndices"),
+  cornerIndicesQ           (&cornerIndices,         std::bind(&BaseGeometryInterface::computeCornerIndices, this),          quantities, "cornerIndices"),
+  faceIndicesQ             (&faceIndices,           std::bind(&BaseGeometryInterface::computeFaceIndices, this),            quantities, "faceIndices"),
+  boundaryLoopIndicesQ     (&boundaryLoopIndices,   std::bind(&BaseGeometryInterface::computeBoundaryLoopIndices, this),    quantities, "boundaryLoopIndices")
 
   {
   }
@@ -25,6 +25,7 @@ BaseGeometryInterface::BaseGeometryInterface(SurfaceMesh& mesh_)
 BaseGeometryInterface::~BaseGeometryInterface() {}
 
 void BaseGeometryInterface::refreshQuantities() {
+  if (isFrozen()) throw std::runtime_error("cannot refreshQuantities() while geometry is frozen");
   for (DependentQuantity* q : quantities) {
     q->computed = false;
   }
@@ -34,11 +35,62 @@ void BaseGeometryInterface::refreshQuantities() {
 }
 
 void BaseGeometryInterface::purgeQuantities() {
+  if (isFrozen()) throw std::runtime_error("cannot purgeQuantities() while geometry is frozen");
   for (DependentQuantity* q : quantities) {
     q->clearIfNotRequired();
   }
 }
 
+std::vector<QuantityStatistics> BaseGeometryInterface::getQuantityStatistics() const {
+  std::vector<QuantityStatistics> stats;
+  for (DependentQuantity* q : quantities) {
+    stats.push_back(q->getStatistics());
+  }
+  return stats;
+}
+
+size_t BaseGeometryInterface::quantitiesBufferBytes() const {
+  size_t bytes = 0;
+  for (DependentQuantity* q : quantities) {
+    bytes += q->bufferBytes();
+  }
+  return bytes;
+}
+
+void BaseGeometryInterface::setQuantityMemoryBudget(size_t maxBytes) {
+  if (isFrozen()) throw std::runtime_error("cannot setQuantityMemoryBudget() while geometry is frozen");
+  if (quantityMemoryBudget) {
+    quantityMemoryBudget->maxBytes = maxBytes;
+  } else {
+    quantityMemoryBudget.reset(new QuantityMemoryBudget(quantities, maxBytes));
+  }
+  quantityMemoryBudget->enforce();
+}
+
+void BaseGeometryInterface::removeQuantityMemoryBudget() {
+  if (!quantityMemoryBudget) return;
+  quantityMemoryBudget->detach();
+  quantityMemoryBudget.reset();
+}
+
+void BaseGeometryInterface::freeze() {
+  if (freezeLock) return;
+  freezeLock.reset(new std::recursive_mutex());
+  for (DependentQuantity* q : quantities) {
+    q->freezeLock = freezeLock.get();
+  }
+}
+
+void BaseGeometryInterface::unfreeze() {
+  if (!freezeLock) return;
+  for (DependentQuantity* q : quantities) {
+    q->freezeLock = nullptr;
+  }
+  freezeLock.reset();
+}
+
+bool BaseGeometryInterface::isFrozen() const { return freezeLock != nullptr; }
+
 // == Indices
 
 // Vertex indices
@@ -388,49 +388,55 @@ void CommonSubdivision::constructMeshData(std::vector<std::vector<size_t>>& face
                                           std::vector<CommonSubdivisionPoint*>& parents_out,
                                           std::vector<Face>& sourceFaceA_out, std::vector<Face>& sourceFaceB_out) {
 
-  // Compute element counts to reserve space
-  // size_t nV, nE, nF;
-  // std::tie(nV, nE, nF) = elementCounts();
-
-  // Id of subdivision points in the parents list
-  // TODO: if CommonSubdivisionPoint was hashable, we could just plug it
-  // into the hashmap
-  std::map<CommonSubdivisionPoint*, size_t> subdivisionPointsId;
-  // parents_out.reserve(nE + meshB.nVertices());
-
-  for (CommonSubdivisionPoint& p : subdivisionPoints) {
-    if (p.intersectionType != CSIntersectionType::EDGE_PARALLEL) {
-      subdivisionPointsId[&p] = parents_out.size();
-      parents_out.push_back(&p);
-    }
+  // Number the subdivision points, and store the ids of the crossings along each edge of mesh B (including the source
+  // and destination vertices as the first and last crossings) in one flat array. Every point which is not
+  // EDGE_PARALLEL is either a vertex of mesh B or lies in the middle of exactly one edge of mesh B, so we can number the
+  // vertices first and then the crossings edge-by-edge, without needing a lookup table keyed on the points.
+  VertexData<size_t> vertexPointId(meshB);
+  for (Vertex vB : meshB.vertices()) {
+    Halfedge he = vB.halfedge();
+    const std::vector<CommonSubdivisionPoint*>& points = pointsAlongB[he.edge()];
+    vertexPointId[vB] = parents_out.size();
+    parents_out.push_back(he == he.edge().halfedge() ? points.front() : points.back());
   }
 
-  // Store the vertex id of each crossing along this edge
-  // Considers its source vertex as the first crossing and its destination
-  // vertex as the final crossing
-  EdgeData<std::vector<size_t>> crossingVtxIds(meshB);
-
+  EdgeData<size_t> crossingStart(meshB);
+  EdgeData<size_t> crossingEnd(meshB);
+  std::vector<size_t> crossingVtxIds;
   for (Edge eB : meshB.edges()) {
-    // crossingVtxIds[eB].reserve(intersectionsB(eB) + 2);
+    const std::vector<CommonSubdivisionPoint*>& points = pointsAlongB[eB];
+    crossingStart[eB] = crossingVtxIds.size();
 
     // Source
-    crossingVtxIds[eB].push_back(subdivisionPointsId[pointsAlongB[eB][0]]);
+    crossingVtxIds.push_back(vertexPointId[eB.halfedge().tailVertex()]);
+    GC_SAFETY_ASSERT(parents_out[crossingVtxIds.back()] == points.front(), "edge should start at its source vertex");
 
     // Middle points
-    for (size_t iC = 1; iC + 1 < pointsAlongB[eB].size(); ++iC) {
-      if (pointsAlongB[eB][iC]->intersectionType != CSIntersectionType::EDGE_PARALLEL) {
-        crossingVtxIds[eB].push_back(subdivisionPointsId[pointsAlongB[eB][iC]]);
+    for (size_t iC = 1; iC + 1 < points.size(); ++iC) {
+      if (points[iC]->intersectionType != CSIntersectionType::EDGE_PARALLEL) {
+        crossingVtxIds.push_back(parents_out.size());
+        parents_out.push_back(points[iC]);
       }
-      if (pointsAlongB[eB][iC]->intersectionType == CSIntersectionType::VERTEX_VERTEX) {
+      if (points[iC]->intersectionType == CSIntersectionType::VERTEX_VERTEX) {
         throw std::runtime_error("encountered vertex intersection in the middle of an "
                                  "edge");
       }
     }
 
     // Dst
-    crossingVtxIds[eB].push_back(subdivisionPointsId[pointsAlongB[eB][pointsAlongB[eB].size() - 1]]);
+    crossingVtxIds.push_back(vertexPointId[eB.halfedge().tipVertex()]);
+    GC_SAFETY_ASSERT(parents_out[crossingVtxIds.back()] == points.back(), "edge should end at its destination vertex");
+    crossingEnd[eB] = crossingVtxIds.size();
   }
 
+  // The crossings along a halfedge of mesh B, ordered along the halfedge
+  auto halfedgeCrossings = [&](Halfedge he) {
+    std::vector<size_t> crossings(crossingVtxIds.begin() + crossingStart[he.edge()],
+                                  crossingVtxIds.begin() + crossingEnd[he.edge()]);
+    if (he != he.edge().halfedge()) std::reverse(std::begin(crossings), std::end(crossings));
+    return crossings;
+  };
+
 
   // faces.reserve(nF);
   // Loop over faces of mesh B and cut along edges of mesh A which cross
@@ -443,12 +449,9 @@ void CommonSubdivision::constructMeshData(std::vector<std::vector<size_t>>& face
     Halfedge ki = jk.next();
 
     // Get list of crossings along each halfedge
-    std::vector<size_t> pij = crossingVtxIds[ij.edge()];
-    if (ij != ij.edge().halfedge()) std::reverse(std::begin(pij), std::end(pij));
-    std::vector<size_t> pjk = crossingVtxIds[jk.edge()];
-    if (jk != jk.edge().halfedge()) std::reverse(std::begin(pjk), std::end(pjk));
-    std::vector<size_t> pki = crossingVtxIds[ki.edge()];
-    if (ki != ki.edge().halfedge()) std::reverse(std::begin(pki), std::end(pki));
+    std::vector<size_t> pij = halfedgeCrossings(ij);
+    std::vector<size_t> pjk = halfedgeCrossings(jk);
+    std::vector<size_t> pki = halfedgeCrossings(ki);
 
     std::vector<std::vector<size_t>> newFaces = sliceFace(pij, pjk, pki);
 
@@ -3,6 +3,8 @@
 
 #include "geometrycentral/surface/exact_geodesic_helpers.h"
 
+#include <cstddef>
+
 namespace geometrycentral {
 namespace surface {
 double Interval::signal(double x) const {
@@ -452,5 +454,42 @@ Vector2 transformToCoordinateSystem(IntrinsicGeometryInterface& geom, Vector2 v,
 
 } // namespace exactgeodesic
 
+namespace {
+// round up so that every node in a block stays suitably aligned
+size_t alignedNodeSize(size_t bytes) {
+  size_t const align = alignof(std::max_align_t);
+  return (bytes + align - 1) / align * align;
+}
+} // namespace
+
+void* NodePool::allocate(size_t bytes) {
+  if (m_node_size == 0) {
+    m_node_size = alignedNodeSize(bytes);
+  }
+  if (alignedNodeSize(bytes) != m_node_size) {
+    return ::operator new(bytes);
+  }
+
+  if (m_free.empty()) {
+    size_t const nodes_per_block = 1024;
+    m_blocks.emplace_back(new char[nodes_per_block * m_node_size]);
+    char* block = m_blocks.back().get();
+    for (size_t i = nodes_per_block; i > 0; i--) {
+      m_free.push_back(block + (i - 1) * m_node_size);
+    }
+  }
+  void* result = m_free.back();
+  m_free.pop_back();
+  return result;
+}
+
+void NodePool::deallocate(void* p, size_t bytes) {
+  if (alignedNodeSize(bytes) != m_node_size) {
+    ::operator delete(p);
+    return;
+  }
+  m_free.push_back(p);
+}
+
 } // namespace surface
 } // namespace geometrycentral
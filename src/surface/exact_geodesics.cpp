@@ -3,6 +3,11 @@
 
 #include "geometrycentral/surface/exact_geodesics.h"
 
+#include "geometrycentral/utilities/parallel.h"
+
+#include <exception>
+#include <memory>
+
 namespace geometrycentral {
 namespace surface {
 
@@ -12,6 +17,91 @@ VertexData<double> exactGeodesicDistance(SurfaceMesh& mesh, IntrinsicGeometryInt
   return mmp.getDistanceFunction();
 }
 
+namespace {
+
+// Run one propagation per source over a pool of threads. Each thread owns a solver (and thus its interval lists and
+// allocator), which is reused for all of the sources it handles. The geometry is frozen for the duration, so that the
+// solvers can share it.
+void parallelExactPropagations(SurfaceMesh& mesh, IntrinsicGeometryInterface& geom, size_t nSources, size_t nThreads,
+                               const std::function<void(GeodesicAlgorithmExact&, size_t)>& processSource) {
+  if (nSources == 0) return;
+  nThreads = std::min(resolveThreadCount(nThreads), nSources);
+
+  // Everything the solver reads from the geometry
+  bool wasFrozen = geom.isFrozen();
+  if (!wasFrozen) {
+    geom.requireEdgeLengths();
+    geom.requireCornerAngles();
+    geom.requireVertexGaussianCurvatures();
+    geom.freeze();
+  }
+
+  std::vector<std::unique_ptr<GeodesicAlgorithmExact>> solvers;
+  for (size_t iThread = 0; iThread < nThreads; iThread++) {
+    solvers.emplace_back(new GeodesicAlgorithmExact(mesh, geom));
+  }
+
+  std::exception_ptr error;
+  try {
+    parallelForWithThreadIndex(nSources, nThreads,
+                               [&](size_t iThread, size_t iSource) { processSource(*solvers[iThread], iSource); });
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  solvers.clear();
+  if (!wasFrozen) {
+    geom.unfreeze();
+    geom.unrequireEdgeLengths();
+    geom.unrequireCornerAngles();
+    geom.unrequireVertexGaussianCurvatures();
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+} // namespace
+
+DenseMatrix<double> exactGeodesicDistanceMatrix(SurfaceMesh& mesh, IntrinsicGeometryInterface& geom,
+                                                const std::vector<Vertex>& sources, const std::vector<Vertex>& targets,
+                                                size_t nThreads) {
+  DenseMatrix<double> distances(sources.size(), targets.size());
+
+  // Propagation can stop as soon as all of the targets are covered
+  std::vector<SurfacePoint> stopPoints;
+  for (Vertex v : targets) stopPoints.push_back(SurfacePoint(v));
+
+  parallelExactPropagations(mesh, geom, sources.size(), nThreads, [&](GeodesicAlgorithmExact& mmp, size_t iSource) {
+    mmp.propagate(SurfacePoint(sources[iSource]), GEODESIC_INF, stopPoints);
+    for (size_t iTarget = 0; iTarget < targets.size(); iTarget++) {
+      distances(iSource, iTarget) = mmp.getDistance(targets[iTarget]);
+    }
+  });
+
+  return distances;
+}
+
+DenseMatrix<double> exactGeodesicDistanceMatrix(SurfaceMesh& mesh, IntrinsicGeometryInterface& geom,
+                                                const std::vector<Vertex>& vertices, size_t nThreads) {
+  size_t N = vertices.size();
+  DenseMatrix<double> distances = DenseMatrix<double>::Zero(N, N);
+
+  // By symmetry, the propagation from vertex i only needs to reach vertices j > i
+  parallelExactPropagations(mesh, geom, N, nThreads, [&](GeodesicAlgorithmExact& mmp, size_t i) {
+    if (i + 1 == N) return;
+    std::vector<SurfacePoint> stopPoints;
+    for (size_t j = i + 1; j < N; j++) stopPoints.push_back(SurfacePoint(vertices[j]));
+
+    mmp.propagate(SurfacePoint(vertices[i]), GEODESIC_INF, stopPoints);
+    for (size_t j = i + 1; j < N; j++) {
+      double d = mmp.getDistance(vertices[j]);
+      distances(i, j) = d;
+      distances(j, i) = d;
+    }
+  });
+
+  return distances;
+}
+
 GeodesicAlgorithmExact::GeodesicAlgorithmExact(SurfaceMesh& mesh_, IntrinsicGeometryInterface& geom_)
     : m_max_propagation_distance(1e100), mesh(mesh_), geom(geom_), m_memory_allocator(mesh_.nEdges(), mesh_.nEdges()) {
 
@@ -25,6 +115,8 @@ GeodesicAlgorithmExact::GeodesicAlgorithmExact(SurfaceMesh& mesh_, IntrinsicGeom
   // Cache vertex manifold status so we don't have to repeatedly check vertices
   vertexIsManifold = mesh.getVertexManifoldStatus();
   vertexIsBoundary = mesh.getVertexBoundaryStatus();
+
+  m_vertex_reported = VertexData<char>(mesh, false);
 };
 
 // == Adapters for various input types
@@ -50,6 +142,50 @@ void GeodesicAlgorithmExact::propagate(const Vertex& source, double max_propagat
   propagate(source_surface_points, max_propagation_distance, stop_surface_points);
 }
 
+std::vector<std::pair<Vertex, double>> GeodesicAlgorithmExact::queryDistance(const SurfacePoint& source,
+                                                                              double maxDistance) {
+  std::vector<std::pair<Vertex, double>> result;
+  queryDistance(source, maxDistance, result);
+  return result;
+}
+
+void GeodesicAlgorithmExact::queryDistance(const SurfacePoint& source, double maxDistance,
+                                           std::vector<std::pair<Vertex, double>>& result) {
+  m_query_sources.resize(1);
+  m_query_sources[0] = source;
+  propagate(m_query_sources, maxDistance);
+
+  // Any vertex within range is an endpoint of an edge which received intervals, or is on the source element itself
+  result.clear();
+  auto report = [&](Vertex v) {
+    if (m_vertex_reported[v]) return;
+    m_vertex_reported[v] = true;
+    m_query_vertices.push_back(v);
+    double distance = getDistance(v);
+    if (distance <= maxDistance) result.emplace_back(v, distance);
+  };
+  switch (source.type) {
+  case SurfacePointType::Vertex:
+    report(source.vertex);
+    break;
+  case SurfacePointType::Edge:
+    report(source.edge.firstVertex());
+    report(source.edge.secondVertex());
+    break;
+  case SurfacePointType::Face:
+    for (Vertex v : source.face.adjacentVertices()) report(v);
+    break;
+  }
+  for (Edge e : m_touched_edges) {
+    report(e.firstVertex());
+    report(e.secondVertex());
+  }
+
+  // Reset the marks, touching only what was marked
+  for (Vertex v : m_query_vertices) m_vertex_reported[v] = false;
+  m_query_vertices.clear();
+}
+
 std::vector<SurfacePoint> GeodesicAlgorithmExact::traceBack(const Vertex& point) const {
   // Call general version
   double ignore;
@@ -661,6 +797,7 @@ void GeodesicAlgorithmExact::update_list_and_queue(list_pointer list,
   double const local_epsilon = SMALLEST_INTERVAL_RATIO * edge_length;
 
   if (list->first() == nullptr) {
+    m_touched_edges.push_back(edge);
     interval_pointer* p = &list->first();
     IntervalWithStop* first;
     IntervalWithStop* second;
@@ -1348,6 +1485,7 @@ void GeodesicAlgorithmExact::set_stop_conditions(const std::vector<SurfacePoint>
     return;
   }
 
+  m_stop_vertices.clear();
   m_stop_vertices.reserve(stop_points.size());
 
   // TODO: not tested
@@ -1374,9 +1512,10 @@ void GeodesicAlgorithmExact::set_stop_conditions(const std::vector<SurfacePoint>
 void GeodesicAlgorithmExact::clear() {
   m_memory_allocator.clear();
   m_queue.clear();
-  for (unsigned i = 0; i < m_edge_interval_lists.size(); ++i) {
-    m_edge_interval_lists[i].clear();
+  for (Edge e : m_touched_edges) {
+    m_edge_interval_lists[e].clear();
   }
+  m_touched_edges.clear();
   m_propagation_distance_stopped = GEODESIC_INF;
 };
 
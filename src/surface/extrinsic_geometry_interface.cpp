@@ -9,12 +9,12 @@ namespace surface {
 ExtrinsicGeometryInterface::ExtrinsicGeometryInterface(SurfaceMesh& mesh_) : 
   IntrinsicGeometryInterface(mesh_),
 
-  edgeDihedralAnglesQ                  (&edgeDihedralAngles,                   std::bind(&ExtrinsicGeometryInterface::computeEdgeDihedralAngles, this),                 quantities),
-  vertexMeanCurvaturesQ                (&vertexMeanCurvatures,                 std::bind(&ExtrinsicGeometryInterface::computeVertexMeanCurvatures, this),               quantities),
-  vertexMinPrincipalCurvaturesQ        (&vertexMinPrincipalCurvatures,         std::bind(&ExtrinsicGeometryInterface::computeVertexMinPrincipalCurvatures, this),       quantities),
-  vertexMaxPrincipalCurvaturesQ        (&vertexMaxPrincipalCurvatures,         std::bind(&ExtrinsicGeometryInterface::computeVertexMaxPrincipalCurvatures, this),       quantities),
-  vertexPrincipalCurvatureDirectionsQ  (&vertexPrincipalCurvatureDirections,   std::bind(&ExtrinsicGeometryInterface::computeVertexPrincipalCurvatureDirections, this), quantities),
-  facePrincipalCurvatureDirectionsQ    (&facePrincipalCurvatureDirections,     std::bind(&ExtrinsicGeometryInterface::computeFacePrincipalCurvatureDirections, this),   quantities)
+  edgeDihedralAnglesQ                  (&edgeDihedralAngles,                   std::bind(&ExtrinsicGeometryInterface::computeEdgeDihedralAngles, this),                 quantities, "edgeDihedralAngles"),
+  vertexMeanCurvaturesQ                (&vertexMeanCurvatures,                 std::bind(&ExtrinsicGeometryInterface::computeVertexMeanCurvatures, this),               quantities, "vertexMeanCurvatures"),
+  vertexMinPrincipalCurvaturesQ        (&vertexMinPrincipalCurvatures,         std::bind(&ExtrinsicGeometryInterface::computeVertexMinPrincipalCurvatures, this),       quantities, "vertexMinPrincipalCurvatures"),
+  vertexMaxPrincipalCurvaturesQ        (&vertexMaxPrincipalCurvatures,         std::bind(&ExtrinsicGeometryInterface::computeVertexMaxPrincipalCurvatures, this),       quantities, "vertexMaxPrincipalCurvatures"),
+  vertexPrincipalCurvatureDirectionsQ  (&vertexPrincipalCurvatureDirections,   std::bind(&ExtrinsicGeometryInterface::computeVertexPrincipalCurvatureDirections, this), quantities, "vertexPrincipalCurvatureDirections"),
+  facePrincipalCurvatureDirectionsQ    (&facePrincipalCurvatureDirections,     std::bind(&ExtrinsicGeometryInterface::computeFacePrincipalCurvatureDirections, this),   quantities, "facePrincipalCurvatureDirections")
   
   {
   }
@@ -1,7 +1,12 @@
 #include "geometrycentral/surface/fast_marching_method.h"
 
-#include <queue>
-#include <tuple>
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 
 
 namespace geometrycentral {
@@ -48,85 +53,231 @@ double eikonalDistanceSubroutine(double a, double b, double theta, double dA, do
   }
 }
 
-
 } // namespace
 
 
 VertexData<double> FMMDistance(IntrinsicGeometryInterface& geometry,
                                const std::vector<std::pair<Vertex, double>>& initialDistances) {
+  FastMarchingSolver solver(geometry);
+  solver.compute(initialDistances);
+  return solver.getDistanceFunction();
+}
 
-  typedef std::pair<double, Vertex> Entry;
+VertexData<double> FIMDistance(IntrinsicGeometryInterface& geometry,
+                               const std::vector<std::pair<Vertex, double>>& initialDistances, size_t nThreads) {
 
   SurfaceMesh& mesh = geometry.mesh;
   geometry.requireEdgeLengths();
   geometry.requireCornerAngles();
-  
+
   // TODO this could handle nonmanifold geometry with a few small tweaks
-  if(!mesh.isManifold()) {
+  if (!mesh.isManifold()) {
     throw std::runtime_error("handling of nonmanifold mesh not yet implemented");
   }
 
-  // Initialize
-  VertexData<double> distances(mesh, std::numeric_limits<double>::infinity());
-  VertexData<char> finalized(mesh, false);
+  // Flatten the neighborhood of each vertex, so the threads only read plain arrays
+  struct CornerEntry {
+    size_t vA, vB;     // other two vertices of the face
+    double lenA, lenB; // lengths of the edges to vA and vB
+    double angle;
+  };
+  VertexData<size_t> vInd = mesh.getVertexIndices();
+  size_t nV = mesh.nVertices();
+  std::vector<size_t> neighStart(nV + 1, 0), cornerStart(nV + 1, 0);
+  std::vector<size_t> neighbors;
+  std::vector<double> neighborLengths;
+  std::vector<CornerEntry> corners;
+  neighbors.reserve(2 * mesh.nEdges());
+  neighborLengths.reserve(2 * mesh.nEdges());
+  corners.reserve(mesh.nCorners());
+  for (Vertex v : mesh.vertices()) {
+    for (Halfedge he : v.outgoingHalfedges()) {
+      neighbors.push_back(vInd[he.tipVertex()]);
+      neighborLengths.push_back(geometry.edgeLengths[he.edge()]);
+      if (he.isInterior()) {
+        corners.push_back(CornerEntry{vInd[he.tipVertex()], vInd[he.next().tipVertex()], geometry.edgeLengths[he.edge()],
+                                      geometry.edgeLengths[he.next().next().edge()], geometry.cornerAngles[he.corner()]});
+      }
+    }
+    neighStart[vInd[v] + 1] = neighbors.size();
+    cornerStart[vInd[v] + 1] = corners.size();
+  }
 
-  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontierPQ;
+  // Each vertex is only ever written by the thread whose part of the band contains it, but is read by the threads
+  // updating its neighbors
+  std::unique_ptr<std::atomic<double>[]> distances(new std::atomic<double>[nV]);
+  for (size_t iV = 0; iV < nV; iV++) distances[iV].store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
   for (auto& x : initialDistances) {
-    frontierPQ.push(std::make_pair(x.second, x.first));
+    size_t iV = vInd[x.first];
+    distances[iV].store(std::min(distances[iV].load(std::memory_order_relaxed), x.second), std::memory_order_relaxed);
   }
-  size_t nFound = 0;
-  size_t nVert = mesh.nVertices();
+  auto dist = [&](size_t iV) -> double { return distances[iV].load(std::memory_order_relaxed); };
 
-  // Search
-  while (nFound < nVert && !frontierPQ.empty()) {
+  // The smallest value a vertex can get from its neighbors' current values
+  auto localSolve = [&](size_t iV) -> double {
+    double best = dist(iV);
+    for (size_t k = neighStart[iV]; k < neighStart[iV + 1]; k++) {
+      best = std::min(best, dist(neighbors[k]) + neighborLengths[k]);
+    }
+    for (size_t k = cornerStart[iV]; k < cornerStart[iV + 1]; k++) {
+      const CornerEntry& c = corners[k];
+      double dA = dist(c.vA);
+      double dB = dist(c.vB);
+      if (dA == std::numeric_limits<double>::infinity() || dB == std::numeric_limits<double>::infinity()) continue;
+      // same argument order as in fast marching, where the later of the two vertices is the one just finalized
+      if (dA <= dB) {
+        best = std::min(best, eikonalDistanceSubroutine(c.lenB, c.lenA, c.angle, dA, dB));
+      } else {
+        best = std::min(best, eikonalDistanceSubroutine(c.lenA, c.lenB, c.angle, dB, dA));
+      }
+    }
+    return best;
+  };
 
-    // Pop the nearest element
-    Entry currPair = frontierPQ.top();
-    frontierPQ.pop();
-    Vertex currV = currPair.second;
-    double currDist = currPair.first;
+  // Marks which vertices are already in the next active band
+  std::unique_ptr<std::atomic<uint32_t>[]> activeStamp(new std::atomic<uint32_t>[nV]);
+  for (size_t iV = 0; iV < nV; iV++) activeStamp[iV].store(0, std::memory_order_relaxed);
+
+  // The initial band is everything adjacent to a source
+  uint32_t iteration = 1;
+  std::vector<size_t> active;
+  for (auto& x : initialDistances) {
+    size_t iV = vInd[x.first];
+    for (size_t k = neighStart[iV]; k < neighStart[iV + 1]; k++) {
+      size_t iN = neighbors[k];
+      if (activeStamp[iN].exchange(iteration) != iteration) active.push_back(iN);
+    }
+  }
+
+  // Vertices are handed out in blocks, so each block updates its part of the band in place, and later vertices in the
+  // block already see the new values of earlier ones
+  const size_t grainSize = 256;
+  std::vector<char> changed;
+  std::vector<std::vector<size_t>> nextActive(resolveThreadCount(nThreads));
+  while (!active.empty()) {
+
+    changed.assign(active.size(), false);
+    parallelFor(
+        active.size(), nThreads,
+        [&](size_t k) {
+          size_t iV = active[k];
+          double newDist = localSolve(iV);
+          changed[k] = newDist < dist(iV);
+          if (changed[k]) distances[iV].store(newDist, std::memory_order_relaxed);
+        },
+        grainSize);
+
+    // Activate the neighbors of everything that changed. Any update through a vertex is at least as large as its value,
+    // so neighbors which are already closer cannot improve.
+    parallelForWithThreadIndex(
+        active.size(), nThreads,
+        [&](size_t iThread, size_t k) {
+          if (!changed[k]) return;
+          size_t iV = active[k];
+          for (size_t j = neighStart[iV]; j < neighStart[iV + 1]; j++) {
+            size_t iN = neighbors[j];
+            if (dist(iN) <= dist(iV)) continue;
+            if (activeStamp[iN].exchange(iteration + 1) != iteration + 1) nextActive[iThread].push_back(iN);
+          }
+        },
+        grainSize);
 
+    active.clear();
+    for (std::vector<size_t>& next : nextActive) {
+      active.insert(active.end(), next.begin(), next.end());
+      next.clear();
+    }
+    iteration++;
+  }
+
+  VertexData<double> result(mesh);
+  for (Vertex v : mesh.vertices()) {
+    result[v] = dist(vInd[v]);
+  }
+  return result;
+}
+
+
+FastMarchingSolver::FastMarchingSolver(IntrinsicGeometryInterface& geom_) : mesh(geom_.mesh), geom(geom_) {
+
+  // TODO this could handle nonmanifold geometry with a few small tweaks
+  if (!mesh.isManifold()) {
+    throw std::runtime_error("handling of nonmanifold mesh not yet implemented");
+  }
+
+  geom.requireEdgeLengths();
+  geom.requireCornerAngles();
+
+  vertexStamp = VertexData<uint32_t>(mesh, 0);
+  targetStamp = VertexData<uint32_t>(mesh, 0);
+  distances = VertexData<double>(mesh);
+  finalized = VertexData<char>(mesh);
+  heapIndex = VertexData<size_t>(mesh);
+}
+
+void FastMarchingSolver::compute(const std::vector<std::pair<Vertex, double>>& initialDistances, double maxDistance,
+                                 const std::vector<Vertex>& targets) {
+
+  // Start a new solve, invalidating all per-vertex state from the previous one
+  currentStamp++;
+  if (currentStamp == 0) { // wrapped around
+    vertexStamp.fill(0);
+    targetStamp.fill(0);
+    currentStamp = 1;
+  }
+  heap.clear();
+  finalizedVertices.clear();
 
-    // Accept it if not stale
-    if (finalized[currV]) {
-      continue;
+  for (auto& x : initialDistances) {
+    relax(x.first, x.second);
+  }
+  size_t nTargetsRemaining = 0;
+  for (Vertex v : targets) {
+    if (targetStamp[v] != currentStamp) {
+      targetStamp[v] = currentStamp;
+      nTargetsRemaining++;
     }
-    distances[currV] = currDist;
+  }
+
+  // Search
+  while (!heap.empty()) {
+
+    // Everything left is out of range
+    if (distances[heap.front()] > maxDistance) break;
+
+    // Pop the nearest element and accept it
+    Vertex currV = popMin();
+    double currDist = distances[currV];
     finalized[currV] = true;
-    nFound++;
+    finalizedVertices.push_back(currV);
 
+    if (targetStamp[currV] == currentStamp) {
+      nTargetsRemaining--;
+      if (nTargetsRemaining == 0) break;
+    }
 
     // Add any eligible neighbors
     for (Halfedge he : currV.incomingHalfedges()) {
       Vertex neighVert = he.vertex();
 
       // Add with length
-      if (!finalized[neighVert]) {
-        double newDist = currDist + geometry.edgeLengths[he.edge()];
-        if (newDist < distances[neighVert]) {
-          frontierPQ.push(std::make_pair(currDist + geometry.edgeLengths[he.edge()], neighVert));
-          distances[neighVert] = newDist;
-        }
+      if (!isFinalized(neighVert)) {
+        relax(neighVert, currDist + geom.edgeLengths[he.edge()]);
         continue;
       }
 
       // Check the third point of the "left" triangle straddling this edge
       if (he.isInterior()) {
         Vertex newVert = he.next().next().vertex();
-        if (!finalized[newVert]) {
+        if (!isFinalized(newVert)) {
 
           // Compute the distance
-          double lenB = geometry.edgeLengths[he.next().next().edge()];
+          double lenB = geom.edgeLengths[he.next().next().edge()];
           double distB = currDist;
-          double lenA = geometry.edgeLengths[he.next().edge()];
+          double lenA = geom.edgeLengths[he.next().edge()];
           double distA = distances[neighVert];
-          double theta = geometry.cornerAngles[he.next().next().corner()];
-          double newDist = eikonalDistanceSubroutine(lenA, lenB, theta, distA, distB);
-
-          if (newDist < distances[newVert]) {
-            frontierPQ.push(std::make_pair(newDist, newVert));
-            distances[newVert] = newDist;
-          }
+          double theta = geom.cornerAngles[he.next().next().corner()];
+          relax(newVert, eikonalDistanceSubroutine(lenA, lenB, theta, distA, distB));
         }
       }
 
@@ -134,26 +285,100 @@ VertexData<double> FMMDistance(IntrinsicGeometryInterface& geometry,
       Halfedge heT = he.twin();
       if (heT.isInterior()) {
         Vertex newVert = heT.next().next().vertex();
-        if (!finalized[newVert]) {
+        if (!isFinalized(newVert)) {
 
           // Compute the distance
-          double lenB = geometry.edgeLengths[heT.next().edge()];
+          double lenB = geom.edgeLengths[heT.next().edge()];
           double distB = currDist;
-          double lenA = geometry.edgeLengths[heT.next().next().edge()];
+          double lenA = geom.edgeLengths[heT.next().next().edge()];
           double distA = distances[neighVert];
-          double theta = geometry.cornerAngles[heT.next().next().corner()];
-          double newDist = eikonalDistanceSubroutine(lenA, lenB, theta, distA, distB);
-
-          if (newDist < distances[newVert]) {
-            frontierPQ.push(std::make_pair(newDist, newVert));
-            distances[newVert] = newDist;
-          }
+          double theta = geom.cornerAngles[heT.next().next().corner()];
+          relax(newVert, eikonalDistanceSubroutine(lenA, lenB, theta, distA, distB));
         }
       }
     }
   }
+}
+
+double FastMarchingSolver::getDistance(Vertex v) const {
+  return isFinalized(v) ? distances[v] : std::numeric_limits<double>::infinity();
+}
+
+bool FastMarchingSolver::isFinalized(Vertex v) const { return vertexStamp[v] == currentStamp && finalized[v]; }
+
+const std::vector<Vertex>& FastMarchingSolver::getFinalizedVertices() const { return finalizedVertices; }
 
-  return distances;
+VertexData<double> FastMarchingSolver::getDistanceFunction() const {
+  VertexData<double> result(mesh, std::numeric_limits<double>::infinity());
+  for (Vertex v : finalizedVertices) {
+    result[v] = distances[v];
+  }
+  return result;
+}
+
+void FastMarchingSolver::touch(Vertex v) {
+  if (vertexStamp[v] != currentStamp) {
+    vertexStamp[v] = currentStamp;
+    distances[v] = std::numeric_limits<double>::infinity();
+    finalized[v] = false;
+    heapIndex[v] = INVALID_IND;
+  }
+}
+
+void FastMarchingSolver::relax(Vertex v, double newDist) {
+  touch(v);
+  if (finalized[v] || !(newDist < distances[v])) return;
+
+  distances[v] = newDist;
+  if (heapIndex[v] == INVALID_IND) {
+    heapIndex[v] = heap.size();
+    heap.push_back(v);
+  }
+  siftUp(heapIndex[v]);
+}
+
+Vertex FastMarchingSolver::popMin() {
+  Vertex top = heap.front();
+  heapIndex[top] = INVALID_IND;
+  Vertex last = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    heap[0] = last;
+    heapIndex[last] = 0;
+    siftDown(0);
+  }
+  return top;
+}
+
+void FastMarchingSolver::siftUp(size_t i) {
+  Vertex v = heap[i];
+  double d = distances[v];
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!(d < distances[heap[parent]])) break;
+    heap[i] = heap[parent];
+    heapIndex[heap[i]] = i;
+    i = parent;
+  }
+  heap[i] = v;
+  heapIndex[v] = i;
+}
+
+void FastMarchingSolver::siftDown(size_t i) {
+  Vertex v = heap[i];
+  double d = distances[v];
+  size_t n = heap.size();
+  while (true) {
+    size_t child = 2 * i + 1;
+    if (child >= n) break;
+    if (child + 1 < n && distances[heap[child + 1]] < distances[heap[child]]) child++;
+    if (!(distances[heap[child]] < d)) break;
+    heap[i] = heap[child];
+    heapIndex[heap[i]] = i;
+    i = child;
+  }
+  heap[i] = v;
+  heapIndex[v] = i;
 }
 
 
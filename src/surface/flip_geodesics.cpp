@@ -1,9 +1,12 @@
 #include "geometrycentral/surface/flip_geodesics.h"
 
 #include "geometrycentral/surface/mesh_graph_algorithms.h"
+#include "geometrycentral/utilities/parallel.h"
 
 #include "happly.h"
 
+#include <exception>
+
 namespace geometrycentral {
 namespace surface {
 
@@ -288,12 +291,13 @@ std::unique_ptr<FlipEdgeNetwork> FlipEdgeNetwork::constructFromPiecewiseDijkstra
 
   std::vector<Halfedge> halfedges;
   VertexData<bool> extraMark(geom.mesh, false);
+  GraphDistanceEngine dijkstra(geom);
 
   size_t end = closed ? points.size() : points.size() - 1;
   for (size_t i = 0; i < end; i++) {
     Vertex vA = points[i];
     Vertex vB = points[(i + 1) % points.size()];
-    std::vector<Halfedge> dijkstraPath = shortestEdgePath(geom, vA, vB);
+    std::vector<Halfedge> dijkstraPath = dijkstra.shortestEdgePath(vA, vB);
 
     if (markInterior) {
       extraMark[vA] = true;
@@ -1829,5 +1833,57 @@ bool FlipPathSegment::operator<=(const FlipPathSegment& other) const {
   return std::make_tuple(path, id) <= std::make_tuple(other.path, other.id);
 }
 
+std::vector<std::vector<SurfacePoint>> computeGeodesicPaths(ManifoldSurfaceMesh& mesh, IntrinsicGeometryInterface& geom,
+                                                            const std::vector<std::pair<Vertex, Vertex>>& endpoints,
+                                                            size_t nThreads) {
+  std::vector<std::vector<SurfacePoint>> result(endpoints.size());
+  if (endpoints.empty()) return result;
+  nThreads = std::min(resolveThreadCount(nThreads), endpoints.size());
+
+  // Per-thread state. This is constructed before the geometry is frozen and destroyed after it is unfrozen, so that the
+  // require()/unrequire() calls it makes on the geometry stay balanced.
+  std::vector<std::unique_ptr<FlipEdgeNetwork>> networks;
+  std::vector<std::unique_ptr<GraphDistanceEngine>> dijkstras;
+  for (size_t iThread = 0; iThread < nThreads; iThread++) {
+    networks.emplace_back(new FlipEdgeNetwork(mesh, geom, {}));
+    networks.back()->supportRewinding = true;
+    dijkstras.emplace_back(new GraphDistanceEngine(geom));
+  }
+
+  // The threads share the input geometry, which the triangulations read when tracing paths
+  bool wasFrozen = geom.isFrozen();
+  if (!wasFrozen) geom.freeze();
+
+  std::exception_ptr error;
+  try {
+    parallelForWithThreadIndex(endpoints.size(), nThreads, [&](size_t iThread, size_t iQuery) {
+      FlipEdgeNetwork& network = *networks[iThread];
+      Vertex vA = endpoints[iQuery].first;
+      Vertex vB = endpoints[iQuery].second;
+      std::vector<Halfedge> dijkstraPath = dijkstras[iThread]->shortestEdgePath(vA, vB);
+      if (dijkstraPath.empty()) return; // not connected, or same vertex
+
+      network.reinitializePath({dijkstraPath});
+      network.iterativeShorten();
+      result[iQuery] = network.getPathPolyline().front();
+
+      // Rewinding undoes the flips but leaves the endpoints marked, which would block later paths from straightening
+      // through them
+      network.rewind();
+      network.isMarkedVertex[network.mesh.vertex(vA.getIndex())] = false;
+      network.isMarkedVertex[network.mesh.vertex(vB.getIndex())] = false;
+    });
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  if (!wasFrozen) geom.unfreeze();
+  networks.clear();
+  dijkstras.clear();
+
+  if (error) std::rethrow_exception(error);
+  return result;
+}
+
 } // namespace surface
 } // namespace geometrycentral
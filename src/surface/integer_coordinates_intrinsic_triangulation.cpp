@@ -1,5 +1,7 @@
 #include "geometrycentral/surface/integer_coordinates_intrinsic_triangulation.h"
 
+#include "geometrycentral/utilities/profiler.h"
+
 #include <ctime>
 
 namespace geometrycentral {
@@ -184,7 +186,22 @@ SurfacePoint IntegerCoordinatesIntrinsicTriangulation::equivalentPointOnInput(co
 
 bool IntegerCoordinatesIntrinsicTriangulation::checkEdgeOriginal(Edge e) const { return normalCoordinates[e] == -1; }
 
+void IntegerCoordinatesIntrinsicTriangulation::saveCheckpointData() {
+  IntrinsicTriangulation::saveCheckpointData();
+  checkpointEdgeCoords = normalCoordinates.edgeCoords.raw();
+  checkpointRoundabouts = normalCoordinates.roundabouts.raw();
+  checkpointRoundaboutDegrees = normalCoordinates.roundaboutDegrees.raw();
+}
+
+void IntegerCoordinatesIntrinsicTriangulation::restoreCheckpointData() {
+  IntrinsicTriangulation::restoreCheckpointData();
+  normalCoordinates.edgeCoords.raw().head(checkpointEdgeCoords.size()) = checkpointEdgeCoords;
+  normalCoordinates.roundabouts.raw().head(checkpointRoundabouts.size()) = checkpointRoundabouts;
+  normalCoordinates.roundaboutDegrees.raw().head(checkpointRoundaboutDegrees.size()) = checkpointRoundaboutDegrees;
+}
+
 void IntegerCoordinatesIntrinsicTriangulation::constructCommonSubdivision() {
+  GC_PROFILE_SCOPE("IntegerCoordinatesIntrinsicTriangulation::constructCommonSubdivision");
 
   intrinsicMesh->compress();
 
@@ -234,13 +251,32 @@ void IntegerCoordinatesIntrinsicTriangulation::constructCommonSubdivision() {
     cs.pointsAlongB[eB][n + 1] = bVtx[dst(eB)];
   }
 
-  // Trace the edges of mesh A (inputMesh) over mesh B (intrinsicMesh)
+  // Trace the edges of mesh A (inputMesh) over mesh B (intrinsicMesh), and lay out the geodesic along each component
+  // which is not a shared edge. The edges are independent, so do this in parallel before assembling the results below.
+  std::vector<Edge> inputEdges;
+  inputEdges.reserve(inputMesh.nEdges());
   for (Edge eA : inputMesh.edges()) {
-    NormalCoordinatesCompoundCurve compoundPath = traceInputEdge(eA);
+    inputEdges.push_back(eA);
+  }
+  std::vector<NormalCoordinatesCompoundCurve> compoundPaths(inputEdges.size());
+  std::vector<std::vector<std::vector<std::pair<SurfacePoint, double>>>> geodesicPaths(inputEdges.size());
+  parallelForFrozen(inputEdges.size(), traceThreads, [&](size_t iE) {
+    compoundPaths[iE] = traceInputEdge(inputEdges[iE]);
+    for (const NormalCoordinatesCurve& curve : compoundPaths[iE].components) {
+      geodesicPaths[iE].emplace_back();
+      if (curve.crossings.size() == 1 && std::get<0>(curve.crossings[0]) < 0) continue; // shared edge
+      geodesicPaths[iE].back() = generateFullSingleGeodesicGeometry(*intrinsicMesh, *this, curve);
+    }
+  });
+
+  for (size_t iE = 0; iE < inputEdges.size(); iE++) {
+    Edge eA = inputEdges[iE];
+    const NormalCoordinatesCompoundCurve& compoundPath = compoundPaths[iE];
 
     for (size_t iC = 0; iC < compoundPath.components.size(); iC++) {
 
       const NormalCoordinatesCurve& curve = compoundPath.components[iC];
+      const std::vector<std::pair<SurfacePoint, double>>& geodesicPath = geodesicPaths[iE][iC];
       bool first = iC == 0;
 
       auto& path = curve.crossings;
@@ -276,9 +312,6 @@ void IntegerCoordinatesIntrinsicTriangulation::constructCommonSubdivision() {
         // if (geodesic) { // Lay out geodesic
         // std::cout << path << std::endl;
 
-        std::vector<std::pair<SurfacePoint, double>> geodesicPath =
-            generateFullSingleGeodesicGeometry(*intrinsicMesh, *this, curve);
-
         if (first) cs.pointsAlongA[eA].push_back(aVtx[src(eA)]);
 
         Halfedge hB;
@@ -1157,6 +1190,7 @@ std::pair<SurfacePoint, size_t> IntegerCoordinatesIntrinsicTriangulation::comput
 }
 
 Vertex IntegerCoordinatesIntrinsicTriangulation::insertVertex(SurfacePoint pt) {
+  GC_PROFILE_SCOPE("IntegerCoordinatesIntrinsicTriangulation::insertVertex");
   Vertex newVertex;
   switch (pt.type) {
   case SurfacePointType::Vertex:
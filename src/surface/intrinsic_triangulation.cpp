@@ -4,6 +4,8 @@
 #include "geometrycentral/surface/mesh_graph_algorithms.h"
 #include "geometrycentral/surface/trace_geodesic.h"
 #include "geometrycentral/utilities/elementary_geometry.h"
+#include "geometrycentral/utilities/parallel.h"
+#include "geometrycentral/utilities/profiler.h"
 
 #include <iomanip>
 #include <queue>
@@ -68,13 +70,19 @@ void IntrinsicTriangulation::clearMarkedEdges() { markedEdges = EdgeData<bool>()
 EdgeData<std::vector<SurfacePoint>> IntrinsicTriangulation::traceAllIntrinsicEdgesAlongInput() {
 
   // Naively call the one-off function for each edge. Subclasses can override with better strategies.
+  // The traces are independent, so run them in parallel.
 
   EdgeData<std::vector<SurfacePoint>> tracedEdges(mesh);
 
+  std::vector<Edge> edges;
+  edges.reserve(mesh.nEdges());
   for (Edge e : mesh.edges()) {
-    Halfedge he = e.halfedge();
-    tracedEdges[e] = traceIntrinsicHalfedgeAlongInput(he);
+    edges.push_back(e);
   }
+  parallelForFrozen(edges.size(), traceThreads, [&](size_t i) {
+    Halfedge he = edges[i].halfedge();
+    tracedEdges[he.edge()] = traceIntrinsicHalfedgeAlongInput(he);
+  });
 
   return tracedEdges;
 }
@@ -82,13 +90,19 @@ EdgeData<std::vector<SurfacePoint>> IntrinsicTriangulation::traceAllIntrinsicEdg
 EdgeData<std::vector<SurfacePoint>> IntrinsicTriangulation::traceAllInputEdgesAlongIntrinsic() {
 
   // Naively call the one-off function for each edge. Subclasses can override with better strategies.
+  // The traces are independent, so run them in parallel.
 
   EdgeData<std::vector<SurfacePoint>> tracedEdges(inputMesh);
 
+  std::vector<Edge> edges;
+  edges.reserve(inputMesh.nEdges());
   for (Edge e : inputMesh.edges()) {
-    Halfedge he = e.halfedge();
-    tracedEdges[e] = traceInputHalfedgeAlongIntrinsic(he);
+    edges.push_back(e);
   }
+  parallelForFrozen(edges.size(), traceThreads, [&](size_t i) {
+    Halfedge he = edges[i].halfedge();
+    tracedEdges[he.edge()] = traceInputHalfedgeAlongIntrinsic(he);
+  });
 
   return tracedEdges;
 }
@@ -246,6 +260,11 @@ double IntrinsicTriangulation::minAngleDegreesAtValidFaces(double minAngleSum) c
 
 
 Vertex IntrinsicTriangulation::insertCircumcenter(Face f) {
+  GC_PROFILE_SCOPE("IntrinsicTriangulation::insertCircumcenter");
+  return insertVertex(locateCircumcenter(f));
+}
+
+SurfacePoint IntrinsicTriangulation::locateCircumcenter(Face f) {
 
   // === Circumcenter in barycentric coordinates
 
@@ -281,8 +300,7 @@ Vertex IntrinsicTriangulation::insertCircumcenter(Face f) {
     newPositionOnIntrinsic.tEdge = 0.5;
   }
 
-  // === Phase 3: Add the new vertex
-  return insertVertex(newPositionOnIntrinsic);
+  return newPositionOnIntrinsic;
 }
 
 Vertex IntrinsicTriangulation::insertBarycenter(Face f) {
@@ -327,7 +345,19 @@ std::vector<double> IntrinsicTriangulation::recoverTraceTValues(const std::vecto
 //
 
 
-void IntrinsicTriangulation::flipToDelaunay() {
+void IntrinsicTriangulation::flipToDelaunay(size_t nThreads) {
+  GC_PROFILE_SCOPE("IntrinsicTriangulation::flipToDelaunay");
+
+  if (nThreads != 1) {
+    std::vector<Edge> allEdges;
+    allEdges.reserve(mesh.nEdges());
+    for (Edge e : mesh.edges()) {
+      allEdges.push_back(e);
+    }
+    flipToDelaunayInRounds(allEdges, nThreads);
+    refreshQuantities();
+    return;
+  }
 
   std::deque<Edge> edgesToCheck;
   EdgeData<bool> inQueue(mesh, true);
@@ -367,8 +397,91 @@ void IntrinsicTriangulation::flipToDelaunay() {
   refreshQuantities();
 }
 
+void IntrinsicTriangulation::flipToDelaunayInRounds(std::vector<Edge> edgesToCheck, size_t nThreads) {
+
+  // Any flip may modify the mesh and data on the four vertices of its diamond (and the elements between them), so flips
+  // whose diamonds share no vertices can run concurrently.
+  auto diamondVertices = [](Edge e) {
+    Halfedge he = e.halfedge();
+    return std::array<Vertex, 4>{he.vertex(), he.next().vertex(), he.next().next().vertex(),
+                                 he.twin().next().next().vertex()};
+  };
+
+  EdgeData<char> inQueue(mesh, false);
+  for (Edge e : edgesToCheck) {
+    inQueue[e] = true;
+  }
+
+  triangulationChanged(); // (only the first flip would need to clear it, but they all call this)
+
+  VertexData<char> claimed(mesh, false);
+  std::vector<char> needsFlip, wasFlipped;
+  std::vector<Edge> roundEdges, nextEdgesToCheck;
+  while (!edgesToCheck.empty()) {
+
+    // Test the queued edges
+    needsFlip.assign(edgesToCheck.size(), false);
+    parallelFor(
+        edgesToCheck.size(), nThreads, [&](size_t i) { needsFlip[i] = !isDelaunay(edgesToCheck[i]); }, 1024);
+
+    // Greedily choose independent edges in queue order; the others wait for a later round
+    roundEdges.clear();
+    nextEdgesToCheck.clear();
+    for (size_t i = 0; i < edgesToCheck.size(); i++) {
+      Edge e = edgesToCheck[i];
+      if (!needsFlip[i]) {
+        inQueue[e] = false;
+        continue;
+      }
+      std::array<Vertex, 4> verts = diamondVertices(e);
+      if (claimed[verts[0]] || claimed[verts[1]] || claimed[verts[2]] || claimed[verts[3]]) {
+        nextEdgesToCheck.push_back(e);
+        continue;
+      }
+      for (Vertex v : verts) claimed[v] = true;
+      roundEdges.push_back(e);
+    }
+
+    // Flip them all
+    wasFlipped.assign(roundEdges.size(), false);
+    flipCallbacksDeferred = true;
+    try {
+      parallelFor(
+          roundEdges.size(), nThreads, [&](size_t i) { wasFlipped[i] = flipEdgeIfNotDelaunay(roundEdges[i]); }, 64);
+    } catch (...) {
+      flipCallbacksDeferred = false;
+      throw;
+    }
+    flipCallbacksDeferred = false;
+
+    // Handle the aftermath of the flips, in order
+    for (size_t i = 0; i < roundEdges.size(); i++) {
+      Edge e = roundEdges[i];
+      inQueue[e] = false;
+      for (Vertex v : diamondVertices(e)) claimed[v] = false;
+      if (!wasFlipped[i]) continue;
+
+      invokeEdgeFlipCallbacks(e);
+
+      // Add neighbors to queue, as they may need flipping now
+      Halfedge he = e.halfedge();
+      Halfedge heN = he.next();
+      Halfedge heT = he.twin();
+      Halfedge heTN = heT.next();
+      for (Edge nE : {heN.edge(), heN.next().edge(), heTN.edge(), heTN.next().edge()}) {
+        if (!inQueue[nE]) {
+          nextEdgesToCheck.push_back(nE);
+          inQueue[nE] = true;
+        }
+      }
+    }
+
+    std::swap(edgesToCheck, nextEdgesToCheck);
+  }
+}
+
 void IntrinsicTriangulation::delaunayRefine(double angleThreshDegrees, double circumradiusThresh,
-                                            size_t maxInsertions) {
+                                            size_t maxInsertions, size_t nThreads) {
 
   // Relationship between angles and circumradius-to-edge
   double angleThreshRad = angleThreshDegrees * M_PI / 180.;
@@ -449,11 +562,13 @@ void IntrinsicTriangulation::delaunayRefine(double angleThreshDegrees, double ci
   };
 
   // Call the general version
-  delaunayRefine(needsCircumcenterRefinement, maxInsertions);
+  delaunayRefine(needsCircumcenterRefinement, maxInsertions, nThreads);
 }
 
 
-void IntrinsicTriangulation::delaunayRefine(const std::function<bool(Face)>& shouldRefine, size_t maxInsertions) {
+void IntrinsicTriangulation::delaunayRefine(const std::function<bool(Face)>& shouldRefine, size_t maxInsertions,
+                                            size_t nThreads) {
+  GC_PROFILE_SCOPE("IntrinsicTriangulation::delaunayRefine");
 
   // Manages a check at the bottom to avoid infinite-looping when numerical baddness happens
   int recheckCount = 0;
@@ -540,7 +655,24 @@ void IntrinsicTriangulation::delaunayRefine(const std::function<bool(Face)>& sho
     }
   };
 
+  // Same as above, but flipping independent edges concurrently. Flip callbacks (including ours) get invoked after each
+  // round, and may queue up more edges to check.
+  auto flipToDelaunayFromQueueInRounds = [&]() {
+    std::vector<Edge> edgesToCheck;
+    while (!delaunayCheckQueue.empty()) {
+      edgesToCheck.clear();
+      for (Edge e : delaunayCheckQueue) {
+        if (e.isDead()) continue;
+        inDelaunayQueue[e] = false;
+        edgesToCheck.push_back(e);
+      }
+      delaunayCheckQueue.clear();
+      flipToDelaunayInRounds(edgesToCheck, nThreads);
+    }
+  };
+
   // Register a callback, which will be invoked to delete previously-inserted vertices whenever refinment splits an edge
+  GraphDistanceEngine nearbySearch(*this);
   auto deleteNearbyVertices = [&](Edge e, Halfedge he1, Halfedge he2) {
     // radius of the diametral ball
     double ballRad = std::max(edgeLengths[he1.edge()], edgeLengths[he2.edge()]);
@@ -557,11 +689,10 @@ void IntrinsicTriangulation::delaunayRefine(const std::function<bool(Face)>& sho
     // Intrinsic Triangulations Course, the underlying reference is Ge Xia 2013. "The Stretch Factor of the Delaunay
     // Triangulation Is Less than 1.998"). So instead, we delete all previously-inserted vertices within 2x the Dikstra
     // radius instead. This may delete some extra verts, but that does not effect convergence.
-    std::unordered_map<Vertex, double> nearbyVerts = vertexDijkstraDistanceWithinRadius(*this, newV, 2. * ballRad);
+    const std::vector<Vertex>& nearbyVerts = nearbySearch.verticesWithinRadius(newV, 2. * ballRad);
 
     // remove inserted vertices
-    for (auto p : nearbyVerts) {
-      Vertex v = p.first;
+    for (Vertex v : nearbyVerts) {
       if (v != newV && !isOnFixedEdge(v) && vertexLocations[v].type != SurfacePointType::Vertex) {
         Face fReplace = removeInsertedVertex(v);
 
@@ -588,19 +719,167 @@ void IntrinsicTriangulation::delaunayRefine(const std::function<bool(Face)>& sho
   // right after the split before we mess with the mesh.
   auto splitCallbackHandle = edgeSplitCallbackList.insert(std::end(edgeSplitCallbackList), deleteNearbyVertices);
 
+  // Mark everything in the 1-ring of a new vertex as possibly non-Delaunay and possibly violating the circumradius
+  // constraint
+  auto checkNeighborsAfterInsertion = [&](Vertex newVert) {
+    for (Face nF : newVert.adjacentFaces()) {
+
+      // Check circumradius constraint
+      if (shouldRefine(nF)) {
+        circumradiusCheckQueue.push(std::make_tuple(areaWeight(nF), faceArea(nF), nF));
+      }
+
+      // Check delaunay constraint
+      for (Edge nE : nF.adjacentEdges()) {
+        if (!inDelaunayQueue[nE]) {
+          delaunayCheckQueue.push_back(nE);
+          inDelaunayQueue[nE] = true;
+        }
+      }
+    }
+  };
+
+  // Insert a batch of circumcenters (used when nThreads != 1).
+  // The highest-priority faces which currently need refinement are gathered, and their circumcenters are located in
+  // parallel. Then, in order of priority, we accept those whose surroundings (the vertices of the faces containing the
+  // point, and of the faces across their edges) share no vertices with a previously accepted point; the rest go back in
+  // the queue.
+  // The accepted points lie in distinct faces and edges, so inserting a point in a face does not move the others. All
+  // points in faces are inserted first, since splitting an edge might flip or delete nearby elements (see above). Fixed
+  // edges are never flipped, so any number of them may be split after that, but at most one other edge is split (and
+  // before the fixed ones).
+  FaceData<char> inBatch(mesh, false);
+  VertexData<char> claimed(mesh, false);
+  std::vector<AreaFace> batchFaces;
+  std::vector<SurfacePoint> batchPoints;
+  std::vector<SurfacePoint> acceptedPoints;
+  std::vector<SurfacePoint> acceptedFixedEdgePoints;
+  std::vector<Vertex> claimedVerts;
+  // Candidates which are not accepted will be located again in a later round, so limit the batch size to a multiple of
+  // the number accepted in the previous round
+  const size_t minBatchSize = 64 * resolveThreadCount(nThreads);
+  size_t batchSize = minBatchSize;
+  auto insertCircumcenterBatch = [&]() {
+    // Gather the faces
+    batchFaces.clear();
+    while (!circumradiusCheckQueue.empty() && batchFaces.size() < batchSize) {
+      AreaFace entry = circumradiusCheckQueue.top();
+      circumradiusCheckQueue.pop();
+      Face f = std::get<2>(entry);
+      if (f.isDead() || inBatch[f]) continue;
+
+      // Skip stale entries, as in the one-at-a-time loop below
+      if (std::get<1>(entry) == faceArea(f) && shouldRefine(f)) {
+        inBatch[f] = true;
+        batchFaces.push_back(entry);
+      }
+    }
+
+    // Locate the circumcenters
+    batchPoints.resize(batchFaces.size());
+    parallelForFrozen(batchFaces.size(), nThreads,
+                      [&](size_t i) { batchPoints[i] = locateCircumcenter(std::get<2>(batchFaces[i])); });
+
+    // Choose the points to insert
+    size_t maxAccepted = maxInsertions == INVALID_IND ? INVALID_IND : maxInsertions - nInsertions;
+    size_t nAccepted = 0;
+    acceptedPoints.clear();
+    acceptedFixedEdgePoints.clear();
+    SurfacePoint otherEdgePoint;
+    for (size_t i = 0; i < batchFaces.size(); i++) {
+      Face f = std::get<2>(batchFaces[i]);
+      inBatch[f] = false;
+      const SurfacePoint& p = batchPoints[i];
+
+      bool onFixedEdge = p.type == SurfacePointType::Edge && isFixed(p.edge);
+      bool onOtherEdge = p.type == SurfacePointType::Edge && !onFixedEdge;
+      bool accept = nAccepted < maxAccepted && !(onOtherEdge && otherEdgePoint.type == SurfacePointType::Edge);
+
+      // Claim the surroundings, marking vertices claimed by this point with 2 until it is accepted
+      size_t nClaimedBefore = claimedVerts.size();
+      std::array<Face, 2> regionFaces{Face(), Face()};
+      if (p.type == SurfacePointType::Face) {
+        regionFaces[0] = p.face;
+      } else if (p.type == SurfacePointType::Edge) {
+        regionFaces[0] = p.edge.halfedge().face();
+        if (p.edge.halfedge().twin().isInterior()) regionFaces[1] = p.edge.halfedge().twin().face();
+      }
+      for (Face rF : regionFaces) {
+        if (!accept || rF == Face()) continue;
+        for (Halfedge he : rF.adjacentHalfedges()) {
+          std::array<Vertex, 2> verts{he.vertex(), he.twin().isInterior() ? he.twin().next().next().vertex() : Vertex()};
+          for (Vertex v : verts) {
+            if (v == Vertex() || claimed[v] == 2) continue;
+            if (claimed[v]) {
+              accept = false;
+              break;
+            }
+            claimed[v] = 2;
+            claimedVerts.push_back(v);
+          }
+          if (!accept) break;
+        }
+      }
+
+      if (!accept) {
+        // Leave it for a later round, and release anything it claimed
+        for (size_t j = nClaimedBefore; j < claimedVerts.size(); j++) claimed[claimedVerts[j]] = false;
+        claimedVerts.resize(nClaimedBefore);
+        circumradiusCheckQueue.push(batchFaces[i]);
+        continue;
+      }
+      for (size_t j = nClaimedBefore; j < claimedVerts.size(); j++) claimed[claimedVerts[j]] = true;
+
+      nAccepted++;
+      if (onFixedEdge) {
+        acceptedFixedEdgePoints.push_back(p);
+      } else if (onOtherEdge) {
+        otherEdgePoint = p;
+      } else {
+        acceptedPoints.push_back(p);
+      }
+    }
+    for (Vertex v : claimedVerts) claimed[v] = false;
+    claimedVerts.clear();
+    batchSize = std::max(minBatchSize, 4 * nAccepted);
+
+    if (otherEdgePoint.type == SurfacePointType::Edge) acceptedPoints.push_back(otherEdgePoint);
+    acceptedPoints.insert(acceptedPoints.end(), acceptedFixedEdgePoints.begin(), acceptedFixedEdgePoints.end());
+
+    // Insert them
+    for (const SurfacePoint& p : acceptedPoints) {
+      Vertex newVert = insertVertex(p);
+      if (newVert == Vertex()) {
+        // vertex insertion failed (probably due to a tracing error)
+        continue;
+      }
+      nInsertions++;
+      checkNeighborsAfterInsertion(newVert);
+    }
+  };
+
   // === Outer iteration: flip and insert until we have a mesh that satisfies both angle and circumradius goals
   do {
 
     // == First, flip to delaunay
-    flipToDelaunayFromQueue();
+    if (nThreads == 1) {
+      flipToDelaunayFromQueue();
+    } else {
+      flipToDelaunayFromQueueInRounds();
+    }
 
-    // == Second, insert one circumcenter
+    // == Second, insert one circumcenter (or a batch of them)
 
     // If we've already inserted the max number of points, call it a day
     if (maxInsertions != INVALID_IND && nInsertions == maxInsertions) {
       break;
     }
 
+    if (nThreads != 1 && !circumradiusCheckQueue.empty()) {
+      insertCircumcenterBatch();
+      continue;
+    }
+
     // Try to insert just one circumcenter
     if (!circumradiusCheckQueue.empty()) {
 
@@ -623,22 +902,7 @@ void IntrinsicTriangulation::delaunayRefine(const std::function<bool(Face)>& sho
         }
         nInsertions++;
 
-        // Mark everything in the 1-ring as possibly non-Delaunay and possibly violating the circumradius constraint
-        for (Face nF : newVert.adjacentFaces()) {
-
-          // Check circumradius constraint
-          if (shouldRefine(nF)) {
-            circumradiusCheckQueue.push(std::make_tuple(areaWeight(nF), faceArea(nF), nF));
-          }
-
-          // Check delaunay constraint
-          for (Edge nE : nF.adjacentEdges()) {
-            if (!inDelaunayQueue[nE]) {
-              delaunayCheckQueue.push_back(nE);
-              inDelaunayQueue[nE] = true;
-            }
-          }
-        }
+        checkNeighborsAfterInsertion(newVert);
       }
 
       continue;
@@ -709,23 +973,85 @@ CommonSubdivision& IntrinsicTriangulation::getCommonSubdivision() {
 }
 
 
-void IntrinsicTriangulation::triangulationChanged() { commonSubdivision.reset(); }
+void IntrinsicTriangulation::triangulationChanged() {
+  if (commonSubdivision) commonSubdivision.reset(); // (test first, so concurrent flips only read it)
+}
 
 void IntrinsicTriangulation::invokeEdgeFlipCallbacks(Edge e) {
+  if (flipCallbacksDeferred) return;
+  GC_PROFILE_COUNTER("intrinsic edge flips", 1);
   for (auto& fn : edgeFlipCallbackList) {
     fn(e);
   }
 }
 void IntrinsicTriangulation::invokeFaceInsertionCallbacks(Face f, Vertex v) {
+  GC_PROFILE_COUNTER("intrinsic face insertions", 1);
   for (auto& fn : faceInsertionCallbackList) {
     fn(f, v);
   }
 }
 void IntrinsicTriangulation::invokeEdgeSplitCallbacks(Edge e, Halfedge he1, Halfedge he2) {
+  GC_PROFILE_COUNTER("intrinsic edge splits", 1);
   for (auto& fn : edgeSplitCallbackList) {
     fn(e, he1, he2);
   }
 }
 
+// ======================================================
+// ======== Checkpoints
+// ======================================================
+
+void IntrinsicTriangulation::checkpoint() {
+  GC_PROFILE_SCOPE("IntrinsicTriangulation::checkpoint");
+  checkpointMesh = intrinsicMesh->copy();
+  saveCheckpointData();
+}
+
+void IntrinsicTriangulation::rollback() {
+  GC_PROFILE_SCOPE("IntrinsicTriangulation::rollback");
+  if (!checkpointMesh) {
+    throw std::runtime_error("cannot rollback() without a checkpoint(). Call checkpoint() first.");
+  }
+
+  intrinsicMesh->restoreConnectivity(*checkpointMesh);
+  restoreCheckpointData();
+
+  triangulationChanged();
+  refreshQuantities();
+}
+
+bool IntrinsicTriangulation::hasCheckpoint() const { return checkpointMesh != nullptr; }
+
+void IntrinsicTriangulation::clearCheckpoint() {
+  checkpointMesh.reset();
+  checkpointEdgeLengths.resize(0);
+  checkpointVertexLocations.resize(0);
+  checkpointMarkedEdges.resize(0);
+  checkpointHasMarkedEdges = false;
+}
+
+void IntrinsicTriangulation::saveCheckpointData() {
+  checkpointEdgeLengths = edgeLengths.raw();
+  checkpointVertexLocations = vertexLocations.raw();
+  checkpointHasMarkedEdges = markedEdges.size() > 0;
+  if (checkpointHasMarkedEdges) {
+    checkpointMarkedEdges = markedEdges.raw();
+  } else {
+    checkpointMarkedEdges.resize(0);
+  }
+}
+
+void IntrinsicTriangulation::restoreCheckpointData() {
+  // (containers have already been resized to the capacity of the restored mesh, which is at least the saved size)
+  edgeLengths.raw().head(checkpointEdgeLengths.size()) = checkpointEdgeLengths;
+  vertexLocations.raw().head(checkpointVertexLocations.size()) = checkpointVertexLocations;
+  if (checkpointHasMarkedEdges) {
+    if (markedEdges.size() == 0) markedEdges = EdgeData<bool>(*intrinsicMesh, false);
+    markedEdges.raw().head(checkpointMarkedEdges.size()) = checkpointMarkedEdges;
+  } else {
+    clearMarkedEdges();
+  }
+}
+
 } // namespace surface
 } // namespace geometrycentral
@@ -2,7 +2,7 @@
 
 #include "geometrycentral/utilities/combining_hash_functions.h"
 #include "geometrycentral/utilities/disjoint_sets.h"
-#include "geometrycentral/utilities/timing.h"
+#include "geometrycentral/utilities/profiler.h"
 
 #include <algorithm>
 #include <limits>
@@ -49,7 +49,7 @@ ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<std::vector<size_t>>&
   // Assumes that the input index set is dense. This sometimes isn't true of (eg) obj files floating around the
   // internet, so consider removing unused vertices first when reading from foreign sources.
 
-  // START_TIMING(construction)
+  GC_PROFILE_SCOPE("ManifoldSurfaceMesh construction");
 
   // Check input list and measure some element counts
   nFacesCount = polygons.size();
@@ -163,56 +163,7 @@ ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<std::vector<size_t>>&
   }
 #endif
 
-  // == Resolve boundary loops
-  nInteriorHalfedgesCount = nHalfedgesCount; // will decrement as we find exterior
-  for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
-
-    // If the face pointer is invalid, the halfedge must be along an unresolved boundary loop
-    if (heFaceArr[iHe] != INVALID_IND) continue;
-
-    // Create the new boundary loop
-    size_t boundaryLoopInd = nFacesCount + nBoundaryLoopsCount;
-    fHalfedgeArr.push_back(iHe);
-    nBoundaryLoopsCount++;
-
-    // = Walk around the loop (CW)
-    size_t currHe = iHe;
-    size_t prevHe = INVALID_IND;
-    size_t loopCount = 0;
-    do {
-
-      // The boundary loop is the face for these halfedges
-      heFaceArr[currHe] = boundaryLoopInd;
-
-      // currHe.twin() is a boundary interior halfedge, this is a good time to enforce that v.halfedge() is always the
-      // boundary interior halfedge for a boundary vertex.
-      size_t currHeT = heTwin(currHe);
-      vHalfedgeArr[heVertexArr[currHeT]] = currHeT;
-
-      // This isn't an interior halfedge.
-      nInteriorHalfedgesCount--;
-
-      // Advance to the next halfedge along the boundary
-      prevHe = currHe;
-      currHe = heTwin(heNextArr[heTwin(currHe)]);
-      size_t loopCountInnter = 0;
-      while (heFaceArr[currHe] != INVALID_IND) {
-        if (currHe == iHe) break;
-        currHe = heTwin(heNextArr[currHe]);
-        loopCountInnter++;
-        GC_SAFETY_ASSERT(loopCountInnter < nHalfedgesCount, "boundary infinite loop orbit");
-      }
-
-      // Set the next pointer around the boundary loop
-      heNextArr[currHe] = prevHe;
-
-      // Make sure this loop doesn't infinite-loop. Certainly won't happen for proper input, but might happen for bogus
-      // input. I don't _think_ it can happen, but there might be some non-manifold input which manfests failure via an
-      // infinte loop here, and such a loop is an inconvenient failure mode.
-      loopCount++;
-      GC_SAFETY_ASSERT(loopCount < nHalfedgesCount, "boundary infinite loop");
-    } while (currHe != iHe);
-  }
+  resolveBoundaryLoops();
 
   // SOMEDAY: could shrink_to_fit() std::vectors here, at the cost of a copy. What's preferable?
 
@@ -229,34 +180,12 @@ ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<std::vector<size_t>>&
   isCompressedFlag = true;
 
 #ifndef NGC_SAFETY_CHECKS
-  { // Check that the input was manifold in the sense that each vertex has a single connected loop of faces around it.
-    std::vector<char> halfedgeSeen(nHalfedgesCount, false);
-    for (size_t iV = 0; iV < nVerticesCount; iV++) {
-
-      // For each vertex, orbit around the outgoing halfedges. This _should_ touch every halfedge.
-      size_t currHe = vHalfedgeArr[iV];
-      size_t firstHe = currHe;
-      do {
-
-        GC_SAFETY_ASSERT(!halfedgeSeen[currHe], "somehow encountered outgoing halfedge before orbiting v");
-        halfedgeSeen[currHe] = true;
-
-        currHe = heNextArr[heTwinImplicit(currHe)];
-      } while (currHe != firstHe);
-    }
-
-    // Verify that we actually did touch every halfedge.
-    for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
-      GC_SAFETY_ASSERT(halfedgeSeen[iHe], "mesh not manifold. Vertex " + std::to_string(heVertexArr[iHe]) +
-                                              " has disconnected neighborhoods incident (imagine an hourglass)");
-    }
-  }
+  validateVertexNeighborhoods();
 #endif
 
 
   // Print some nice statistics
   // printStatistics();
-  // std::cout << "Construction took " << pretty_time(FINISH_TIMING(construction)) << std::endl;
 }
 
 ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<std::vector<size_t>>& polygons,
@@ -266,7 +195,7 @@ ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<std::vector<size_t>>&
   // Assumes that the input index set is dense. This sometimes isn't true of (eg) obj files floating around the
   // internet, so consider removing unused vertices first when reading from foreign sources.
 
-  START_TIMING(construction)
+  GC_PROFILE_SCOPE("ManifoldSurfaceMesh construction");
 
   GC_SAFETY_ASSERT(polygons.size() == twins.size(), "twin list should be same shape as polygon list");
 
@@ -373,85 +302,180 @@ ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<std::vector<size_t>>&
   }
 #endif
 
-  // == Resolve boundary loops
-  nInteriorHalfedgesCount = nHalfedgesCount; // will decrement as we find exterior
-  for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
+  resolveBoundaryLoops();
 
-    // If the face pointer is invalid, the halfedge must be along an unresolved boundary loop
-    if (heFaceArr[iHe] != INVALID_IND) continue;
+  // SOMEDAY: could shrink_to_fit() std::vectors here, at the cost of a copy. What's preferable?
 
-    // Create the new boundary loop
-    size_t boundaryLoopInd = nFacesCount + nBoundaryLoopsCount;
-    fHalfedgeArr.push_back(iHe);
-    nBoundaryLoopsCount++;
+  // Set capacities and other properties
+  nVerticesCapacityCount = nVerticesCount;
+  nHalfedgesCapacityCount = nHalfedgesCount;
+  nFacesCapacityCount = nFacesCount + nBoundaryLoopsCount;
+  nVerticesFillCount = nVerticesCount;
+  nHalfedgesFillCount = nHalfedgesCount;
+  nFacesFillCount = nFacesCount;
+  nBoundaryLoopsFillCount = nBoundaryLoopsCount;
+  isCompressedFlag = true;
 
-    // = Walk around the loop (CW)
-    size_t currHe = iHe;
-    size_t prevHe = INVALID_IND;
-    size_t loopCount = 0;
-    do {
+  // Print some nice statistics
+  // printStatistics();
+}
 
-      // The boundary loop is the face for these halfedges
-      heFaceArr[currHe] = boundaryLoopInd;
+ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<size_t>& faceVertexIndices, size_t faceDegree)
+    : SurfaceMesh(true) {
+  GC_PROFILE_SCOPE("ManifoldSurfaceMesh construction");
 
-      // currHe.twin() is a boundary interior halfedge, this is a good time to enforce that v.halfedge() is always the
-      // boundary interior halfedge for a boundary vertex.
-      size_t currHeT = heTwinImplicit(currHe);
-      vHalfedgeArr[heVertexArr[currHeT]] = currHeT;
+  // Assumes that the input index set is dense, as in the constructors above.
+  //
+  // Rather than hashing vertex pairs, twins are matched via a compressed list of the corners incoming to each vertex.
+  // This keeps temporary storage to a few flat arrays, which matters for very large meshes.
 
-      // This isn't an interior halfedge.
-      nInteriorHalfedgesCount--;
+  GC_SAFETY_ASSERT(faceDegree >= 3, "faces must have degree >= 3");
+  GC_SAFETY_ASSERT(faceVertexIndices.size() % faceDegree == 0, "face index list must be a multiple of face degree");
 
-      // Advance to the next halfedge along the boundary
-      prevHe = currHe;
-      currHe = heTwinImplicit(heNextArr[heTwinImplicit(currHe)]);
-      size_t loopCountInnter = 0;
-      while (heFaceArr[currHe] != INVALID_IND) {
-        if (currHe == iHe) break;
-        currHe = heTwinImplicit(heNextArr[currHe]);
-        loopCountInnter++;
-        GC_SAFETY_ASSERT(loopCountInnter < nHalfedgesCount, "boundary infinite loop orbit");
+  // Check input list and measure some element counts
+  size_t nCorners = faceVertexIndices.size();
+  nFacesCount = nCorners / faceDegree;
+  nVerticesCount = 0;
+  for (size_t i : faceVertexIndices) {
+    nVerticesCount = std::max(nVerticesCount, i);
+  }
+  nVerticesCount++; // 0-based means count is max+1
+
+  // Corner iC is the halfedge from faceVertexIndices[iC] to the next vertex in its face
+  auto cornerNext = [&](size_t iC) -> size_t {
+    return (iC % faceDegree == faceDegree - 1) ? iC + 1 - faceDegree : iC + 1;
+  };
+
+  // Index of the halfedge for each corner
+  std::vector<size_t> cornerHalfedge(nCorners, INVALID_IND);
+  nEdgesCount = 0;
+
+  { // Match twins
+    // Build a compressed list of the corners incoming to each vertex
+    std::vector<size_t> vertexInStart(nVerticesCount + 1, 0);
+    for (size_t iC = 0; iC < nCorners; iC++) {
+      vertexInStart[faceVertexIndices[cornerNext(iC)] + 1]++;
+    }
+    for (size_t iV = 0; iV < nVerticesCount; iV++) {
+      // Every vertex has an incoming corner if and only if it is referenced by some face
+      GC_SAFETY_ASSERT(vertexInStart[iV + 1] > 0, "unreferenced vertex " + std::to_string(iV));
+      vertexInStart[iV + 1] += vertexInStart[iV];
+    }
+    std::vector<size_t> vertexInCorners(nCorners);
+    {
+      std::vector<size_t> fillCount(vertexInStart.begin(), vertexInStart.end() - 1);
+      for (size_t iC = 0; iC < nCorners; iC++) {
+        vertexInCorners[fillCount[faceVertexIndices[cornerNext(iC)]]++] = iC;
       }
+    }
 
-      // Set the next pointer around the boundary loop
-      heNextArr[currHe] = prevHe;
+    // Find the unique corner in the incoming list of vTip which comes from vTail, or INVALID_IND if there is none
+    auto findIncoming = [&](size_t vTail, size_t vTip) -> size_t {
+      size_t found = INVALID_IND;
+      for (size_t i = vertexInStart[vTip]; i < vertexInStart[vTip + 1]; i++) {
+        size_t iC = vertexInCorners[i];
+        if (faceVertexIndices[iC] == vTail) {
+          GC_SAFETY_ASSERT(found == INVALID_IND,
+                           "duplicate edge in list " + std::to_string(vTail) + " -- " + std::to_string(vTip));
+          found = iC;
+        }
+      }
+      return found;
+    };
 
-      // Make sure this loop doesn't infinite-loop. Certainly won't happen for proper input, but might happen for
-      // bogus input. I don't _think_ it can happen, but there might be some non-manifold input which manfests failure
-      // via an infinte loop here, and such a loop is an inconvenient failure mode.
-      loopCount++;
-      GC_SAFETY_ASSERT(loopCount < nHalfedgesCount, "boundary infinite loop");
-    } while (currHe != iHe);
+    // Walk the corners, creating a new edge whenever we reach a corner whose twin has not been seen
+    for (size_t iC = 0; iC < nCorners; iC++) {
+      if (cornerHalfedge[iC] != INVALID_IND) continue;
+
+      size_t indTail = faceVertexIndices[iC];
+      size_t indTip = faceVertexIndices[cornerNext(iC)];
+      GC_SAFETY_ASSERT(indTail != indTip,
+                       "self-edge in face list " + std::to_string(indTail) + " -- " + std::to_string(indTip));
+#ifndef NGC_SAFETY_CHECKS
+      findIncoming(indTail, indTip); // only called to check for duplicates
+#endif
+
+      size_t iE = nEdgesCount++;
+      cornerHalfedge[iC] = eHalfedgeImplicit(iE);
+
+      size_t iCTwin = findIncoming(indTip, indTail);
+      if (iCTwin != INVALID_IND) {
+        cornerHalfedge[iCTwin] = heTwinImplicit(eHalfedgeImplicit(iE));
+      }
+    }
   }
 
-  // SOMEDAY: could shrink_to_fit() std::vectors here, at the cost of a copy. What's preferable?
+  // Allocate and fill the connectivity arrays
+  nHalfedgesCount = 2 * nEdgesCount;
+  heNextArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  heVertexArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  heFaceArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  vHalfedgeArr = std::vector<size_t>(nVerticesCount, INVALID_IND);
+  fHalfedgeArr = std::vector<size_t>(nFacesCount, INVALID_IND);
+  for (size_t iC = 0; iC < nCorners; iC++) {
+    size_t iHe = cornerHalfedge[iC];
+    size_t indTail = faceVertexIndices[iC];
+    size_t iCNext = cornerNext(iC);
+
+    heNextArr[iHe] = cornerHalfedge[iCNext];
+    heVertexArr[iHe] = indTail;
+    heFaceArr[iHe] = iC / faceDegree;
+    vHalfedgeArr[indTail] = iHe;
+    if (iC % faceDegree == 0) {
+      fHalfedgeArr[iC / faceDegree] = iHe;
+    }
+
+    // Set the vertex of the twin too, in case it is a boundary halfedge which will never be visited
+    heVertexArr[heTwinImplicit(iHe)] = faceVertexIndices[iCNext];
+  }
+  cornerHalfedge.clear();
+  cornerHalfedge.shrink_to_fit();
+
+// Ensure that each boundary neighborhood is either a disk or a half-disk. Harder to diagnose if we wait until the
+// boundary walk below.
+#ifndef NGC_SAFETY_CHECKS
+  {
+    std::vector<char> vertexOnBoundary(nVerticesCount, false);
+    for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
+      if (heNextArr[iHe] == INVALID_IND) {
+        size_t v = heVertexArr[iHe];
+        GC_SAFETY_ASSERT(!vertexOnBoundary[v],
+                         "vertex " + std::to_string(v) + " appears in more than one boundary loop");
+        vertexOnBoundary[v] = true;
+      }
+    }
+  }
+#endif
+
+  resolveBoundaryLoops();
 
   // Set capacities and other properties
   nVerticesCapacityCount = nVerticesCount;
   nHalfedgesCapacityCount = nHalfedgesCount;
+  nEdgesCapacityCount = nEdgesCount;
   nFacesCapacityCount = nFacesCount + nBoundaryLoopsCount;
   nVerticesFillCount = nVerticesCount;
   nHalfedgesFillCount = nHalfedgesCount;
+  nEdgesFillCount = nEdgesCount;
   nFacesFillCount = nFacesCount;
   nBoundaryLoopsFillCount = nBoundaryLoopsCount;
   isCompressedFlag = true;
 
-  // Print some nice statistics
-  // printStatistics();
-  // std::cout << "Construction took " << pretty_time(FINISH_TIMING(construction)) << std::endl;
+#ifndef NGC_SAFETY_CHECKS
+  validateVertexNeighborhoods();
+#endif
 }
 
-ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<size_t>& heNextArr_, const std::vector<size_t>& heVertexArr_,
-                                         const std::vector<size_t>& heFaceArr_,
-                                         const std::vector<size_t>& vHalfedgeArr_,
-                                         const std::vector<size_t>& fHalfedgeArr_, size_t nBoundaryLoopsFillCount_)
+ManifoldSurfaceMesh::ManifoldSurfaceMesh(std::vector<size_t> heNextArr_, std::vector<size_t> heVertexArr_,
+                                         std::vector<size_t> heFaceArr_, std::vector<size_t> vHalfedgeArr_,
+                                         std::vector<size_t> fHalfedgeArr_, size_t nBoundaryLoopsFillCount_)
     : SurfaceMesh(true) {
 
-  heNextArr = heNextArr_;
-  heVertexArr = heVertexArr_;
-  heFaceArr = heFaceArr_;
-  vHalfedgeArr = vHalfedgeArr_;
-  fHalfedgeArr = fHalfedgeArr_;
+  heNextArr = std::move(heNextArr_);
+  heVertexArr = std::move(heVertexArr_);
+  heFaceArr = std::move(heFaceArr_);
+  vHalfedgeArr = std::move(vHalfedgeArr_);
+  fHalfedgeArr = std::move(fHalfedgeArr_);
 
   // == Set all counts
   nHalfedgesCount = heNextArr.size();
@@ -511,6 +535,83 @@ ManifoldSurfaceMesh::ManifoldSurfaceMesh(const std::vector<size_t>& heNextArr_,
 
 ManifoldSurfaceMesh::~ManifoldSurfaceMesh() {}
 
+void ManifoldSurfaceMesh::resolveBoundaryLoops() {
+  // Any halfedges which still have no face must lie along boundary loops. Create the loops and hook up pointers.
+  nInteriorHalfedgesCount = nHalfedgesCount; // will decrement as we find exterior
+  for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
+
+    // If the face pointer is invalid, the halfedge must be along an unresolved boundary loop
+    if (heFaceArr[iHe] != INVALID_IND) continue;
+
+    // Create the new boundary loop
+    size_t boundaryLoopInd = nFacesCount + nBoundaryLoopsCount;
+    fHalfedgeArr.push_back(iHe);
+    nBoundaryLoopsCount++;
+
+    // = Walk around the loop (CW)
+    size_t currHe = iHe;
+    size_t prevHe = INVALID_IND;
+    size_t loopCount = 0;
+    do {
+
+      // The boundary loop is the face for these halfedges
+      heFaceArr[currHe] = boundaryLoopInd;
+
+      // currHe.twin() is a boundary interior halfedge, this is a good time to enforce that v.halfedge() is always the
+      // boundary interior halfedge for a boundary vertex.
+      size_t currHeT = heTwinImplicit(currHe);
+      vHalfedgeArr[heVertexArr[currHeT]] = currHeT;
+
+      // This isn't an interior halfedge.
+      nInteriorHalfedgesCount--;
+
+      // Advance to the next halfedge along the boundary
+      prevHe = currHe;
+      currHe = heTwinImplicit(heNextArr[heTwinImplicit(currHe)]);
+      size_t loopCountInnter = 0;
+      while (heFaceArr[currHe] != INVALID_IND) {
+        if (currHe == iHe) break;
+        currHe = heTwinImplicit(heNextArr[currHe]);
+        loopCountInnter++;
+        GC_SAFETY_ASSERT(loopCountInnter < nHalfedgesCount, "boundary infinite loop orbit");
+      }
+
+      // Set the next pointer around the boundary loop
+      heNextArr[currHe] = prevHe;
+
+      // Make sure this loop doesn't infinite-loop. Certainly won't happen for proper input, but might happen for bogus
+      // input. I don't _think_ it can happen, but there might be some non-manifold input which manfests failure via an
+      // infinte loop here, and such a loop is an inconvenient failure mode.
+      loopCount++;
+      GC_SAFETY_ASSERT(loopCount < nHalfedgesCount, "boundary infinite loop");
+    } while (currHe != iHe);
+  }
+}
+
+void ManifoldSurfaceMesh::validateVertexNeighborhoods() {
+  // Check that the input was manifold in the sense that each vertex has a single connected loop of faces around it.
+  std::vector<char> halfedgeSeen(nHalfedgesCount, false);
+  for (size_t iV = 0; iV < nVerticesCount; iV++) {
+
+    // For each vertex, orbit around the outgoing halfedges. This _should_ touch every halfedge.
+    size_t currHe = vHalfedgeArr[iV];
+    size_t firstHe = currHe;
+    do {
+
+      GC_SAFETY_ASSERT(!halfedgeSeen[currHe], "somehow encountered outgoing halfedge before orbiting v");
+      halfedgeSeen[currHe] = true;
+
+      currHe = heNextArr[heTwinImplicit(currHe)];
+    } while (currHe != firstHe);
+  }
+
+  // Verify that we actually did touch every halfedge.
+  for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
+    GC_SAFETY_ASSERT(halfedgeSeen[iHe], "mesh not manifold. Vertex " + std::to_string(heVertexArr[iHe]) +
+                                            " has disconnected neighborhoods incident (imagine an hourglass)");
+  }
+}
+
 
 int ManifoldSurfaceMesh::eulerCharacteristic() const {
   // be sure to do intermediate arithmetic with large *signed* integers
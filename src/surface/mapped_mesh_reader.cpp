@@ -0,0 +1,389 @@
+#include "geometrycentral/surface/mapped_mesh_reader.h"
+
+#include "geometrycentral/utilities/binary_ply.h"
+#include "geometrycentral/utilities/mapped_file.h"
+#include "geometrycentral/utilities/parallel.h"
+#include "geometrycentral/utilities/vertex_welding.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace geometrycentral {
+namespace surface {
+
+namespace {
+
+// Read a little-endian value of type T from a possibly-unaligned location
+template <typename T>
+inline T readRaw(const char* p) {
+  T val;
+  std::memcpy(&val, p, sizeof(T));
+  return val;
+}
+
+// == Binary .stl
+
+bool readMappedStl(const MappedFile& file, MappedMeshData& data, size_t nThreads) {
+  const size_t HEADER_SIZE = 84;
+  const size_t TRIANGLE_SIZE = 50;
+
+  if (file.size() < HEADER_SIZE) return false;
+  size_t nTriangles = readRaw<uint32_t>(file.data() + 80);
+  bool sizeMatches = file.size() == HEADER_SIZE + TRIANGLE_SIZE * nTriangles;
+
+  // Ascii files begin with "solid"; but so do some binary files, in which case the size is the giveaway
+  bool startsWithSolid = true;
+  for (size_t i = 0; i < 5; i++) {
+    startsWithSolid = startsWithSolid && std::tolower(file.data()[i]) == "solid"[i];
+  }
+  if (startsWithSolid && !sizeMatches) return false;
+  if (file.size() < HEADER_SIZE + TRIANGLE_SIZE * nTriangles) {
+    throw std::runtime_error("binary stl file is truncated: header lists " + std::to_string(nTriangles) +
+                             " triangles");
+  }
+
+  // Each triangle gets its own three vertices, which are merged afterwards
+  data.vertexCoordinates.resize(3 * nTriangles);
+  data.faceIndices.resize(3 * nTriangles);
+  data.faceDegree = 3;
+
+  const char* triangles = file.data() + HEADER_SIZE;
+  parallelFor(
+      nTriangles, nThreads,
+      [&](size_t iT) {
+        const char* p = triangles + TRIANGLE_SIZE * iT;
+        auto readVector = [&](size_t i) {
+          return Vector3{readRaw<float>(p + 12 * i), readRaw<float>(p + 12 * i + 4), readRaw<float>(p + 12 * i + 8)};
+        };
+
+        Vector3 normal = readVector(0);
+        for (size_t j = 0; j < 3; j++) {
+          data.vertexCoordinates[3 * iT + j] = readVector(j + 1);
+          data.faceIndices[3 * iT + j] = 3 * iT + j;
+        }
+
+        // Orient face using normal
+        const Vector3* pos = &data.vertexCoordinates[3 * iT];
+        Vector3 faceNormal = cross(pos[1] - pos[0], pos[2] - pos[0]);
+        if (dot(faceNormal, normal) < 0) {
+          std::swap(data.faceIndices[3 * iT], data.faceIndices[3 * iT + 2]);
+        }
+      },
+      4096);
+
+  return true;
+}
+
+// == Binary little-endian .ply
+
+// Reads an integer; negative values come back as a huge size_t, which fails the subsequent range checks
+inline size_t readPlyIndex(const char* p, PlyType type) {
+  switch (type) {
+  case PlyType::Int8:
+    return static_cast<size_t>(static_cast<int64_t>(readRaw<int8_t>(p)));
+  case PlyType::UInt8:
+    return readRaw<uint8_t>(p);
+  case PlyType::Int16:
+    return static_cast<size_t>(static_cast<int64_t>(readRaw<int16_t>(p)));
+  case PlyType::UInt16:
+    return readRaw<uint16_t>(p);
+  case PlyType::Int32:
+    return static_cast<size_t>(static_cast<int64_t>(readRaw<int32_t>(p)));
+  case PlyType::UInt32:
+    return readRaw<uint32_t>(p);
+  default:
+    return 0; // float indices are rejected when parsing the header
+  }
+}
+
+bool readMappedPly(const MappedFile& file, MappedMeshData& data, size_t nThreads) {
+
+  // == Parse the header
+  const char* begin = file.data();
+  std::string format;
+  std::vector<PlyElement> elements;
+  size_t headerSize;
+  if (!parsePlyHeader(begin, begin + file.size(), format, elements, headerSize)) return false;
+  if (format != "binary_little_endian") return false;
+
+  // == Locate the vertex and face elements
+  // Any elements before them must have only scalar properties, so that they can be skipped over without parsing
+  size_t fileSize = file.size();
+  size_t vertexDataOffset = 0, faceDataOffset = 0;
+  const PlyElement* vertexElement = nullptr;
+  const PlyElement* faceElement = nullptr;
+  size_t offset = headerSize;
+  for (const PlyElement& elem : elements) {
+    if (elem.name == "vertex") {
+      vertexElement = &elem;
+      vertexDataOffset = offset;
+    } else if (elem.name == "face") {
+      faceElement = &elem;
+      faceDataOffset = offset;
+    }
+    if (vertexElement != nullptr && faceElement != nullptr) break;
+    if (!elem.allScalar()) return false;
+    size_t stride = elem.scalarStride();
+    if (stride > 0 && elem.count > (fileSize - offset) / stride) {
+      throw std::runtime_error("binary ply file is truncated while reading element " + elem.name);
+    }
+    offset += elem.count * stride;
+  }
+  if (vertexElement == nullptr || !vertexElement->allScalar()) return false;
+
+  // == Vertices
+  size_t vertexStride = vertexElement->scalarStride();
+  size_t positionOffset[3];
+  PlyType positionType[3];
+  for (int j = 0; j < 3; j++) {
+    std::string name(1, "xyz"[j]);
+    bool found = false;
+    size_t offset = 0;
+    for (const PlyProperty& prop : vertexElement->properties) {
+      if (prop.name == name) {
+        positionOffset[j] = offset;
+        positionType[j] = prop.type;
+        found = true;
+      }
+      offset += plyTypeSize(prop.type);
+    }
+    if (!found) return false;
+  }
+
+  size_t nVertices = vertexElement->count;
+  if (nVertices > (fileSize - vertexDataOffset) / vertexStride) {
+    throw std::runtime_error("binary ply file is truncated while reading vertices");
+  }
+  const char* vertexData = begin + vertexDataOffset;
+  data.vertexCoordinates.resize(nVertices);
+  parallelFor(
+      nVertices, nThreads,
+      [&](size_t iV) {
+        const char* v = vertexData + vertexStride * iV;
+        for (int j = 0; j < 3; j++) {
+          data.vertexCoordinates[iV][j] = readPlyValue<double>(v + positionOffset[j], positionType[j]);
+        }
+      },
+      4096);
+
+  // == Faces
+  if (faceElement == nullptr) {
+    data.faceDegree = 3; // no faces at all
+    return true;
+  }
+
+  // The face element must hold exactly one list, of vertex indices, plus any number of scalars around it
+  size_t bytesBeforeList = 0;
+  size_t bytesAfterList = 0;
+  const PlyProperty* indexList = nullptr;
+  for (const PlyProperty& prop : faceElement->properties) {
+    if (prop.isList) {
+      if (indexList != nullptr || (prop.name != "vertex_indices" && prop.name != "vertex_index")) return false;
+      indexList = &prop;
+    } else {
+      (indexList == nullptr ? bytesBeforeList : bytesAfterList) += plyTypeSize(prop.type);
+    }
+  }
+  if (indexList == nullptr || indexList->type == PlyType::Float32 || indexList->type == PlyType::Float64) return false;
+  PlyType countType = indexList->countType;
+  PlyType indexType = indexList->type;
+  size_t countSize = plyTypeSize(countType);
+  size_t indexSize = plyTypeSize(indexType);
+
+  size_t nFaces = faceElement->count;
+  const char* faceData = begin + faceDataOffset;
+  size_t faceBytesAvailable = fileSize - faceDataOffset;
+  auto faceDegreeAt = [&](size_t offset) -> size_t {
+    if (offset + bytesBeforeList + countSize > faceBytesAvailable) {
+      throw std::runtime_error("binary ply file is truncated while reading faces");
+    }
+    return readPlyIndex(faceData + offset + bytesBeforeList, countType);
+  };
+
+  // Most files have faces of a single degree, in which case each face is at a known offset and can be decoded
+  // independently. Check that hypothesis in parallel, and otherwise measure the faces with a serial scan.
+  size_t firstDegree = nFaces > 0 ? faceDegreeAt(0) : 3;
+  size_t uniformFaceSize = bytesBeforeList + countSize + firstDegree * indexSize + bytesAfterList;
+  bool uniform = nFaces <= faceBytesAvailable / uniformFaceSize;
+  if (uniform) {
+    std::atomic<bool> mismatch(false);
+    parallelFor(
+        nFaces, nThreads,
+        [&](size_t iF) {
+          if (readPlyIndex(faceData + uniformFaceSize * iF + bytesBeforeList, countType) != firstDegree) {
+            mismatch = true;
+          }
+        },
+        16384);
+    uniform = !mismatch;
+  }
+
+  std::vector<size_t> faceOffset; // byte offset of each face, only when non-uniform
+  if (uniform) {
+    data.faceDegree = firstDegree;
+    data.faceIndices.resize(nFaces * firstDegree);
+  } else {
+    data.faceDegree = 0;
+    faceOffset.resize(nFaces);
+    data.faceStart.resize(nFaces + 1);
+    data.faceStart[0] = 0;
+    size_t offset = 0;
+    for (size_t iF = 0; iF < nFaces; iF++) {
+      size_t degree = faceDegreeAt(offset);
+      faceOffset[iF] = offset;
+      data.faceStart[iF + 1] = data.faceStart[iF] + degree;
+      offset += bytesBeforeList + countSize + degree * indexSize + bytesAfterList;
+    }
+    if (offset > faceBytesAvailable) throw std::runtime_error("binary ply file is truncated while reading faces");
+    data.faceIndices.resize(data.faceStart[nFaces]);
+  }
+
+  std::atomic<bool> badIndex(false);
+  parallelFor(
+      nFaces, nThreads,
+      [&](size_t iF) {
+        size_t iStart = uniform ? iF * firstDegree : data.faceStart[iF];
+        size_t degree = uniform ? firstDegree : data.faceStart[iF + 1] - iStart;
+        const char* indices =
+            faceData + (uniform ? iF * uniformFaceSize : faceOffset[iF]) + bytesBeforeList + countSize;
+        for (size_t j = 0; j < degree; j++) {
+          size_t iV = readPlyIndex(indices + j * indexSize, indexType);
+          if (iV >= nVertices) badIndex = true;
+          data.faceIndices[iStart + j] = iV;
+        }
+      },
+      4096);
+  if (badIndex) throw std::runtime_error("binary ply file has a face with an out-of-range vertex index");
+
+  return true;
+}
+
+// == Post-processing, as in meshio.cpp for general files
+
+void stripUnusedVertices(MappedMeshData& data, size_t nThreads) {
+  size_t nV = data.vertexCoordinates.size();
+  std::vector<std::atomic<char>> used(nV);
+  parallelFor(
+      data.faceIndices.size(), nThreads,
+      [&](size_t i) { used[data.faceIndices[i]].store(true, std::memory_order_relaxed); }, 16384);
+
+  std::vector<size_t> newIndex(nV);
+  parallelFor(
+      nV, nThreads, [&](size_t iV) { newIndex[iV] = used[iV].load(std::memory_order_relaxed) ? 1 : 0; }, 16384);
+  size_t nUsed = parallelExclusiveScan(newIndex, nThreads);
+  if (nUsed == nV) return;
+
+  std::vector<Vector3> usedCoordinates(nUsed);
+  parallelFor(
+      nV, nThreads,
+      [&](size_t iV) {
+        if (used[iV].load(std::memory_order_relaxed)) usedCoordinates[newIndex[iV]] = data.vertexCoordinates[iV];
+      },
+      16384);
+  data.vertexCoordinates = std::move(usedCoordinates);
+  parallelFor(
+      data.faceIndices.size(), nThreads, [&](size_t i) { data.faceIndices[i] = newIndex[data.faceIndices[i]]; },
+      16384);
+}
+
+void mergeIdenticalVertices(MappedMeshData& data, size_t nThreads) {
+  std::vector<size_t> compressVertex = weldVertexPositions(data.vertexCoordinates, 0., nThreads);
+  parallelFor(
+      data.faceIndices.size(), nThreads, [&](size_t i) { data.faceIndices[i] = compressVertex[data.faceIndices[i]]; },
+      16384);
+}
+
+// Move positions into a geometry on a newly constructed mesh
+std::unique_ptr<VertexPositionGeometry> consumePositions(SurfaceMesh& mesh, MappedMeshData& data, size_t nThreads) {
+  std::unique_ptr<VertexPositionGeometry> geometry(new VertexPositionGeometry(mesh));
+  parallelFor(
+      mesh.nVertices(), nThreads, [&](size_t iV) { geometry->vertexPositions[iV] = data.vertexCoordinates[iV]; }, 16384);
+  data.vertexCoordinates.clear();
+  data.vertexCoordinates.shrink_to_fit();
+  return geometry;
+}
+
+} // namespace
+
+size_t MappedMeshData::nFaces() const {
+  if (!faceStart.empty()) return faceStart.size() - 1;
+  return faceDegree == 0 ? 0 : faceIndices.size() / faceDegree;
+}
+
+std::vector<std::vector<size_t>> MappedMeshData::toPolygons() const {
+  std::vector<std::vector<size_t>> polygons(nFaces());
+  for (size_t iF = 0; iF < polygons.size(); iF++) {
+    size_t iStart = faceStart.empty() ? iF * faceDegree : faceStart[iF];
+    size_t iEnd = faceStart.empty() ? iStart + faceDegree : faceStart[iF + 1];
+    polygons[iF].assign(faceIndices.begin() + iStart, faceIndices.begin() + iEnd);
+  }
+  return polygons;
+}
+
+bool readMappedMesh(std::string filename, std::string type, MappedMeshData& data, size_t nThreads) {
+  data = MappedMeshData();
+
+  if (type == "") {
+    std::string::size_type sepInd = filename.rfind('.');
+    if (sepInd == std::string::npos) return false;
+    type = filename.substr(sepInd + 1);
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+  }
+  if ((type != "stl" && type != "ply") || !plyHostIsLittleEndian()) return false;
+
+  MappedFile file(filename);
+  bool success = (type == "stl") ? readMappedStl(file, data, nThreads) : readMappedPly(file, data, nThreads);
+  if (!success) {
+    data = MappedMeshData();
+    return false;
+  }
+
+  stripUnusedVertices(data, nThreads);
+  if (type == "stl") {
+    mergeIdenticalVertices(data, nThreads);
+  }
+  return true;
+}
+
+std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeSurfaceMeshAndGeometry(MappedMeshData&& data, size_t nThreads) {
+  // Flat construction, without nested face lists
+  std::unique_ptr<SurfaceMesh> mesh;
+  if (data.faceDegree >= 3 && !data.faceIndices.empty()) {
+    mesh.reset(new SurfaceMesh(data.faceIndices, data.faceDegree));
+  } else if (!data.faceStart.empty() && !data.faceIndices.empty()) {
+    mesh.reset(new SurfaceMesh(data.faceIndices, data.faceStart));
+  } else {
+    mesh.reset(new SurfaceMesh(data.toPolygons()));
+  }
+  data.faceIndices.clear();
+  data.faceIndices.shrink_to_fit();
+  data.faceStart.clear();
+  data.faceStart.shrink_to_fit();
+  std::unique_ptr<VertexPositionGeometry> geometry = consumePositions(*mesh, data, nThreads);
+  return std::make_tuple(std::move(mesh), std::move(geometry));
+}
+
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeManifoldSurfaceMeshAndGeometry(MappedMeshData&& data, size_t nThreads) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  if (data.faceDegree >= 3 && !data.faceIndices.empty()) {
+    // Flat construction, without nested face lists
+    mesh.reset(new ManifoldSurfaceMesh(data.faceIndices, data.faceDegree));
+  } else {
+    mesh.reset(new ManifoldSurfaceMesh(data.toPolygons()));
+  }
+  data.faceIndices.clear();
+  data.faceIndices.shrink_to_fit();
+  data.faceStart.clear();
+  data.faceStart.shrink_to_fit();
+  std::unique_ptr<VertexPositionGeometry> geometry = consumePositions(*mesh, data, nThreads);
+  return std::make_tuple(std::move(mesh), std::move(geometry));
+}
+
+} // namespace surface
+} // namespace geometrycentral
@@ -0,0 +1,426 @@
+#include "geometrycentral/surface/mesh_archive.h"
+
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace geometrycentral {
+namespace surface {
+
+namespace {
+
+// File layout (all values little-endian):
+//   header:  8 byte magic, uint32 version, uint32 reserved, uint64 chunk count
+//   chunks:  uint64 payload bytes, uint64 value count, uint64 payload checksum,
+//            uint32 element type, uint32 bytes per value, uint32 name length, uint32 type name length,
+//            name, type name (padded to 8 bytes), payload (padded to 8 bytes)
+const char ARCHIVE_MAGIC[8] = {'G', 'C', 'M', 'E', 'S', 'H', 'A', 'R'};
+const size_t ARCHIVE_HEADER_SIZE = 24;
+const size_t CHUNK_HEADER_SIZE = 40;
+const size_t CHECKSUM_BLOCK_SIZE = 1 << 20;
+
+const std::string INTERNAL_PREFIX = "gc_internal_";
+const std::string POSITIONS_NAME = "gc_internal_vertexPositions";
+
+bool hostIsLittleEndian() {
+  uint16_t one = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 1;
+}
+
+template <typename T>
+inline T readRaw(const char* p) {
+  T val;
+  std::memcpy(&val, p, sizeof(T));
+  return val;
+}
+
+template <typename T>
+inline void writeRaw(std::ostream& out, T val) {
+  out.write(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+size_t paddedSize(size_t n) { return (n + 7) / 8 * 8; }
+
+inline uint64_t mixHash(uint64_t h, uint64_t w) {
+  h ^= w + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+  h *= 0xff51afd7ed558ccdull;
+  return h ^ (h >> 33);
+}
+
+// A 64-bit hash of a buffer. Blocks are hashed in parallel, then combined in order, so the result does not depend on
+// the number of threads.
+uint64_t checksum(const char* data, size_t nBytes, size_t nThreads) {
+  size_t nBlocks = (nBytes + CHECKSUM_BLOCK_SIZE - 1) / CHECKSUM_BLOCK_SIZE;
+  std::vector<uint64_t> blockHashes(nBlocks);
+  parallelFor(nBlocks, nThreads, [&](size_t iBlock) {
+    const char* p = data + iBlock * CHECKSUM_BLOCK_SIZE;
+    size_t n = std::min(CHECKSUM_BLOCK_SIZE, nBytes - iBlock * CHECKSUM_BLOCK_SIZE);
+    uint64_t h = n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      h = mixHash(h, readRaw<uint64_t>(p + i));
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p + i, n - i);
+    blockHashes[iBlock] = mixHash(h, tail);
+  });
+
+  uint64_t h = nBytes;
+  for (uint64_t blockHash : blockHashes) {
+    h = mixHash(h, blockHash);
+  }
+  return h;
+}
+
+// Connectivity arrays are stored as uint64, with INVALID_IND as the maximum value
+std::vector<char> packIndices(std::vector<size_t>::const_iterator b, std::vector<size_t>::const_iterator e) {
+  size_t count = std::distance(b, e);
+  std::vector<char> bytes(count * sizeof(uint64_t));
+  if (sizeof(size_t) == sizeof(uint64_t)) {
+    if (count > 0) std::memcpy(&bytes[0], &*b, bytes.size());
+    return bytes;
+  }
+  for (size_t i = 0; i < count; i++) {
+    size_t ind = *(b + i);
+    uint64_t val = ind == INVALID_IND ? std::numeric_limits<uint64_t>::max() : static_cast<uint64_t>(ind);
+    std::memcpy(&bytes[i * sizeof(uint64_t)], &val, sizeof(uint64_t));
+  }
+  return bytes;
+}
+
+std::vector<size_t> unpackIndices(const char* data, size_t count) {
+  std::vector<size_t> out(count);
+  if (sizeof(size_t) == sizeof(uint64_t)) {
+    if (count > 0) std::memcpy(&out[0], data, count * sizeof(uint64_t));
+    return out;
+  }
+  for (size_t i = 0; i < count; i++) {
+    uint64_t val = readRaw<uint64_t>(data + i * sizeof(uint64_t));
+    if (val == std::numeric_limits<uint64_t>::max()) {
+      out[i] = INVALID_IND;
+    } else if (val > std::numeric_limits<size_t>::max()) {
+      throw std::runtime_error("mesh archive is too large to be loaded on this platform");
+    } else {
+      out[i] = static_cast<size_t>(val);
+    }
+  }
+  return out;
+}
+
+// Throw if any entry is not INVALID_IND or an index less than bound
+void checkIndexRange(const std::vector<size_t>& arr, size_t bound, std::string name, size_t nThreads) {
+  std::atomic<bool> bad(false);
+  parallelFor(
+      arr.size(), nThreads,
+      [&](size_t i) {
+        if (arr[i] != INVALID_IND && arr[i] >= bound) bad = true;
+      },
+      1 << 16);
+  if (bad) {
+    throw std::runtime_error("mesh archive is corrupt: out of range index in " + name);
+  }
+}
+
+} // namespace
+
+
+MeshArchive::MeshArchive(SurfaceMesh& mesh_) : mesh(&mesh_) { addConnectivityChunks(); }
+
+MeshArchive::MeshArchive(SurfaceMesh& mesh_, std::string filename, bool verifyChecksums, size_t nThreads)
+    : MeshArchive(filename, verifyChecksums, nThreads) {
+  mesh = &mesh_;
+
+  // Catch the most likely mismatches; attribute sizes are checked again when they are read
+  if (getChunk("gc_internal_heNextArr").count != mesh->nHalfedgesFillCount ||
+      getChunk("gc_internal_vHalfedgeArr").count != mesh->nVerticesFillCount ||
+      getChunk("gc_internal_fHalfedgeArr").count != mesh->nFacesFillCount + mesh->nBoundaryLoopsFillCount) {
+    throw std::runtime_error("mesh archive " + filename + " was not written from a mesh with this connectivity");
+  }
+}
+
+MeshArchive::MeshArchive(std::string filename, bool verifyChecksums, size_t nThreads) {
+  if (!hostIsLittleEndian()) {
+    throw std::runtime_error("mesh archives can only be read on little-endian hosts");
+  }
+
+  file.reset(new MappedFile(filename));
+  const char* begin = file->data();
+  size_t size = file->size();
+
+  if (size < ARCHIVE_HEADER_SIZE || std::memcmp(begin, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) {
+    throw std::runtime_error("file " + filename + " is not a mesh archive");
+  }
+  uint32_t version = readRaw<uint32_t>(begin + 8);
+  if (version > VERSION) {
+    throw std::runtime_error("mesh archive " + filename + " has version " + std::to_string(version) +
+                             ", but this build can only read up to version " + std::to_string(VERSION));
+  }
+  uint64_t nChunks = readRaw<uint64_t>(begin + 16);
+
+  // Walk the chunk listing; payloads stay in the mapping
+  std::string truncatedMessage = "mesh archive " + filename + " is truncated";
+  size_t offset = ARCHIVE_HEADER_SIZE;
+  std::vector<uint64_t> expectedChecksums;
+  for (uint64_t iChunk = 0; iChunk < nChunks; iChunk++) {
+    if (size - offset < CHUNK_HEADER_SIZE) throw std::runtime_error(truncatedMessage);
+    const char* p = begin + offset;
+    uint64_t payloadBytes = readRaw<uint64_t>(p);
+    Chunk chunk;
+    chunk.count = readRaw<uint64_t>(p + 8);
+    expectedChecksums.push_back(readRaw<uint64_t>(p + 16));
+    chunk.elementType = readRaw<uint32_t>(p + 24);
+    chunk.valueBytes = readRaw<uint32_t>(p + 28);
+    uint32_t nameBytes = readRaw<uint32_t>(p + 32);
+    uint32_t typeNameBytes = readRaw<uint32_t>(p + 36);
+    offset += CHUNK_HEADER_SIZE;
+
+    size_t namesSize = paddedSize(static_cast<size_t>(nameBytes) + typeNameBytes);
+    if (size - offset < namesSize) throw std::runtime_error(truncatedMessage);
+    chunk.name.assign(begin + offset, nameBytes);
+    chunk.typeName.assign(begin + offset + nameBytes, typeNameBytes);
+    offset += namesSize;
+
+    if (chunk.valueBytes == 0 || chunk.count > payloadBytes || payloadBytes != chunk.count * chunk.valueBytes) {
+      throw std::runtime_error("mesh archive " + filename + " is corrupt: bad size for chunk " + chunk.name);
+    }
+    if (size - offset < payloadBytes) throw std::runtime_error(truncatedMessage);
+    chunk.mappedData = begin + offset;
+    offset += std::min<size_t>(size - offset, paddedSize(payloadBytes));
+
+    chunks.push_back(std::move(chunk));
+  }
+
+  if (verifyChecksums) {
+    for (size_t iChunk = 0; iChunk < chunks.size(); iChunk++) {
+      const Chunk& chunk = chunks[iChunk];
+      if (checksum(chunk.data(), chunk.count * chunk.valueBytes, nThreads) != expectedChecksums[iChunk]) {
+        throw std::runtime_error("mesh archive " + filename + " is corrupt: checksum mismatch in chunk " +
+                                 chunk.name);
+      }
+    }
+  }
+}
+
+void MeshArchive::loadMeshFromFile(size_t nThreads) {
+  if (mesh != nullptr) throw std::runtime_error("cannot load mesh multiple times");
+
+  if (!hasProperty("gc_internal_info")) {
+    throw std::runtime_error("cannot load mesh from archive, it does not contain connectivity");
+  }
+
+  auto getIndices = [&](std::string name) {
+    const Chunk& chunk = getChunk(name);
+    if (chunk.valueBytes != sizeof(uint64_t)) {
+      throw std::runtime_error("mesh archive is corrupt: bad value size for " + name);
+    }
+    return unpackIndices(chunk.data(), chunk.count);
+  };
+
+  std::vector<size_t> info = getIndices("gc_internal_info");
+  if (info.size() != 2) throw std::runtime_error("mesh archive is corrupt: bad connectivity info");
+  bool useImplicitTwin = info[0] != 0;
+  size_t nBoundaryLoopsFillCount = info[1];
+
+  std::vector<size_t> heNextArr = getIndices("gc_internal_heNextArr");
+  std::vector<size_t> heVertexArr = getIndices("gc_internal_heVertexArr");
+  std::vector<size_t> heFaceArr = getIndices("gc_internal_heFaceArr");
+  std::vector<size_t> vHalfedgeArr = getIndices("gc_internal_vHalfedgeArr");
+  std::vector<size_t> fHalfedgeArr = getIndices("gc_internal_fHalfedgeArr");
+
+  // Check sizes and index ranges, so that a corrupt file cannot send the mesh constructors out of bounds
+  size_t nHalfedges = heNextArr.size();
+  if (heVertexArr.size() != nHalfedges || heFaceArr.size() != nHalfedges ||
+      nBoundaryLoopsFillCount > fHalfedgeArr.size()) {
+    throw std::runtime_error("mesh archive is corrupt: inconsistent connectivity array sizes");
+  }
+  checkIndexRange(heNextArr, nHalfedges, "heNextArr", nThreads);
+  checkIndexRange(heVertexArr, vHalfedgeArr.size(), "heVertexArr", nThreads);
+  checkIndexRange(heFaceArr, fHalfedgeArr.size(), "heFaceArr", nThreads);
+  checkIndexRange(vHalfedgeArr, nHalfedges, "vHalfedgeArr", nThreads);
+  checkIndexRange(fHalfedgeArr, nHalfedges, "fHalfedgeArr", nThreads);
+
+  // Build the actual mesh
+  if (useImplicitTwin) {
+    if (nHalfedges % 2 != 0) {
+      throw std::runtime_error("mesh archive is corrupt: odd number of halfedges in a manifold mesh");
+    }
+    mesh = new ManifoldSurfaceMesh(std::move(heNextArr), std::move(heVertexArr), std::move(heFaceArr),
+                                   std::move(vHalfedgeArr), std::move(fHalfedgeArr), nBoundaryLoopsFillCount);
+  } else {
+    std::vector<size_t> heSiblingArr = getIndices("gc_internal_heSiblingArr");
+    std::vector<size_t> heEdgeArr = getIndices("gc_internal_heEdgeArr");
+    std::vector<size_t> eHalfedgeArr = getIndices("gc_internal_eHalfedgeArr");
+    const Chunk& orientChunk = getChunk("gc_internal_heOrientArr");
+    std::vector<char> heOrientArr(orientChunk.data(), orientChunk.data() + orientChunk.count);
+
+    if (heSiblingArr.size() != nHalfedges || heEdgeArr.size() != nHalfedges || heOrientArr.size() != nHalfedges) {
+      throw std::runtime_error("mesh archive is corrupt: inconsistent connectivity array sizes");
+    }
+    checkIndexRange(heSiblingArr, nHalfedges, "heSiblingArr", nThreads);
+    checkIndexRange(heEdgeArr, eHalfedgeArr.size(), "heEdgeArr", nThreads);
+    checkIndexRange(eHalfedgeArr, nHalfedges, "eHalfedgeArr", nThreads);
+
+    mesh = new SurfaceMesh(std::move(heNextArr), std::move(heVertexArr), std::move(heFaceArr),
+                           std::move(vHalfedgeArr), std::move(fHalfedgeArr), std::move(heSiblingArr),
+                           std::move(heEdgeArr), std::move(heOrientArr), std::move(eHalfedgeArr),
+                           nBoundaryLoopsFillCount);
+  }
+}
+
+std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<MeshArchive>>
+MeshArchive::readMeshAndData(std::string filename, bool verifyChecksums, size_t nThreads) {
+  std::unique_ptr<MeshArchive> data(new MeshArchive(filename, verifyChecksums, nThreads));
+  data->loadMeshFromFile(nThreads);
+  return std::make_tuple(std::unique_ptr<SurfaceMesh>(data->mesh), std::move(data));
+}
+
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<MeshArchive>>
+MeshArchive::readManifoldMeshAndData(std::string filename, bool verifyChecksums, size_t nThreads) {
+  std::unique_ptr<MeshArchive> data(new MeshArchive(filename, verifyChecksums, nThreads));
+  data->loadMeshFromFile(nThreads);
+  ManifoldSurfaceMesh* manifMesh = dynamic_cast<ManifoldSurfaceMesh*>(data->mesh);
+  if (manifMesh == nullptr) {
+    delete data->mesh;
+    throw std::runtime_error("tried to read ManifoldSurfaceMesh, but file was not written from a ManifoldSurfaceMesh");
+  }
+  return std::make_tuple(std::unique_ptr<ManifoldSurfaceMesh>(manifMesh), std::move(data));
+}
+
+void MeshArchive::addConnectivityChunks() {
+
+  // Arrays are written up to their fill counts, so uncompressed meshes keep their element indices. The boundary loops
+  // live at the back of the face buffer, and are moved up to directly follow the faces.
+  auto addIndices = [&](std::string name, std::vector<char>&& bytes) {
+    uint64_t count = bytes.size() / sizeof(uint64_t);
+    addChunk(INTERNAL_PREFIX + name, "uint64", 0, sizeof(uint64_t), count, std::move(bytes));
+  };
+
+  const std::vector<size_t>& fHalfedgeArr = mesh->fHalfedgeArr;
+  std::vector<size_t> fHalfedgeAndBl(fHalfedgeArr.begin(), fHalfedgeArr.begin() + mesh->nFacesFillCount);
+  fHalfedgeAndBl.insert(fHalfedgeAndBl.end(), fHalfedgeArr.end() - mesh->nBoundaryLoopsFillCount, fHalfedgeArr.end());
+
+  // Halfedges refer to boundary loops by their position in the face buffer, so those references move with the loops
+  size_t nHe = mesh->nHalfedgesFillCount;
+  size_t blShift = mesh->nFacesCapacityCount - mesh->nFacesFillCount - mesh->nBoundaryLoopsFillCount;
+  std::vector<size_t> heFaceArr(mesh->heFaceArr.begin(), mesh->heFaceArr.begin() + nHe);
+  if (blShift > 0) {
+    for (size_t& iF : heFaceArr) {
+      if (iF != INVALID_IND && iF >= mesh->nFacesFillCount) iF -= blShift;
+    }
+  }
+
+  std::vector<size_t> info{mesh->usesImplicitTwin() ? 1u : 0u, mesh->nBoundaryLoopsFillCount};
+  addIndices("info", packIndices(info.begin(), info.end()));
+
+  // clang-format off
+  addIndices("heNextArr",    packIndices(mesh->heNextArr.begin(),   mesh->heNextArr.begin() + nHe));
+  addIndices("heVertexArr",  packIndices(mesh->heVertexArr.begin(), mesh->heVertexArr.begin() + nHe));
+  addIndices("heFaceArr",    packIndices(heFaceArr.begin(),         heFaceArr.end()));
+  addIndices("vHalfedgeArr", packIndices(mesh->vHalfedgeArr.begin(), mesh->vHalfedgeArr.begin() + mesh->nVerticesFillCount));
+  addIndices("fHalfedgeArr", packIndices(fHalfedgeAndBl.begin(), fHalfedgeAndBl.end()));
+  if (!mesh->usesImplicitTwin()) {
+    addIndices("heSiblingArr", packIndices(mesh->heSiblingArr.begin(), mesh->heSiblingArr.begin() + nHe));
+    addIndices("heEdgeArr",    packIndices(mesh->heEdgeArr.begin(),    mesh->heEdgeArr.begin() + nHe));
+    addIndices("eHalfedgeArr", packIndices(mesh->eHalfedgeArr.begin(), mesh->eHalfedgeArr.begin() + mesh->nEdgesFillCount));
+    addChunk(INTERNAL_PREFIX + "heOrientArr", "char", 0, 1, nHe,
+             std::vector<char>(mesh->heOrientArr.begin(), mesh->heOrientArr.begin() + nHe));
+  }
+  // clang-format on
+}
+
+void MeshArchive::write(std::string filename, size_t nThreads) {
+  if (!hostIsLittleEndian()) {
+    throw std::runtime_error("mesh archives can only be written on little-endian hosts");
+  }
+
+  std::ofstream out(filename, std::ios::binary);
+  if (!out) throw std::runtime_error("failed to open output file " + filename);
+
+  const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  auto pad = [&](size_t n) { out.write(zeros, paddedSize(n) - n); };
+
+  out.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+  writeRaw<uint32_t>(out, VERSION);
+  writeRaw<uint32_t>(out, 0);
+  writeRaw<uint64_t>(out, chunks.size());
+
+  for (const Chunk& chunk : chunks) {
+    uint64_t payloadBytes = chunk.count * chunk.valueBytes;
+    writeRaw<uint64_t>(out, payloadBytes);
+    writeRaw<uint64_t>(out, chunk.count);
+    writeRaw<uint64_t>(out, checksum(chunk.data(), payloadBytes, nThreads));
+    writeRaw<uint32_t>(out, chunk.elementType);
+    writeRaw<uint32_t>(out, chunk.valueBytes);
+    writeRaw<uint32_t>(out, chunk.name.size());
+    writeRaw<uint32_t>(out, chunk.typeName.size());
+    out << chunk.name << chunk.typeName;
+    pad(chunk.name.size() + chunk.typeName.size());
+    out.write(chunk.data(), payloadBytes);
+    pad(payloadBytes);
+  }
+
+  if (!out) throw std::runtime_error("failed to write mesh archive " + filename);
+}
+
+void MeshArchive::addChunk(std::string name, std::string typeName, uint32_t elementType, uint32_t valueBytes,
+                           uint64_t count, std::vector<char>&& data) {
+  Chunk chunk;
+  chunk.name = name;
+  chunk.typeName = typeName;
+  chunk.elementType = elementType;
+  chunk.valueBytes = valueBytes;
+  chunk.count = count;
+  chunk.ownedData = std::move(data);
+
+  // Replace any existing chunk with the same name
+  for (Chunk& existing : chunks) {
+    if (existing.name == name) {
+      existing = std::move(chunk);
+      return;
+    }
+  }
+  chunks.push_back(std::move(chunk));
+}
+
+const MeshArchive::Chunk& MeshArchive::getChunk(std::string name) const {
+  for (const Chunk& chunk : chunks) {
+    if (chunk.name == name) return chunk;
+  }
+  throw std::runtime_error("mesh archive does not contain property " + name);
+}
+
+bool MeshArchive::hasProperty(std::string propertyName) const {
+  for (const Chunk& chunk : chunks) {
+    if (chunk.name == propertyName) return true;
+  }
+  return false;
+}
+
+std::vector<std::string> MeshArchive::getPropertyNames() const {
+  std::vector<std::string> names;
+  for (const Chunk& chunk : chunks) {
+    if (chunk.name.compare(0, INTERNAL_PREFIX.size(), INTERNAL_PREFIX) != 0) names.push_back(chunk.name);
+  }
+  return names;
+}
+
+void MeshArchive::addGeometry(EmbeddedGeometryInterface& geometry) {
+  geometry.requireVertexPositions();
+  addElementProperty(POSITIONS_NAME, geometry.vertexPositions);
+  geometry.unrequireVertexPositions();
+}
+
+std::unique_ptr<VertexPositionGeometry> MeshArchive::getGeometry() const {
+  VertexData<Vector3> positions = getElementProperty<Vertex, Vector3>(POSITIONS_NAME);
+  return std::unique_ptr<VertexPositionGeometry>(new VertexPositionGeometry(*mesh, positions));
+}
+
+} // namespace surface
+} // namespace geometrycentral
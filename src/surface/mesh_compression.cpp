@@ -0,0 +1,1184 @@
+#include "geometrycentral/surface/mesh_compression.h"
+
+#include "geometrycentral/surface/mapped_mesh_reader.h"
+#include "geometrycentral/utilities/mapped_file.h"
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace geometrycentral {
+namespace surface {
+
+const MeshCompressionOptions defaultMeshCompressionOptions;
+
+namespace {
+
+const char FORMAT_MAGIC[4] = {'G', 'C', 'M', 'Z'};
+const uint32_t FORMAT_VERSION = 1;
+const uint32_t FLAG_PRESERVE_ORDER = 1;
+const size_t POSITION_BLOCK_SIZE = 1 << 14;
+
+void throwCorrupt() { throw std::runtime_error("compressed mesh data is corrupt"); }
+
+// ============================================================
+// =============== Entropy coding
+// ============================================================
+
+// An adaptive binary range coder, in the style of LZMA. Each modeled bit has a probability of being 0, which is updated
+// as bits are coded.
+const uint32_t PROB_BITS = 11;
+const uint16_t PROB_INIT = 1 << (PROB_BITS - 1);
+const uint32_t PROB_ADAPT_SHIFT = 5;
+const uint32_t RANGE_TOP = 1u << 24;
+
+class RangeEncoder {
+public:
+  void encodeBit(uint16_t& prob, uint32_t bit) {
+    uint32_t bound = (range >> PROB_BITS) * prob;
+    if (bit == 0) {
+      range = bound;
+      prob += ((1 << PROB_BITS) - prob) >> PROB_ADAPT_SHIFT;
+    } else {
+      low += bound;
+      range -= bound;
+      prob -= prob >> PROB_ADAPT_SHIFT;
+    }
+    normalize();
+  }
+
+  // Code bits with probability 1/2, without a model
+  void encodeDirect(uint64_t value, int nBits) {
+    for (int i = nBits - 1; i >= 0; i--) {
+      range >>= 1;
+      if ((value >> i) & 1) low += range;
+      normalize();
+    }
+  }
+
+  std::vector<char> finish() {
+    for (int i = 0; i < 5; i++) shiftLow();
+    return std::move(bytes);
+  }
+
+private:
+  void normalize() {
+    while (range < RANGE_TOP) {
+      range <<= 8;
+      shiftLow();
+    }
+  }
+
+  // Emit the top byte of low, holding back runs of 0xFF bytes until it is known whether a carry reaches them
+  void shiftLow() {
+    if (static_cast<uint32_t>(low) < 0xFF000000u || (low >> 32) != 0) {
+      uint8_t carry = static_cast<uint8_t>(low >> 32);
+      uint8_t pending = cache;
+      do {
+        bytes.push_back(static_cast<char>(static_cast<uint8_t>(pending + carry)));
+        pending = 0xFF;
+      } while (--cacheSize != 0);
+      cache = static_cast<uint8_t>(low >> 24);
+    }
+    cacheSize++;
+    low = (low & 0x00FFFFFFu) << 8;
+  }
+
+  uint64_t low = 0;
+  uint32_t range = 0xFFFFFFFFu;
+  uint8_t cache = 0;
+  uint64_t cacheSize = 1;
+  std::vector<char> bytes;
+};
+
+class RangeDecoder {
+public:
+  RangeDecoder(const char* begin, const char* end) : ptr(begin), end(end) {
+    for (int i = 0; i < 5; i++) code = (code << 8) | nextByte();
+  }
+
+  uint32_t decodeBit(uint16_t& prob) {
+    uint32_t bound = (range >> PROB_BITS) * prob;
+    uint32_t bit;
+    if (code < bound) {
+      range = bound;
+      prob += ((1 << PROB_BITS) - prob) >> PROB_ADAPT_SHIFT;
+      bit = 0;
+    } else {
+      code -= bound;
+      range -= bound;
+      prob -= prob >> PROB_ADAPT_SHIFT;
+      bit = 1;
+    }
+    normalize();
+    return bit;
+  }
+
+  uint64_t decodeDirect(int nBits) {
+    uint64_t value = 0;
+    for (int i = 0; i < nBits; i++) {
+      range >>= 1;
+      uint32_t bit = code >= range ? 1 : 0;
+      if (bit) code -= range;
+      value = (value << 1) | bit;
+      normalize();
+    }
+    return value;
+  }
+
+  // Whether decoding has run off the end of the data, which never happens for a valid stream
+  bool exhausted() const { return nPastEnd > 0; }
+
+private:
+  void normalize() {
+    while (range < RANGE_TOP) {
+      range <<= 8;
+      code = (code << 8) | nextByte();
+    }
+  }
+
+  uint32_t nextByte() {
+    if (ptr == end) {
+      nPastEnd++;
+      return 0;
+    }
+    return static_cast<uint8_t>(*ptr++);
+  }
+
+  const char* ptr;
+  const char* end;
+  uint32_t code = 0;
+  uint32_t range = 0xFFFFFFFFu;
+  size_t nPastEnd = 0;
+};
+
+// Code an nBits-bit value one bit at a time, each modeled in the context of the bits above it
+void encodeBitTree(RangeEncoder& enc, uint16_t* probs, int nBits, uint32_t value) {
+  uint32_t node = 1;
+  for (int i = nBits - 1; i >= 0; i--) {
+    uint32_t bit = (value >> i) & 1;
+    enc.encodeBit(probs[node], bit);
+    node = (node << 1) | bit;
+  }
+}
+uint32_t decodeBitTree(RangeDecoder& dec, uint16_t* probs, int nBits) {
+  uint32_t node = 1;
+  for (int i = 0; i < nBits; i++) node = (node << 1) | dec.decodeBit(probs[node]);
+  return node - (1u << nBits);
+}
+
+uint64_t zigzag(int64_t val) { return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63); }
+int64_t unzigzag(uint64_t val) { return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1); }
+
+// An adaptive model for unsigned integers, which codes the bit length of a value, then the bits below its leading one.
+// The highest few of those bits are modeled, and the rest are sent directly.
+const int LENGTH_TREE_BITS = 7;
+const int LENGTH_TREE_SIZE = 1 << LENGTH_TREE_BITS;
+const int MODELED_MANTISSA_BITS = 2;
+const int MANTISSA_TREE_SIZE = 1 << MODELED_MANTISSA_BITS;
+
+class IntegerModel {
+public:
+  IntegerModel() {
+    std::fill(lengthProbs, lengthProbs + LENGTH_TREE_SIZE, PROB_INIT);
+    std::fill(&mantissaProbs[0][0], &mantissaProbs[0][0] + 65 * MANTISSA_TREE_SIZE, PROB_INIT);
+  }
+
+  void encode(RangeEncoder& enc, uint64_t value) {
+    int nBits = 0;
+    while (nBits < 64 && (value >> nBits) != 0) nBits++;
+    encodeBitTree(enc, lengthProbs, LENGTH_TREE_BITS, nBits);
+    if (nBits <= 1) return;
+
+    int nLow = nBits - 1;
+    int nModeled = std::min(nLow, MODELED_MANTISSA_BITS);
+    uint32_t node = 1;
+    for (int i = nLow - 1; i >= nLow - nModeled; i--) {
+      uint32_t bit = (value >> i) & 1;
+      enc.encodeBit(mantissaProbs[nBits][node], bit);
+      node = (node << 1) | bit;
+    }
+    int nDirect = nLow - nModeled;
+    enc.encodeDirect(value & ((uint64_t(1) << nDirect) - 1), nDirect);
+  }
+
+  uint64_t decode(RangeDecoder& dec) {
+    int nBits = static_cast<int>(decodeBitTree(dec, lengthProbs, LENGTH_TREE_BITS));
+    if (nBits > 64) throwCorrupt();
+    if (nBits <= 1) return nBits;
+
+    int nLow = nBits - 1;
+    int nModeled = std::min(nLow, MODELED_MANTISSA_BITS);
+    uint64_t value = 1;
+    uint32_t node = 1;
+    for (int i = 0; i < nModeled; i++) {
+      uint32_t bit = dec.decodeBit(mantissaProbs[nBits][node]);
+      node = (node << 1) | bit;
+      value = (value << 1) | bit;
+    }
+    int nDirect = nLow - nModeled;
+    return (value << nDirect) | dec.decodeDirect(nDirect);
+  }
+
+private:
+  uint16_t lengthProbs[LENGTH_TREE_SIZE];
+  uint16_t mantissaProbs[65][MANTISSA_TREE_SIZE];
+};
+
+// ============================================================
+// =============== Connectivity traversal
+// ============================================================
+
+// The faces and boundary loops of a connected component ("records") are visited one at a time, across the halfedges of
+// a front. At each step the front's gate halfedge is matched with its twin, which is either the first halfedge of an
+// unvisited record (FACE / HOLE, followed by its degree), or another halfedge on the front: the next one (RIGHT), the
+// previous one (LEFT), the only other one (END), one further along the same loop, which splits the loop in two (SPLIT),
+// or one in a loop waiting on the stack, which merges the loops (MERGE). Each step pairs exactly one edge, and the
+// decoder replays the same steps to recover the twin of every halfedge.
+enum TraversalOp : uint32_t { OP_FACE = 0, OP_HOLE, OP_RIGHT, OP_LEFT, OP_END, OP_SPLIT, OP_MERGE, N_TRAVERSAL_OPS };
+
+// The models for the traversal of one component
+struct TraversalModel {
+  TraversalModel() {
+    std::fill(&opProbs[0][0], &opProbs[0][0] + (N_TRAVERSAL_OPS + 1) * 8, PROB_INIT);
+  }
+
+  void encodeOp(RangeEncoder& enc, uint32_t op) {
+    encodeBitTree(enc, opProbs[prevOp], 3, op);
+    prevOp = op;
+  }
+  uint32_t decodeOp(RangeDecoder& dec) {
+    uint32_t op = decodeBitTree(dec, opProbs[prevOp], 3);
+    if (op >= N_TRAVERSAL_OPS) throwCorrupt();
+    prevOp = op;
+    return op;
+  }
+
+  uint16_t opProbs[N_TRAVERSAL_OPS + 1][8]; // each op is modeled in the context of the previous one
+  uint32_t prevOp = N_TRAVERSAL_OPS;
+  uint16_t splitDirection = PROB_INIT;
+  IntegerModel faceDegree;
+  IntegerModel holeDegree;
+  IntegerModel splitDistance;
+  IntegerModel mergeLoop;
+  IntegerModel mergeOffset;
+};
+
+// The records of a component in traversal order. The halfedges of each record are numbered consecutively, starting
+// from the one the record was reached through.
+struct ComponentLayout {
+  ComponentLayout() : recordStart(1, 0) {}
+
+  std::vector<size_t> recordStart; // record r has halfedges recordStart[r] ... recordStart[r+1]-1
+  std::vector<char> recordIsHole;
+  std::vector<size_t> recordGate; // the halfedge of an earlier record it was reached through (INVALID_IND for the seed)
+  std::vector<size_t> heTwin;
+  std::vector<size_t> heRecord;
+  size_t nFaces = 0; // records which are not holes
+
+  // Filled by numberVertices()
+  std::vector<size_t> heVertex; // the tail vertex of each halfedge
+  std::vector<size_t> vertexFirstHalfedge;
+
+  size_t nRecords() const { return recordIsHole.size(); }
+  size_t nHalfedges() const { return heTwin.size(); }
+  size_t nVertices() const { return vertexFirstHalfedge.size(); }
+
+  // Returns the first halfedge of the new record
+  size_t addRecord(size_t degree, bool isHole, size_t gate) {
+    size_t first = nHalfedges();
+    size_t iRecord = nRecords();
+    recordStart.push_back(first + degree);
+    recordIsHole.push_back(isHole);
+    recordGate.push_back(gate);
+    heTwin.resize(first + degree, INVALID_IND);
+    heRecord.resize(first + degree, iRecord);
+    if (!isHole) nFaces++;
+    return first;
+  }
+
+  size_t prev(size_t he) const {
+    size_t iRecord = heRecord[he];
+    return he == recordStart[iRecord] ? recordStart[iRecord + 1] - 1 : he - 1;
+  }
+
+  void pair(size_t heA, size_t heB) {
+    if (heTwin[heA] != INVALID_IND || heTwin[heB] != INVALID_IND) throwCorrupt();
+    heTwin[heA] = heB;
+    heTwin[heB] = heA;
+  }
+};
+
+// Number the vertices of a component in order of first appearance, reading the faces in traversal order. Each vertex
+// is found by walking around it from one of its halfedges.
+void numberVertices(ComponentLayout& layout) {
+  layout.heVertex.assign(layout.nHalfedges(), INVALID_IND);
+  layout.vertexFirstHalfedge.clear();
+  for (size_t iRecord = 0; iRecord < layout.nRecords(); iRecord++) {
+    if (layout.recordIsHole[iRecord]) continue;
+    for (size_t he = layout.recordStart[iRecord]; he < layout.recordStart[iRecord + 1]; he++) {
+      if (layout.heVertex[he] != INVALID_IND) continue;
+      size_t iV = layout.vertexFirstHalfedge.size();
+      layout.vertexFirstHalfedge.push_back(he);
+      size_t heOut = he;
+      do {
+        layout.heVertex[heOut] = iV;
+        heOut = layout.heTwin[layout.prev(heOut)];
+      } while (heOut != he);
+    }
+  }
+}
+
+// The halfedges of visited records whose twins have not been reached, as loops. The loops are doubly-linked lists, and
+// loops other than the current one wait on a stack.
+struct FrontLoop {
+  size_t gate;
+  size_t size;
+};
+
+class TraversalFront {
+public:
+  void resize(size_t nHalfedges) {
+    next.resize(nHalfedges);
+    prev.resize(nHalfedges);
+    isStackGate.resize(nHalfedges, false);
+  }
+
+  bool done() const { return current.size == 0; }
+  size_t gate() const { return current.gate; }
+  size_t size() const { return current.size; }
+  size_t nextOf(size_t he) const { return next[he]; }
+  size_t prevOf(size_t he) const { return prev[he]; }
+  const std::vector<FrontLoop>& loopStack() const { return stack; }
+  bool isGateOfStackedLoop(size_t he) const { return isStackGate[he]; }
+
+  size_t walk(size_t he, size_t nSteps, bool forward) const {
+    for (size_t i = 0; i < nSteps; i++) he = forward ? next[he] : prev[he];
+    return he;
+  }
+
+  // Make the halfedges first ... first+n-1 the current loop
+  void start(size_t first, size_t n) {
+    for (size_t i = 0; i < n; i++) link(first + i, first + (i + 1) % n);
+    current = FrontLoop{first, n};
+  }
+
+  // The gate was matched with a new record: replace it by the record's other halfedges first ... first+n-1
+  void replaceGate(size_t first, size_t n) {
+    size_t g = current.gate;
+    if (current.size == 1) {
+      start(first, n);
+      return;
+    }
+    size_t before = prev[g];
+    size_t after = next[g];
+    link(before, first);
+    for (size_t i = 0; i + 1 < n; i++) link(first + i, first + i + 1);
+    link(first + n - 1, after);
+    current = FrontLoop{first, current.size + n - 1};
+  }
+
+  // The gate was matched with the next halfedge of the loop
+  void zipRight() {
+    size_t g = current.gate;
+    size_t before = prev[g];
+    size_t after = next[next[g]];
+    link(before, after);
+    current = FrontLoop{after, current.size - 2};
+  }
+
+  // The gate was matched with the previous halfedge of the loop
+  void zipLeft() {
+    size_t g = current.gate;
+    size_t before = prev[prev[g]];
+    size_t after = next[g];
+    link(before, after);
+    current = FrontLoop{after, current.size - 2};
+  }
+
+  // The gate was matched with the only other halfedge of the loop
+  void endLoop() { popLoop(); }
+
+  // The gate was matched with the halfedge `distance` steps ahead in the loop, splitting it into the halfedges in
+  // between, which become the current loop, and those beyond, which are pushed on the stack
+  void split(size_t twin, size_t distance) {
+    size_t g = current.gate;
+    size_t firstBetween = next[g];
+    size_t lastBetween = prev[twin];
+    size_t firstBeyond = next[twin];
+    size_t lastBeyond = prev[g];
+    link(lastBetween, firstBetween);
+    link(lastBeyond, firstBeyond);
+    pushLoop(FrontLoop{firstBeyond, current.size - distance - 1});
+    current = FrontLoop{firstBetween, distance - 1};
+  }
+
+  // The gate was matched with a halfedge of the stacked loop iLoop, joining the two loops into one
+  void merge(size_t iLoop, size_t twin) {
+    FrontLoop other = stack[iLoop];
+    isStackGate[other.gate] = false;
+    stack.erase(stack.begin() + iLoop);
+
+    size_t g = current.gate;
+    size_t nCurrent = current.size - 1;
+    size_t nOther = other.size - 1;
+    if (nCurrent > 0 && nOther > 0) {
+      size_t firstCurrent = next[g];
+      size_t lastCurrent = prev[g];
+      size_t firstOther = next[twin];
+      size_t lastOther = prev[twin];
+      link(lastCurrent, firstOther);
+      link(lastOther, firstCurrent);
+      current = FrontLoop{firstCurrent, nCurrent + nOther};
+    } else if (nCurrent > 0) {
+      link(prev[g], next[g]);
+      current = FrontLoop{next[g], nCurrent};
+    } else if (nOther > 0) {
+      link(prev[twin], next[twin]);
+      current = FrontLoop{next[twin], nOther};
+    } else {
+      popLoop();
+    }
+  }
+
+private:
+  void link(size_t heA, size_t heB) {
+    next[heA] = heB;
+    prev[heB] = heA;
+  }
+
+  void pushLoop(FrontLoop loop) {
+    isStackGate[loop.gate] = true;
+    stack.push_back(loop);
+  }
+
+  // Continue with the loop on top of the stack, if there is one
+  void popLoop() {
+    current = FrontLoop{INVALID_IND, 0};
+    if (stack.empty()) return;
+    current = stack.back();
+    stack.pop_back();
+    isStackGate[current.gate] = false;
+  }
+
+  std::vector<size_t> next;
+  std::vector<size_t> prev;
+  std::vector<char> isStackGate;
+  std::vector<FrontLoop> stack;
+  FrontLoop current{INVALID_IND, 0};
+};
+
+// Encode the connected component containing seed, recording its traversal in layout. layoutHalfedges[i] is the mesh
+// halfedge for halfedge i of the layout, and localIndex the reverse map (which may be shared by several components).
+std::vector<char> encodeComponent(Face seed, HalfedgeData<size_t>& localIndex, ComponentLayout& layout,
+                                  std::vector<Halfedge>& layoutHalfedges) {
+  RangeEncoder enc;
+  TraversalModel model;
+  TraversalFront front;
+
+  auto addRecord = [&](Halfedge first, size_t gate) {
+    size_t degree = 0;
+    Halfedge he = first;
+    do {
+      degree++;
+      he = he.next();
+    } while (he != first);
+
+    size_t start = layout.addRecord(degree, !first.isInterior(), gate);
+    for (size_t i = 0; i < degree; i++) {
+      localIndex[he] = start + i;
+      layoutHalfedges.push_back(he);
+      he = he.next();
+    }
+    front.resize(layout.nHalfedges());
+    return start;
+  };
+
+  addRecord(seed.halfedge(), INVALID_IND);
+  model.faceDegree.encode(enc, layout.nHalfedges() - 2);
+  front.start(0, layout.nHalfedges());
+
+  while (!front.done()) {
+    size_t g = front.gate();
+    Halfedge twinHe = layoutHalfedges[g].twin();
+    size_t twin = localIndex[twinHe];
+
+    if (twin == INVALID_IND) {
+      bool isHole = !twinHe.isInterior();
+      twin = addRecord(twinHe, g);
+      size_t degree = layout.nHalfedges() - twin;
+      model.encodeOp(enc, isHole ? OP_HOLE : OP_FACE);
+      (isHole ? model.holeDegree : model.faceDegree).encode(enc, degree - 2);
+      layout.pair(g, twin);
+      front.replaceGate(twin + 1, degree - 1);
+      continue;
+    }
+
+    layout.pair(g, twin);
+    if (front.size() == 2) {
+      model.encodeOp(enc, OP_END);
+      front.endLoop();
+    } else if (front.nextOf(g) == twin) {
+      model.encodeOp(enc, OP_RIGHT);
+      front.zipRight();
+    } else if (front.prevOf(g) == twin) {
+      model.encodeOp(enc, OP_LEFT);
+      front.zipLeft();
+    } else {
+      // Look for the twin in the current loop, in both directions at once
+      size_t ahead = front.nextOf(g);
+      size_t behind = front.prevOf(g);
+      size_t distance = 0;
+      bool backward = false;
+      for (size_t i = 2; i <= front.size() / 2; i++) {
+        ahead = front.nextOf(ahead);
+        behind = front.prevOf(behind);
+        if (ahead == twin || behind == twin) {
+          distance = i;
+          backward = behind == twin;
+          break;
+        }
+      }
+
+      if (distance > 0) {
+        model.encodeOp(enc, OP_SPLIT);
+        enc.encodeBit(model.splitDirection, backward);
+        model.splitDistance.encode(enc, distance - 2);
+        front.split(twin, backward ? front.size() - distance : distance);
+      } else {
+        // The twin is in a stacked loop; find which one by walking to its gate
+        size_t nSteps = 0;
+        size_t he = twin;
+        while (!front.isGateOfStackedLoop(he)) {
+          he = front.nextOf(he);
+          nSteps++;
+        }
+        const std::vector<FrontLoop>& stack = front.loopStack();
+        size_t iLoop = stack.size() - 1;
+        while (stack[iLoop].gate != he) iLoop--;
+
+        model.encodeOp(enc, OP_MERGE);
+        model.mergeLoop.encode(enc, stack.size() - 1 - iLoop);
+        model.mergeOffset.encode(enc, (stack[iLoop].size - nSteps) % stack[iLoop].size);
+        front.merge(iLoop, twin);
+      }
+    }
+  }
+
+  return enc.finish();
+}
+
+// Replay the traversal of one component, checking every step against the sizes given in the header
+void decodeComponent(const char* begin, const char* end, size_t nRecords, size_t nHalfedges,
+                     ComponentLayout& layout) {
+  RangeDecoder dec(begin, end);
+  TraversalModel model;
+  TraversalFront front;
+
+  auto addRecord = [&](uint64_t degreeCode, bool isHole, size_t gate) {
+    if (layout.nRecords() == nRecords || degreeCode > nHalfedges || degreeCode + 2 > nHalfedges - layout.nHalfedges()) {
+      throwCorrupt();
+    }
+    size_t start = layout.addRecord(degreeCode + 2, isHole, gate);
+    front.resize(layout.nHalfedges());
+    return start;
+  };
+
+  addRecord(model.faceDegree.decode(dec), false, INVALID_IND);
+  front.start(0, layout.nHalfedges());
+
+  while (!front.done()) {
+    if (dec.exhausted()) throwCorrupt();
+
+    uint32_t op = model.decodeOp(dec);
+    size_t g = front.gate();
+    size_t size = front.size();
+    switch (op) {
+    case OP_FACE:
+    case OP_HOLE: {
+      bool isHole = op == OP_HOLE;
+      size_t twin = addRecord((isHole ? model.holeDegree : model.faceDegree).decode(dec), isHole, g);
+      layout.pair(g, twin);
+      front.replaceGate(twin + 1, layout.nHalfedges() - twin - 1);
+      break;
+    }
+    case OP_END:
+      if (size != 2) throwCorrupt();
+      layout.pair(g, front.nextOf(g));
+      front.endLoop();
+      break;
+    case OP_RIGHT:
+      if (size < 3) throwCorrupt();
+      layout.pair(g, front.nextOf(g));
+      front.zipRight();
+      break;
+    case OP_LEFT:
+      if (size < 3) throwCorrupt();
+      layout.pair(g, front.prevOf(g));
+      front.zipLeft();
+      break;
+    case OP_SPLIT: {
+      bool backward = dec.decodeBit(model.splitDirection);
+      uint64_t distance = model.splitDistance.decode(dec);
+      if (size < 4 || distance > size - 4) throwCorrupt();
+      distance += 2;
+      size_t twin = front.walk(g, distance, !backward);
+      layout.pair(g, twin);
+      front.split(twin, backward ? size - distance : distance);
+      break;
+    }
+    case OP_MERGE: {
+      uint64_t iFromTop = model.mergeLoop.decode(dec);
+      uint64_t offset = model.mergeOffset.decode(dec);
+      const std::vector<FrontLoop>& stack = front.loopStack();
+      if (iFromTop >= stack.size()) throwCorrupt();
+      size_t iLoop = stack.size() - 1 - iFromTop;
+      if (offset >= stack[iLoop].size) throwCorrupt();
+      size_t twin = front.walk(stack[iLoop].gate, offset, true);
+      layout.pair(g, twin);
+      front.merge(iLoop, twin);
+      break;
+    }
+    default:
+      throwCorrupt();
+    }
+  }
+
+  // Every halfedge left the front paired, so the layout is complete if the counts match
+  if (layout.nRecords() != nRecords || layout.nHalfedges() != nHalfedges || dec.exhausted()) throwCorrupt();
+}
+
+// ============================================================
+// =============== Positions
+// ============================================================
+
+// Predict the quantized position of vertex iV from vertices before it in its block, following the face where it first
+// appears: the third vertex of a face is predicted by completing a parallelogram with the face it was reached from,
+// later vertices by translating the previous one along the face's first edge, and otherwise the nearest available
+// vertex is used.
+void predictPosition(const std::vector<ComponentLayout>& components, const std::vector<size_t>& vertexOffset,
+                     size_t iComponent, size_t iV, size_t blockStart, const std::vector<int64_t>& quantized,
+                     int64_t* prediction) {
+  const ComponentLayout& layout = components[iComponent];
+  size_t base = vertexOffset[iComponent];
+  size_t heFirst = layout.vertexFirstHalfedge[iV - base];
+  size_t iRecord = layout.heRecord[heFirst];
+  size_t recordStart = layout.recordStart[iRecord];
+  size_t iInFace = heFirst - recordStart;
+
+  auto vertexAt = [&](size_t he) { return layout.heVertex[he] + base; };
+  auto available = [&](size_t jV) { return jV >= blockStart && jV < iV; };
+  auto combine = [&](size_t jA, size_t jB, size_t jC) { // A + B - C
+    for (int k = 0; k < 3; k++) {
+      prediction[k] = quantized[3 * jA + k] + quantized[3 * jB + k] - quantized[3 * jC + k];
+    }
+  };
+  auto copy = [&](size_t jV) {
+    for (int k = 0; k < 3; k++) prediction[k] = quantized[3 * jV + k];
+  };
+
+  size_t gate = layout.recordGate[iRecord];
+  if (iInFace == 2 && gate != INVALID_IND && !layout.recordIsHole[layout.heRecord[gate]]) {
+    size_t jA = vertexAt(recordStart);
+    size_t jB = vertexAt(recordStart + 1);
+    size_t jOpposite = vertexAt(layout.prev(gate));
+    if (available(jA) && available(jB) && available(jOpposite)) {
+      combine(jA, jB, jOpposite);
+      return;
+    }
+  }
+  if (iInFace >= 3) {
+    size_t jPrev = vertexAt(heFirst - 1);
+    size_t jA = vertexAt(recordStart);
+    size_t jB = vertexAt(recordStart + 1);
+    if (available(jPrev) && available(jA) && available(jB)) {
+      combine(jPrev, jA, jB);
+      return;
+    }
+  }
+  for (size_t i = iInFace; i > 0; i--) {
+    size_t jV = vertexAt(recordStart + i - 1);
+    if (available(jV)) {
+      copy(jV);
+      return;
+    }
+  }
+  if (iV > blockStart) {
+    copy(iV - 1);
+    return;
+  }
+  prediction[0] = prediction[1] = prediction[2] = 0;
+}
+
+size_t componentOfVertex(const std::vector<size_t>& vertexOffset, size_t iV) {
+  return std::upper_bound(vertexOffset.begin(), vertexOffset.end(), iV) - vertexOffset.begin() - 1;
+}
+
+std::vector<char> encodePositionBlock(const std::vector<ComponentLayout>& components,
+                                      const std::vector<size_t>& vertexOffset, size_t blockStart, size_t blockEnd,
+                                      const std::vector<int64_t>& quantized) {
+  RangeEncoder enc;
+  IntegerModel residualModels[3];
+  size_t iComponent = componentOfVertex(vertexOffset, blockStart);
+  for (size_t iV = blockStart; iV < blockEnd; iV++) {
+    while (iV >= vertexOffset[iComponent + 1]) iComponent++;
+    int64_t prediction[3];
+    predictPosition(components, vertexOffset, iComponent, iV, blockStart, quantized, prediction);
+    for (int k = 0; k < 3; k++) residualModels[k].encode(enc, zigzag(quantized[3 * iV + k] - prediction[k]));
+  }
+  return enc.finish();
+}
+
+void decodePositionBlock(const char* begin, const char* end, const std::vector<ComponentLayout>& components,
+                         const std::vector<size_t>& vertexOffset, size_t blockStart, size_t blockEnd, int64_t maxValue,
+                         std::vector<int64_t>& quantized) {
+  RangeDecoder dec(begin, end);
+  IntegerModel residualModels[3];
+  size_t iComponent = componentOfVertex(vertexOffset, blockStart);
+  for (size_t iV = blockStart; iV < blockEnd; iV++) {
+    while (iV >= vertexOffset[iComponent + 1]) iComponent++;
+    int64_t prediction[3];
+    predictPosition(components, vertexOffset, iComponent, iV, blockStart, quantized, prediction);
+    for (int k = 0; k < 3; k++) {
+      int64_t value = prediction[k] + unzigzag(residualModels[k].decode(dec));
+      if (value < 0 || value > maxValue) throwCorrupt();
+      quantized[3 * iV + k] = value;
+    }
+  }
+  if (dec.exhausted()) throwCorrupt();
+}
+
+// ============================================================
+// =============== Container
+// ============================================================
+
+void putU32(std::vector<char>& out, uint32_t val) {
+  for (int i = 0; i < 4; i++) out.push_back(static_cast<char>((val >> (8 * i)) & 0xFF));
+}
+void putU64(std::vector<char>& out, uint64_t val) {
+  for (int i = 0; i < 8; i++) out.push_back(static_cast<char>((val >> (8 * i)) & 0xFF));
+}
+void putDouble(std::vector<char>& out, double val) {
+  uint64_t bits;
+  std::memcpy(&bits, &val, sizeof(double));
+  putU64(out, bits);
+}
+
+class ByteReader {
+public:
+  ByteReader(const char* begin, const char* end) : ptr(begin), end(end) {}
+
+  const char* take(uint64_t nBytes) {
+    if (nBytes > static_cast<uint64_t>(end - ptr)) {
+      throw std::runtime_error("compressed mesh data is truncated");
+    }
+    const char* data = ptr;
+    ptr += nBytes;
+    return data;
+  }
+  uint64_t readUnsigned(int nBytes) {
+    const char* data = take(nBytes);
+    uint64_t val = 0;
+    for (int i = 0; i < nBytes; i++) val |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    return val;
+  }
+  uint32_t u32() { return static_cast<uint32_t>(readUnsigned(4)); }
+  uint64_t u64() { return readUnsigned(8); }
+  double f64() {
+    uint64_t bits = u64();
+    double val;
+    std::memcpy(&val, &bits, sizeof(double));
+    return val;
+  }
+
+private:
+  const char* ptr;
+  const char* end;
+};
+
+size_t nPositionBlocks(size_t nVertices) { return (nVertices + POSITION_BLOCK_SIZE - 1) / POSITION_BLOCK_SIZE; }
+
+} // namespace
+
+
+std::vector<char> compressSurfaceMesh(ManifoldSurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                      const MeshCompressionOptions& options, MeshCompressionStats* stats) {
+  if (options.positionBits < 1 || options.positionBits > 31) {
+    throw std::runtime_error("mesh compression positionBits must be between 1 and 31");
+  }
+  size_t nThreads = options.nThreads;
+  VertexData<size_t> vertexIndices = mesh.getVertexIndices();
+  FaceData<size_t> faceIndices = mesh.getFaceIndices();
+
+  // Meshes are rebuilt from face lists when decoding, which cannot express several edges joining the same vertices
+  {
+    std::vector<size_t> lastNeighborOf(mesh.nVertices(), INVALID_IND);
+    for (Vertex v : mesh.vertices()) {
+      for (Halfedge he : v.outgoingHalfedges()) {
+        size_t iTip = vertexIndices[he.tipVertex()];
+        if (iTip == vertexIndices[v] || lastNeighborOf[iTip] == vertexIndices[v]) {
+          throw std::runtime_error("cannot compress a mesh with several edges between the same pair of vertices");
+        }
+        lastNeighborOf[iTip] = vertexIndices[v];
+      }
+    }
+  }
+
+  // Find a seed face for each connected component
+  std::vector<Face> seeds;
+  {
+    FaceData<char> reached(mesh, false);
+    std::vector<Face> toVisit;
+    for (Face f : mesh.faces()) {
+      if (reached[f]) continue;
+      seeds.push_back(f);
+      reached[f] = true;
+      toVisit.push_back(f);
+      while (!toVisit.empty()) {
+        Face fVisit = toVisit.back();
+        toVisit.pop_back();
+        for (Halfedge he : fVisit.adjacentHalfedges()) {
+          Halfedge heTwin = he.twin();
+          if (heTwin.isInterior() && !reached[heTwin.face()]) {
+            reached[heTwin.face()] = true;
+            toVisit.push_back(heTwin.face());
+          }
+        }
+      }
+    }
+  }
+
+  // Traverse the components
+  size_t nComponents = seeds.size();
+  std::vector<ComponentLayout> components(nComponents);
+  std::vector<std::vector<Halfedge>> componentHalfedges(nComponents);
+  std::vector<std::vector<char>> connectivityStreams(nComponents);
+  HalfedgeData<size_t> localIndex(mesh, INVALID_IND);
+  parallelFor(nComponents, nThreads, [&](size_t iComp) {
+    connectivityStreams[iComp] =
+        encodeComponent(seeds[iComp], localIndex, components[iComp], componentHalfedges[iComp]);
+    numberVertices(components[iComp]);
+  });
+
+  std::vector<size_t> vertexOffset(nComponents + 1);
+  for (size_t iComp = 0; iComp < nComponents; iComp++) vertexOffset[iComp] = components[iComp].nVertices();
+  size_t nVertices = parallelExclusiveScan(vertexOffset, nThreads);
+  if (nVertices != mesh.nVertices()) {
+    throw std::runtime_error("cannot compress a mesh with vertices which are not in any face");
+  }
+
+  // The mesh vertex at each position of the traversal order
+  std::vector<Vertex> traversalVertices(nVertices);
+  parallelFor(nComponents, nThreads, [&](size_t iComp) {
+    const ComponentLayout& layout = components[iComp];
+    for (size_t iV = 0; iV < layout.nVertices(); iV++) {
+      traversalVertices[vertexOffset[iComp] + iV] = componentHalfedges[iComp][layout.vertexFirstHalfedge[iV]].vertex();
+    }
+  });
+
+  // Quantize positions to a grid over the bounding box
+  geometry.requireVertexPositions();
+  Vector3 boundMin{0., 0., 0.};
+  Vector3 boundMax{0., 0., 0.};
+  for (size_t iV = 0; iV < nVertices; iV++) {
+    Vector3 p = geometry.vertexPositions[traversalVertices[iV]];
+    if (!isfinite(p)) throw std::runtime_error("cannot compress a mesh with non-finite vertex positions");
+    boundMin = iV == 0 ? p : componentwiseMin(boundMin, p);
+    boundMax = iV == 0 ? p : componentwiseMax(boundMax, p);
+  }
+  Vector3 extent = boundMax - boundMin;
+  int64_t maxValue = (int64_t(1) << options.positionBits) - 1;
+  double cellSize = std::max(extent.x, std::max(extent.y, extent.z)) / maxValue;
+
+  std::vector<int64_t> quantized(3 * nVertices);
+  std::vector<double> quantizationError(nVertices);
+  parallelFor(
+      nVertices, nThreads,
+      [&](size_t iV) {
+        Vector3 p = geometry.vertexPositions[traversalVertices[iV]];
+        Vector3 pQuantized = boundMin;
+        for (int k = 0; k < 3; k++) {
+          int64_t val = 0;
+          if (cellSize > 0) {
+            val = std::llround((p[k] - boundMin[k]) / cellSize);
+            val = std::min(std::max(val, int64_t(0)), maxValue);
+          }
+          quantized[3 * iV + k] = val;
+          pQuantized[k] += val * cellSize;
+        }
+        quantizationError[iV] = norm(p - pQuantized);
+      },
+      1 << 14);
+  geometry.unrequireVertexPositions();
+
+  std::vector<std::vector<char>> positionStreams(nPositionBlocks(nVertices));
+  parallelFor(positionStreams.size(), nThreads, [&](size_t iBlock) {
+    size_t blockStart = iBlock * POSITION_BLOCK_SIZE;
+    size_t blockEnd = std::min(nVertices, blockStart + POSITION_BLOCK_SIZE);
+    positionStreams[iBlock] = encodePositionBlock(components, vertexOffset, blockStart, blockEnd, quantized);
+  });
+
+  // The original index of each vertex and face in traversal order, and the offset of each face's first halfedge
+  std::vector<char> orderStream;
+  if (options.preserveElementOrder) {
+    RangeEncoder enc;
+    IntegerModel vertexModel, faceModel, rotationModel;
+    int64_t prevIndex = 0;
+    for (size_t iV = 0; iV < nVertices; iV++) {
+      int64_t index = vertexIndices[traversalVertices[iV]];
+      vertexModel.encode(enc, zigzag(index - prevIndex));
+      prevIndex = index;
+    }
+    prevIndex = 0;
+    for (size_t iComp = 0; iComp < nComponents; iComp++) {
+      const ComponentLayout& layout = components[iComp];
+      for (size_t iRecord = 0; iRecord < layout.nRecords(); iRecord++) {
+        if (layout.recordIsHole[iRecord]) continue;
+        Face f = componentHalfedges[iComp][layout.recordStart[iRecord]].face();
+        int64_t index = faceIndices[f];
+        faceModel.encode(enc, zigzag(index - prevIndex));
+        rotationModel.encode(enc, localIndex[f.halfedge()] - layout.recordStart[iRecord]);
+        prevIndex = index;
+      }
+    }
+    orderStream = enc.finish();
+  }
+
+  // Assemble the header and streams
+  std::vector<char> out(FORMAT_MAGIC, FORMAT_MAGIC + 4);
+  putU32(out, FORMAT_VERSION);
+  putU32(out, options.preserveElementOrder ? FLAG_PRESERVE_ORDER : 0);
+  putU32(out, options.positionBits);
+  for (int k = 0; k < 3; k++) putDouble(out, boundMin[k]);
+  putDouble(out, cellSize);
+  putU64(out, nVertices);
+  putU64(out, mesh.nFaces());
+  putU64(out, nComponents);
+  for (size_t iComp = 0; iComp < nComponents; iComp++) {
+    putU64(out, components[iComp].nRecords());
+    putU64(out, components[iComp].nHalfedges());
+    putU64(out, components[iComp].nVertices());
+    putU64(out, connectivityStreams[iComp].size());
+  }
+  for (const std::vector<char>& stream : positionStreams) putU64(out, stream.size());
+  putU64(out, orderStream.size());
+  size_t headerBytes = out.size();
+
+  size_t connectivityBytes = 0;
+  size_t positionBytes = 0;
+  for (const std::vector<char>& stream : connectivityStreams) {
+    out.insert(out.end(), stream.begin(), stream.end());
+    connectivityBytes += stream.size();
+  }
+  for (const std::vector<char>& stream : positionStreams) {
+    out.insert(out.end(), stream.begin(), stream.end());
+    positionBytes += stream.size();
+  }
+  out.insert(out.end(), orderStream.begin(), orderStream.end());
+
+  if (stats != nullptr) {
+    stats->compressedBytes = out.size();
+    stats->connectivityBytes = connectivityBytes + headerBytes;
+    stats->positionBytes = positionBytes;
+    stats->orderBytes = orderStream.size();
+    stats->uncompressedBytes = 3 * sizeof(double) * nVertices;
+    for (Face f : mesh.faces()) stats->uncompressedBytes += 1 + sizeof(int32_t) * f.degree();
+    stats->compressionRatio = static_cast<double>(stats->uncompressedBytes) / out.size();
+    stats->maxPositionError = 0.;
+    for (double err : quantizationError) stats->maxPositionError = std::max(stats->maxPositionError, err);
+  }
+
+  return out;
+}
+
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+decompressSurfaceMesh(const char* data, size_t nBytes, size_t nThreads) {
+  ByteReader reader(data, data + nBytes);
+
+  // Header
+  if (std::memcmp(reader.take(4), FORMAT_MAGIC, 4) != 0) {
+    throw std::runtime_error("data is not a compressed mesh");
+  }
+  uint32_t version = reader.u32();
+  if (version > FORMAT_VERSION) {
+    throw std::runtime_error("compressed mesh has format version " + std::to_string(version) +
+                             ", which is newer than this reader");
+  }
+  bool preserveOrder = (reader.u32() & FLAG_PRESERVE_ORDER) != 0;
+  uint32_t positionBits = reader.u32();
+  if (positionBits < 1 || positionBits > 31) throwCorrupt();
+  Vector3 boundMin;
+  for (int k = 0; k < 3; k++) boundMin[k] = reader.f64();
+  double cellSize = reader.f64();
+  uint64_t nVertices = reader.u64();
+  uint64_t nFaces = reader.u64();
+  uint64_t nComponents = reader.u64();
+
+  // Each component and block takes at least a few bytes, so these cannot be too large for the data
+  if (nComponents > nBytes || nPositionBlocks(nVertices) > nBytes) throwCorrupt();
+  std::vector<uint64_t> componentRecords(nComponents), componentHalfedges(nComponents);
+  std::vector<size_t> vertexOffset(nComponents + 1, 0);
+  std::vector<uint64_t> connectivityBytes(nComponents);
+  for (size_t iComp = 0; iComp < nComponents; iComp++) {
+    componentRecords[iComp] = reader.u64();
+    componentHalfedges[iComp] = reader.u64();
+    uint64_t nComponentVertices = reader.u64();
+    connectivityBytes[iComp] = reader.u64();
+    if (nComponentVertices > nVertices - vertexOffset[iComp]) throwCorrupt();
+    vertexOffset[iComp + 1] = vertexOffset[iComp] + nComponentVertices;
+  }
+  if (vertexOffset.back() != nVertices) throwCorrupt();
+  std::vector<uint64_t> positionBytes(nPositionBlocks(nVertices));
+  for (uint64_t& size : positionBytes) size = reader.u64();
+  uint64_t orderBytes = reader.u64();
+
+  // Locate the streams
+  std::vector<const char*> connectivityData(nComponents), positionData(positionBytes.size());
+  for (size_t iComp = 0; iComp < nComponents; iComp++) connectivityData[iComp] = reader.take(connectivityBytes[iComp]);
+  for (size_t iBlock = 0; iBlock < positionBytes.size(); iBlock++) positionData[iBlock] = reader.take(positionBytes[iBlock]);
+  const char* orderData = reader.take(orderBytes);
+
+  // Connectivity
+  std::vector<ComponentLayout> components(nComponents);
+  parallelFor(nComponents, nThreads, [&](size_t iComp) {
+    ComponentLayout& layout = components[iComp];
+    decodeComponent(connectivityData[iComp], connectivityData[iComp] + connectivityBytes[iComp],
+                    componentRecords[iComp], componentHalfedges[iComp], layout);
+    numberVertices(layout);
+    if (layout.nVertices() != vertexOffset[iComp + 1] - vertexOffset[iComp]) throwCorrupt();
+  });
+  std::vector<size_t> faceOffset(nComponents + 1);
+  for (size_t iComp = 0; iComp < nComponents; iComp++) faceOffset[iComp] = components[iComp].nFaces;
+  if (parallelExclusiveScan(faceOffset, nThreads) != nFaces) throwCorrupt();
+
+  // Positions
+  std::vector<int64_t> quantized(3 * nVertices);
+  int64_t maxValue = (int64_t(1) << positionBits) - 1;
+  parallelFor(positionBytes.size(), nThreads, [&](size_t iBlock) {
+    size_t blockStart = iBlock * POSITION_BLOCK_SIZE;
+    size_t blockEnd = std::min<size_t>(nVertices, blockStart + POSITION_BLOCK_SIZE);
+    decodePositionBlock(positionData[iBlock], positionData[iBlock] + positionBytes[iBlock], components, vertexOffset,
+                        blockStart, blockEnd, maxValue, quantized);
+  });
+
+  // Element order, either stored or the traversal order
+  std::vector<size_t> vertexIndex(nVertices), faceIndex(nFaces), faceRotation(nFaces, 0);
+  if (preserveOrder) {
+    RangeDecoder dec(orderData, orderData + orderBytes);
+    IntegerModel vertexModel, faceModel, rotationModel;
+    std::vector<char> seenVertex(nVertices, false);
+    int64_t prevIndex = 0;
+    for (size_t iV = 0; iV < nVertices; iV++) {
+      int64_t index = prevIndex + unzigzag(vertexModel.decode(dec));
+      if (index < 0 || static_cast<uint64_t>(index) >= nVertices || seenVertex[index]) throwCorrupt();
+      seenVertex[index] = true;
+      vertexIndex[iV] = index;
+      prevIndex = index;
+    }
+    std::vector<char> seenFace(nFaces, false);
+    prevIndex = 0;
+    for (size_t iF = 0; iF < nFaces; iF++) {
+      int64_t index = prevIndex + unzigzag(faceModel.decode(dec));
+      if (index < 0 || static_cast<uint64_t>(index) >= nFaces || seenFace[index]) throwCorrupt();
+      seenFace[index] = true;
+      faceIndex[iF] = index;
+      faceRotation[iF] = rotationModel.decode(dec);
+      prevIndex = index;
+    }
+    if (dec.exhausted()) throwCorrupt();
+  } else {
+    for (size_t iV = 0; iV < nVertices; iV++) vertexIndex[iV] = iV;
+    for (size_t iF = 0; iF < nFaces; iF++) faceIndex[iF] = iF;
+  }
+
+  // Build a flat face list, in the final face order
+  std::vector<size_t> faceStart(nFaces);
+  parallelFor(nComponents, nThreads, [&](size_t iComp) {
+    const ComponentLayout& layout = components[iComp];
+    size_t iF = faceOffset[iComp];
+    for (size_t iRecord = 0; iRecord < layout.nRecords(); iRecord++) {
+      if (layout.recordIsHole[iRecord]) continue;
+      size_t degree = layout.recordStart[iRecord + 1] - layout.recordStart[iRecord];
+      if (faceRotation[iF] >= degree) throwCorrupt();
+      faceStart[faceIndex[iF]] = degree;
+      iF++;
+    }
+  });
+  size_t faceDegree = nFaces == 0 ? 0 : faceStart[0];
+  for (size_t degree : faceStart) {
+    if (degree != faceDegree) faceDegree = 0;
+  }
+  size_t nCorners = parallelExclusiveScan(faceStart, nThreads);
+  faceStart.push_back(nCorners);
+
+  MappedMeshData decoded;
+  decoded.faceIndices.resize(nCorners);
+  parallelFor(nComponents, nThreads, [&](size_t iComp) {
+    const ComponentLayout& layout = components[iComp];
+    size_t iF = faceOffset[iComp];
+    for (size_t iRecord = 0; iRecord < layout.nRecords(); iRecord++) {
+      if (layout.recordIsHole[iRecord]) continue;
+      size_t start = layout.recordStart[iRecord];
+      size_t degree = layout.recordStart[iRecord + 1] - start;
+      size_t* face = &decoded.faceIndices[faceStart[faceIndex[iF]]];
+      for (size_t j = 0; j < degree; j++) {
+        face[j] = vertexIndex[layout.heVertex[start + (j + faceRotation[iF]) % degree] + vertexOffset[iComp]];
+      }
+      iF++;
+    }
+  });
+  if (faceDegree == 0) {
+    decoded.faceStart = std::move(faceStart);
+  } else {
+    decoded.faceDegree = faceDegree;
+  }
+
+  decoded.vertexCoordinates.resize(nVertices);
+  parallelFor(
+      nVertices, nThreads,
+      [&](size_t iV) {
+        Vector3 p = boundMin;
+        for (int k = 0; k < 3; k++) p[k] += quantized[3 * iV + k] * cellSize;
+        decoded.vertexCoordinates[vertexIndex[iV]] = p;
+      },
+      1 << 14);
+
+  return makeManifoldSurfaceMeshAndGeometry(std::move(decoded), nThreads);
+}
+
+
+MeshCompressionStats writeCompressedSurfaceMesh(ManifoldSurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                                std::string filename, const MeshCompressionOptions& options) {
+  std::ofstream out(filename, std::ios::binary);
+  if (!out) throw std::runtime_error("couldn't open output file " + filename);
+  return writeCompressedSurfaceMesh(mesh, geometry, out, options);
+}
+
+MeshCompressionStats writeCompressedSurfaceMesh(ManifoldSurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                                std::ostream& out, const MeshCompressionOptions& options) {
+  MeshCompressionStats stats;
+  std::vector<char> bytes = compressSurfaceMesh(mesh, geometry, options, &stats);
+  out.write(bytes.data(), bytes.size());
+  if (!out) throw std::runtime_error("failed to write compressed mesh");
+  return stats;
+}
+
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+readCompressedSurfaceMesh(std::string filename, size_t nThreads) {
+  MappedFile file(filename);
+  return decompressSurfaceMesh(file.data(), file.size(), nThreads);
+}
+
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+readCompressedSurfaceMesh(std::istream& in, size_t nThreads) {
+  std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  return decompressSurfaceMesh(bytes.data(), bytes.size(), nThreads);
+}
+
+} // namespace surface
+} // namespace geometrycentral
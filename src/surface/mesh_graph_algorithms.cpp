@@ -3,6 +3,8 @@
 #include "geometrycentral/utilities/disjoint_sets.h"
 
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <queue>
 #include <unordered_map>
 #include <utility>
@@ -129,6 +131,143 @@ std::unordered_map<Vertex, double> vertexDijkstraDistanceWithinRadius(IntrinsicG
 }
 
 
+GraphDistanceEngine::GraphDistanceEngine(IntrinsicGeometryInterface& geom_)
+    : geom(geom_), embeddedGeom(dynamic_cast<EmbeddedGeometryInterface*>(&geom_)) {
+  SurfaceMesh& mesh = geom.mesh;
+  geom.requireEdgeLengths();
+  if (embeddedGeom) embeddedGeom->requireVertexPositions();
+
+  discoveredStamp = VertexData<uint32_t>(mesh, 0);
+  finalizedStamp = VertexData<uint32_t>(mesh, 0);
+  targetStamp = VertexData<uint32_t>(mesh, 0);
+  distance = VertexData<double>(mesh);
+  incomingHalfedge = VertexData<Halfedge>(mesh);
+}
+
+GraphDistanceEngine::~GraphDistanceEngine() {
+  geom.unrequireEdgeLengths();
+  if (embeddedGeom) embeddedGeom->unrequireVertexPositions();
+}
+
+std::vector<Halfedge> GraphDistanceEngine::shortestEdgePath(Vertex startVert, Vertex endVert) {
+
+  // Early out for empty case
+  if (startVert == endVert) {
+    return std::vector<Halfedge>();
+  }
+
+  startSearch();
+  targetStamp[endVert] = currentStamp;
+  search(startVert, std::numeric_limits<double>::infinity(), 1, endVert);
+  return pathTo(startVert, endVert);
+}
+
+std::vector<std::vector<Halfedge>> GraphDistanceEngine::shortestEdgePaths(Vertex startVert,
+                                                                          const std::vector<Vertex>& targets) {
+  startSearch();
+  size_t nTargets = 0;
+  for (Vertex v : targets) {
+    if (targetStamp[v] != currentStamp) {
+      targetStamp[v] = currentStamp;
+      nTargets++;
+    }
+  }
+  if (nTargets == 0) return {};
+  search(startVert, std::numeric_limits<double>::infinity(), nTargets, Vertex());
+
+  std::vector<std::vector<Halfedge>> paths;
+  for (Vertex v : targets) {
+    paths.push_back(pathTo(startVert, v));
+  }
+  return paths;
+}
+
+const std::vector<Vertex>& GraphDistanceEngine::verticesWithinRadius(Vertex startVert, double ballRad) {
+  startSearch();
+  search(startVert, ballRad, 0, Vertex());
+  return finalizedVertices;
+}
+
+double GraphDistanceEngine::getDistance(Vertex v) const {
+  return finalizedStamp[v] == currentStamp ? distance[v] : std::numeric_limits<double>::infinity();
+}
+
+bool GraphDistanceEngine::usesEuclideanHeuristic() const { return embeddedGeom != nullptr; }
+
+void GraphDistanceEngine::startSearch() {
+  currentStamp++;
+  if (currentStamp == 0) { // wrapped around
+    discoveredStamp.fill(0);
+    finalizedStamp.fill(0);
+    targetStamp.fill(0);
+    currentStamp = 1;
+  }
+  heap.clear();
+  finalizedVertices.clear();
+}
+
+void GraphDistanceEngine::search(Vertex startVert, double ballRad, size_t nTargets, Vertex heuristicTarget) {
+
+  // Lower bound on the remaining distance to the target (zero for a plain Dijkstra search)
+  bool useHeuristic = embeddedGeom != nullptr && heuristicTarget != Vertex();
+  Vector3 targetPos = useHeuristic ? embeddedGeom->vertexPositions[heuristicTarget] : Vector3::zero();
+  auto heuristic = [&](Vertex v) { return useHeuristic ? norm(embeddedGeom->vertexPositions[v] - targetPos) : 0.; };
+  std::greater<WeightedVertex> heapCompare;
+
+  discoveredStamp[startVert] = currentStamp;
+  distance[startVert] = 0.;
+  incomingHalfedge[startVert] = Halfedge();
+  heap.emplace_back(heuristic(startVert), startVert);
+
+  while (!heap.empty()) {
+
+    // Get the next closest vertex off the queue
+    std::pop_heap(heap.begin(), heap.end(), heapCompare);
+    Vertex currVert = heap.back().second;
+    heap.pop_back();
+
+    // skips stale entries
+    if (finalizedStamp[currVert] == currentStamp) continue;
+    finalizedStamp[currVert] = currentStamp;
+    finalizedVertices.push_back(currVert);
+
+    if (targetStamp[currVert] == currentStamp) {
+      nTargets--;
+      if (nTargets == 0) return;
+    }
+
+    double currDist = distance[currVert];
+    for (Halfedge he : currVert.outgoingHalfedges()) {
+      Vertex targetVert = he.tipVertex();
+      double targetDist = currDist + geom.edgeLengths[he.edge()];
+      if (targetDist > ballRad || finalizedStamp[targetVert] == currentStamp) continue;
+
+      if (discoveredStamp[targetVert] != currentStamp || targetDist < distance[targetVert]) {
+        discoveredStamp[targetVert] = currentStamp;
+        distance[targetVert] = targetDist;
+        incomingHalfedge[targetVert] = he;
+        heap.emplace_back(targetDist + heuristic(targetVert), targetVert);
+        std::push_heap(heap.begin(), heap.end(), heapCompare);
+      }
+    }
+  }
+}
+
+std::vector<Halfedge> GraphDistanceEngine::pathTo(Vertex startVert, Vertex endVert) const {
+  std::vector<Halfedge> path;
+  if (finalizedStamp[endVert] != currentStamp) return path;
+
+  Vertex walkV = endVert;
+  while (walkV != startVert) {
+    Halfedge prevHe = incomingHalfedge[walkV];
+    path.push_back(prevHe);
+    walkV = prevHe.vertex();
+  }
+  std::reverse(std::begin(path), std::end(path));
+  return path;
+}
+
+
 /*
 
 // Note: Assumes mesh is a single connected component
@@ -1,13 +1,19 @@
 #include "geometrycentral/surface/meshio.h"
 
 #include "geometrycentral/surface/manifold_surface_mesh.h"
+#include "geometrycentral/surface/mapped_mesh_reader.h"
+#include "geometrycentral/surface/mesh_compression.h"
 #include "geometrycentral/surface/simple_polygon_mesh.h"
 #include "geometrycentral/surface/surface_mesh_factories.h"
+#include "geometrycentral/utilities/formatted_output.h"
 
 #include "happly.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <limits>
+#include <memory>
 
 using std::cout;
 using std::endl;
@@ -41,6 +47,32 @@ std::vector<Vector3> geometryToStdVector(SurfaceMesh& mesh, EmbeddedGeometryInte
   return verts;
 }
 
+// Compressed meshes (see mesh_compression.h) are handled here rather than by SimplePolygonMesh, since they are decoded
+// straight to a halfedge mesh
+bool isCompressedMeshType(std::string filename, std::string type) {
+  if (type == "") {
+    size_t sepInd = filename.rfind('.');
+    if (sepInd == std::string::npos) return false;
+    type = filename.substr(sepInd + 1);
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+  }
+  return type == "gcz";
+}
+
+ManifoldSurfaceMesh& manifoldMeshForCompression(SurfaceMesh& mesh) {
+  ManifoldSurfaceMesh* manifoldMesh = dynamic_cast<ManifoldSurfaceMesh*>(&mesh);
+  if (manifoldMesh == nullptr) throw std::runtime_error("only a ManifoldSurfaceMesh can be written as a .gcz file");
+  return *manifoldMesh;
+}
+
+// The .gcz format holds only connectivity and positions, so texture coordinates would be silently lost
+void checkTexCoordsWritable(std::string filename, std::string type) {
+  if (isCompressedMeshType(filename, type)) {
+    throw std::runtime_error("texture coordinates cannot be written to a .gcz file; write the mesh without them, or "
+                             "use another format");
+  }
+}
+
 
 std::vector<std::vector<Vector2>> paramToStdVector(SurfaceMesh& mesh, CornerData<Vector2>& param) {
   std::vector<std::vector<Vector2>> uv(mesh.nFaces());
@@ -54,6 +86,24 @@ std::vector<std::vector<Vector2>> paramToStdVector(SurfaceMesh& mesh, CornerData
   return uv;
 }
 
+
+// Format and write a snapshot of a mesh on another thread
+std::future<void> writeSnapshotAsync(std::shared_ptr<SimplePolygonMesh> snapshot, std::string filename,
+                                     std::string type) {
+  bool compressed = isCompressedMeshType(filename, type);
+  return std::async(std::launch::async, [snapshot, filename, type, compressed]() {
+    if (compressed) {
+      // The element order is the same as in the original mesh, so this is the same as compressing that mesh
+      std::unique_ptr<ManifoldSurfaceMesh> mesh;
+      std::unique_ptr<VertexPositionGeometry> geometry;
+      std::tie(mesh, geometry) = makeManifoldSurfaceMeshAndGeometry(snapshot->polygons, snapshot->vertexCoordinates);
+      writeCompressedSurfaceMesh(*mesh, *geometry, filename);
+    } else {
+      snapshot->writeMesh(filename, type);
+    }
+  });
+}
+
 } // namespace
 
 std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>> loadMesh(std::string filename,
@@ -65,6 +115,18 @@ std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionG
 // Load a general surface mesh, which might or might not be manifold
 std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>> readSurfaceMesh(std::string filename,
                                                                                                   std::string type) {
+  if (isCompressedMeshType(filename, type)) {
+    auto lvals = readCompressedSurfaceMesh(filename);
+    return std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>(
+        std::move(std::get<0>(lvals)), std::move(std::get<1>(lvals)));
+  }
+
+  // Binary files are decoded directly from a memory mapping where possible
+  MappedMeshData mappedData;
+  if (readMappedMesh(filename, type, mappedData)) {
+    return makeSurfaceMeshAndGeometry(std::move(mappedData));
+  }
+
   std::string loadType;
   SimplePolygonMesh simpleMesh;
   simpleMesh.readMeshFromFile(filename, type, loadType);
@@ -73,6 +135,12 @@ std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>
 }
 std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>> readSurfaceMesh(std::istream& in,
                                                                                                   std::string type) {
+  if (isCompressedMeshType("", type)) {
+    auto lvals = readCompressedSurfaceMesh(in);
+    return std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>(
+        std::move(std::get<0>(lvals)), std::move(std::get<1>(lvals)));
+  }
+
   std::string loadType = type;
   SimplePolygonMesh simpleMesh;
   simpleMesh.readMeshFromFile(in, type);
@@ -83,6 +151,14 @@ std::tuple<std::unique_ptr<SurfaceMesh>, std::unique_ptr<VertexPositionGeometry>
 // Load a manifold surface mesh; an exception will by thrown if the mesh is not manifold.
 std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
 readManifoldSurfaceMesh(std::string filename, std::string type) {
+  if (isCompressedMeshType(filename, type)) return readCompressedSurfaceMesh(filename);
+
+  // Binary files are decoded directly from a memory mapping where possible
+  MappedMeshData mappedData;
+  if (readMappedMesh(filename, type, mappedData)) {
+    return makeManifoldSurfaceMeshAndGeometry(std::move(mappedData));
+  }
+
   std::string loadType;
   SimplePolygonMesh simpleMesh;
   simpleMesh.readMeshFromFile(filename, type, loadType);
@@ -94,6 +170,8 @@ readManifoldSurfaceMesh(std::string filename, std::string type) {
 }
 std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
 readManifoldSurfaceMesh(std::istream& in, std::string type) {
+  if (isCompressedMeshType("", type)) return readCompressedSurfaceMesh(in);
+
   std::string loadType = type;
   SimplePolygonMesh simpleMesh;
   simpleMesh.readMeshFromFile(in, type);
@@ -135,28 +213,57 @@ readParameterizedSurfaceMesh(std::string filename, std::string type) {
 
 
 void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, std::string filename, std::string type) {
+  if (isCompressedMeshType(filename, type)) {
+    writeCompressedSurfaceMesh(manifoldMeshForCompression(mesh), geometry, filename);
+    return;
+  }
   SimplePolygonMesh simpleMesh(mesh.getFaceVertexList(), geometryToStdVector(mesh, geometry));
   simpleMesh.writeMesh(filename, type);
 }
 
 void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, CornerData<Vector2>& texCoords,
                       std::string filename, std::string type) {
+  checkTexCoordsWritable(filename, type);
   SimplePolygonMesh simpleMesh(mesh.getFaceVertexList(), geometryToStdVector(mesh, geometry),
                                paramToStdVector(mesh, texCoords));
   simpleMesh.writeMesh(filename, type);
 }
 
 void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, std::ostream& out, std::string type) {
+  if (isCompressedMeshType("", type)) {
+    writeCompressedSurfaceMesh(manifoldMeshForCompression(mesh), geometry, out);
+    return;
+  }
   SimplePolygonMesh simpleMesh(mesh.getFaceVertexList(), geometryToStdVector(mesh, geometry));
   simpleMesh.writeMesh(out, type);
 }
 void writeSurfaceMesh(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, CornerData<Vector2>& texCoords,
                       std::ostream& out, std::string type) {
+  checkTexCoordsWritable("", type);
   SimplePolygonMesh simpleMesh(mesh.getFaceVertexList(), geometryToStdVector(mesh, geometry),
                                paramToStdVector(mesh, texCoords));
   simpleMesh.writeMesh(out, type);
 }
 
+std::future<void> writeSurfaceMeshAsync(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry, std::string filename,
+                                        std::string type) {
+  if (isCompressedMeshType(filename, type)) manifoldMeshForCompression(mesh); // fail now, rather than in the future
+  std::shared_ptr<SimplePolygonMesh> snapshot(new SimplePolygonMesh());
+  snapshot->polygons = mesh.getFaceVertexList();
+  snapshot->vertexCoordinates = geometryToStdVector(mesh, geometry);
+  return writeSnapshotAsync(snapshot, filename, type);
+}
+
+std::future<void> writeSurfaceMeshAsync(SurfaceMesh& mesh, EmbeddedGeometryInterface& geometry,
+                                        CornerData<Vector2>& texCoords, std::string filename, std::string type) {
+  checkTexCoordsWritable(filename, type); // fail now, rather than in the future
+  std::shared_ptr<SimplePolygonMesh> snapshot(new SimplePolygonMesh());
+  snapshot->polygons = mesh.getFaceVertexList();
+  snapshot->vertexCoordinates = geometryToStdVector(mesh, geometry);
+  snapshot->paramCoordinates = paramToStdVector(mesh, texCoords);
+  return writeSnapshotAsync(snapshot, filename, type);
+}
+
 
 CornerData<Vector2> packToParam(SurfaceMesh& mesh, VertexData<double>& vals) {
   CornerData<Vector2> out(mesh);
@@ -254,10 +361,8 @@ bool WavefrontOBJ::openStream(std::ofstream& out, std::string filename) {
     return false;
   }
 
-  // Use full precision---yes, this makes files bigger, but it also
-  // means that saving and then re-loading files doesn't result in
-  // unexpected behavior.
-  out.precision(std::numeric_limits<double>::max_digits10);
+  // Numbers are written with formatDouble(), which gives the shortest representation that reads back to exactly the
+  // same value, so saving and then re-loading files doesn't result in unexpected behavior.
 
   return true;
 }
@@ -269,33 +374,60 @@ void WavefrontOBJ::writeHeader(std::ofstream& out, EmbeddedGeometryInterface& ge
   out << "#     faces: " << geometry.mesh.nFaces() << endl;
 }
 
+namespace {
+
+// Write one line per vector, as a prefix followed by the components
+template <typename T>
+void writeVectorLines(std::ofstream& out, const char* prefix, const std::vector<T>& vecs, int nComponents) {
+  size_t prefixLen = std::strlen(prefix);
+  writeInParallel(out, vecs.size(), [&](size_t i, std::string& buffer) {
+    char line[3 * FORMAT_BUFFER_SIZE + 8];
+    char* p = line;
+    for (int j = 0; j < nComponents; j++) {
+      *p++ = ' ';
+      p = formatDouble(p, vecs[i][j]);
+    }
+    *p++ = '\n';
+    buffer.append(prefix, prefixLen);
+    buffer.append(line, p);
+  });
+}
+
+} // namespace
+
 void WavefrontOBJ::writeVertices(std::ofstream& out, EmbeddedGeometryInterface& geometry) {
   SurfaceMesh& mesh(geometry.mesh);
   geometry.requireVertexPositions();
 
+  std::vector<Vector3> positions;
+  positions.reserve(mesh.nVertices());
   for (Vertex v : mesh.vertices()) {
-    Vector3 p = geometry.vertexPositions[v];
-    out << "v " << p.x << " " << p.y << " " << p.z << endl;
+    positions.push_back(geometry.vertexPositions[v]);
   }
+  writeVectorLines(out, "v", positions, 3);
 }
 
 void WavefrontOBJ::writeTexCoords(std::ofstream& out, EmbeddedGeometryInterface& geometry,
                                   CornerData<Vector2>& texcoords) {
   SurfaceMesh& mesh(geometry.mesh);
 
+  std::vector<Vector2> coords;
+  coords.reserve(mesh.nCorners());
   for (Corner c : mesh.corners()) {
-    Vector2 z = texcoords[c];
-    out << "vt " << z.x << " " << z.y << endl;
+    coords.push_back(texcoords[c]);
   }
+  writeVectorLines(out, "vt", coords, 2);
 }
 
 void WavefrontOBJ::writeNormals(std::ofstream& out, EmbeddedGeometryInterface& geometry, CornerData<Vector3>& normals) {
   SurfaceMesh& mesh(geometry.mesh);
 
+  std::vector<Vector3> vecs;
+  vecs.reserve(mesh.nCorners());
   for (Corner c : mesh.corners()) {
-    Vector3 n = normals[c];
-    out << "vn " << n.x << " " << n.y << " " << n.z << endl;
+    vecs.push_back(normals[c]);
   }
+  writeVectorLines(out, "vn", vecs, 3);
 }
 
 void WavefrontOBJ::writeFaces(std::ofstream& out, EmbeddedGeometryInterface& geometry, bool useTexCoords,
@@ -306,19 +438,39 @@ void WavefrontOBJ::writeFaces(std::ofstream& out, EmbeddedGeometryInterface& geo
   VertexData<size_t> indices = mesh.getVertexIndices();
   CornerData<size_t> cIndices = mesh.getCornerIndices();
 
-  auto indexFn = [&](Corner c) {
-    std::string texCoordString = (useTexCoords) ? std::to_string(cIndices[c] + 1) : "";
-    std::string normalString = (useNormals) ? std::to_string(cIndices[c] + 1) : "";
-    return " " + std::to_string(indices[c.vertex()] + 1) + "/" + texCoordString + "/" + normalString;
-  };
-
+  // Gather the (vertex, corner) index pairs of each face into flat arrays, so faces can be formatted in parallel
+  std::vector<size_t> faceStart{0};
+  std::vector<size_t> vertexInds, cornerInds;
+  faceStart.reserve(mesh.nFaces() + 1);
+  vertexInds.reserve(mesh.nCorners());
+  cornerInds.reserve(mesh.nCorners());
   for (Face f : mesh.faces()) {
-    out << "f";
     for (Corner c : f.adjacentCorners()) {
-      out << indexFn(c);
+      vertexInds.push_back(indices[c.vertex()]);
+      cornerInds.push_back(cIndices[c]);
     }
-    out << endl;
+    faceStart.push_back(vertexInds.size());
   }
+
+  writeInParallel(out, faceStart.size() - 1, [&](size_t iF, std::string& buffer) {
+    buffer.push_back('f');
+    for (size_t i = faceStart[iF]; i < faceStart[iF + 1]; i++) {
+      char entry[3 * FORMAT_BUFFER_SIZE + 4];
+      char* p = entry;
+      *p++ = ' ';
+      p = formatInteger(p, vertexInds[i] + 1);
+      if (useTexCoords || useNormals) {
+        *p++ = '/';
+        if (useTexCoords) p = formatInteger(p, cornerInds[i] + 1);
+      }
+      if (useNormals) {
+        *p++ = '/';
+        p = formatInteger(p, cornerInds[i] + 1);
+      }
+      buffer.append(entry, p);
+    }
+    buffer.push_back('\n');
+  });
 }
 
 std::array<std::pair<std::vector<size_t>, size_t>, 5> polyscopePermutations(SurfaceMesh& mesh) {
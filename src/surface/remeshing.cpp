@@ -1,5 +1,7 @@
 #include "geometrycentral/surface/remeshing.h"
 
+#include "geometrycentral/utilities/profiler.h"
+
 namespace geometrycentral {
 namespace surface {
 
@@ -12,6 +14,7 @@ void remesh(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom, RemeshOptio
 }
 
 void remesh(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom, MutationManager& mm, RemeshOptions options) {
+  GC_PROFILE_SCOPE("remesh");
   if (options.targetEdgeLength < 0) {
     double meanLength = 0;
     geom.requireEdgeLengths();
@@ -209,6 +212,7 @@ size_t fixDelaunay(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom) {
 }
 
 size_t fixDelaunay(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom, MutationManager& mm) {
+  GC_PROFILE_SCOPE("fixDelaunay");
   // Logic duplicated from surface/intrinsic_triangulation.cpp
 
   std::deque<Edge> edgesToCheck;      // queue of edges to check if Delaunay
@@ -258,6 +262,7 @@ double smoothByLaplacian(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom
 
 double smoothByLaplacian(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom, MutationManager& mm, double stepSize,
                          RemeshBoundaryCondition bc) {
+  GC_PROFILE_SCOPE("smoothByLaplacian");
   VertexData<Vector3> vertexOffsets(mesh);
   for (Vertex v : mesh.vertices()) {
     // calculate average of surrounding vertices
@@ -311,6 +316,7 @@ double smoothByCircumcenter(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& g
 
 double smoothByCircumcenter(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom, MutationManager& mm,
                             double stepSize, RemeshBoundaryCondition bc) {
+  GC_PROFILE_SCOPE("smoothByCircumcenter");
   geom.requireFaceAreas();
   VertexData<Vector3> vertexOffsets(mesh);
   for (Vertex v : mesh.vertices()) {
@@ -364,6 +370,7 @@ bool adjustEdgeLengths(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom,
 
 bool adjustEdgeLengths(ManifoldSurfaceMesh& mesh, VertexPositionGeometry& geom, MutationManager& mm,
                        RemeshOptions options) {
+  GC_PROFILE_SCOPE("adjustEdgeLengths");
   geom.requireVertexDualAreas();
   geom.requireVertexMeanCurvatures();
 
@@ -3,6 +3,7 @@
 #include "geometrycentral/surface/meshio.h"
 #include "geometrycentral/surface/polygon_soup_mesh.h"
 
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -16,20 +17,49 @@ namespace geometrycentral {
 namespace surface {
 
 
-RichSurfaceMeshData::RichSurfaceMeshData(SurfaceMesh& mesh_, std::string filename_)
-    : plyData(filename_), mesh(&mesh_) {}
+RichSurfaceMeshData::RichSurfaceMeshData(SurfaceMesh& mesh_, std::string filename_) : plyData(), mesh(&mesh_) {
+  openFile(filename_);
+}
 
 RichSurfaceMeshData::RichSurfaceMeshData(SurfaceMesh& mesh_, std::istream& in_) : plyData(in_), mesh(&mesh_) {}
 
 RichSurfaceMeshData::RichSurfaceMeshData(SurfaceMesh& mesh_) : plyData(), mesh(&mesh_) {}
 
 RichSurfaceMeshData::RichSurfaceMeshData(std::istream& in_) : plyData(in_) { loadMeshFromFile(); }
-RichSurfaceMeshData::RichSurfaceMeshData(std::string filename_) : plyData(filename_) { loadMeshFromFile(); }
+RichSurfaceMeshData::RichSurfaceMeshData(std::string filename_) : plyData() {
+  openFile(filename_);
+  loadMeshFromFile();
+}
+
+void RichSurfaceMeshData::openFile(std::string filename) {
+  if (!MappedPlyFile::canRead(filename)) {
+    plyData = happly::PLYData(filename);
+    return;
+  }
+
+  // Properties are only read from the mapping when requested, or when writing
+  std::shared_ptr<MappedPlyFile> file(new MappedPlyFile(filename));
+  for (const PlyElement& elem : file->getElements()) {
+    streamData.addElement(elem.name, elem.count);
+    for (const PlyProperty& prop : elem.properties) {
+      streamData.addPropertyFromFile(file, elem.name, prop.name);
+    }
+  }
+}
+
+bool RichSurfaceMeshData::hasFileElement(std::string elementName) {
+  return streamData.hasElement(elementName) || plyData.hasElement(elementName);
+}
+
+bool RichSurfaceMeshData::hasFileProperty(std::string elementName, std::string propertyName) {
+  return streamData.hasProperty(elementName, propertyName) ||
+         (plyData.hasElement(elementName) && plyData.getElement(elementName).hasProperty(propertyName));
+}
 
 void RichSurfaceMeshData::loadMeshFromFile() {
   if (mesh != nullptr) throw std::runtime_error("cannot load mesh multiple times");
 
-  if (!plyData.hasElement("gc_internal_halfedge")) {
+  if (!hasFileElement("gc_internal_halfedge")) {
     throw std::runtime_error(
         "Cannot load mesh from file, file was saved without connectiviy. Call addMeshConnectivity() before saving.");
   }
@@ -48,12 +78,12 @@ void RichSurfaceMeshData::loadMeshFromFile() {
   // clang-format off
 
   // Read the necessary arrays
-  std::vector<size_t> heNextArr     = fromSmallerVec(plyData.getElement("gc_internal_halfedge").getProperty<uint32_t>("gc_internal_heNextArr"));
-  std::vector<size_t> heVertexArr   = fromSmallerVec(plyData.getElement("gc_internal_halfedge").getProperty<uint32_t>("gc_internal_heVertexArr"));
-  std::vector<size_t> heFaceArr     = fromSmallerVec(plyData.getElement("gc_internal_halfedge").getProperty<uint32_t>("gc_internal_heFaceArr"));
-  std::vector<size_t> vHalfedgeArr  = fromSmallerVec(plyData.getElement("gc_internal_vertex").getProperty<uint32_t>("gc_internal_vHalfedgeArr"));
-  std::vector<size_t> fHalfedgeArr  = fromSmallerVec(plyData.getElement("gc_internal_face").getProperty<uint32_t>("gc_internal_fHalfedgeArr"));
-  std::vector<size_t> fHalfedgeArrB = fromSmallerVec(plyData.getElement("gc_internal_bl").getProperty<uint32_t>("gc_internal_blHalfedgeArr"));
+  std::vector<size_t> heNextArr     = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heNextArr"));
+  std::vector<size_t> heVertexArr   = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heVertexArr"));
+  std::vector<size_t> heFaceArr     = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heFaceArr"));
+  std::vector<size_t> vHalfedgeArr  = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_vertex", "gc_internal_vHalfedgeArr"));
+  std::vector<size_t> fHalfedgeArr  = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_face", "gc_internal_fHalfedgeArr"));
+  std::vector<size_t> fHalfedgeArrB = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_bl", "gc_internal_blHalfedgeArr"));
   fHalfedgeArr.insert(fHalfedgeArr.end(), fHalfedgeArrB.begin(), fHalfedgeArrB.end());
 
 
@@ -61,12 +91,12 @@ void RichSurfaceMeshData::loadMeshFromFile() {
   std::vector<size_t> heEdgeArr;   
   std::vector<char> heOrientArr;   
   std::vector<size_t> eHalfedgeArr;
-  bool useImplicitTwin = !plyData.getElement("gc_internal_halfedge").hasProperty("gc_internal_heSiblingArr");
+  bool useImplicitTwin = !hasFileProperty("gc_internal_halfedge", "gc_internal_heSiblingArr");
   if(!useImplicitTwin) {
-    heSiblingArr    = fromSmallerVec(plyData.getElement("gc_internal_halfedge").getProperty<uint32_t>("gc_internal_heSiblingArr"));
-    heEdgeArr       = fromSmallerVec(plyData.getElement("gc_internal_halfedge").getProperty<uint32_t>("gc_internal_heEdgeArr"));
-    heOrientArr     = plyData.getElement("gc_internal_halfedge").getProperty<char>("gc_internal_heOrientArr");
-    eHalfedgeArr    = fromSmallerVec(plyData.getElement("gc_internal_edge").getProperty<uint32_t>("gc_internal_eHalfedgeArr"));
+    heSiblingArr    = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heSiblingArr"));
+    heEdgeArr       = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heEdgeArr"));
+    heOrientArr     = readFileProperty<char>("gc_internal_halfedge", "gc_internal_heOrientArr");
+    eHalfedgeArr    = fromSmallerVec(readFileProperty<uint32_t>("gc_internal_edge", "gc_internal_eHalfedgeArr"));
   }
 
   // clang-format on
@@ -115,8 +145,21 @@ void RichSurfaceMeshData::addMeshConnectivity() {
   // GC_SAFETY_ASSERT(mesh.isCompressed(), "Mesh must be compressed to use RichSurfaceMeshData. Call mesh.compress().");
 
   // == Write connectiviy as indices
+  // (as happly's addFaceIndices() does, using signed ints where they are large enough)
   std::vector<std::vector<size_t>> faceIndices = mesh->getFaceVertexList();
-  plyData.addFaceIndices(faceIndices);
+  if (mesh->nVertices() < static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    std::vector<std::vector<int32_t>> intIndices(faceIndices.size());
+    for (size_t iF = 0; iF < faceIndices.size(); iF++) {
+      intIndices[iF].assign(faceIndices[iF].begin(), faceIndices[iF].end());
+    }
+    streamData.addListProperty<int32_t>("face", "vertex_indices", intIndices);
+  } else {
+    std::vector<std::vector<uint32_t>> intIndices(faceIndices.size());
+    for (size_t iF = 0; iF < faceIndices.size(); iF++) {
+      intIndices[iF].assign(faceIndices[iF].begin(), faceIndices[iF].end());
+    }
+    streamData.addListProperty<uint32_t>("face", "vertex_indices", intIndices);
+  }
 
   // == Write rich connectivity
   // These needed to be added on distinct elements, since in an uncompressed mesh the length of the arrays might be
@@ -139,41 +182,35 @@ void RichSurfaceMeshData::addMeshConnectivity() {
   // clang-format off
 
   // Add the elements themselves
-  plyData.addElement("gc_internal_vertex", mesh->nVerticesFillCount);
-  plyData.addElement("gc_internal_halfedge", mesh->nHalfedgesFillCount);
-  plyData.addElement("gc_internal_edge", mesh->nEdgesFillCount);
-  plyData.addElement("gc_internal_face", mesh->nFacesFillCount);
-  plyData.addElement("gc_internal_bl", mesh->nBoundaryLoopsFillCount);
-
-  auto& elemVertex = plyData.getElement("gc_internal_vertex");
-  auto& elemHalfedge = plyData.getElement("gc_internal_halfedge");
-  auto& elemEdge = plyData.getElement("gc_internal_edge");
-  auto& elemFace = plyData.getElement("gc_internal_face");
-  auto& elemBl= plyData.getElement("gc_internal_bl");
+  streamData.addElement("gc_internal_vertex", mesh->nVerticesFillCount);
+  streamData.addElement("gc_internal_halfedge", mesh->nHalfedgesFillCount);
+  streamData.addElement("gc_internal_edge", mesh->nEdgesFillCount);
+  streamData.addElement("gc_internal_face", mesh->nFacesFillCount);
+  streamData.addElement("gc_internal_bl", mesh->nBoundaryLoopsFillCount);
 
   // Halfedge properties
-  elemHalfedge.addProperty<uint32_t>("gc_internal_heNextArr", toSmallerVec(mesh->heNextArr.begin(), mesh->heNextArr.begin() + mesh->nHalfedgesFillCount));
-  elemHalfedge.addProperty<uint32_t>("gc_internal_heFaceArr", toSmallerVec(mesh->heFaceArr.begin(), mesh->heFaceArr.begin() + mesh->nHalfedgesFillCount));
-  elemHalfedge.addProperty<uint32_t>("gc_internal_heVertexArr", toSmallerVec(mesh->heVertexArr.begin(), mesh->heVertexArr.begin() + mesh->nHalfedgesFillCount));
+  streamData.addProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heNextArr", toSmallerVec(mesh->heNextArr.begin(), mesh->heNextArr.begin() + mesh->nHalfedgesFillCount));
+  streamData.addProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heFaceArr", toSmallerVec(mesh->heFaceArr.begin(), mesh->heFaceArr.begin() + mesh->nHalfedgesFillCount));
+  streamData.addProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heVertexArr", toSmallerVec(mesh->heVertexArr.begin(), mesh->heVertexArr.begin() + mesh->nHalfedgesFillCount));
   if(!mesh->usesImplicitTwin()) {
-    elemHalfedge.addProperty<uint32_t>("gc_internal_heSiblingArr", toSmallerVec(mesh->heSiblingArr.begin(), mesh->heSiblingArr.begin() + mesh->nHalfedgesFillCount));
-    elemHalfedge.addProperty<uint32_t>("gc_internal_heEdgeArr", toSmallerVec(mesh->heEdgeArr.begin(), mesh->heEdgeArr.begin() + mesh->nHalfedgesFillCount));
-    elemHalfedge.addProperty<char>("gc_internal_heOrientArr", std::vector<char>(mesh->heOrientArr.begin(), mesh->heOrientArr.begin() + mesh->nHalfedgesFillCount));
+    streamData.addProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heSiblingArr", toSmallerVec(mesh->heSiblingArr.begin(), mesh->heSiblingArr.begin() + mesh->nHalfedgesFillCount));
+    streamData.addProperty<uint32_t>("gc_internal_halfedge", "gc_internal_heEdgeArr", toSmallerVec(mesh->heEdgeArr.begin(), mesh->heEdgeArr.begin() + mesh->nHalfedgesFillCount));
+    streamData.addProperty<char>("gc_internal_halfedge", "gc_internal_heOrientArr", std::vector<char>(mesh->heOrientArr.begin(), mesh->heOrientArr.begin() + mesh->nHalfedgesFillCount));
   }
 
   // Vertex properties
-  elemVertex.addProperty<uint32_t>("gc_internal_vHalfedgeArr", toSmallerVec(mesh->vHalfedgeArr.begin(), mesh->vHalfedgeArr.begin() + mesh->nVerticesFillCount));
+  streamData.addProperty<uint32_t>("gc_internal_vertex", "gc_internal_vHalfedgeArr", toSmallerVec(mesh->vHalfedgeArr.begin(), mesh->vHalfedgeArr.begin() + mesh->nVerticesFillCount));
  
   // Edge properties
   if(!mesh->usesImplicitTwin()) {
-    elemEdge.addProperty<uint32_t>("gc_internal_eHalfedgeArr", toSmallerVec(mesh->eHalfedgeArr.begin(), mesh->eHalfedgeArr.begin() + mesh->nEdgesFillCount));
+    streamData.addProperty<uint32_t>("gc_internal_edge", "gc_internal_eHalfedgeArr", toSmallerVec(mesh->eHalfedgeArr.begin(), mesh->eHalfedgeArr.begin() + mesh->nEdgesFillCount));
   }
 
   // Face properties
-  elemFace.addProperty<uint32_t>("gc_internal_fHalfedgeArr", toSmallerVec(mesh->fHalfedgeArr.begin(), mesh->fHalfedgeArr.begin() + mesh->nFacesFillCount));
+  streamData.addProperty<uint32_t>("gc_internal_face", "gc_internal_fHalfedgeArr", toSmallerVec(mesh->fHalfedgeArr.begin(), mesh->fHalfedgeArr.begin() + mesh->nFacesFillCount));
   
   // Boundary loop properties
-  elemBl.addProperty<uint32_t>("gc_internal_blHalfedgeArr", toSmallerVec(mesh->fHalfedgeArr.end() - mesh->nBoundaryLoopsFillCount, mesh->fHalfedgeArr.end()));
+  streamData.addProperty<uint32_t>("gc_internal_bl", "gc_internal_blHalfedgeArr", toSmallerVec(mesh->fHalfedgeArr.end() - mesh->nBoundaryLoopsFillCount, mesh->fHalfedgeArr.end()));
 
   
   /*
@@ -280,8 +317,88 @@ VertexData<Vector3> RichSurfaceMeshData::getVertexColors() {
   }
 }
 
-void RichSurfaceMeshData::write(std::string filename) { plyData.write(filename, outputFormat); }
-void RichSurfaceMeshData::write(std::ostream& out) { plyData.write(out, outputFormat); }
+namespace {
+
+template <typename T>
+void mergePropertyIntoPlyData(PlyStreamWriter& streamData, happly::Element& element, const PlyProperty& prop) {
+  if (prop.isList) {
+    element.addListProperty<T>(prop.name, streamData.getListProperty<T>(element.name, prop.name));
+  } else {
+    element.addProperty<T>(prop.name, streamData.getProperty<T>(element.name, prop.name));
+  }
+}
+
+} // namespace
+
+void RichSurfaceMeshData::mergeIntoPlyData() {
+  for (const PlyElement& elem : streamData.getElements()) {
+    if (!plyData.hasElement(elem.name)) {
+      plyData.addElement(elem.name, elem.count);
+    }
+    happly::Element& element = plyData.getElement(elem.name);
+    for (const PlyProperty& prop : elem.properties) {
+      // clang-format off
+      switch (prop.type) {
+        case PlyType::Int8:    mergePropertyIntoPlyData<int8_t>(streamData, element, prop);   break;
+        case PlyType::UInt8:   mergePropertyIntoPlyData<uint8_t>(streamData, element, prop);  break;
+        case PlyType::Int16:   mergePropertyIntoPlyData<int16_t>(streamData, element, prop);  break;
+        case PlyType::UInt16:  mergePropertyIntoPlyData<uint16_t>(streamData, element, prop); break;
+        case PlyType::Int32:   mergePropertyIntoPlyData<int32_t>(streamData, element, prop);  break;
+        case PlyType::UInt32:  mergePropertyIntoPlyData<uint32_t>(streamData, element, prop); break;
+        case PlyType::Float32: mergePropertyIntoPlyData<float>(streamData, element, prop);    break;
+        case PlyType::Float64: mergePropertyIntoPlyData<double>(streamData, element, prop);   break;
+      }
+      // clang-format on
+    }
+  }
+  streamData.clear();
+}
+
+void RichSurfaceMeshData::write(std::string filename) {
+  if (outputFormat != happly::DataFormat::Binary || !plyData.elements.empty() || !plyHostIsLittleEndian()) {
+    mergeIntoPlyData();
+    plyData.write(filename, outputFormat);
+    return;
+  }
+
+  // The output might replace the file which is mapped for reading, so write alongside it and then swap it in
+  std::string tempFilename = createFileAlongside(filename);
+  try {
+    std::ofstream out(tempFilename, std::ios::binary);
+    if (!out) throw std::runtime_error("couldn't open output file " + tempFilename);
+    streamData.write(out);
+  } catch (...) {
+    std::remove(tempFilename.c_str());
+    throw;
+  }
+
+  // Release the mapped input before replacing it (Windows will not replace a mapped file), then read the properties
+  // back from the new file, which holds the same data
+  std::vector<std::string> comments = streamData.getComments();
+  streamData.clear();
+  bool replaced = true;
+  try {
+    replaceFile(tempFilename, filename);
+  } catch (const std::runtime_error&) {
+    replaced = false;
+  }
+  openFile(replaced ? filename : tempFilename);
+  for (const std::string& comment : comments) {
+    streamData.addComment(comment);
+  }
+  if (!replaced) {
+    throw std::runtime_error("couldn't replace file " + filename + ", the output was left in " + tempFilename);
+  }
+}
+
+void RichSurfaceMeshData::write(std::ostream& out) {
+  if (outputFormat != happly::DataFormat::Binary || !plyData.elements.empty() || !plyHostIsLittleEndian()) {
+    mergeIntoPlyData();
+    plyData.write(out, outputFormat);
+    return;
+  }
+  streamData.write(out);
+}
 
 } // namespace surface
 } // namespace geometrycentral
@@ -3,6 +3,7 @@
 #include "geometrycentral/surface/barycentric_coordinate_helpers.h"
 #include "geometrycentral/surface/mesh_graph_algorithms.h"
 #include "geometrycentral/surface/trace_geodesic.h"
+#include "geometrycentral/utilities/profiler.h"
 
 #include <iomanip>
 #include <queue>
@@ -398,6 +399,7 @@ void SignpostIntrinsicTriangulation::flipEdgeManual(Edge e, double newLength, do
 
 
 Vertex SignpostIntrinsicTriangulation::insertVertex(SurfacePoint newPositionOnIntrinsic) {
+  GC_PROFILE_SCOPE("SignpostIntrinsicTriangulation::insertVertex");
   switch (newPositionOnIntrinsic.type) {
   case SurfacePointType::Vertex: {
     throw std::logic_error("can't insert vertex at vertex");
@@ -759,7 +761,20 @@ void SignpostIntrinsicTriangulation::resolveNewVertex(Vertex newV, SurfacePoint
   } while (currHe != firstHe);
 }
 
+void SignpostIntrinsicTriangulation::saveCheckpointData() {
+  IntrinsicTriangulation::saveCheckpointData();
+  checkpointSignpostAngle = signpostAngle.raw();
+  checkpointEdgeIsOriginal = edgeIsOriginal.raw();
+}
+
+void SignpostIntrinsicTriangulation::restoreCheckpointData() {
+  IntrinsicTriangulation::restoreCheckpointData();
+  signpostAngle.raw().head(checkpointSignpostAngle.size()) = checkpointSignpostAngle;
+  edgeIsOriginal.raw().head(checkpointEdgeIsOriginal.size()) = checkpointEdgeIsOriginal;
+}
+
 void SignpostIntrinsicTriangulation::constructCommonSubdivision() {
+  GC_PROFILE_SCOPE("SignpostIntrinsicTriangulation::constructCommonSubdivision");
 
   intrinsicMesh->compress();
 
@@ -851,14 +866,25 @@ void SignpostIntrinsicTriangulation::constructCommonSubdivision() {
     cs.pointsAlongB[e].push_back(bVtx[e.halfedge().tipVertex()]);
   }
 
-  // Get all the intersections right along the input mesh edges
+  // Sort the existing points along each input edge
+  std::vector<Edge> inputEdges;
+  inputEdges.reserve(inputMesh.nEdges());
   for (Edge e : inputMesh.edges()) {
-    std::vector<CommonSubdivisionPoint*>& vec = cs.pointsAlongA[e];
+    inputEdges.push_back(e);
+  }
+  parallelFor(
+      inputEdges.size(), traceThreads,
+      [&](size_t i) {
+        std::vector<CommonSubdivisionPoint*>& vec = cs.pointsAlongA[inputEdges[i]];
+        std::sort(vec.begin(), vec.end(), [](CommonSubdivisionPoint* a, CommonSubdivisionPoint* b) -> bool {
+          return a->posA.tEdge < b->posA.tEdge;
+        });
+      },
+      256);
 
-    // Sort the existing points
-    std::sort(vec.begin(), vec.end(), [](CommonSubdivisionPoint*& a, CommonSubdivisionPoint*& b) -> bool {
-      return a->posA.tEdge < b->posA.tEdge;
-    });
+  // Get all the intersections right along the input mesh edges
+  for (Edge e : inputEdges) {
+    std::vector<CommonSubdivisionPoint*>& vec = cs.pointsAlongA[e];
 
     // Prepend the first vertex point to the front
     CommonSubdivisionPoint* firstP = aVtx[e.halfedge().tailVertex()];
@@ -1,14 +1,17 @@
 #include "geometrycentral/surface/simple_idt.h"
 
 #include "geometrycentral/utilities/elementary_geometry.h"
+#include "geometrycentral/utilities/parallel.h"
 
+#include <array>
 #include <deque>
 
 namespace geometrycentral {
 namespace surface {
 
 
-size_t flipToDelaunay(SurfaceMesh& mesh, EdgeData<double>& edgeLengths, FlipType flipType, double delaunayEPS) {
+size_t flipToDelaunay(SurfaceMesh& mesh, EdgeData<double>& edgeLengths, FlipType flipType, double delaunayEPS,
+                      size_t nThreads) {
 
   // TODO all of these helpers are duplicated from signpost_intrinsic_triangulation
 
@@ -149,6 +152,85 @@ size_t flipToDelaunay(SurfaceMesh& mesh, EdgeData<double>& edgeLengths, FlipType
     return true;
   };
 
+  if (nThreads != 1) {
+    // Flip in rounds. A flip only modifies the elements of its two faces, and the connectivity around their vertices,
+    // so edges whose faces share no vertices are flipped concurrently.
+    auto diamondVertices = [](Edge e) {
+      Halfedge heA = e.halfedge();
+      Halfedge heB = heA.twin();
+      return std::array<Vertex, 6>{heA.vertex(), heA.next().vertex(), heA.next().next().vertex(),
+                                   heB.vertex(), heB.next().vertex(), heB.next().next().vertex()};
+    };
+
+    std::vector<Edge> edgesToCheck;
+    EdgeData<char> inQueue(mesh, true);
+    for (Edge e : mesh.edges()) {
+      edgesToCheck.push_back(e);
+    }
+
+    size_t nFlips = 0;
+    VertexData<char> claimed(mesh, false);
+    std::vector<char> needsFlip, wasFlipped;
+    std::vector<Edge> roundEdges, nextEdgesToCheck;
+    while (!edgesToCheck.empty()) {
+
+      // Test the queued edges
+      needsFlip.assign(edgesToCheck.size(), false);
+      parallelFor(
+          edgesToCheck.size(), nThreads, [&](size_t i) { needsFlip[i] = shouldFlipEdge(edgesToCheck[i]); }, 1024);
+
+      // Greedily choose independent edges in queue order; the others wait for a later round
+      roundEdges.clear();
+      nextEdgesToCheck.clear();
+      for (size_t i = 0; i < edgesToCheck.size(); i++) {
+        Edge e = edgesToCheck[i];
+        if (!needsFlip[i]) {
+          inQueue[e] = false;
+          continue;
+        }
+        std::array<Vertex, 6> verts = diamondVertices(e);
+        bool independent = true;
+        for (Vertex v : verts) independent = independent && !claimed[v];
+        if (!independent) {
+          nextEdgesToCheck.push_back(e);
+          continue;
+        }
+        for (Vertex v : verts) claimed[v] = true;
+        roundEdges.push_back(e);
+      }
+
+      // Flip them all
+      wasFlipped.assign(roundEdges.size(), false);
+      parallelFor(
+          roundEdges.size(), nThreads, [&](size_t i) { wasFlipped[i] = flipEdgeIfNotDelaunay(roundEdges[i]); }, 64);
+
+      // Handle the aftermath of the flips
+      for (size_t i = 0; i < roundEdges.size(); i++) {
+        Edge e = roundEdges[i];
+        inQueue[e] = false;
+        for (Vertex v : diamondVertices(e)) claimed[v] = false;
+        if (!wasFlipped[i]) continue;
+        nFlips++;
+
+        // Add neighbors to queue, as they may need flipping now
+        Halfedge he = e.halfedge();
+        Halfedge heN = he.next();
+        Halfedge heT = he.twin();
+        Halfedge heTN = heT.next();
+        for (Edge nE : {heN.edge(), heN.next().edge(), heTN.edge(), heTN.next().edge()}) {
+          if (!inQueue[nE]) {
+            nextEdgesToCheck.push_back(nE);
+            inQueue[nE] = true;
+          }
+        }
+      }
+
+      std::swap(edgesToCheck, nextEdgesToCheck);
+    }
+
+    return nFlips;
+  }
+
   std::deque<Edge> edgesToCheck;
   EdgeData<char> inQueue(mesh, true);
   for (Edge e : mesh.edges()) {
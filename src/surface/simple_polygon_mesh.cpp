@@ -1,14 +1,21 @@
 #include "geometrycentral/surface/simple_polygon_mesh.h"
 
+#include "geometrycentral/utilities/formatted_output.h"
+#include "geometrycentral/utilities/parallel.h"
+#include "geometrycentral/utilities/vertex_welding.h"
+
 #include "happly.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <set>
 #include <sstream>
 #include <string>
-#include <iomanip>
-#include <unordered_set>
+#include <limits>
 // For strncmp
 #include <string.h>
 
@@ -36,60 +43,162 @@ SimplePolygonMesh::SimplePolygonMesh(const std::vector<std::vector<size_t>>& pol
 
 namespace { // helpers for parsing
 
-// String manipulation helpers to parse .obj files
-// See http://stackoverflow.com/a/236803
-// ONEDAY: move to utility?
-std::vector<std::string>& split(const std::string& s, char delim, std::vector<std::string>& elems) {
-  std::stringstream ss(s);
-  std::string item;
-  while (std::getline(ss, item, delim)) {
-    elems.push_back(item);
+// == Fast .obj parsing
+// The whole file is read into one buffer, split into chunks at line boundaries, and the chunks are parsed in parallel
+// into flat arrays which are then stitched together.
+
+const size_t OBJ_READ_BLOCK_SIZE = 1 << 24;
+const size_t OBJ_CHUNK_SIZE = 1 << 22;
+const long long OBJ_NO_INDEX = std::numeric_limits<long long>::min();
+
+// Read the remainder of a stream into a string, in large blocks
+std::string readStreamIntoBuffer(std::istream& in) {
+  std::string buffer;
+  size_t size = 0;
+  while (in) {
+    buffer.resize(size + OBJ_READ_BLOCK_SIZE);
+    in.read(&buffer[size], OBJ_READ_BLOCK_SIZE);
+    size += static_cast<size_t>(in.gcount());
   }
-  return elems;
-}
-std::vector<std::string> split(const std::string& s, char delim) {
-  std::vector<std::string> elems;
-  split(s, delim, elems);
-  return elems;
+  buffer.resize(size);
+  return buffer;
 }
 
-class Index {
-public:
-  Index() {}
+inline bool isLineEnd(char c) { return c == '\n' || c == '\r' || c == '\0'; }
 
-  Index(long long int v, long long int vt, long long int vn) : position(v), uv(vt), normal(vn) {}
+// Skips spaces and tabs within a line, including a backslash line continuation
+inline void skipSpace(const char*& p) {
+  while (true) {
+    if (*p == ' ' || *p == '\t' || *p == '\v' || *p == '\f') {
+      p++;
+    } else if (*p == '\\' && (p[1] == '\n' || (p[1] == '\r' && p[2] == '\n'))) {
+      p += (p[1] == '\n') ? 2 : 3;
+    } else {
+      return;
+    }
+  }
+}
 
-  bool operator<(const Index& i) const {
-    if (position < i.position) return true;
-    if (position > i.position) return false;
-    if (uv < i.uv) return true;
-    if (uv > i.uv) return false;
-    if (normal < i.normal) return true;
-    if (normal > i.normal) return false;
+// True if the line ending at the newline at p is continued onto the next line
+inline bool isContinuedLine(const char* begin, const char* p) {
+  if (p > begin && p[-1] == '\r') p--;
+  return p > begin && p[-1] == '\\';
+}
 
-    return false;
+// Advances past the end of the current (possibly continued) line
+inline void skipLine(const char*& p, const char* end) {
+  while (p < end) {
+    if (*p == '\\' && (p[1] == '\n' || (p[1] == '\r' && p[2] == '\n'))) {
+      p += (p[1] == '\n') ? 2 : 3;
+    } else if (*p == '\n') {
+      p++;
+      return;
+    } else {
+      p++;
+    }
   }
+}
 
-  long long int position = -1;
-  long long int uv = -1;
-  long long int normal = -1;
+// Everything parsed from one chunk of an .obj file. Face corners hold 0-based vertex and uv indices. Relative
+// (negative) indices can only be resolved against the number of elements in the preceding chunks, so they are stored
+// relative to the start of this chunk, with their positions in the corner arrays listed for fixing up later.
+struct ObjChunk {
+  std::vector<Vector3> positions;
+  std::vector<Vector2> coords;
+  std::vector<size_t> faceStart = {0};
+  std::vector<long long> cornerVertex;
+  std::vector<long long> cornerCoord; // OBJ_NO_INDEX if absent
+  std::vector<size_t> relativeVertexCorners;
+  std::vector<size_t> relativeCoordCorners;
+  size_t nFacesWithCoords = 0;
 };
 
-Index parseFaceIndex(const std::string& token) {
-  std::stringstream in(token);
-  std::string indexString;
-  int indices[3] = {1, 1, 1};
+void throwObjParseError(const char* lineStart, const std::string& what) {
+  const char* lineEnd = lineStart;
+  while (!isLineEnd(*lineEnd)) lineEnd++;
+  throw std::runtime_error("Failed to parse obj file: " + what + " on line \"" + std::string(lineStart, lineEnd) +
+                           "\"");
+}
+
+// Parse all lines in [begin, end), which must start at the beginning of a line and end at the end of one
+void parseObjChunk(const char* begin, const char* end, ObjChunk& chunk) {
+  const char* p = begin;
+  while (p < end) {
+    const char* lineStart = p;
+    skipSpace(p);
 
-  int i = 0;
-  while (std::getline(in, indexString, '/')) {
-    if (indexString != "\\") {
-      std::stringstream ss(indexString);
-      ss >> indices[i++];
+    if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+      p++;
+      Vector3 position;
+      for (int i = 0; i < 3; i++) {
+        skipSpace(p);
+        if (!parseDouble(p, position[i])) throwObjParseError(lineStart, "bad vertex position");
+      }
+      chunk.positions.push_back(position);
+
+    } else if (p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+      p += 2;
+      Vector2 coord{0., 0.};
+      skipSpace(p);
+      if (!parseDouble(p, coord.x)) throwObjParseError(lineStart, "bad texture coordinate");
+      skipSpace(p);
+      parseDouble(p, coord.y);
+      chunk.coords.push_back(coord);
+
+    } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+      p++;
+      bool hasCoords = false;
+      while (true) {
+        skipSpace(p);
+        if (isLineEnd(*p) || *p == '#') break;
+
+        // v, v/vt, v//vn, or v/vt/vn, where negative indices count back from the most recent element
+        long long vInd, vtInd, vnInd;
+        if (!parseInteger(p, vInd) || vInd == 0) throwObjParseError(lineStart, "bad face index");
+        if (vInd < 0) {
+          vInd += static_cast<long long>(chunk.positions.size());
+          chunk.relativeVertexCorners.push_back(chunk.cornerVertex.size());
+        } else {
+          vInd--;
+        }
+        chunk.cornerVertex.push_back(vInd);
+
+        long long coordInd = OBJ_NO_INDEX;
+        if (*p == '/') {
+          p++;
+          if (*p != '/') {
+            if (!parseInteger(p, vtInd) || vtInd == 0) throwObjParseError(lineStart, "bad texture coordinate index");
+            if (vtInd < 0) {
+              vtInd += static_cast<long long>(chunk.coords.size());
+              chunk.relativeCoordCorners.push_back(chunk.cornerCoord.size());
+            } else {
+              vtInd--;
+            }
+            coordInd = vtInd;
+            hasCoords = true;
+          }
+          if (*p == '/') {
+            p++;
+            // an empty normal index ("1/2/") is allowed
+            bool emptyIndex = *p == ' ' || *p == '\t' || *p == '\\' || *p == '#' || isLineEnd(*p);
+            if (!emptyIndex && !parseInteger(p, vnInd)) {
+              throwObjParseError(lineStart, "bad normal index");
+            }
+          }
+        }
+        chunk.cornerCoord.push_back(coordInd);
+
+        if (!(*p == ' ' || *p == '\t' || *p == '\\' || *p == '#' || isLineEnd(*p))) {
+          throwObjParseError(lineStart, "bad face index");
+        }
+      }
+      chunk.faceStart.push_back(chunk.cornerVertex.size());
+      if (hasCoords) chunk.nFacesWithCoords++;
     }
-  }
 
-  // decrement since indices in OBJ files are 1-based
-  return Index(indices[0] - 1, indices[1] - 1, indices[2] - 1);
+    // Anything else (normals, groups, materials, comments, ...) is ignored, as is any trailing data on the lines above
+    skipLine(p, end);
+  }
 }
 
 std::vector<std::string> supportedMeshTypes = {"obj", "ply", "stl", "off"};
@@ -165,68 +274,79 @@ void SimplePolygonMesh::readMeshFromFile(std::istream& in, std::string type) {
 void SimplePolygonMesh::readMeshFromObjFile(std::istream& in) {
   clear();
 
-  // corner UV coords, unpacked below
-  std::vector<Vector2> coords;
-  std::vector<std::vector<size_t>> polygonCoordInds;
-
-  // parse obj format
-  std::string line;
-  while (getline(in, line)) {
-    std::stringstream ss(line);
-    std::string token;
-
-    ss >> token;
-
-    if (token == "v") {
-      Vector3 position;
-      ss >> position;
-
-      vertexCoordinates.push_back(position);
-
-    } else if (token == "vt") {
-      double u, v;
-      ss >> u >> v;
-
-      coords.push_back(Vector2{u, v});
-
-    } else if (token == "vn") {
-      // Do nothing
-
-    } else if (token == "f") {
-      std::vector<size_t> face;
-      std::vector<size_t> faceCoordInds;
-      while (ss >> token) {
-        Index index = parseFaceIndex(token);
-        if (index.position < 0) {
-          getline(in, line);
-          size_t i = line.find_first_not_of("\t\n\v\f\r ");
-          index = parseFaceIndex(line.substr(i));
-        }
-
-        face.push_back(index.position);
+  const std::string buffer = readStreamIntoBuffer(in);
+  const char* bufferBegin = buffer.c_str(); // null-terminated, which the parsing helpers rely on
+  const char* bufferEnd = bufferBegin + buffer.size();
 
-        if (index.uv != -1) {
-          faceCoordInds.push_back(index.uv);
-        }
-      }
-
-      polygons.push_back(face);
-      if (!faceCoordInds.empty()) {
-        polygonCoordInds.push_back(faceCoordInds);
+  // Split the buffer in to chunks which end at line boundaries
+  std::vector<const char*> chunkStart{bufferBegin};
+  while (chunkStart.back() != bufferEnd) {
+    const char* p = chunkStart.back() + std::min(OBJ_CHUNK_SIZE, static_cast<size_t>(bufferEnd - chunkStart.back()));
+    while (p != bufferEnd && (p[-1] != '\n' || isContinuedLine(bufferBegin, p - 1))) p++;
+    chunkStart.push_back(p);
+  }
+  size_t nChunks = chunkStart.size() - 1;
+
+  std::vector<ObjChunk> chunks(nChunks);
+  parallelFor(nChunks, nThreads,
+              [&](size_t iChunk) { parseObjChunk(chunkStart[iChunk], chunkStart[iChunk + 1], chunks[iChunk]); });
+
+  // Offsets of each chunk's elements in the merged arrays
+  std::vector<size_t> vertexOffset(nChunks + 1, 0), coordOffset(nChunks + 1, 0), faceOffset(nChunks + 1, 0),
+      paramOffset(nChunks + 1, 0);
+  for (size_t iChunk = 0; iChunk < nChunks; iChunk++) {
+    const ObjChunk& chunk = chunks[iChunk];
+    vertexOffset[iChunk + 1] = vertexOffset[iChunk] + chunk.positions.size();
+    coordOffset[iChunk + 1] = coordOffset[iChunk] + chunk.coords.size();
+    faceOffset[iChunk + 1] = faceOffset[iChunk] + chunk.faceStart.size() - 1;
+    paramOffset[iChunk + 1] = paramOffset[iChunk] + chunk.nFacesWithCoords;
+  }
+  long long nVertices = static_cast<long long>(vertexOffset[nChunks]);
+
+  std::vector<Vector2> coords(coordOffset[nChunks]);
+  vertexCoordinates.resize(vertexOffset[nChunks]);
+  polygons.resize(faceOffset[nChunks]);
+  paramCoordinates.resize(paramOffset[nChunks]);
+
+  parallelFor(nChunks, nThreads, [&](size_t iChunk) {
+    ObjChunk& chunk = chunks[iChunk];
+    for (size_t iCorner : chunk.relativeVertexCorners) chunk.cornerVertex[iCorner] += vertexOffset[iChunk];
+    for (size_t iCorner : chunk.relativeCoordCorners) chunk.cornerCoord[iCorner] += coordOffset[iChunk];
+    std::copy(chunk.positions.begin(), chunk.positions.end(), vertexCoordinates.begin() + vertexOffset[iChunk]);
+    std::copy(chunk.coords.begin(), chunk.coords.end(), coords.begin() + coordOffset[iChunk]);
+  });
+
+  // Check vertex indices before building faces, so the error does not depend on the chunking
+  for (const ObjChunk& chunk : chunks) {
+    for (long long i : chunk.cornerVertex) {
+      if (i < 0 || i >= nVertices) {
+        throw std::runtime_error("Failed to parse obj file: face refers to vertex " + std::to_string(i + 1) +
+                                 ", but there are " + std::to_string(nVertices) + " vertices");
       }
     }
   }
 
-  // If we got uv coords, unpack them in to per-corner values
-  if (!polygonCoordInds.empty()) {
-    for (std::vector<size_t>& faceCoordInd : polygonCoordInds) {
-      paramCoordinates.emplace_back();
-      std::vector<Vector2>& faceCoord = paramCoordinates.back();
-      for (size_t i : faceCoordInd) {
-        if (i < coords.size()) faceCoord.push_back(coords[i]);
+  parallelFor(nChunks, nThreads, [&](size_t iChunk) {
+    const ObjChunk& chunk = chunks[iChunk];
+    size_t iParam = paramOffset[iChunk];
+    for (size_t iF = 0; iF + 1 < chunk.faceStart.size(); iF++) {
+      std::vector<size_t>& face = polygons[faceOffset[iChunk] + iF];
+      face.assign(chunk.cornerVertex.begin() + chunk.faceStart[iF],
+                  chunk.cornerVertex.begin() + chunk.faceStart[iF + 1]);
+
+      // Corner UV coords, for faces which have any (out-of-range coords are skipped)
+      bool hasCoords = false;
+      std::vector<Vector2> faceCoord;
+      for (size_t iCorner = chunk.faceStart[iF]; iCorner < chunk.faceStart[iF + 1]; iCorner++) {
+        long long i = chunk.cornerCoord[iCorner];
+        hasCoords |= i != OBJ_NO_INDEX;
+        if (i >= 0 && i < static_cast<long long>(coords.size())) faceCoord.push_back(coords[i]);
+      }
+      if (hasCoords) {
+        paramCoordinates[iParam++] = std::move(faceCoord);
       }
     }
-  }
+  });
 }
 
 // Assumes that first line has already been consumed
@@ -441,38 +561,18 @@ void SimplePolygonMesh::readMeshFromPlyFile(std::istream& in) {
 // Mutate this mesh by merging vertices with identical floating point positions.
 // Useful for loading .stl files, which don't contain information about which
 // triangle corners meet at vertices.
-void SimplePolygonMesh::mergeIdenticalVertices() {
-  std::vector<Vector3> compressedPositions;
-  // Store mapping from original vertex index to merged vertex index
-  std::vector<size_t> compressVertex;
-  compressVertex.reserve(vertexCoordinates.size());
-
-  std::unordered_map<Vector3, size_t> canonicalIndex;
-
-  for (size_t iV = 0; iV < vertexCoordinates.size(); ++iV) {
-    Vector3 v = vertexCoordinates[iV];
-    auto it = canonicalIndex.find(v);
-
-    // Check if vertex exists in map or not
-    if (it == canonicalIndex.end()) {
-      compressedPositions.push_back(v);
-      size_t vecIndex = compressedPositions.size() - 1;
-      canonicalIndex[v] = vecIndex;
-      compressVertex.push_back(vecIndex);
-    } else {
-      size_t vecIndex = it->second;
-      compressVertex.push_back(vecIndex);
-    }
-  }
-
-  vertexCoordinates = std::move(compressedPositions);
+void SimplePolygonMesh::mergeIdenticalVertices(double tolerance) {
+  std::vector<size_t> compressVertex = weldVertexPositions(vertexCoordinates, tolerance, nThreads);
 
   // Update face indices
-  for (std::vector<size_t>& face : polygons) {
-    for (size_t& iV : face) {
-      iV = compressVertex[iV];
-    }
-  }
+  parallelFor(
+      polygons.size(), nThreads,
+      [&](size_t iF) {
+        for (size_t& iV : polygons[iF]) {
+          iV = compressVertex[iV];
+        }
+      },
+      4096);
 }
 
 
@@ -480,36 +580,47 @@ std::vector<size_t> SimplePolygonMesh::stripUnusedVertices() {
 
   // Check which indices are used
   size_t nV = vertexCoordinates.size();
-  std::vector<char> vertexUsed(nV, false);
-  for (auto poly : polygons) {
-    for (auto i : poly) {
-      GC_SAFETY_ASSERT(i < nV,
-                       "polygon list has index " + std::to_string(i) + " >= num vertices " + std::to_string(nV));
-      vertexUsed[i] = true;
-    }
-  }
-
+  std::vector<std::atomic<char>> vertexUsed(nV);
+  parallelFor(
+      polygons.size(), nThreads,
+      [&](size_t iF) {
+        for (size_t i : polygons[iF]) {
+          GC_SAFETY_ASSERT(i < nV,
+                           "polygon list has index " + std::to_string(i) + " >= num vertices " + std::to_string(nV));
+          vertexUsed[i].store(true, std::memory_order_relaxed);
+        }
+      },
+      4096);
 
   // Re-index
-  std::vector<size_t> newInd(nV, INVALID_IND);
-  std::vector<Vector3> newVertexCoordinates;
-  size_t nNewV = 0;
-  for (size_t iOldV = 0; iOldV < nV; iOldV++) {
-    if (!vertexUsed[iOldV]) continue;
-    size_t iNewV = nNewV++;
-    newInd[iOldV] = iNewV;
-    newVertexCoordinates.push_back(vertexCoordinates[iOldV]);
-  }
-  vertexCoordinates = newVertexCoordinates;
+  std::vector<size_t> newInd(nV);
+  parallelFor(
+      nV, nThreads, [&](size_t iV) { newInd[iV] = vertexUsed[iV].load(std::memory_order_relaxed) ? 1 : 0; }, 16384);
+  size_t nNewV = parallelExclusiveScan(newInd, nThreads);
+  std::vector<Vector3> newVertexCoordinates(nNewV);
+  parallelFor(
+      nV, nThreads,
+      [&](size_t iOldV) {
+        if (vertexUsed[iOldV].load(std::memory_order_relaxed)) {
+          newVertexCoordinates[newInd[iOldV]] = vertexCoordinates[iOldV];
+        } else {
+          newInd[iOldV] = INVALID_IND;
+        }
+      },
+      16384);
+  vertexCoordinates = std::move(newVertexCoordinates);
 
   // Translate the polygon listing
-  for (auto& poly : polygons) {
-    for (auto& i : poly) {
-      i = newInd[i];
-    }
-  }
+  parallelFor(
+      polygons.size(), nThreads,
+      [&](size_t iF) {
+        for (size_t& i : polygons[iF]) {
+          i = newInd[i];
+        }
+      },
+      4096);
 
-  return newInd; 
+  return newInd;
 }
 
 void SimplePolygonMesh::clear() {
@@ -521,34 +632,51 @@ void SimplePolygonMesh::clear() {
 
 void SimplePolygonMesh::stripFacesWithDuplicateVertices() {
 
-  std::vector<std::vector<size_t>> newFaces;
-  for (const std::vector<size_t>& face : polygons) {
-
-    // Generally use a simple search
-    size_t D = face.size();
-    bool hasRepeat = false;
-    if (D < 8) {
-      for (size_t i = 0; i < D; i++) {
-        for (size_t j = i + 1; j < D; j++) {
-          if (face[i] == face[j]) hasRepeat = true;
+  // Find the faces to keep
+  std::vector<size_t> newFaceInd(polygons.size());
+  parallelFor(
+      polygons.size(), nThreads,
+      [&](size_t iF) {
+        const std::vector<size_t>& face = polygons[iF];
+
+        // Generally use a simple search
+        size_t D = face.size();
+        bool hasRepeat = false;
+        if (D < 8) {
+          for (size_t i = 0; i < D; i++) {
+            for (size_t j = i + 1; j < D; j++) {
+              if (face[i] == face[j]) hasRepeat = true;
+            }
+          }
+        }
+        // Sort a copy to avoid n^2 for big faces
+        else {
+          std::vector<size_t> inds(face);
+          std::sort(inds.begin(), inds.end());
+          hasRepeat = std::adjacent_find(inds.begin(), inds.end()) != inds.end();
         }
-      }
-    }
-    // Use a hashset to avoid n^2 for big faces
-    else {
-      std::unordered_set<size_t> inds;
-      for (size_t ind : face) {
-        if (inds.find(ind) != inds.end()) hasRepeat = true;
-        inds.insert(ind);
-      }
-    }
-
-    if (!hasRepeat) {
-      newFaces.push_back(face);
-    }
-  }
 
-  polygons = newFaces;
+        newFaceInd[iF] = hasRepeat ? 0 : 1;
+      },
+      4096);
+
+  // Compact the kept faces, and their parameterization if there is one
+  std::vector<size_t> keep(newFaceInd);
+  size_t nNewF = parallelExclusiveScan(newFaceInd, nThreads);
+  bool hasParam = paramCoordinates.size() == polygons.size();
+  std::vector<std::vector<size_t>> newFaces(nNewF);
+  std::vector<std::vector<Vector2>> newParamCoordinates(hasParam ? nNewF : 0);
+  parallelFor(
+      polygons.size(), nThreads,
+      [&](size_t iF) {
+        if (!keep[iF]) return;
+        newFaces[newFaceInd[iF]] = std::move(polygons[iF]);
+        if (hasParam) newParamCoordinates[newFaceInd[iF]] = std::move(paramCoordinates[iF]);
+      },
+      4096);
+
+  polygons = std::move(newFaces);
+  if (hasParam) paramCoordinates = std::move(newParamCoordinates);
 }
 
 
@@ -577,8 +705,10 @@ void SimplePolygonMesh::writeMesh(std::string filename, std::string type) {
     type = detectFileType(filename);
   }
 
-  // NOTE if/when we ever start writing binary file formats, will need to open in binary mode for those formats
-  std::ofstream outStream(filename);
+  // Binary formats must be opened in binary mode
+  std::ios_base::openmode mode = std::ios::out;
+  if (type == "ply") mode |= std::ios::binary;
+  std::ofstream outStream(filename, mode);
   if (!outStream) throw std::runtime_error("couldn't open output file " + filename);
   writeMesh(outStream, type);
 }
@@ -586,6 +716,8 @@ void SimplePolygonMesh::writeMesh(std::string filename, std::string type) {
 void SimplePolygonMesh::writeMesh(std::ostream& out, std::string type) {
   if (type == "obj") {
     return writeMeshObj(out);
+  } else if (type == "ply") {
+    return writeMeshPly(out);
   } else {
     throw std::runtime_error("Write mesh file type " + type + " not supported");
   }
@@ -593,42 +725,180 @@ void SimplePolygonMesh::writeMesh(std::ostream& out, std::string type) {
 
 void SimplePolygonMesh::writeMeshObj(std::ostream& out) {
 
-  // Make sure we write out at full precision
-  out << std::setprecision(std::numeric_limits<double>::max_digits10);
+  // Numbers are written with formatDouble(), which gives the shortest string that reads back to the same value, so
+  // there is no loss of precision
 
   // Write header
-  out << "# Mesh exported from geometry-central" << std::endl;
-  out << "#  vertices: " << vertexCoordinates.size() << std::endl;
-  out << "#     faces: " << polygons.size() << std::endl;
-  out << std::endl;
+  out << "# Mesh exported from geometry-central\n";
+  out << "#  vertices: " << vertexCoordinates.size() << "\n";
+  out << "#     faces: " << polygons.size() << "\n";
+  out << "\n";
 
   // Write vertices
-  for (Vector3 p : vertexCoordinates) {
-    out << "v " << p.x << " " << p.y << " " << p.z << std::endl;
+  writeInParallel(
+      out, vertexCoordinates.size(),
+      [&](size_t iV, std::string& buffer) {
+        char line[3 * FORMAT_BUFFER_SIZE + 8];
+        char* p = line;
+        *p++ = 'v';
+        for (int j = 0; j < 3; j++) {
+          *p++ = ' ';
+          p = formatDouble(p, vertexCoordinates[iV][j]);
+        }
+        *p++ = '\n';
+        buffer.append(line, p);
+      },
+      nThreads);
+
+  // Texture coordinates are numbered consecutively, in face order
+  bool useCoords = !paramCoordinates.empty();
+  std::vector<size_t> coordStart;
+  if (useCoords) {
+    if (paramCoordinates.size() != polygons.size()) {
+      throw std::runtime_error("paramCoordinates must have one entry per polygon");
+    }
+    coordStart.resize(polygons.size());
+    parallelFor(polygons.size(), nThreads, [&](size_t iF) { coordStart[iF] = paramCoordinates[iF].size(); });
+    parallelExclusiveScan(coordStart, nThreads);
   }
 
-
   // Write texture coords (if present)
-  for (std::vector<Vector2>& coords : paramCoordinates) {
-    for (Vector2 c : coords) {
-      out << "vt " << c.x << " " << c.y << std::endl;
-    }
+  if (useCoords) {
+    writeInParallel(
+        out, paramCoordinates.size(),
+        [&](size_t iF, std::string& buffer) {
+          for (Vector2 c : paramCoordinates[iF]) {
+            char line[2 * FORMAT_BUFFER_SIZE + 8];
+            char* p = line;
+            *p++ = 'v';
+            *p++ = 't';
+            *p++ = ' ';
+            p = formatDouble(p, c.x);
+            *p++ = ' ';
+            p = formatDouble(p, c.y);
+            *p++ = '\n';
+            buffer.append(line, p);
+          }
+        },
+        nThreads);
   }
 
   // Write faces
-  size_t iC = 0;
-  for (std::vector<size_t>& face : polygons) {
-    out << "f";
-    for (size_t ind : face) {
-      out << " " << (ind + 1);
-
-      if (!paramCoordinates.empty()) {
-        out << "/" << (iC + 1);
-        iC++;
-      }
-    }
-    out << std::endl;
+  writeInParallel(
+      out, polygons.size(),
+      [&](size_t iF, std::string& buffer) {
+        const std::vector<size_t>& face = polygons[iF];
+        if (useCoords && paramCoordinates[iF].size() != face.size()) {
+          throw std::runtime_error("paramCoordinates must have one entry per polygon corner");
+        }
+        buffer.push_back('f');
+        for (size_t j = 0; j < face.size(); j++) {
+          char entry[2 * FORMAT_BUFFER_SIZE + 4];
+          char* p = entry;
+          *p++ = ' ';
+          p = formatInteger(p, face[j] + 1);
+          if (useCoords) {
+            *p++ = '/';
+            p = formatInteger(p, coordStart[iF] + j + 1);
+          }
+          buffer.append(entry, p);
+        }
+        buffer.push_back('\n');
+      },
+      nThreads);
+}
+
+namespace {
+
+bool hostIsLittleEndian() {
+  uint32_t probe = 1;
+  char firstByte;
+  std::memcpy(&firstByte, &probe, 1);
+  return firstByte == 1;
+}
+
+template <typename T>
+void appendBinary(std::string& buffer, T val) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &val, sizeof(T));
+  buffer.append(bytes, sizeof(T));
+}
+
+} // namespace
+
+void SimplePolygonMesh::writeMeshPly(std::ostream& out) {
+
+  // Vertex indices are written as 32-bit ints, which every ply reader supports
+  if (vertexCoordinates.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    throw std::runtime_error("too many vertices to write a ply file");
   }
+  bool useCoords = !paramCoordinates.empty();
+  if (useCoords && paramCoordinates.size() != polygons.size()) {
+    throw std::runtime_error("paramCoordinates must have one entry per polygon");
+  }
+
+  // Face degrees are written as a uchar, unless some face is too big for that
+  size_t maxDegree = 0;
+  for (const std::vector<size_t>& face : polygons) maxDegree = std::max(maxDegree, face.size());
+  bool smallIndexLists = maxDegree <= std::numeric_limits<uint8_t>::max();
+  bool smallCoordLists = 2 * maxDegree <= std::numeric_limits<uint8_t>::max();
+
+  // Write header. Data is written in the byte order of this machine.
+  out << "ply\n";
+  out << "format " << (hostIsLittleEndian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n";
+  out << "comment Mesh exported from geometry-central\n";
+  out << "element vertex " << vertexCoordinates.size() << "\n";
+  out << "property double x\n";
+  out << "property double y\n";
+  out << "property double z\n";
+  out << "element face " << polygons.size() << "\n";
+  out << "property list " << (smallIndexLists ? "uchar" : "uint") << " int vertex_indices\n";
+  if (useCoords) {
+    // Texture coordinates are stored per face corner, as u1 v1 u2 v2 ..., following the convention used by MeshLab
+    out << "property list " << (smallCoordLists ? "uchar" : "uint") << " double texcoord\n";
+  }
+  out << "end_header\n";
+
+  // Write vertices
+  writeInParallel(
+      out, vertexCoordinates.size(),
+      [&](size_t iV, std::string& buffer) {
+        for (int j = 0; j < 3; j++) appendBinary<double>(buffer, vertexCoordinates[iV][j]);
+      },
+      nThreads);
+
+  // Write faces
+  auto appendCount = [](std::string& buffer, size_t count, bool small) {
+    if (small) {
+      appendBinary<uint8_t>(buffer, static_cast<uint8_t>(count));
+    } else {
+      appendBinary<uint32_t>(buffer, static_cast<uint32_t>(count));
+    }
+  };
+  writeInParallel(
+      out, polygons.size(),
+      [&](size_t iF, std::string& buffer) {
+        const std::vector<size_t>& face = polygons[iF];
+        appendCount(buffer, face.size(), smallIndexLists);
+        for (size_t ind : face) {
+          if (ind >= vertexCoordinates.size()) {
+            throw std::runtime_error("polygon vertex index out of range while writing ply file");
+          }
+          appendBinary<int32_t>(buffer, static_cast<int32_t>(ind));
+        }
+        if (useCoords) {
+          const std::vector<Vector2>& coords = paramCoordinates[iF];
+          if (coords.size() != face.size()) {
+            throw std::runtime_error("paramCoordinates must have one entry per polygon corner");
+          }
+          appendCount(buffer, 2 * coords.size(), smallCoordLists);
+          for (Vector2 c : coords) {
+            appendBinary<double>(buffer, c.x);
+            appendBinary<double>(buffer, c.y);
+          }
+        }
+      },
+      nThreads);
 }
 
 std::unique_ptr<SimplePolygonMesh> unionMeshes(const std::vector<SimplePolygonMesh>& meshes) {
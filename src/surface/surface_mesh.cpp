@@ -3,7 +3,7 @@
 #include "geometrycentral/surface/manifold_surface_mesh.h"
 #include "geometrycentral/utilities/combining_hash_functions.h"
 #include "geometrycentral/utilities/disjoint_sets.h"
-#include "geometrycentral/utilities/timing.h"
+#include "geometrycentral/utilities/profiler.h"
 
 #include <algorithm>
 #include <limits>
@@ -65,7 +65,7 @@ SurfaceMesh::SurfaceMesh(const std::vector<std::vector<size_t>>& polygons,
   // Assumes that the input index set is dense. This sometimes isn't true of (eg) obj files floating around the
   // internet, so consider removing unused vertices first when reading from foreign sources.
 
-  // START_TIMING(construction)
+  GC_PROFILE_SCOPE("SurfaceMesh construction");
 
   // Check input list and measure some element counts
   nFacesCount = polygons.size();
@@ -214,14 +214,161 @@ SurfaceMesh::SurfaceMesh(const std::vector<std::vector<size_t>>& polygons,
 }
 
 
-SurfaceMesh::SurfaceMesh(const std::vector<size_t>& heNextArr_, const std::vector<size_t>& heVertexArr_,
-                         const std::vector<size_t>& heFaceArr_, const std::vector<size_t>& vHalfedgeArr_,
-                         const std::vector<size_t>& fHalfedgeArr_, const std::vector<size_t>& heSiblingArr_,
-                         const std::vector<size_t>& heEdgeArr_, const std::vector<char>& heOrientArr_,
-                         const std::vector<size_t>& eHalfedgeArr_, size_t nBoundaryLoopsFillCount_)
-    : heNextArr(heNextArr_), heVertexArr(heVertexArr_), heFaceArr(heFaceArr_), vHalfedgeArr(vHalfedgeArr_),
-      fHalfedgeArr(fHalfedgeArr_), useImplicitTwinFlag(false), heSiblingArr(heSiblingArr_), heEdgeArr(heEdgeArr_),
-      heOrientArr(heOrientArr_), eHalfedgeArr(eHalfedgeArr_) {
+SurfaceMesh::SurfaceMesh(const std::vector<size_t>& faceVertexIndices, size_t faceDegree)
+    : useImplicitTwinFlag(false) {
+  GC_SAFETY_ASSERT(faceDegree >= 3, "faces must have degree >= 3");
+  GC_SAFETY_ASSERT(faceVertexIndices.size() % faceDegree == 0, "face index list must be a multiple of face degree");
+  initializeFromFlatFaces(faceVertexIndices, faceDegree, {});
+}
+
+SurfaceMesh::SurfaceMesh(const std::vector<size_t>& faceVertexIndices, const std::vector<size_t>& faceStart)
+    : useImplicitTwinFlag(false) {
+  GC_SAFETY_ASSERT(!faceStart.empty() && faceStart.front() == 0 && faceStart.back() == faceVertexIndices.size(),
+                   "face start offsets must run from 0 to the length of the face index list");
+  initializeFromFlatFaces(faceVertexIndices, 0, faceStart);
+}
+
+void SurfaceMesh::initializeFromFlatFaces(const std::vector<size_t>& faceVertexIndices, size_t faceDegree,
+                                          const std::vector<size_t>& faceStart) {
+  GC_PROFILE_SCOPE("SurfaceMesh construction");
+
+  // Produces exactly the same mesh as the polygon list constructor, but rather than hashing vertex pairs, halfedges
+  // are grouped in to edges via a compressed list of the halfedges at the lower-indexed endpoint of each. This keeps
+  // temporary storage to a few flat arrays, which matters for very large meshes.
+
+  // Check input list and measure some element counts
+  size_t nCorners = faceVertexIndices.size();
+  nFacesCount = faceStart.empty() ? nCorners / faceDegree : faceStart.size() - 1;
+  nVerticesCount = 0;
+  for (size_t i : faceVertexIndices) {
+    nVerticesCount = std::max(nVerticesCount, i);
+  }
+  nVerticesCount++; // 0-based means count is max+1
+
+  // === Walk the faces, creating halfedges. Corner iC becomes halfedge iC.
+  nHalfedgesCount = nCorners;
+  nInteriorHalfedgesCount = nCorners;
+  heNextArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  heVertexArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  heFaceArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  vHalfedgeArr = std::vector<size_t>(nVerticesCount, INVALID_IND);
+  fHalfedgeArr = std::vector<size_t>(nFacesCount, INVALID_IND);
+  for (size_t iFace = 0; iFace < nFacesCount; iFace++) {
+    size_t iStart = faceStart.empty() ? iFace * faceDegree : faceStart[iFace];
+    size_t iEnd = faceStart.empty() ? iStart + faceDegree : faceStart[iFace + 1];
+    GC_SAFETY_ASSERT(iEnd >= iStart + 3, "faces must have degree >= 3");
+
+    fHalfedgeArr[iFace] = iStart;
+    for (size_t iHe = iStart; iHe < iEnd; iHe++) {
+      size_t indTail = faceVertexIndices[iHe];
+      heNextArr[iHe] = (iHe + 1 == iEnd) ? iStart : iHe + 1;
+      heVertexArr[iHe] = indTail;
+      heFaceArr[iHe] = iFace;
+      vHalfedgeArr[indTail] = iHe;
+    }
+  }
+
+#ifndef NGC_SAFETY_CHECKS
+  // Look for any vertices which were unreferenced
+  for (size_t iV = 0; iV < nVerticesCount; iV++) {
+    GC_SAFETY_ASSERT(vHalfedgeArr[iV] != INVALID_IND, "unreferenced vertex " + std::to_string(iV));
+  }
+#endif
+
+  // === Create edges and hook up siblings
+  // Any halfedges between a pair of vertices are considered to be incident on the same edge
+  heSiblingArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  heEdgeArr = std::vector<size_t>(nHalfedgesCount, INVALID_IND);
+  heOrientArr = std::vector<char>(nHalfedgesCount, true);
+  auto heLowVertex = [&](size_t iHe) -> size_t {
+    return std::min(heVertexArr[iHe], heVertexArr[heNextArr[iHe]]);
+  };
+  auto heHighVertex = [&](size_t iHe) -> size_t {
+    return std::max(heVertexArr[iHe], heVertexArr[heNextArr[iHe]]);
+  };
+
+  { // Group halfedges by their endpoints
+
+    // Build a compressed list of the halfedges at the lower-indexed endpoint of each vertex, in increasing order
+    std::vector<size_t> vertexLowStart(nVerticesCount + 1, 0);
+    for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
+      vertexLowStart[heLowVertex(iHe) + 1]++;
+    }
+    for (size_t iV = 0; iV < nVerticesCount; iV++) {
+      vertexLowStart[iV + 1] += vertexLowStart[iV];
+    }
+    std::vector<size_t> vertexLowHalfedges(nHalfedgesCount);
+    {
+      std::vector<size_t> fillCount(vertexLowStart.begin(), vertexLowStart.end() - 1);
+      for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
+        vertexLowHalfedges[fillCount[heLowVertex(iHe)]++] = iHe;
+      }
+    }
+
+    // Within each list, gather the halfedges which share the other endpoint as well. The first halfedge of each group
+    // is the lowest-indexed one, and each later halfedge points back to the one before it, exactly as in the polygon
+    // constructor. For now, heEdgeArr holds the first halfedge of each group.
+    for (size_t iV = 0; iV < nVerticesCount; iV++) {
+      for (size_t i = vertexLowStart[iV]; i < vertexLowStart[iV + 1]; i++) {
+        size_t firstHe = vertexLowHalfedges[i];
+        if (heEdgeArr[firstHe] != INVALID_IND) continue;
+
+        size_t indHigh = heHighVertex(firstHe);
+        size_t lastHe = firstHe;
+        heEdgeArr[firstHe] = firstHe;
+        for (size_t j = i + 1; j < vertexLowStart[iV + 1]; j++) {
+          size_t iHe = vertexLowHalfedges[j];
+          if (heHighVertex(iHe) != indHigh) continue;
+          heEdgeArr[iHe] = firstHe;
+          heSiblingArr[iHe] = lastHe;
+          // best we can to is set orientation to match endpoints (need a richer representation to input orientation if
+          // endpoints are not unique)
+          heOrientArr[iHe] = (heVertexArr[iHe] == heVertexArr[firstHe]);
+          lastHe = iHe;
+        }
+        heSiblingArr[firstHe] = lastHe; // connect the first to the last (or itself, for a boundary halfedge)
+      }
+    }
+  }
+
+  // Number the edges in the order their first halfedge appears
+  nEdgesCount = 0;
+  eHalfedgeArr.clear();
+  for (size_t iHe = 0; iHe < nHalfedgesCount; iHe++) {
+    size_t firstHe = heEdgeArr[iHe];
+    if (firstHe == iHe) {
+      heEdgeArr[iHe] = nEdgesCount++;
+      eHalfedgeArr.push_back(iHe);
+    } else {
+      heEdgeArr[iHe] = heEdgeArr[firstHe]; // already renumbered, since firstHe < iHe
+    }
+  }
+
+  // Set capacities and other properties
+  nVerticesCapacityCount = nVerticesCount;
+  nHalfedgesCapacityCount = nHalfedgesCount;
+  nEdgesCapacityCount = nEdgesCount;
+  nFacesCapacityCount = nFacesCount;
+  nVerticesFillCount = nVerticesCount;
+  nHalfedgesFillCount = nHalfedgesCount;
+  nEdgesFillCount = nEdgesCount;
+  nFacesFillCount = nFacesCount;
+
+  initializeHalfedgeNeighbors();
+
+  isCompressedFlag = true;
+}
+
+
+SurfaceMesh::SurfaceMesh(std::vector<size_t> heNextArr_, std::vector<size_t> heVertexArr_,
+                         std::vector<size_t> heFaceArr_, std::vector<size_t> vHalfedgeArr_,
+                         std::vector<size_t> fHalfedgeArr_, std::vector<size_t> heSiblingArr_,
+                         std::vector<size_t> heEdgeArr_, std::vector<char> heOrientArr_,
+                         std::vector<size_t> eHalfedgeArr_, size_t nBoundaryLoopsFillCount_)
+    : heNextArr(std::move(heNextArr_)), heVertexArr(std::move(heVertexArr_)), heFaceArr(std::move(heFaceArr_)),
+      vHalfedgeArr(std::move(vHalfedgeArr_)), fHalfedgeArr(std::move(fHalfedgeArr_)), useImplicitTwinFlag(false),
+      heSiblingArr(std::move(heSiblingArr_)), heEdgeArr(std::move(heEdgeArr_)), heOrientArr(std::move(heOrientArr_)),
+      eHalfedgeArr(std::move(eHalfedgeArr_)) {
 
   // == Set all counts
   nHalfedgesCount = heNextArr.size();
@@ -362,6 +509,27 @@ void SurfaceMesh::printStatistics() const {
   std::cout << "      and " << nBoundaryLoops() << " boundary components. " << std::endl;
 }
 
+SurfaceMeshMemoryReport SurfaceMesh::getMemoryReport() const {
+  SurfaceMeshMemoryReport report;
+
+  for (const std::vector<size_t>* arr :
+       {&heNextArr, &heVertexArr, &heFaceArr, &vHalfedgeArr, &fHalfedgeArr, &heSiblingArr, &heEdgeArr, &eHalfedgeArr,
+        &heVertInNextArr, &heVertInPrevArr, &vHeInStartArr, &heVertOutNextArr, &heVertOutPrevArr, &vHeOutStartArr}) {
+    report.connectivityBytes += arr->capacity() * sizeof(size_t);
+  }
+  report.connectivityBytes += heOrientArr.capacity() * sizeof(char);
+
+  std::lock_guard<std::mutex> lock(callbackRegistrationMutex);
+  for (const std::function<size_t()>& f : meshDataMemoryCallbackList) {
+    report.nMeshData++;
+    report.meshDataBytes += f();
+  }
+
+  return report;
+}
+
+size_t SurfaceMesh::bufferBytes() const { return getMemoryReport().totalBytes(); }
+
 
 bool SurfaceMesh::hasBoundary() {
   for (Edge e : edges()) {
@@ -591,6 +759,30 @@ std::unique_ptr<ManifoldSurfaceMesh> SurfaceMesh::toManifoldMesh() {
   return std::unique_ptr<ManifoldSurfaceMesh>(new ManifoldSurfaceMesh(polygons, twins));
 }
 
+void SurfaceMesh::restoreConnectivity(const SurfaceMesh& savedCopy) {
+  if (savedCopy.usesImplicitTwin() != usesImplicitTwin()) {
+    throw std::runtime_error("cannot restore connectivity from a mesh with a different twin convention");
+  }
+
+  savedCopy.copyInternalFields(*this);
+  modificationTick++;
+
+  // Containers must span the restored index space. Capacities may have grown or shrunk (by compress()) in the meantime,
+  // so always resize them to match.
+  for (auto& f : vertexExpandCallbackList) {
+    f(nVerticesCapacityCount);
+  }
+  for (auto& f : halfedgeExpandCallbackList) {
+    f(nHalfedgesCapacityCount);
+  }
+  for (auto& f : edgeExpandCallbackList) {
+    f(nEdgesCapacityCount);
+  }
+  for (auto& f : faceExpandCallbackList) {
+    f(nFacesCapacityCount);
+  }
+}
+
 void SurfaceMesh::copyInternalFields(SurfaceMesh& target) const {
   // == Copy _all_ the fields!
 
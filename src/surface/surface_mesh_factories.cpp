@@ -1,9 +1,44 @@
 #include "geometrycentral/surface/surface_mesh_factories.h"
 
+#include <array>
+#include <map>
+#include <random>
+
 
 namespace geometrycentral {
 namespace surface {
 
+namespace {
+
+// Build a manifold mesh from a flat face index buffer, then populate positions by evaluating vertexPosition(iV). The
+// index buffer is consumed, so it can be released before the geometry is allocated.
+template <typename F>
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeProceduralMeshAndGeometry(std::vector<size_t>& faceVertexIndices, size_t faceDegree, F vertexPosition) {
+
+  std::unique_ptr<ManifoldSurfaceMesh> mesh(new ManifoldSurfaceMesh(faceVertexIndices, faceDegree));
+  faceVertexIndices.clear();
+  faceVertexIndices.shrink_to_fit();
+
+  std::unique_ptr<VertexPositionGeometry> geometry(new VertexPositionGeometry(*mesh));
+  for (size_t iV = 0; iV < mesh->nVertices(); iV++) {
+    geometry->vertexPositions[iV] = vertexPosition(iV);
+  }
+
+  return std::make_tuple(std::move(mesh), std::move(geometry));
+}
+
+// Emit the faces of a quad with corners a,b,c,d (in CCW order), either as one quad or two triangles
+void pushQuad(std::vector<size_t>& faceVertexIndices, bool triangulate, size_t a, size_t b, size_t c, size_t d) {
+  if (triangulate) {
+    faceVertexIndices.insert(faceVertexIndices.end(), {a, b, c, a, c, d});
+  } else {
+    faceVertexIndices.insert(faceVertexIndices.end(), {a, b, c, d});
+  }
+}
+
+} // namespace
+
 
 std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
 makeManifoldSurfaceMeshAndGeometry(const std::vector<std::vector<size_t>>& polygons,
@@ -111,5 +146,163 @@ makeSurfaceMeshAndGeometry(const std::vector<std::vector<size_t>>& polygons,
 }
 
 
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeGridMeshAndGeometry(size_t nX, size_t nY, bool triangulate) {
+  if (nX == 0 || nY == 0) throw std::runtime_error("grid must have at least one quad in each direction");
+
+  size_t nVertX = nX + 1;
+  auto vInd = [&](size_t i, size_t j) { return i + nVertX * j; };
+
+  size_t faceDegree = triangulate ? 3 : 4;
+  std::vector<size_t> faceVertexIndices;
+  faceVertexIndices.reserve(nX * nY * (triangulate ? 6 : 4));
+  for (size_t j = 0; j < nY; j++) {
+    for (size_t i = 0; i < nX; i++) {
+      pushQuad(faceVertexIndices, triangulate, vInd(i, j), vInd(i + 1, j), vInd(i + 1, j + 1), vInd(i, j + 1));
+    }
+  }
+
+  return makeProceduralMeshAndGeometry(faceVertexIndices, faceDegree, [&](size_t iV) {
+    size_t i = iV % nVertX;
+    size_t j = iV / nVertX;
+    return Vector3{static_cast<double>(i) / nX, static_cast<double>(j) / nY, 0.};
+  });
+}
+
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeTorusMeshAndGeometry(size_t nMajor, size_t nMinor, double majorRadius, double minorRadius, bool triangulate) {
+  if (nMajor < 3 || nMinor < 3) throw std::runtime_error("torus must have at least 3 quads in each direction");
+
+  // i indexes around the major circle, j around the minor circle
+  auto vInd = [&](size_t i, size_t j) { return (i % nMajor) + nMajor * (j % nMinor); };
+
+  size_t faceDegree = triangulate ? 3 : 4;
+  std::vector<size_t> faceVertexIndices;
+  faceVertexIndices.reserve(nMajor * nMinor * (triangulate ? 6 : 4));
+  for (size_t j = 0; j < nMinor; j++) {
+    for (size_t i = 0; i < nMajor; i++) {
+      pushQuad(faceVertexIndices, triangulate, vInd(i, j), vInd(i + 1, j), vInd(i + 1, j + 1), vInd(i, j + 1));
+    }
+  }
+
+  return makeProceduralMeshAndGeometry(faceVertexIndices, faceDegree, [&](size_t iV) {
+    double u = 2. * PI * static_cast<double>(iV % nMajor) / nMajor;
+    double v = 2. * PI * static_cast<double>(iV / nMajor) / nMinor;
+    double rad = majorRadius + minorRadius * std::cos(v);
+    return Vector3{rad * std::cos(u), rad * std::sin(u), minorRadius * std::sin(v)};
+  });
+}
+
+std::tuple<std::unique_ptr<ManifoldSurfaceMesh>, std::unique_ptr<VertexPositionGeometry>>
+makeIcosphereMeshAndGeometry(size_t frequency) {
+  if (frequency == 0) throw std::runtime_error("icosphere frequency must be at least 1");
+
+  // Base icosahedron, with faces oriented outward
+  const double phi = (1. + std::sqrt(5.)) / 2.;
+  const std::array<Vector3, 12> icoVerts{{{-1., phi, 0.},
+                                          {1., phi, 0.},
+                                          {-1., -phi, 0.},
+                                          {1., -phi, 0.},
+                                          {0., -1., phi},
+                                          {0., 1., phi},
+                                          {0., -1., -phi},
+                                          {0., 1., -phi},
+                                          {phi, 0., -1.},
+                                          {phi, 0., 1.},
+                                          {-phi, 0., -1.},
+                                          {-phi, 0., 1.}}};
+  const std::array<std::array<size_t, 3>, 20> icoFaces{{{{0, 11, 5}}, {{0, 5, 1}},  {{0, 1, 7}},   {{0, 7, 10}},
+                                                        {{0, 10, 11}}, {{1, 5, 9}},  {{5, 11, 4}},  {{11, 10, 2}},
+                                                        {{10, 7, 6}},  {{7, 1, 8}},  {{3, 9, 4}},   {{3, 4, 2}},
+                                                        {{3, 2, 6}},   {{3, 6, 8}},  {{3, 8, 9}},   {{4, 9, 5}},
+                                                        {{2, 4, 11}},  {{6, 2, 10}}, {{8, 6, 7}},   {{9, 8, 1}}}};
+
+  // Index the icosahedron edges
+  std::map<std::pair<size_t, size_t>, size_t> icoEdgeInd;
+  std::vector<std::pair<size_t, size_t>> icoEdges;
+  for (const std::array<size_t, 3>& f : icoFaces) {
+    for (size_t k = 0; k < 3; k++) {
+      std::pair<size_t, size_t> key = std::minmax(f[k], f[(k + 1) % 3]);
+      if (icoEdgeInd.find(key) == icoEdgeInd.end()) {
+        icoEdgeInd[key] = icoEdges.size();
+        icoEdges.push_back(key);
+      }
+    }
+  }
+
+  // Vertices are numbered as: icosahedron vertices, then the interior of each icosahedron edge, then the interior of
+  // each icosahedron face
+  size_t n = frequency;
+  size_t nEdgeInterior = n - 1;
+  size_t nFaceInterior = n < 2 ? 0 : (n - 1) * (n - 2) / 2;
+  size_t edgeVertStart = icoVerts.size();
+  size_t faceVertStart = edgeVertStart + icoEdges.size() * nEdgeInterior;
+  size_t nVerts = faceVertStart + icoFaces.size() * nFaceInterior;
+
+  // The vertex which is t steps along the icosahedron edge from vA to vB
+  auto edgeVert = [&](size_t vA, size_t vB, size_t t) -> size_t {
+    if (t == 0) return vA;
+    if (t == n) return vB;
+    size_t iE = icoEdgeInd[std::minmax(vA, vB)];
+    size_t tLow = (vA < vB) ? t : n - t;
+    return edgeVertStart + iE * nEdgeInterior + (tLow - 1);
+  };
+
+  // The vertex at lattice coordinate (i,j) in face iF, at position ((n-i-j)*A + i*B + j*C)/n
+  auto latticeVert = [&](size_t iF, size_t i, size_t j) -> size_t {
+    const std::array<size_t, 3>& f = icoFaces[iF];
+    if (j == 0) return edgeVert(f[0], f[1], i);
+    if (i == 0) return edgeVert(f[0], f[2], j);
+    if (i + j == n) return edgeVert(f[1], f[2], j);
+    size_t rowStart = (i - 1) * (n - 1) - (i - 1) * i / 2;
+    return faceVertStart + iF * nFaceInterior + rowStart + (j - 1);
+  };
+
+  std::vector<size_t> faceVertexIndices;
+  faceVertexIndices.reserve(3 * icoFaces.size() * n * n);
+  std::vector<Vector3> vertexPositions(nVerts);
+  for (size_t iF = 0; iF < icoFaces.size(); iF++) {
+    const std::array<size_t, 3>& f = icoFaces[iF];
+    for (size_t i = 0; i <= n; i++) {
+      for (size_t j = 0; i + j <= n; j++) {
+        Vector3 p = (static_cast<double>(n - i - j) * icoVerts[f[0]] + static_cast<double>(i) * icoVerts[f[1]] +
+                     static_cast<double>(j) * icoVerts[f[2]]);
+        vertexPositions[latticeVert(iF, i, j)] = normalize(p);
+
+        if (i + j < n) {
+          faceVertexIndices.insert(faceVertexIndices.end(),
+                                   {latticeVert(iF, i, j), latticeVert(iF, i + 1, j), latticeVert(iF, i, j + 1)});
+        }
+        if (i + j + 1 < n) {
+          faceVertexIndices.insert(faceVertexIndices.end(), {latticeVert(iF, i + 1, j), latticeVert(iF, i + 1, j + 1),
+                                                             latticeVert(iF, i, j + 1)});
+        }
+      }
+    }
+  }
+
+  return makeProceduralMeshAndGeometry(faceVertexIndices, 3, [&](size_t iV) { return vertexPositions[iV]; });
+}
+
+void perturbVertexPositions(VertexPositionGeometry& geometry, double amplitude, unsigned int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(-amplitude, amplitude);
+  for (Vertex v : geometry.mesh.vertices()) {
+    geometry.vertexPositions[v] += Vector3{dist(gen), dist(gen), dist(gen)};
+  }
+  geometry.refreshQuantities();
+}
+
+void degenerateVertexPositions(VertexPositionGeometry& geometry, double fraction, unsigned int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(0., 1.);
+  for (Vertex v : geometry.mesh.vertices()) {
+    if (dist(gen) < fraction) {
+      geometry.vertexPositions[v] = geometry.vertexPositions[v.halfedge().tipVertex()];
+    }
+  }
+  geometry.refreshQuantities();
+}
+
 } // namespace surface
 } // namespace geometrycentral
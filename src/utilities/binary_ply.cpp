@@ -0,0 +1,567 @@
+#include "geometrycentral/utilities/binary_ply.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace geometrycentral {
+
+// === Layout
+
+bool parsePlyType(const std::string& name, PlyType& type) {
+  if (name == "char" || name == "int8") {
+    type = PlyType::Int8;
+  } else if (name == "uchar" || name == "uint8") {
+    type = PlyType::UInt8;
+  } else if (name == "short" || name == "int16") {
+    type = PlyType::Int16;
+  } else if (name == "ushort" || name == "uint16") {
+    type = PlyType::UInt16;
+  } else if (name == "int" || name == "int32") {
+    type = PlyType::Int32;
+  } else if (name == "uint" || name == "uint32") {
+    type = PlyType::UInt32;
+  } else if (name == "float" || name == "float32") {
+    type = PlyType::Float32;
+  } else if (name == "double" || name == "float64") {
+    type = PlyType::Float64;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string plyTypeName(PlyType type) {
+  switch (type) {
+  case PlyType::Int8:
+    return "char";
+  case PlyType::UInt8:
+    return "uchar";
+  case PlyType::Int16:
+    return "short";
+  case PlyType::UInt16:
+    return "ushort";
+  case PlyType::Int32:
+    return "int";
+  case PlyType::UInt32:
+    return "uint";
+  case PlyType::Float32:
+    return "float";
+  case PlyType::Float64:
+    return "double";
+  }
+  return "";
+}
+
+size_t plyTypeSize(PlyType type) {
+  switch (type) {
+  case PlyType::Int8:
+  case PlyType::UInt8:
+    return 1;
+  case PlyType::Int16:
+  case PlyType::UInt16:
+    return 2;
+  case PlyType::Int32:
+  case PlyType::UInt32:
+  case PlyType::Float32:
+    return 4;
+  case PlyType::Float64:
+    return 8;
+  }
+  return 0;
+}
+
+bool plyTypeConvertible(PlyType from, PlyType to) {
+  auto family = [](PlyType type) {
+    switch (type) {
+    case PlyType::Int8:
+    case PlyType::Int16:
+    case PlyType::Int32:
+      return 0;
+    case PlyType::UInt8:
+    case PlyType::UInt16:
+    case PlyType::UInt32:
+      return 1;
+    default:
+      return 2;
+    }
+  };
+  return family(from) == family(to) && plyTypeSize(from) <= plyTypeSize(to);
+}
+
+bool PlyElement::allScalar() const {
+  for (const PlyProperty& p : properties) {
+    if (p.isList) return false;
+  }
+  return true;
+}
+
+size_t PlyElement::scalarStride() const {
+  size_t stride = 0;
+  for (const PlyProperty& p : properties) stride += plyTypeSize(p.type);
+  return stride;
+}
+
+size_t PlyElement::propertyIndex(const std::string& propertyName) const {
+  for (size_t i = 0; i < properties.size(); i++) {
+    if (properties[i].name == propertyName) return i;
+  }
+  return INVALID_IND;
+}
+
+bool parsePlyHeader(const char* begin, const char* end, std::string& format, std::vector<PlyElement>& elements,
+                    size_t& headerSize) {
+  format = "";
+  elements.clear();
+
+  if (end - begin < 3 || std::string(begin, 3) != "ply") return false;
+  const std::string endToken = "end_header";
+  const char* headerEnd = std::search(begin, end, endToken.begin(), endToken.end());
+  if (headerEnd == end) return false;
+  headerEnd += endToken.size();
+  if (headerEnd != end && *headerEnd == '\r') headerEnd++;
+  if (headerEnd == end || *headerEnd != '\n') return false;
+  headerEnd++;
+  headerSize = headerEnd - begin;
+
+  std::stringstream header(std::string(begin, headerEnd));
+  std::string line;
+  while (std::getline(header, line)) {
+    std::stringstream lineStream(line);
+    std::string keyword;
+    lineStream >> keyword;
+    if (keyword == "format") {
+      lineStream >> format;
+    } else if (keyword == "element") {
+      elements.emplace_back();
+      lineStream >> elements.back().name >> elements.back().count;
+      if (!lineStream) return false;
+    } else if (keyword == "property") {
+      if (elements.empty()) return false;
+      PlyProperty prop;
+      std::string typeName;
+      lineStream >> typeName;
+      if (typeName == "list") {
+        std::string countTypeName;
+        prop.isList = true;
+        lineStream >> countTypeName >> typeName;
+        if (!parsePlyType(countTypeName, prop.countType)) return false;
+        if (prop.countType == PlyType::Float32 || prop.countType == PlyType::Float64) return false;
+      }
+      if (!parsePlyType(typeName, prop.type)) return false;
+      lineStream >> prop.name;
+      elements.back().properties.push_back(prop);
+    }
+  }
+  return true;
+}
+
+bool plyHostIsLittleEndian() {
+  uint16_t one = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 1;
+}
+
+void checkPlyPropertyReadable(const PlyProperty& prop, PlyType requestedType, bool requestedList) {
+  if (prop.isList != requestedList) {
+    throw std::runtime_error("ply property " + prop.name + (prop.isList ? " is" : " is not") + " a list property");
+  }
+  if (!plyTypeConvertible(prop.type, requestedType)) {
+    throw std::runtime_error("ply property " + prop.name + " cannot be coerced to requested type " +
+                             plyTypeName(requestedType) + ". Has type " + plyTypeName(prop.type));
+  }
+}
+
+
+// === MappedPlyFile
+
+MappedPlyFile::MappedPlyFile(std::string filename_) : file(new MappedFile(filename_)), filename(filename_) {
+  std::string format;
+  size_t headerSize;
+  if (!parsePlyHeader(file->data(), file->data() + file->size(), format, elements, headerSize)) {
+    throw std::runtime_error("could not parse ply header of " + filename);
+  }
+  if (format != "binary_little_endian" || !plyHostIsLittleEndian()) {
+    throw std::runtime_error("ply file " + filename + " is not in the binary byte order of this machine");
+  }
+  dataOffsets.assign(elements.size(), INVALID_IND);
+  if (!elements.empty()) dataOffsets[0] = headerSize;
+}
+
+bool MappedPlyFile::canRead(std::string filename) {
+  if (!plyHostIsLittleEndian()) return false;
+  try {
+    MappedFile file(filename);
+    std::string format;
+    std::vector<PlyElement> elements;
+    size_t headerSize;
+    return parsePlyHeader(file.data(), file.data() + file.size(), format, elements, headerSize) &&
+           format == "binary_little_endian";
+  } catch (const std::runtime_error&) {
+    return false; // leave the error to whichever reader is used instead
+  }
+}
+
+size_t MappedPlyFile::findElement(const std::string& elementName) const {
+  for (size_t i = 0; i < elements.size(); i++) {
+    if (elements[i].name == elementName) return i;
+  }
+  throw std::runtime_error("ply file " + filename + " has no element " + elementName);
+}
+
+bool MappedPlyFile::hasElement(std::string elementName) const {
+  for (const PlyElement& elem : elements) {
+    if (elem.name == elementName) return true;
+  }
+  return false;
+}
+
+bool MappedPlyFile::hasProperty(std::string elementName, std::string propertyName) const {
+  return hasElement(elementName) && getElement(elementName).propertyIndex(propertyName) != INVALID_IND;
+}
+
+const PlyElement& MappedPlyFile::getElement(std::string elementName) const {
+  return elements[findElement(elementName)];
+}
+
+const PlyProperty& MappedPlyFile::getPropertyLayout(std::string elementName, std::string propertyName) const {
+  const PlyElement& elem = getElement(elementName);
+  size_t iProperty = elem.propertyIndex(propertyName);
+  if (iProperty == INVALID_IND) {
+    throw std::runtime_error("ply file " + filename + " has no property " + propertyName + " on element " +
+                             elementName);
+  }
+  return elem.properties[iProperty];
+}
+
+size_t MappedPlyFile::listCountAt(size_t offset, PlyType countType) const {
+  if (offset + plyTypeSize(countType) > file->size()) {
+    throw std::runtime_error("ply file " + filename + " is truncated");
+  }
+  return readPlyValue<size_t>(file->data() + offset, countType);
+}
+
+size_t MappedPlyFile::rowSize(const PlyElement& elem, size_t rowOffset, size_t iProperty,
+                              size_t& propertyOffset) const {
+  size_t fileSize = file->size();
+  size_t offset = rowOffset;
+  for (size_t i = 0; i < elem.properties.size(); i++) {
+    const PlyProperty& prop = elem.properties[i];
+    if (i == iProperty) propertyOffset = offset;
+    if (prop.isList) {
+      // Negative counts come back as huge values, and fail this check too
+      size_t count = listCountAt(offset, prop.countType);
+      offset += plyTypeSize(prop.countType);
+      if (count > (fileSize - offset) / plyTypeSize(prop.type)) {
+        throw std::runtime_error("ply file " + filename + " is truncated while reading element " + elem.name);
+      }
+      offset += count * plyTypeSize(prop.type);
+    } else {
+      offset += plyTypeSize(prop.type);
+      if (offset > fileSize) {
+        throw std::runtime_error("ply file " + filename + " is truncated while reading element " + elem.name);
+      }
+    }
+  }
+  return offset - rowOffset;
+}
+
+size_t MappedPlyFile::elementDataOffset(size_t iElement) {
+  // Find the last element whose offset is known, and step forward from there
+  size_t iKnown = iElement;
+  while (dataOffsets[iKnown] == INVALID_IND) iKnown--;
+
+  for (size_t i = iKnown; i < iElement; i++) {
+    const PlyElement& elem = elements[i];
+    size_t offset = dataOffsets[i];
+    if (elem.allScalar()) {
+      size_t stride = elem.scalarStride();
+      if (stride > 0 && elem.count > (file->size() - offset) / stride) {
+        throw std::runtime_error("ply file " + filename + " is truncated while reading element " + elem.name);
+      }
+      offset += elem.count * stride;
+    } else {
+      size_t unused;
+      for (size_t iRow = 0; iRow < elem.count; iRow++) {
+        offset += rowSize(elem, offset, INVALID_IND, unused);
+      }
+    }
+    dataOffsets[i + 1] = offset;
+  }
+  return dataOffsets[iElement];
+}
+
+
+// === PlyStreamWriter
+
+namespace {
+
+void seekSpill(std::FILE* spill, uint64_t offset) {
+#ifdef _WIN32
+  int result = _fseeki64(spill, static_cast<__int64>(offset), SEEK_SET);
+#else
+  int result = fseeko(spill, static_cast<off_t>(offset), SEEK_SET);
+#endif
+  if (result != 0) throw std::runtime_error("failed to seek in temporary ply data file");
+}
+
+// Rows are written out in blocks of this size, and each column is read back from the spill file in blocks of this size
+const size_t PLY_WRITE_BLOCK_SIZE = 1 << 20;
+const size_t PLY_SPILL_READ_SIZE = 1 << 18;
+
+} // namespace
+
+// Walks the serialized rows of one column, in order
+class PlyStreamWriter::ColumnCursor {
+public:
+  ColumnCursor(std::FILE* spill_, const PlyElement& elem, size_t iProperty, const Column& column)
+      : prop(elem.properties[iProperty]), spill(spill_), spillPos(column.spillOffset),
+        spillEnd(column.spillOffset + column.spillBytes), source(column.source.get()) {
+    if (source != nullptr) {
+      sourceElement = &source->getElement(elem.name);
+      sourceProperty = sourceElement->propertyIndex(prop.name);
+      rowOffset = source->elementDataOffset(source->findElement(elem.name));
+      if (sourceElement->allScalar()) {
+        sourceStride = sourceElement->scalarStride();
+        if (sourceElement->count > (source->file->size() - rowOffset) / sourceStride) {
+          throw std::runtime_error("ply file " + source->filename + " is truncated while reading element " +
+                                   elem.name);
+        }
+        for (size_t i = 0; i < sourceProperty; i++) {
+          scalarPropertyOffset += plyTypeSize(sourceElement->properties[i].type);
+        }
+      }
+    }
+  }
+
+  // Append the bytes of the next row to out
+  void appendNextRow(std::string& out) {
+    if (source != nullptr) {
+      const char* data = source->file->data();
+      if (sourceStride > 0) {
+        out.append(data + rowOffset + scalarPropertyOffset, plyTypeSize(prop.type));
+        rowOffset += sourceStride;
+      } else {
+        size_t propertyOffset;
+        size_t size = source->rowSize(*sourceElement, rowOffset, sourceProperty, propertyOffset);
+        out.append(data + propertyOffset, serializedSize(data + propertyOffset));
+        rowOffset += size;
+      }
+      return;
+    }
+
+    size_t countSize = prop.isList ? plyTypeSize(prop.countType) : plyTypeSize(prop.type);
+    fill(countSize);
+    size_t size = serializedSize(&buffer[bufferPos]);
+    fill(size);
+    out.append(&buffer[bufferPos], size);
+    bufferPos += size;
+  }
+
+private:
+  const PlyProperty& prop;
+
+  // Columns in the spill file are read through a buffer
+  std::FILE* spill;
+  uint64_t spillPos, spillEnd;
+  std::vector<char> buffer;
+  size_t bufferPos = 0;
+
+  // Columns in a source file are read from its mapping
+  MappedPlyFile* source;
+  const PlyElement* sourceElement = nullptr;
+  size_t sourceProperty = 0;
+  size_t rowOffset = 0;
+  size_t sourceStride = 0; // only for elements with no lists
+  size_t scalarPropertyOffset = 0;
+
+  size_t serializedSize(const char* bytes) const {
+    if (!prop.isList) return plyTypeSize(prop.type);
+    return plyTypeSize(prop.countType) + readPlyValue<size_t>(bytes, prop.countType) * plyTypeSize(prop.type);
+  }
+
+  // Make sure the buffer holds at least nBytes past bufferPos
+  void fill(size_t nBytes) {
+    size_t available = buffer.size() - bufferPos;
+    if (available >= nBytes) return;
+    std::vector<char> newBuffer(std::max(nBytes, std::min<size_t>(PLY_SPILL_READ_SIZE, spillEnd - spillPos + available)));
+    std::memcpy(newBuffer.data(), buffer.data() + bufferPos, available);
+    size_t toRead = std::min<uint64_t>(newBuffer.size() - available, spillEnd - spillPos);
+    seekSpill(spill, spillPos);
+    if (std::fread(newBuffer.data() + available, 1, toRead, spill) != toRead) {
+      throw std::runtime_error("failed to read temporary ply data file");
+    }
+    spillPos += toRead;
+    newBuffer.resize(available + toRead);
+    buffer.swap(newBuffer);
+    bufferPos = 0;
+  }
+};
+
+PlyStreamWriter::PlyStreamWriter() {}
+
+PlyStreamWriter::~PlyStreamWriter() {
+  if (spill != nullptr) std::fclose(spill);
+}
+
+PlyStreamWriter::PlyStreamWriter(PlyStreamWriter&& other)
+    : elements(std::move(other.elements)), columns(std::move(other.columns)), comments(std::move(other.comments)),
+      spill(other.spill), spillSize(other.spillSize) {
+  other.spill = nullptr;
+  other.clear();
+}
+
+PlyStreamWriter& PlyStreamWriter::operator=(PlyStreamWriter&& other) {
+  if (this != &other) {
+    clear();
+    elements = std::move(other.elements);
+    columns = std::move(other.columns);
+    comments = std::move(other.comments);
+    spill = other.spill;
+    spillSize = other.spillSize;
+    other.spill = nullptr;
+    other.clear();
+  }
+  return *this;
+}
+
+size_t PlyStreamWriter::findElement(const std::string& elementName) const {
+  for (size_t i = 0; i < elements.size(); i++) {
+    if (elements[i].name == elementName) return i;
+  }
+  throw std::runtime_error("ply data has no element " + elementName);
+}
+
+bool PlyStreamWriter::hasElement(std::string elementName) const {
+  for (const PlyElement& elem : elements) {
+    if (elem.name == elementName) return true;
+  }
+  return false;
+}
+
+bool PlyStreamWriter::hasProperty(std::string elementName, std::string propertyName) const {
+  return hasElement(elementName) && elements[findElement(elementName)].propertyIndex(propertyName) != INVALID_IND;
+}
+
+void PlyStreamWriter::addElement(std::string elementName, size_t count) {
+  if (hasElement(elementName)) {
+    size_t existingCount = elements[findElement(elementName)].count;
+    if (existingCount != count) {
+      throw std::runtime_error("ply element " + elementName + " has " + std::to_string(existingCount) +
+                               " rows, not " + std::to_string(count));
+    }
+    return;
+  }
+  elements.emplace_back();
+  elements.back().name = elementName;
+  elements.back().count = count;
+  columns.emplace_back();
+}
+
+void PlyStreamWriter::addColumn(std::string elementName, size_t count, PlyProperty layout, Column column) {
+  addElement(elementName, count);
+  size_t iElement = findElement(elementName);
+  PlyElement& elem = elements[iElement];
+  size_t iProperty = elem.propertyIndex(layout.name);
+  if (iProperty == INVALID_IND) {
+    elem.properties.push_back(layout);
+    columns[iElement].push_back(column);
+  } else {
+    // The bytes of the old column are left unused in the spill file
+    elem.properties[iProperty] = layout;
+    columns[iElement][iProperty] = column;
+  }
+}
+
+void PlyStreamWriter::addPropertyFromFile(std::shared_ptr<MappedPlyFile> source, std::string elementName,
+                                          std::string propertyName) {
+  Column column;
+  column.source = source;
+  addColumn(elementName, source->getElement(elementName).count, source->getPropertyLayout(elementName, propertyName),
+            column);
+}
+
+void PlyStreamWriter::addComment(std::string comment) { comments.push_back(comment); }
+
+uint64_t PlyStreamWriter::appendToSpill(const char* bytes, size_t nBytes) {
+  if (spill == nullptr) {
+    spill = std::tmpfile();
+    if (spill == nullptr) throw std::runtime_error("could not create temporary file for ply data");
+  }
+  uint64_t offset = spillSize;
+  seekSpill(spill, offset);
+  if (nBytes > 0 && std::fwrite(bytes, 1, nBytes, spill) != nBytes) {
+    throw std::runtime_error("failed to write temporary ply data file");
+  }
+  spillSize += nBytes;
+  return offset;
+}
+
+std::vector<char> PlyStreamWriter::readColumnBytes(size_t iElement, size_t iProperty) {
+  const Column& column = columns[iElement][iProperty];
+  std::vector<char> bytes(column.spillBytes);
+  if (bytes.empty()) return bytes;
+  seekSpill(spill, column.spillOffset);
+  if (std::fread(bytes.data(), 1, bytes.size(), spill) != bytes.size()) {
+    throw std::runtime_error("failed to read temporary ply data file");
+  }
+  return bytes;
+}
+
+void PlyStreamWriter::write(std::ostream& out) {
+  if (!plyHostIsLittleEndian()) {
+    throw std::runtime_error("binary ply files can only be streamed on little-endian machines");
+  }
+
+  // Header
+  out << "ply\n";
+  out << "format binary_little_endian 1.0\n";
+  for (const std::string& comment : comments) out << "comment " << comment << "\n";
+  for (const PlyElement& elem : elements) {
+    out << "element " << elem.name << " " << elem.count << "\n";
+    for (const PlyProperty& prop : elem.properties) {
+      if (prop.isList) {
+        out << "property list " << plyTypeName(prop.countType) << " " << plyTypeName(prop.type) << " " << prop.name
+            << "\n";
+      } else {
+        out << "property " << plyTypeName(prop.type) << " " << prop.name << "\n";
+      }
+    }
+  }
+  out << "end_header\n";
+
+  // Rows, interleaved from each column
+  std::string block;
+  block.reserve(PLY_WRITE_BLOCK_SIZE + 1024);
+  for (size_t iElement = 0; iElement < elements.size(); iElement++) {
+    const PlyElement& elem = elements[iElement];
+    std::vector<std::unique_ptr<ColumnCursor>> cursors;
+    for (size_t iProperty = 0; iProperty < elem.properties.size(); iProperty++) {
+      cursors.emplace_back(new ColumnCursor(spill, elem, iProperty, columns[iElement][iProperty]));
+    }
+
+    for (size_t iRow = 0; iRow < elem.count; iRow++) {
+      for (std::unique_ptr<ColumnCursor>& cursor : cursors) cursor->appendNextRow(block);
+      if (block.size() >= PLY_WRITE_BLOCK_SIZE) {
+        out.write(block.data(), block.size());
+        block.clear();
+      }
+    }
+  }
+  out.write(block.data(), block.size());
+
+  if (!out) throw std::runtime_error("failed to write ply data");
+}
+
+void PlyStreamWriter::clear() {
+  elements.clear();
+  columns.clear();
+  comments.clear();
+  if (spill != nullptr) std::fclose(spill);
+  spill = nullptr;
+  spillSize = 0;
+}
+
+} // namespace geometrycentral
@@ -0,0 +1,431 @@
+#include "geometrycentral/utilities/formatted_output.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace geometrycentral {
+
+namespace {
+
+// Shortest round-trip formatting of doubles, using the Grisu2 algorithm of
+//   Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010
+// The output always reads back to the same double, and is the shortest such string in all but a tiny fraction of
+// cases (where it is one digit longer).
+
+// A floating point value f * 2^e, with a 64-bit significand
+struct DiyFp {
+  uint64_t f;
+  int e;
+};
+
+DiyFp diyFpSub(DiyFp x, DiyFp y) { return DiyFp{x.f - y.f, x.e}; }
+
+// Upper 64 bits of the 128-bit product, rounded
+DiyFp diyFpMul(DiyFp x, DiyFp y) {
+  const uint64_t mask32 = 0xFFFFFFFFu;
+  uint64_t a = x.f >> 32, b = x.f & mask32;
+  uint64_t c = y.f >> 32, d = y.f & mask32;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t mid = (bd >> 32) + (ad & mask32) + (bc & mask32) + (uint64_t(1) << 31);
+  return DiyFp{ac + (ad >> 32) + (bc >> 32) + (mid >> 32), x.e + y.e + 64};
+}
+
+DiyFp diyFpNormalize(DiyFp x) {
+  while ((x.f >> 63) == 0) {
+    x.f <<= 1;
+    x.e--;
+  }
+  return x;
+}
+
+// The value v and the boundaries m- and m+ of the interval of reals which round to v, normalized so that m+ has its
+// top bit set and m- has the same exponent
+void computeBoundaries(double val, DiyFp& v, DiyFp& mMinus, DiyFp& mPlus) {
+  const int significandBits = 52;
+  const int exponentBias = 1075; // 1023 + 52
+  const uint64_t hiddenBit = uint64_t(1) << significandBits;
+
+  uint64_t bits;
+  std::memcpy(&bits, &val, sizeof(double));
+  uint64_t biasedExponent = bits >> significandBits;
+  uint64_t fraction = bits & (hiddenBit - 1);
+
+  if (biasedExponent == 0) { // subnormal
+    v = DiyFp{fraction, 1 - exponentBias};
+  } else {
+    v = DiyFp{fraction + hiddenBit, static_cast<int>(biasedExponent) - exponentBias};
+  }
+
+  // The lower boundary is closer when v is a power of two (other than the smallest normal)
+  bool lowerBoundaryIsCloser = fraction == 0 && biasedExponent > 1;
+  DiyFp plus{2 * v.f + 1, v.e - 1};
+  DiyFp minus = lowerBoundaryIsCloser ? DiyFp{4 * v.f - 1, v.e - 2} : DiyFp{2 * v.f - 1, v.e - 1};
+
+  mPlus = diyFpNormalize(plus);
+  mMinus = DiyFp{minus.f << (minus.e - mPlus.e), mPlus.e};
+  v = diyFpNormalize(v);
+}
+
+// Normalized approximations of 10^k for k = -300, -292, ..., 324, as f * 2^e
+struct CachedPower {
+  uint64_t f;
+  int e;
+  int k;
+};
+
+const CachedPower CACHED_POWERS[] = {
+    {0xAB70FE17C79AC6CA, -1060, -300},
+    {0xFF77B1FCBEBCDC4F, -1034, -292},
+    {0xBE5691EF416BD60C, -1007, -284},
+    {0x8DD01FAD907FFC3C, -980, -276},
+    {0xD3515C2831559A83, -954, -268},
+    {0x9D71AC8FADA6C9B5, -927, -260},
+    {0xEA9C227723EE8BCB, -901, -252},
+    {0xAECC49914078536D, -874, -244},
+    {0x823C12795DB6CE57, -847, -236},
+    {0xC21094364DFB5637, -821, -228},
+    {0x9096EA6F3848984F, -794, -220},
+    {0xD77485CB25823AC7, -768, -212},
+    {0xA086CFCD97BF97F4, -741, -204},
+    {0xEF340A98172AACE5, -715, -196},
+    {0xB23867FB2A35B28E, -688, -188},
+    {0x84C8D4DFD2C63F3B, -661, -180},
+    {0xC5DD44271AD3CDBA, -635, -172},
+    {0x936B9FCEBB25C996, -608, -164},
+    {0xDBAC6C247D62A584, -582, -156},
+    {0xA3AB66580D5FDAF6, -555, -148},
+    {0xF3E2F893DEC3F126, -529, -140},
+    {0xB5B5ADA8AAFF80B8, -502, -132},
+    {0x87625F056C7C4A8B, -475, -124},
+    {0xC9BCFF6034C13053, -449, -116},
+    {0x964E858C91BA2655, -422, -108},
+    {0xDFF9772470297EBD, -396, -100},
+    {0xA6DFBD9FB8E5B88F, -369, -92},
+    {0xF8A95FCF88747D94, -343, -84},
+    {0xB94470938FA89BCF, -316, -76},
+    {0x8A08F0F8BF0F156B, -289, -68},
+    {0xCDB02555653131B6, -263, -60},
+    {0x993FE2C6D07B7FAC, -236, -52},
+    {0xE45C10C42A2B3B06, -210, -44},
+    {0xAA242499697392D3, -183, -36},
+    {0xFD87B5F28300CA0E, -157, -28},
+    {0xBCE5086492111AEB, -130, -20},
+    {0x8CBCCC096F5088CC, -103, -12},
+    {0xD1B71758E219652C, -77, -4},
+    {0x9C40000000000000, -50, 4},
+    {0xE8D4A51000000000, -24, 12},
+    {0xAD78EBC5AC620000, 3, 20},
+    {0x813F3978F8940984, 30, 28},
+    {0xC097CE7BC90715B3, 56, 36},
+    {0x8F7E32CE7BEA5C70, 83, 44},
+    {0xD5D238A4ABE98068, 109, 52},
+    {0x9F4F2726179A2245, 136, 60},
+    {0xED63A231D4C4FB27, 162, 68},
+    {0xB0DE65388CC8ADA8, 189, 76},
+    {0x83C7088E1AAB65DB, 216, 84},
+    {0xC45D1DF942711D9A, 242, 92},
+    {0x924D692CA61BE758, 269, 100},
+    {0xDA01EE641A708DEA, 295, 108},
+    {0xA26DA3999AEF774A, 322, 116},
+    {0xF209787BB47D6B85, 348, 124},
+    {0xB454E4A179DD1877, 375, 132},
+    {0x865B86925B9BC5C2, 402, 140},
+    {0xC83553C5C8965D3D, 428, 148},
+    {0x952AB45CFA97A0B3, 455, 156},
+    {0xDE469FBD99A05FE3, 481, 164},
+    {0xA59BC234DB398C25, 508, 172},
+    {0xF6C69A72A3989F5C, 534, 180},
+    {0xB7DCBF5354E9BECE, 561, 188},
+    {0x88FCF317F22241E2, 588, 196},
+    {0xCC20CE9BD35C78A5, 614, 204},
+    {0x98165AF37B2153DF, 641, 212},
+    {0xE2A0B5DC971F303A, 667, 220},
+    {0xA8D9D1535CE3B396, 694, 228},
+    {0xFB9B7CD9A4A7443C, 720, 236},
+    {0xBB764C4CA7A44410, 747, 244},
+    {0x8BAB8EEFB6409C1A, 774, 252},
+    {0xD01FEF10A657842C, 800, 260},
+    {0x9B10A4E5E9913129, 827, 268},
+    {0xE7109BFBA19C0C9D, 853, 276},
+    {0xAC2820D9623BF429, 880, 284},
+    {0x80444B5E7AA7CF85, 907, 292},
+    {0xBF21E44003ACDD2D, 933, 300},
+    {0x8E679C2F5E44FF8F, 960, 308},
+    {0xD433179D9C8CB841, 986, 316},
+    {0x9E19DB92B4E31BA9, 1013, 324},
+};
+const int CACHED_POWERS_MIN_DEC_EXP = -300;
+const int CACHED_POWERS_DEC_STEP = 8;
+
+// The product of the value with the cached power must have a binary exponent in [ALPHA, GAMMA]
+const int ALPHA = -60;
+const int GAMMA = -32;
+
+CachedPower cachedPowerForBinaryExponent(int e) {
+  // Smallest k such that the exponent of 10^k * 2^e is at least ALPHA, using log10(2) ~= 78913 / 2^18
+  int f = ALPHA - e - 1;
+  int k = (f * 78913) / (1 << 18) + (f > 0 ? 1 : 0);
+  int index = (-CACHED_POWERS_MIN_DEC_EXP + k + (CACHED_POWERS_DEC_STEP - 1)) / CACHED_POWERS_DEC_STEP;
+  return CACHED_POWERS[index];
+}
+
+// Number of decimal digits of n, and the largest power of 10 not greater than n
+int largestPow10(uint32_t n, uint32_t& pow10) {
+  pow10 = 1000000000;
+  int nDigits = 10;
+  while (nDigits > 1 && n < pow10) {
+    pow10 /= 10;
+    nDigits--;
+  }
+  return nDigits;
+}
+
+// Nudge the last digit towards w, while staying inside the rounding interval
+void grisuRound(char* digits, int nDigits, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t tenK) {
+  while (rest < dist && delta - rest >= tenK && (rest + tenK < dist || dist - rest > rest + tenK - dist)) {
+    digits[nDigits - 1]--;
+    rest += tenK;
+  }
+}
+
+// Generate the digits of a number in (M-, M+), close to w. The value is digits * 10^decimalExponent.
+void grisuDigitGen(char* digits, int& nDigits, int& decimalExponent, DiyFp mMinus, DiyFp w, DiyFp mPlus) {
+  uint64_t delta = diyFpSub(mPlus, mMinus).f;
+  uint64_t dist = diyFpSub(mPlus, w).f;
+
+  // Split M+ into an integral part p1 and a fractional part p2
+  DiyFp one{uint64_t(1) << -mPlus.e, mPlus.e};
+  uint32_t p1 = static_cast<uint32_t>(mPlus.f >> -one.e);
+  uint64_t p2 = mPlus.f & (one.f - 1);
+
+  uint32_t pow10;
+  int n = largestPow10(p1, pow10);
+  while (n > 0) {
+    digits[nDigits++] = static_cast<char>('0' + p1 / pow10);
+    p1 %= pow10;
+    n--;
+    uint64_t rest = (uint64_t(p1) << -one.e) + p2;
+    if (rest <= delta) {
+      decimalExponent += n;
+      grisuRound(digits, nDigits, dist, delta, rest, uint64_t(pow10) << -one.e);
+      return;
+    }
+    pow10 /= 10;
+  }
+
+  int m = 0;
+  while (true) {
+    p2 *= 10;
+    digits[nDigits++] = static_cast<char>('0' + (p2 >> -one.e));
+    p2 &= one.f - 1;
+    m++;
+    delta *= 10;
+    dist *= 10;
+    if (p2 <= delta) break;
+  }
+  decimalExponent -= m;
+  grisuRound(digits, nDigits, dist, delta, p2, one.f);
+}
+
+// Digits of a positive, finite value, such that val ~= digits * 10^decimalExponent
+void grisu2(char* digits, int& nDigits, int& decimalExponent, double val) {
+  DiyFp v, mMinus, mPlus;
+  computeBoundaries(val, v, mMinus, mPlus);
+
+  CachedPower cached = cachedPowerForBinaryExponent(mPlus.e);
+  DiyFp c{cached.f, cached.e};
+  DiyFp w = diyFpMul(v, c);
+  DiyFp wMinus = diyFpMul(mMinus, c);
+  DiyFp wPlus = diyFpMul(mPlus, c);
+
+  // Shrink the interval by one unit on each side to account for the rounding in the products
+  nDigits = 0;
+  decimalExponent = -cached.k;
+  grisuDigitGen(digits, nDigits, decimalExponent, DiyFp{wMinus.f + 1, wMinus.e}, w, DiyFp{wPlus.f - 1, wPlus.e});
+}
+
+} // namespace
+
+char* formatInteger(char* buffer, uint64_t val) {
+  char reversed[20];
+  int n = 0;
+  do {
+    reversed[n++] = static_cast<char>('0' + val % 10);
+    val /= 10;
+  } while (val != 0);
+  while (n > 0) *buffer++ = reversed[--n];
+  return buffer;
+}
+
+char* formatDouble(char* buffer, double val) {
+  if (std::signbit(val)) {
+    *buffer++ = '-';
+    val = -val;
+  }
+  if (val == 0) {
+    *buffer++ = '0';
+    return buffer;
+  }
+  if (std::isnan(val)) {
+    std::memcpy(buffer, "nan", 3);
+    return buffer + 3;
+  }
+  if (std::isinf(val)) {
+    std::memcpy(buffer, "inf", 3);
+    return buffer + 3;
+  }
+
+  int nDigits, decimalExponent;
+  grisu2(buffer, nDigits, decimalExponent, val);
+
+  // Lay out the digits; the value is 0.d1d2d3... * 10^pointPos
+  const int maxFixedExponent = 15;
+  const int minFixedExponent = -4;
+  int pointPos = nDigits + decimalExponent;
+
+  if (nDigits <= pointPos && pointPos <= maxFixedExponent) {
+    // An integer: digits followed by zeros
+    std::memset(buffer + nDigits, '0', pointPos - nDigits);
+    return buffer + pointPos;
+  }
+  if (0 < pointPos && pointPos <= maxFixedExponent) {
+    // dig.its
+    std::memmove(buffer + pointPos + 1, buffer + pointPos, nDigits - pointPos);
+    buffer[pointPos] = '.';
+    return buffer + nDigits + 1;
+  }
+  if (minFixedExponent < pointPos && pointPos <= 0) {
+    // 0.[000]digits
+    std::memmove(buffer + 2 - pointPos, buffer, nDigits);
+    buffer[0] = '0';
+    buffer[1] = '.';
+    std::memset(buffer + 2, '0', -pointPos);
+    return buffer + 2 - pointPos + nDigits;
+  }
+
+  // d.igitse[-]xx
+  if (nDigits > 1) {
+    std::memmove(buffer + 2, buffer + 1, nDigits - 1);
+    buffer[1] = '.';
+    buffer += nDigits + 1;
+  } else {
+    buffer += 1;
+  }
+  *buffer++ = 'e';
+  int exponent = pointPos - 1;
+  if (exponent < 0) {
+    *buffer++ = '-';
+    exponent = -exponent;
+  }
+  return formatInteger(buffer, static_cast<uint64_t>(exponent));
+}
+
+
+// === Parsing
+
+namespace {
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isLineEnd(char c) { return c == '\n' || c == '\r' || c == '\0'; }
+} // namespace
+
+// Numbers with at most 19 significant digits and small exponents are converted exactly via a single multiplication or
+// division by a power of ten; anything else (including nan/inf) falls back on strtod.
+bool parseDouble(const char*& p, double& out) {
+  static const double powersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  const char* start = p;
+  const char* c = p;
+  bool negative = false;
+  if (*c == '-' || *c == '+') {
+    negative = *c == '-';
+    c++;
+  }
+
+  uint64_t mantissa = 0;
+  int nSignificant = 0;
+  int exponent = 0;
+  bool anyDigits = false;
+  bool truncated = false;
+  for (; isDigit(*c); c++) {
+    anyDigits = true;
+    if (nSignificant < 19) {
+      mantissa = 10 * mantissa + (*c - '0');
+      if (mantissa != 0) nSignificant++;
+    } else {
+      exponent++;
+      truncated |= *c != '0';
+    }
+  }
+  if (*c == '.') {
+    c++;
+    for (; isDigit(*c); c++) {
+      anyDigits = true;
+      if (nSignificant < 19) {
+        mantissa = 10 * mantissa + (*c - '0');
+        if (mantissa != 0) nSignificant++;
+        exponent--;
+      } else {
+        truncated |= *c != '0';
+      }
+    }
+  }
+  bool fastPath = anyDigits && !truncated;
+  if (fastPath && (*c == 'e' || *c == 'E')) {
+    const char* e = c + 1;
+    bool negativeExponent = false;
+    if (*e == '-' || *e == '+') {
+      negativeExponent = *e == '-';
+      e++;
+    }
+    if (isDigit(*e)) {
+      int explicitExponent = 0;
+      for (; isDigit(*e); e++) {
+        if (explicitExponent < 10000) explicitExponent = 10 * explicitExponent + (*e - '0');
+      }
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+      c = e;
+    } else {
+      fastPath = false;
+    }
+  }
+
+  if (fastPath && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+    double value = static_cast<double>(mantissa);
+    value = (exponent < 0) ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+    out = negative ? -value : value;
+    p = c;
+    return true;
+  }
+
+  if (isLineEnd(*start)) return false; // strtod() would skip ahead to the next line
+  char* strtodEnd;
+  out = std::strtod(start, &strtodEnd);
+  if (strtodEnd == start) return false;
+  p = strtodEnd;
+  return true;
+}
+
+bool parseInteger(const char*& p, long long& out) {
+  const char* c = p;
+  bool negative = false;
+  if (*c == '-' || *c == '+') {
+    negative = *c == '-';
+    c++;
+  }
+  if (!isDigit(*c)) return false;
+  const long long maxValue = std::numeric_limits<long long>::max();
+  long long value = 0;
+  for (; isDigit(*c); c++) {
+    int digit = *c - '0';
+    if (value > (maxValue - digit) / 10) return false; // would overflow
+    value = 10 * value + digit;
+  }
+  out = negative ? -value : value;
+  p = c;
+  return true;
+}
+
+} // namespace geometrycentral
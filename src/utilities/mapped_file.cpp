@@ -0,0 +1,132 @@
+#include "geometrycentral/utilities/mapped_file.h"
+
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace geometrycentral {
+
+namespace {
+// The directory part of a path, including the trailing separator, or "" for a bare file name
+std::string directoryOf(const std::string& filename) {
+  size_t iSep = filename.find_last_of("/\\");
+  return iSep == std::string::npos ? "" : filename.substr(0, iSep + 1);
+}
+} // namespace
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(std::string filename) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("couldn't open file " + filename);
+  fileHandle = file;
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    CloseHandle(file);
+    throw std::runtime_error("couldn't get size of file " + filename);
+  }
+  dataSize = static_cast<size_t>(fileSize.QuadPart);
+  if (dataSize == 0) return; // empty files cannot be mapped
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) {
+    CloseHandle(file);
+    throw std::runtime_error("couldn't map file " + filename);
+  }
+  mappingHandle = mapping;
+
+  dataPtr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (dataPtr == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    throw std::runtime_error("couldn't map file " + filename);
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (dataPtr != nullptr) UnmapViewOfFile(dataPtr);
+  if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+  if (fileHandle != nullptr) CloseHandle(fileHandle);
+}
+
+std::string createFileAlongside(std::string filename) {
+  std::string directory = directoryOf(filename);
+  char tempName[MAX_PATH];
+  if (GetTempFileNameA(directory.empty() ? "." : directory.c_str(), "gc", 0, tempName) == 0) {
+    throw std::runtime_error("couldn't create a temporary file alongside " + filename);
+  }
+  return tempName;
+}
+
+void replaceFile(std::string source, std::string destination) {
+  if (!MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    throw std::runtime_error("couldn't replace file " + destination);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(std::string filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("couldn't open file " + filename);
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    close(fd);
+    throw std::runtime_error("couldn't get size of file " + filename);
+  }
+  dataSize = static_cast<size_t>(fileStat.st_size);
+  if (dataSize == 0) { // empty files cannot be mapped
+    close(fd);
+    return;
+  }
+
+  void* mapped = mmap(nullptr, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps its own reference to the file
+  if (mapped == MAP_FAILED) throw std::runtime_error("couldn't map file " + filename);
+  dataPtr = static_cast<const char*>(mapped);
+}
+
+MappedFile::~MappedFile() {
+  if (dataPtr != nullptr) munmap(const_cast<char*>(dataPtr), dataSize);
+}
+
+std::string createFileAlongside(std::string filename) {
+  // Rather than mkstemp(), which restricts permissions to the owner, so that the file which is eventually swapped in
+  // gets the usual permissions
+  std::random_device randomSource;
+  std::string directory = directoryOf(filename);
+  for (int iTry = 0; iTry < 100; iTry++) {
+    std::string tempName = directory + ".gc_tmp_" + std::to_string(getpid()) + "_" + std::to_string(randomSource());
+    int fd = open(tempName.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd >= 0) {
+      close(fd);
+      return tempName;
+    }
+    if (errno != EEXIST) break;
+  }
+  throw std::runtime_error("couldn't create a temporary file alongside " + filename);
+}
+
+void replaceFile(std::string source, std::string destination) {
+  // rename() atomically replaces an existing destination on POSIX systems
+  if (std::rename(source.c_str(), destination.c_str()) != 0) {
+    throw std::runtime_error("couldn't replace file " + destination);
+  }
+}
+
+#endif
+
+} // namespace geometrycentral
@@ -0,0 +1,293 @@
+#include "geometrycentral/utilities/profiler.h"
+
+#include "geometrycentral/utilities/utilities.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace geometrycentral {
+namespace profiler {
+
+namespace {
+
+int64_t nowNanoseconds() {
+  static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+struct ZoneRecord {
+  const char* name;
+  int64_t start;
+  int64_t end;   // negative while the zone is still open
+  size_t parent; // index of the enclosing zone in the same buffer, or INVALID_IND
+};
+
+// Each thread records in to its own buffer. The lock is only ever contended while exporting.
+struct ThreadBuffer {
+  size_t threadID = 0;
+  std::mutex mutex;
+  std::vector<ZoneRecord> zones;
+  std::vector<size_t> openZones; // INVALID_IND for zones which were dropped
+  std::unordered_map<const char*, int64_t> counters;
+  size_t nDroppedZones = 0;
+};
+
+std::atomic<size_t> maxZones(1 << 22);
+std::atomic<size_t> nZonesStarted(0); // including dropped zones
+
+// Buffers are shared with the registry, so data survives after the recording thread exits
+struct BufferRegistry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  size_t nextThreadID = 0;
+};
+
+BufferRegistry& registry() {
+  static BufferRegistry r;
+  return r;
+}
+
+ThreadBuffer& localBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    BufferRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    buffer->threadID = r.nextThreadID++;
+    r.buffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+std::vector<std::shared_ptr<ThreadBuffer>> allBuffers() {
+  BufferRegistry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  return r.buffers;
+}
+
+std::string jsonEscape(const std::string& str) {
+  std::string out;
+  out.reserve(str.size());
+  for (char c : str) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    default:
+      out += c;
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+bool isEnabled() {
+#ifdef GC_ENABLE_PROFILER
+  return true;
+#else
+  return false;
+#endif
+}
+
+ScopedZone::ScopedZone(const char* name) { beginZone(name); }
+ScopedZone::~ScopedZone() { endZone(); }
+
+void beginZone(const char* name) {
+  ThreadBuffer& buffer = localBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  if (nZonesStarted++ >= maxZones) {
+    buffer.openZones.push_back(INVALID_IND);
+    buffer.nDroppedZones++;
+    return;
+  }
+  size_t parent = buffer.openZones.empty() ? INVALID_IND : buffer.openZones.back();
+  buffer.openZones.push_back(buffer.zones.size());
+  buffer.zones.push_back(ZoneRecord{name, nowNanoseconds(), -1, parent});
+}
+
+void endZone() {
+  int64_t now = nowNanoseconds();
+  ThreadBuffer& buffer = localBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  if (buffer.openZones.empty()) return; // the zone was discarded by clear()
+  if (buffer.openZones.back() != INVALID_IND) {
+    buffer.zones[buffer.openZones.back()].end = now;
+  }
+  buffer.openZones.pop_back();
+}
+
+void incrementCounter(const char* name, int64_t value) {
+  ThreadBuffer& buffer = localBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.counters[name] += value;
+}
+
+std::vector<ZoneStatistics> getZoneStatistics() {
+
+  std::map<std::string, ZoneStatistics> statsByPath;
+  for (const std::shared_ptr<ThreadBuffer>& buffer : allBuffers()) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+
+    // Zones are recorded in the order they are opened, so parents always come before their children
+    std::vector<std::string> paths(buffer->zones.size());
+    std::vector<size_t> depths(buffer->zones.size(), 0);
+    std::vector<int64_t> childTime(buffer->zones.size(), 0);
+    for (size_t iZ = 0; iZ < buffer->zones.size(); iZ++) {
+      const ZoneRecord& z = buffer->zones[iZ];
+      if (z.parent == INVALID_IND) {
+        paths[iZ] = z.name;
+      } else {
+        paths[iZ] = paths[z.parent] + "/" + z.name;
+        depths[iZ] = depths[z.parent] + 1;
+        if (z.end >= 0) childTime[z.parent] += z.end - z.start;
+      }
+    }
+
+    for (size_t iZ = 0; iZ < buffer->zones.size(); iZ++) {
+      const ZoneRecord& z = buffer->zones[iZ];
+      if (z.end < 0) continue; // still open
+
+      auto it = statsByPath.find(paths[iZ]);
+      if (it == statsByPath.end()) {
+        it = statsByPath.insert({paths[iZ], ZoneStatistics{paths[iZ], depths[iZ], 0, 0., 0.}}).first;
+      }
+      ZoneStatistics& stats = it->second;
+      stats.count++;
+      stats.totalSeconds += 1e-9 * (z.end - z.start);
+      stats.selfSeconds += 1e-9 * (z.end - z.start - childTime[iZ]);
+    }
+  }
+
+  std::vector<ZoneStatistics> result;
+  for (auto& entry : statsByPath) {
+    result.push_back(entry.second);
+  }
+  return result;
+}
+
+std::map<std::string, int64_t> getCounters() {
+  std::map<std::string, int64_t> result;
+  for (const std::shared_ptr<ThreadBuffer>& buffer : allBuffers()) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    for (auto& entry : buffer->counters) {
+      result[entry.first] += entry.second;
+    }
+  }
+  return result;
+}
+
+void writeChromeTrace(std::ostream& out) {
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  auto separator = [&]() {
+    if (!first) out << ",";
+    out << "\n";
+    first = false;
+  };
+
+  out << std::fixed << std::setprecision(3);
+  int64_t lastTime = 0;
+  for (const std::shared_ptr<ThreadBuffer>& buffer : allBuffers()) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    for (const ZoneRecord& z : buffer->zones) {
+      if (z.end < 0) continue;
+      separator();
+      out << "{\"name\":\"" << jsonEscape(z.name) << "\",\"cat\":\"geometrycentral\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+          << buffer->threadID << ",\"ts\":" << 1e-3 * z.start << ",\"dur\":" << 1e-3 * (z.end - z.start) << "}";
+      lastTime = std::max(lastTime, z.end);
+    }
+  }
+
+  // Counters are only tracked as totals, so record them once at the end of the trace
+  for (auto& entry : getCounters()) {
+    separator();
+    out << "{\"name\":\"" << jsonEscape(entry.first) << "\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":" << 1e-3 * lastTime
+        << ",\"args\":{\"value\":" << entry.second << "}}";
+  }
+
+  out << "\n]}\n";
+}
+
+void writeChromeTrace(std::string filename) {
+  std::ofstream out(filename);
+  if (!out) throw std::runtime_error("failed to open profiler output file " + filename);
+  writeChromeTrace(out);
+}
+
+void writeSummaryJSON(std::ostream& out) {
+  out << "{\n  \"zones\": [";
+  out << std::setprecision(9);
+  bool first = true;
+  for (const ZoneStatistics& stats : getZoneStatistics()) {
+    out << (first ? "\n" : ",\n");
+    first = false;
+    out << "    {\"path\": \"" << jsonEscape(stats.path) << "\", \"depth\": " << stats.depth
+        << ", \"count\": " << stats.count << ", \"totalSeconds\": " << stats.totalSeconds
+        << ", \"selfSeconds\": " << stats.selfSeconds << "}";
+  }
+  out << "\n  ],\n  \"counters\": {";
+  first = true;
+  for (auto& entry : getCounters()) {
+    out << (first ? "\n" : ",\n");
+    first = false;
+    out << "    \"" << jsonEscape(entry.first) << "\": " << entry.second;
+  }
+  out << "\n  }\n}\n";
+}
+
+void writeSummaryJSON(std::string filename) {
+  std::ofstream out(filename);
+  if (!out) throw std::runtime_error("failed to open profiler output file " + filename);
+  writeSummaryJSON(out);
+}
+
+void clear() {
+  BufferRegistry& r = registry();
+  std::lock_guard<std::mutex> registryLock(r.mutex);
+
+  // Buffers only referenced by the registry belong to threads which have exited
+  std::vector<std::shared_ptr<ThreadBuffer>> liveBuffers;
+  for (std::shared_ptr<ThreadBuffer>& buffer : r.buffers) {
+    if (buffer.use_count() > 1) liveBuffers.push_back(buffer);
+  }
+  r.buffers = liveBuffers;
+
+  for (const std::shared_ptr<ThreadBuffer>& buffer : r.buffers) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->zones.clear();
+    buffer->zones.shrink_to_fit();
+    buffer->openZones.clear();
+    buffer->counters.clear();
+    buffer->nDroppedZones = 0;
+  }
+  nZonesStarted = 0;
+}
+
+void setMaxZones(size_t newMaxZones) { maxZones = newMaxZones; }
+
+size_t getMaxZones() { return maxZones; }
+
+size_t getDroppedZoneCount() {
+  size_t count = 0;
+  for (const std::shared_ptr<ThreadBuffer>& buffer : allBuffers()) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    count += buffer->nDroppedZones;
+  }
+  return count;
+}
+
+} // namespace profiler
+} // namespace geometrycentral
@@ -0,0 +1,242 @@
+#include "geometrycentral/utilities/vertex_welding.h"
+
+#include "geometrycentral/utilities/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace geometrycentral {
+
+namespace {
+
+// Positions are compared through a key of three integers: the bit patterns of the coordinates, or the indices of the
+// grid cell containing them
+struct WeldKey {
+  uint64_t x, y, z;
+  bool operator==(const WeldKey& other) const { return x == other.x && y == other.y && z == other.z; }
+  bool operator<(const WeldKey& other) const {
+    if (x != other.x) return x < other.x;
+    if (y != other.y) return y < other.y;
+    return z < other.z;
+  }
+};
+
+class WeldKeyFunction {
+public:
+  WeldKeyFunction(double tolerance) : invTolerance(tolerance > 0 ? 1. / tolerance : 0.) {}
+
+  WeldKey operator()(Vector3 p) const { return WeldKey{coordKey(p.x), coordKey(p.y), coordKey(p.z)}; }
+
+private:
+  double invTolerance;
+
+  uint64_t coordKey(double val) const {
+    if (invTolerance > 0) {
+      // Cells far outside the range of int64 (and non-finite values) fall through to an exact comparison
+      double cell = std::floor(val * invTolerance);
+      if (std::abs(cell) < 4e18) return static_cast<uint64_t>(static_cast<int64_t>(cell));
+    }
+    if (val == 0.) val = 0.; // -0 == 0
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(double));
+    return bits;
+  }
+};
+
+uint64_t hashKey(const WeldKey& k) {
+  uint64_t h = k.x * 0x9e3779b97f4a7c15ull;
+  h = (h ^ (h >> 29) ^ k.y) * 0xbf58476d1ce4e5b9ull;
+  h = (h ^ (h >> 32) ^ k.z) * 0x94d049bb133111ebull;
+  return h ^ (h >> 31);
+}
+
+// The key is carried along with the hash, so that runs can be split without going back to the positions array
+struct SortItem {
+  uint64_t hash;
+  WeldKey key;
+  size_t index;
+};
+
+// Items are only grouped by the top bits of their hash; groups are then split by comparing full keys
+const size_t RADIX_BITS = 12;
+const size_t RADIX_PASSES = 2;
+const size_t HASH_SHIFT = 64 - RADIX_BITS * RADIX_PASSES;
+
+// Stable parallel LSD radix sort on the top RADIX_BITS * RADIX_PASSES bits of the hash. Each thread counts and
+// scatters one contiguous range, so items with equal hash prefixes stay in their original order.
+void radixSortByHashPrefix(std::vector<SortItem>& items, size_t nThreads) {
+  const size_t nBuckets = 1 << RADIX_BITS;
+  size_t n = items.size();
+  size_t nRanges = std::min(resolveThreadCount(nThreads), std::max<size_t>(1, n / (1 << 16)));
+  size_t rangeSize = (n + nRanges - 1) / nRanges;
+
+  std::vector<SortItem> scratch(n);
+  std::vector<size_t> offsets(nRanges * nBuckets);
+  for (size_t iPass = 0; iPass < RADIX_PASSES; iPass++) {
+    size_t shift = HASH_SHIFT + iPass * RADIX_BITS;
+
+    parallelFor(nRanges, nRanges, [&](size_t iRange) {
+      size_t* counts = &offsets[iRange * nBuckets];
+      std::fill(counts, counts + nBuckets, 0);
+      size_t iEnd = std::min(n, (iRange + 1) * rangeSize);
+      for (size_t i = iRange * rangeSize; i < iEnd; i++) {
+        counts[(items[i].hash >> shift) & (nBuckets - 1)]++;
+      }
+    });
+
+    // Each range writes each bucket after the earlier ranges' entries for that bucket
+    size_t total = 0;
+    for (size_t iBucket = 0; iBucket < nBuckets; iBucket++) {
+      for (size_t iRange = 0; iRange < nRanges; iRange++) {
+        size_t count = offsets[iRange * nBuckets + iBucket];
+        offsets[iRange * nBuckets + iBucket] = total;
+        total += count;
+      }
+    }
+
+    parallelFor(nRanges, nRanges, [&](size_t iRange) {
+      size_t* next = &offsets[iRange * nBuckets];
+      size_t iEnd = std::min(n, (iRange + 1) * rangeSize);
+      for (size_t i = iRange * rangeSize; i < iEnd; i++) {
+        scratch[next[(items[i].hash >> shift) & (nBuckets - 1)]++] = items[i];
+      }
+    });
+
+    items.swap(scratch);
+  }
+}
+
+struct WeldKeyHash {
+  size_t operator()(const WeldKey& k) const { return static_cast<size_t>(hashKey(k)); }
+};
+
+// With one thread, a hash map is faster than sorting, and gives the same result
+std::vector<size_t> weldVertexPositionsSerial(std::vector<Vector3>& positions, const WeldKeyFunction& key) {
+  std::vector<size_t> compressVertex(positions.size());
+  std::unordered_map<WeldKey, size_t, WeldKeyHash> canonicalIndex;
+  canonicalIndex.reserve(positions.size() / 8); // meshes from triangle soups have ~6 copies of each vertex
+  size_t nWelded = 0;
+  for (size_t iV = 0; iV < positions.size(); iV++) {
+    WeldKey k = key(positions[iV]);
+    auto it = canonicalIndex.find(k);
+    if (it == canonicalIndex.end()) {
+      canonicalIndex[k] = nWelded;
+      positions[nWelded] = positions[iV];
+      compressVertex[iV] = nWelded;
+      nWelded++;
+    } else {
+      compressVertex[iV] = it->second;
+    }
+  }
+  positions.resize(nWelded);
+  positions.shrink_to_fit();
+  return compressVertex;
+}
+
+} // namespace
+
+
+std::vector<size_t> weldVertexPositions(std::vector<Vector3>& positions, double tolerance, size_t nThreads) {
+  if (tolerance < 0 || !std::isfinite(tolerance)) {
+    throw std::runtime_error("vertex welding tolerance must be finite and non-negative");
+  }
+
+  size_t n = positions.size();
+  WeldKeyFunction key(tolerance);
+  const size_t grainSize = 1 << 14;
+  if (resolveThreadCount(nThreads) == 1 || n < (1 << 16)) {
+    return weldVertexPositionsSerial(positions, key);
+  }
+
+  // canonical[i] will hold the first index with the same key as i
+  std::vector<size_t> canonical(n);
+  {
+    std::vector<SortItem> items(n);
+    parallelFor(
+        n, nThreads,
+        [&](size_t i) {
+          WeldKey k = key(positions[i]);
+          items[i] = SortItem{hashKey(k), k, i};
+        },
+        grainSize);
+    radixSortByHashPrefix(items, nThreads);
+
+    // Find the runs of items with equal hash prefixes
+    std::vector<size_t> runStartFlag(n);
+    parallelFor(
+        n, nThreads,
+        [&](size_t i) {
+          runStartFlag[i] = (i == 0 || (items[i].hash >> HASH_SHIFT) != (items[i - 1].hash >> HASH_SHIFT)) ? 1 : 0;
+        },
+        grainSize);
+    std::vector<size_t> runStarts(runStartFlag.begin(), runStartFlag.end());
+    size_t nRuns = parallelExclusiveScan(runStarts, nThreads);
+    std::vector<size_t> runBounds(nRuns + 1, n);
+    parallelFor(
+        n, nThreads,
+        [&](size_t i) {
+          if (runStartFlag[i]) runBounds[runStarts[i]] = i;
+        },
+        grainSize);
+    runStartFlag.clear();
+    runStartFlag.shrink_to_fit();
+    runStarts.clear();
+    runStarts.shrink_to_fit();
+
+    // Split each run by full key. Within a run, items are still in index order, so the first match is the earliest.
+    parallelFor(
+        nRuns, nThreads,
+        [&](size_t iRun) {
+          size_t b = runBounds[iRun];
+          size_t e = runBounds[iRun + 1];
+          if (e - b <= 16) {
+            for (size_t i = b; i < e; i++) {
+              size_t iV = items[i].index;
+              canonical[iV] = iV;
+              for (size_t j = b; j < i; j++) {
+                if (items[j].key == items[i].key) {
+                  canonical[iV] = canonical[items[j].index];
+                  break;
+                }
+              }
+            }
+          } else {
+            // Large runs (many exact duplicates, or unlucky hashes) are sorted instead
+            std::sort(items.begin() + b, items.begin() + e, [](const SortItem& lhs, const SortItem& rhs) {
+              return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.index < rhs.index);
+            });
+            size_t first = items[b].index;
+            for (size_t i = b; i < e; i++) {
+              if (i > b && !(items[i].key == items[i - 1].key)) first = items[i].index;
+              canonical[items[i].index] = first;
+            }
+          }
+        },
+        grainSize / 16);
+  }
+
+  // Number the surviving vertices in their original order, and compact the positions
+  std::vector<size_t> newIndex(n);
+  parallelFor(
+      n, nThreads, [&](size_t i) { newIndex[i] = canonical[i] == i ? 1 : 0; }, grainSize);
+  size_t nWelded = parallelExclusiveScan(newIndex, nThreads);
+
+  std::vector<Vector3> weldedPositions(nWelded);
+  parallelFor(
+      n, nThreads,
+      [&](size_t i) {
+        if (canonical[i] == i) weldedPositions[newIndex[i]] = positions[i];
+      },
+      grainSize);
+  positions = std::move(weldedPositions);
+
+  parallelFor(
+      n, nThreads, [&](size_t i) { canonical[i] = newIndex[canonical[i]]; }, grainSize);
+  return canonical;
+}
+
+} // namespace geometrycentral
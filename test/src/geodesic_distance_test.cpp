@@ -0,0 +1,239 @@
+#include "geometrycentral/surface/exact_geodesics.h"
+#include "geometrycentral/surface/fast_marching_method.h"
+#include "geometrycentral/surface/flip_geodesics.h"
+#include "geometrycentral/surface/edge_length_geometry.h"
+#include "geometrycentral/surface/manifold_surface_mesh.h"
+#include "geometrycentral/surface/mesh_graph_algorithms.h"
+#include "geometrycentral/surface/surface_mesh_factories.h"
+#include "geometrycentral/surface/vertex_position_geometry.h"
+
+#include "load_test_meshes.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <string>
+
+using namespace geometrycentral;
+using namespace geometrycentral::surface;
+
+class GeodesicDistanceSuite : public MeshAssetSuite {};
+
+// ============================================================
+// =============== Exact geodesics
+// ============================================================
+
+TEST_F(GeodesicDistanceSuite, ExactDistanceMatrix) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(24, 12);
+  perturbVertexPositions(*geometry, 0.02);
+
+  std::vector<Vertex> landmarks;
+  for (size_t iV = 0; iV < mesh->nVertices(); iV += 23) {
+    landmarks.push_back(mesh->vertex(iV));
+  }
+
+  DenseMatrix<double> allPairs = exactGeodesicDistanceMatrix(*mesh, *geometry, landmarks, 4);
+  DenseMatrix<double> sourcesToTargets = exactGeodesicDistanceMatrix(*mesh, *geometry, landmarks, landmarks, 3);
+  ASSERT_EQ(allPairs.rows(), (Eigen::Index)landmarks.size());
+  ASSERT_EQ(sourcesToTargets.cols(), (Eigen::Index)landmarks.size());
+
+  // Compare against a full single-source propagation from each landmark
+  for (size_t i = 0; i < landmarks.size(); i++) {
+    VertexData<double> dist = exactGeodesicDistance(*mesh, *geometry, landmarks[i]);
+    for (size_t j = 0; j < landmarks.size(); j++) {
+      EXPECT_NEAR(allPairs(i, j), dist[landmarks[j]], 1e-6);
+      EXPECT_NEAR(sourcesToTargets(i, j), dist[landmarks[j]], 1e-6);
+      EXPECT_EQ(allPairs(i, j), allPairs(j, i));
+    }
+  }
+
+  // The geometry is left as it was
+  EXPECT_FALSE(geometry->isFrozen());
+}
+
+TEST_F(GeodesicDistanceSuite, ExactQueryDistance) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeIcosphereMeshAndGeometry(8);
+  perturbVertexPositions(*geometry, 0.01);
+
+  // Run a sequence of truncated queries on the same solver, interleaved with full propagations
+  GeodesicAlgorithmExact mmp(*mesh, *geometry);
+  for (size_t iV = 0; iV < mesh->nVertices(); iV += 97) {
+    Vertex source = mesh->vertex(iV);
+    double maxDistance = 0.2 + 0.1 * (iV % 5);
+    std::vector<std::pair<Vertex, double>> result = mmp.queryDistance(source, maxDistance);
+
+    VertexData<double> expected = exactGeodesicDistance(*mesh, *geometry, source);
+    VertexData<char> reported(*mesh, false);
+    for (const std::pair<Vertex, double>& entry : result) {
+      EXPECT_FALSE(reported[entry.first]);
+      reported[entry.first] = true;
+      EXPECT_LE(entry.second, maxDistance);
+      EXPECT_NEAR(entry.second, expected[entry.first], 1e-6);
+    }
+    for (Vertex v : mesh->vertices()) {
+      if (expected[v] < maxDistance - 1e-6) {
+        EXPECT_TRUE(reported[v]);
+      }
+    }
+
+    if (iV % 2 == 0) mmp.propagate(source);
+  }
+}
+
+TEST_F(GeodesicDistanceSuite, BatchedFlipGeodesicPaths) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(30, 12);
+  perturbVertexPositions(*geometry, 0.02);
+
+  std::vector<std::pair<Vertex, Vertex>> endpoints;
+  for (size_t iV = 0; iV < mesh->nVertices(); iV += 29) {
+    endpoints.emplace_back(mesh->vertex(iV), mesh->vertex((iV * 7 + 100) % mesh->nVertices()));
+  }
+  endpoints.emplace_back(mesh->vertex(5), mesh->vertex(5)); // degenerate
+
+  std::vector<std::vector<SurfacePoint>> paths = computeGeodesicPaths(*mesh, *geometry, endpoints, 3);
+  ASSERT_EQ(paths.size(), endpoints.size());
+  EXPECT_TRUE(paths.back().empty());
+  EXPECT_FALSE(geometry->isFrozen());
+
+  // Each path should match a path computed by a fresh network
+  for (size_t i = 0; i + 1 < endpoints.size(); i++) {
+    const std::vector<SurfacePoint>& path = paths[i];
+    ASSERT_GE(path.size(), 2u);
+    EXPECT_EQ(path.front().vertex, endpoints[i].first);
+    EXPECT_EQ(path.back().vertex, endpoints[i].second);
+
+    double length = 0.;
+    for (size_t j = 0; j + 1 < path.size(); j++) {
+      length += norm(path[j + 1].interpolate(geometry->vertexPositions) - path[j].interpolate(geometry->vertexPositions));
+    }
+
+    std::unique_ptr<FlipEdgeNetwork> network =
+        FlipEdgeNetwork::constructFromDijkstraPath(*mesh, *geometry, endpoints[i].first, endpoints[i].second);
+    network->iterativeShorten();
+    EXPECT_NEAR(length, network->length(), 1e-6);
+  }
+}
+
+// ============================================================
+// =============== Fast marching
+// ============================================================
+
+TEST_F(GeodesicDistanceSuite, FastMarchingTruncatedQueries) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeIcosphereMeshAndGeometry(12);
+  perturbVertexPositions(*geometry, 0.01);
+
+  FastMarchingSolver solver(*geometry);
+  for (size_t iV = 0; iV < mesh->nVertices(); iV += 131) {
+    Vertex source = mesh->vertex(iV);
+    VertexData<double> full = FMMDistance(*geometry, {{source, 0.}});
+
+    // A full march is a reasonable approximation of the exact distance
+    VertexData<double> exact = exactGeodesicDistance(*mesh, *geometry, source);
+    for (Vertex v : mesh->vertices()) {
+      EXPECT_NEAR(full[v], exact[v], 0.15 * exact[v] + 1e-6);
+    }
+
+    // Truncated marches finalize exactly the vertices within range, with the same distances
+    double maxDistance = 0.3;
+    solver.compute({{source, 0.}}, maxDistance);
+    for (Vertex v : mesh->vertices()) {
+      if (full[v] <= maxDistance) {
+        EXPECT_TRUE(solver.isFinalized(v));
+        EXPECT_EQ(solver.getDistance(v), full[v]);
+      } else {
+        EXPECT_FALSE(solver.isFinalized(v));
+      }
+    }
+    const std::vector<Vertex>& order = solver.getFinalizedVertices();
+    for (size_t i = 1; i < order.size(); i++) {
+      EXPECT_LE(solver.getDistance(order[i - 1]), solver.getDistance(order[i]));
+    }
+
+    // Marching towards targets stops once they are reached
+    std::vector<Vertex> targets{mesh->vertex((iV + 17) % mesh->nVertices()), mesh->vertex((iV + 40) % mesh->nVertices())};
+    solver.compute({{source, 0.}}, std::numeric_limits<double>::infinity(), targets);
+    for (Vertex t : targets) {
+      EXPECT_EQ(solver.getDistance(t), full[t]);
+    }
+    EXPECT_EQ(solver.getFinalizedVertices().back() == targets[0] || solver.getFinalizedVertices().back() == targets[1],
+              true);
+  }
+}
+
+TEST_F(GeodesicDistanceSuite, FastIterativeMethodMatchesFastMarching) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(40, 16);
+  perturbVertexPositions(*geometry, 0.01);
+
+  std::vector<std::pair<Vertex, double>> initialDistances{{mesh->vertex(0), 0.}, {mesh->vertex(300), 0.25}};
+  VertexData<double> fmm = FMMDistance(*geometry, initialDistances);
+  VertexData<double> fimSerial = FIMDistance(*geometry, initialDistances, 1);
+  VertexData<double> fimParallel = FIMDistance(*geometry, initialDistances, 3);
+
+  for (Vertex v : mesh->vertices()) {
+    EXPECT_NEAR(fimSerial[v], fmm[v], 1e-12 * fmm[v]);
+    EXPECT_NEAR(fimParallel[v], fimSerial[v], 1e-12 * fmm[v]);
+  }
+}
+
+// ============================================================
+// =============== Graph distance
+// ============================================================
+
+TEST_F(GeodesicDistanceSuite, GraphDistanceEngine) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(30, 12);
+  perturbVertexPositions(*geometry, 0.02);
+  geometry->requireEdgeLengths();
+  EdgeLengthGeometry intrinsicGeometry(*mesh, geometry->edgeLengths);
+
+  auto pathLength = [&](const std::vector<Halfedge>& path) {
+    double length = 0.;
+    for (Halfedge he : path) length += geometry->edgeLengths[he.edge()];
+    return length;
+  };
+
+  GraphDistanceEngine aStar(*geometry);
+  GraphDistanceEngine dijkstra(intrinsicGeometry);
+  EXPECT_TRUE(aStar.usesEuclideanHeuristic());
+  EXPECT_FALSE(dijkstra.usesEuclideanHeuristic());
+
+  for (size_t iV = 0; iV < mesh->nVertices(); iV += 37) {
+    Vertex source = mesh->vertex(iV);
+    std::vector<Vertex> targets;
+    for (size_t k = 1; k <= 5; k++) targets.push_back(mesh->vertex((iV + 61 * k) % mesh->nVertices()));
+
+    // Point-to-point and batched paths are all shortest paths, and connect the endpoints
+    std::vector<std::vector<Halfedge>> batched = dijkstra.shortestEdgePaths(source, targets);
+    ASSERT_EQ(batched.size(), targets.size());
+    for (size_t k = 0; k < targets.size(); k++) {
+      double expected = pathLength(shortestEdgePath(*geometry, source, targets[k]));
+      std::vector<Halfedge> path = aStar.shortestEdgePath(source, targets[k]);
+      ASSERT_FALSE(path.empty());
+      EXPECT_EQ(path.front().vertex(), source);
+      EXPECT_EQ(path.back().tipVertex(), targets[k]);
+      EXPECT_NEAR(pathLength(path), expected, 1e-9);
+      EXPECT_NEAR(pathLength(dijkstra.shortestEdgePath(source, targets[k])), expected, 1e-9);
+      EXPECT_NEAR(pathLength(batched[k]), expected, 1e-9);
+    }
+
+    // Radius queries agree with the one-off version
+    std::unordered_map<Vertex, double> expectedBall = vertexDijkstraDistanceWithinRadius(*geometry, source, 0.5);
+    const std::vector<Vertex>& ball = dijkstra.verticesWithinRadius(source, 0.5);
+    EXPECT_EQ(ball.size(), expectedBall.size());
+    for (Vertex v : ball) {
+      ASSERT_EQ(expectedBall.count(v), 1u);
+      EXPECT_NEAR(dijkstra.getDistance(v), expectedBall[v], 1e-9);
+    }
+  }
+}
@@ -1,5 +1,6 @@
 
 #include "geometrycentral/surface/manifold_surface_mesh.h"
+#include "geometrycentral/surface/mesh_graph_algorithms.h"
 #include "geometrycentral/surface/meshio.h"
 
 #include "geometrycentral/surface/base_geometry_interface.h"
@@ -19,6 +20,7 @@
 
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_set>
 
 
@@ -183,6 +185,199 @@ TEST_F(HalfedgeGeometrySuite, PurgeTestDEC) {
 }
 
 
+// Introspection of cached quantities, and of the memory held by a mesh
+TEST_F(HalfedgeGeometrySuite, QuantityStatistics) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(20, 10);
+
+  auto getStats = [&](std::string name) {
+    for (QuantityStatistics stats : geometry->getQuantityStatistics()) {
+      if (stats.name == name) return stats;
+    }
+    throw std::runtime_error("no quantity named " + name);
+  };
+
+  size_t bytesBefore = geometry->quantitiesBufferBytes();
+  EXPECT_EQ(getStats("cotanLaplacian").computeCount, 0);
+  EXPECT_EQ(getStats("cotanLaplacian").bufferBytes, 0);
+
+  // Requiring computes the quantity and its dependencies exactly once
+  geometry->requireCotanLaplacian();
+  geometry->requireEdgeLengths();
+  geometry->refreshQuantities();
+  QuantityStatistics lapStats = getStats("cotanLaplacian");
+  EXPECT_TRUE(lapStats.computed);
+  EXPECT_EQ(lapStats.requireCount, 1);
+  EXPECT_EQ(lapStats.computeCount, 2);
+  EXPECT_GE(lapStats.computeSeconds, 0.);
+  EXPECT_GE(lapStats.bufferBytes, geometry->cotanLaplacian.nonZeros() * (sizeof(double) + sizeof(int)));
+  EXPECT_EQ(getStats("edgeLengths").bufferBytes, mesh->nEdges() * sizeof(double));
+  EXPECT_GT(geometry->quantitiesBufferBytes(), bytesBefore);
+
+  // Purging releases the memory
+  geometry->unrequireCotanLaplacian();
+  geometry->purgeQuantities();
+  EXPECT_FALSE(getStats("cotanLaplacian").computed);
+  EXPECT_EQ(getStats("cotanLaplacian").bufferBytes, 0);
+  EXPECT_EQ(getStats("cotanLaplacian").computeCount, 2);
+  EXPECT_EQ(getStats("edgeLengths").bufferBytes, mesh->nEdges() * sizeof(double));
+
+  // Mesh-level report counts connectivity and every container on the mesh
+  SurfaceMeshMemoryReport report = mesh->getMemoryReport();
+  EXPECT_GE(report.connectivityBytes, 3 * mesh->nHalfedges() * sizeof(size_t));
+  {
+    VertexData<double> extraData(*mesh);
+    SurfaceMeshMemoryReport reportWithData = mesh->getMemoryReport();
+    EXPECT_EQ(reportWithData.nMeshData, report.nMeshData + 1);
+    EXPECT_EQ(reportWithData.meshDataBytes, report.meshDataBytes + mesh->nVertices() * sizeof(double));
+  }
+  EXPECT_EQ(mesh->getMemoryReport().nMeshData, report.nMeshData);
+}
+
+// Cached quantities are evicted to respect a memory budget
+TEST_F(HalfedgeGeometrySuite, QuantityMemoryBudget) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(20, 10);
+
+  auto isComputed = [&](std::string name) {
+    for (QuantityStatistics stats : geometry->getQuantityStatistics()) {
+      if (stats.name == name) return stats.computed;
+    }
+    throw std::runtime_error("no quantity named " + name);
+  };
+
+  // Populate some unrequired quantities
+  geometry->requireCotanLaplacian();
+  geometry->requireFaceAreas();
+  geometry->unrequireCotanLaplacian();
+  geometry->unrequireFaceAreas();
+  EXPECT_TRUE(isComputed("cotanLaplacian"));
+  EXPECT_TRUE(isComputed("faceAreas"));
+
+  // A budget with room for just the per-element arrays evicts the operator first
+  size_t laplacianBytes = 0;
+  for (QuantityStatistics stats : geometry->getQuantityStatistics()) {
+    if (stats.name == "cotanLaplacian") laplacianBytes = stats.bufferBytes;
+  }
+  geometry->setQuantityMemoryBudget(geometry->quantitiesBufferBytes() - laplacianBytes);
+  EXPECT_FALSE(isComputed("cotanLaplacian"));
+  EXPECT_TRUE(isComputed("faceAreas"));
+  EXPECT_EQ(geometry->cotanLaplacian.nonZeros(), 0);
+
+  // Required quantities are never evicted, even if they exceed the budget
+  geometry->setQuantityMemoryBudget(0);
+  EXPECT_FALSE(isComputed("faceAreas"));
+  geometry->requireVertexNormals();
+  EXPECT_TRUE(isComputed("vertexNormals"));
+  EXPECT_FALSE(isComputed("faceAreas")); // evicted after use as a dependency
+  for (Vertex v : mesh->vertices()) {
+    EXPECT_NEAR(norm(geometry->vertexNormals[v]), 1., 1e-6);
+  }
+
+  // Evicted quantities are recomputed transparently
+  geometry->requireCotanLaplacian();
+  EXPECT_GT(geometry->cotanLaplacian.nonZeros(), 0);
+
+  geometry->removeQuantityMemoryBudget();
+  geometry->unrequireCotanLaplacian();
+  geometry->requireFaceAreas();
+  EXPECT_TRUE(isComputed("cotanLaplacian"));
+}
+
+// A frozen geometry can be shared between threads
+TEST_F(HalfedgeGeometrySuite, FrozenGeometryThreads) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(30, 15);
+
+  geometry->requireEdgeLengths();
+  geometry->freeze();
+  EXPECT_TRUE(geometry->isFrozen());
+  EXPECT_THROW(geometry->refreshQuantities(), std::runtime_error);
+  EXPECT_THROW(geometry->purgeQuantities(), std::runtime_error);
+
+  // Each thread requires quantities (some of which are not yet computed) and builds its own containers on the mesh
+  size_t nThreads = 8;
+  std::vector<double> results(nThreads);
+  std::vector<std::thread> threads;
+  for (size_t iThread = 0; iThread < nThreads; iThread++) {
+    threads.emplace_back([&, iThread]() {
+      geometry->requireCotanLaplacian();
+      geometry->requireVertexDualAreas();
+      VertexData<double> weightedArea(*mesh);
+      for (Vertex v : mesh->vertices()) {
+        weightedArea[v] = geometry->vertexDualAreas[v] * geometry->cotanLaplacian.coeff(v.getIndex(), v.getIndex());
+      }
+      double sum = 0.;
+      for (Vertex v : mesh->vertices()) {
+        sum += weightedArea[v];
+      }
+      results[iThread] = sum;
+      geometry->unrequireCotanLaplacian();
+      geometry->unrequireVertexDualAreas();
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  for (size_t iThread = 0; iThread < nThreads; iThread++) {
+    EXPECT_EQ(results[iThread], results[0]);
+  }
+  for (QuantityStatistics stats : geometry->getQuantityStatistics()) {
+    if (stats.name == "cotanLaplacian") {
+      EXPECT_EQ(stats.computeCount, 1);
+      EXPECT_EQ(stats.requireCount, 0);
+    }
+  }
+
+  // Back to the usual behavior
+  geometry->unfreeze();
+  geometry->purgeQuantities();
+  EXPECT_EQ(geometry->cotanLaplacian.nonZeros(), 0);
+  EXPECT_GT(geometry->edgeLengths.size(), 0);
+}
+
+// Requirements may be taken while frozen and released afterwards, like objects which require quantities for their
+// lifetime
+TEST_F(HalfedgeGeometrySuite, FrozenRequireAcrossUnfreeze) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeTorusMeshAndGeometry(10, 5);
+  auto requireCount = [&](std::string name) {
+    for (QuantityStatistics stats : geometry->getQuantityStatistics()) {
+      if (stats.name == name) return stats.requireCount;
+    }
+    return -1;
+  };
+
+  geometry->freeze();
+  geometry->requireEdgeLengths();
+  EXPECT_EQ(requireCount("edgeLengths"), 1);
+  geometry->unfreeze();
+  geometry->unrequireEdgeLengths();
+  EXPECT_EQ(requireCount("edgeLengths"), 0);
+
+  // ... and the other way around
+  geometry->requireFaceAreas();
+  geometry->freeze();
+  geometry->unrequireFaceAreas();
+  geometry->unfreeze();
+  EXPECT_EQ(requireCount("faceAreas"), 0);
+  EXPECT_THROW(geometry->unrequireFaceAreas(), std::logic_error);
+  EXPECT_EQ(requireCount("faceAreas"), 0);
+
+  // An object which requires in its constructor and unrequires in its destructor
+  geometry->freeze();
+  std::unique_ptr<GraphDistanceEngine> engine(new GraphDistanceEngine(*geometry));
+  geometry->unfreeze();
+  engine.reset();
+  EXPECT_EQ(requireCount("edgeLengths"), 0);
+}
+
+
 // Copying
 TEST_F(HalfedgeGeometrySuite, CopyTest) {
   for (auto& asset : {getAsset("bob_small.ply", false), getAsset("bob_small.ply", true)}) {
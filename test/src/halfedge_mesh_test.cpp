@@ -1,12 +1,17 @@
 
 #include "geometrycentral/surface/manifold_surface_mesh.h"
+#include "geometrycentral/surface/mesh_archive.h"
+#include "geometrycentral/surface/mesh_compression.h"
 #include "geometrycentral/surface/meshio.h"
 #include "geometrycentral/surface/rich_surface_mesh_data.h"
+#include "geometrycentral/surface/surface_mesh_factories.h"
 
 #include "load_test_meshes.h"
 
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <unordered_set>
@@ -128,6 +133,119 @@ TEST_F(HalfedgeMeshSuite, MatrixConstructorManifoldTest) {
   }
 }
 
+TEST_F(HalfedgeMeshSuite, FlatConstructorManifoldTest) {
+  for (MeshAsset& a : manifoldSurfaceMeshes()) {
+    if (!a.isTriangular) continue;
+    a.printThyName();
+
+    std::vector<size_t> flatFaces;
+    for (const std::vector<size_t>& face : a.mesh->getFaceVertexList()) {
+      flatFaces.insert(flatFaces.end(), face.begin(), face.end());
+    }
+    ManifoldSurfaceMesh newM(flatFaces, 3);
+    newM.validateConnectivity();
+    EXPECT_EQ(newM.nVertices(), a.mesh->nVertices());
+    EXPECT_EQ(newM.nEdges(), a.mesh->nEdges());
+    EXPECT_EQ(newM.nFaces(), a.mesh->nFaces());
+    EXPECT_EQ(newM.nBoundaryLoops(), a.mesh->nBoundaryLoops());
+    EXPECT_EQ(newM.getFaceVertexList(), a.mesh->getFaceVertexList());
+  }
+}
+
+TEST_F(HalfedgeMeshSuite, FlatConstructorTest) {
+  for (MeshAsset& a : allMeshes()) {
+    a.printThyName();
+
+    std::vector<std::vector<size_t>> polygons = a.mesh->getFaceVertexList();
+    std::vector<size_t> flatFaces;
+    std::vector<size_t> faceStart{0};
+    for (const std::vector<size_t>& face : polygons) {
+      flatFaces.insert(flatFaces.end(), face.begin(), face.end());
+      faceStart.push_back(flatFaces.size());
+    }
+    SurfaceMesh polyM(polygons);
+    SurfaceMesh newM(flatFaces, faceStart);
+    newM.validateConnectivity();
+
+    // Should be exactly the same mesh, down to the ordering of edges and siblings
+    ASSERT_EQ(newM.nHalfedges(), polyM.nHalfedges());
+    EXPECT_EQ(newM.nEdges(), polyM.nEdges());
+    EXPECT_EQ(newM.getFaceVertexList(), polygons);
+    for (size_t iHe = 0; iHe < polyM.nHalfedges(); iHe++) {
+      Halfedge he = newM.halfedge(iHe);
+      Halfedge polyHe = polyM.halfedge(iHe);
+      EXPECT_EQ(he.edge().getIndex(), polyHe.edge().getIndex());
+      EXPECT_EQ(he.sibling().getIndex(), polyHe.sibling().getIndex());
+      EXPECT_EQ(he.orientation(), polyHe.orientation());
+    }
+
+    if (a.isTriangular) {
+      SurfaceMesh triM(flatFaces, 3);
+      EXPECT_EQ(triM.nEdges(), polyM.nEdges());
+      EXPECT_EQ(triM.getFaceVertexList(), polygons);
+    }
+  }
+}
+
+TEST_F(HalfedgeMeshSuite, ProceduralMeshTest) {
+
+  { // triangulated grid
+    std::unique_ptr<ManifoldSurfaceMesh> mesh;
+    std::unique_ptr<VertexPositionGeometry> geometry;
+    std::tie(mesh, geometry) = makeGridMeshAndGeometry(7, 5);
+    mesh->validateConnectivity();
+    EXPECT_EQ(mesh->nVertices(), 8 * 6);
+    EXPECT_EQ(mesh->nFaces(), 2 * 7 * 5);
+    EXPECT_EQ(mesh->nBoundaryLoops(), 1);
+    EXPECT_EQ(mesh->genus(), 0);
+    geometry->requireFaceAreas();
+    EXPECT_NEAR(geometry->faceAreas.toVector().sum(), 1., 1e-9);
+  }
+
+  { // quad torus
+    std::unique_ptr<ManifoldSurfaceMesh> mesh;
+    std::unique_ptr<VertexPositionGeometry> geometry;
+    std::tie(mesh, geometry) = makeTorusMeshAndGeometry(12, 6, 1., 0.25, false);
+    mesh->validateConnectivity();
+    EXPECT_EQ(mesh->nFaces(), 12 * 6);
+    EXPECT_FALSE(mesh->isTriangular());
+    EXPECT_FALSE(mesh->hasBoundary());
+    EXPECT_EQ(mesh->genus(), 1);
+  }
+
+  { // icosphere
+    for (size_t freq : {1, 2, 5}) {
+      std::unique_ptr<ManifoldSurfaceMesh> mesh;
+      std::unique_ptr<VertexPositionGeometry> geometry;
+      std::tie(mesh, geometry) = makeIcosphereMeshAndGeometry(freq);
+      mesh->validateConnectivity();
+      EXPECT_EQ(mesh->nVertices(), 10 * freq * freq + 2);
+      EXPECT_EQ(mesh->nFaces(), 20 * freq * freq);
+      EXPECT_EQ(mesh->genus(), 0);
+
+      // faces should be oriented outward
+      geometry->requireFaceNormals();
+      for (Face f : mesh->faces()) {
+        Vector3 c = geometry->vertexPositions[f.halfedge().vertex()];
+        EXPECT_GT(dot(geometry->faceNormals[f], c), 0.);
+      }
+    }
+  }
+
+  { // noisy and degenerate variants
+    std::unique_ptr<ManifoldSurfaceMesh> mesh;
+    std::unique_ptr<VertexPositionGeometry> geometry;
+    std::tie(mesh, geometry) = makeIcosphereMeshAndGeometry(4);
+    perturbVertexPositions(*geometry, 0.01, 7);
+    for (Vertex v : mesh->vertices()) {
+      EXPECT_NEAR(norm(geometry->vertexPositions[v]), 1., 0.02);
+    }
+    degenerateVertexPositions(*geometry, 0.2, 7);
+    geometry->requireEdgeLengths();
+    EXPECT_EQ(geometry->edgeLengths.toVector().minCoeff(), 0.);
+  }
+}
+
 // ============================================================
 // =============== Range iterator tests
 // ============================================================
@@ -938,3 +1056,289 @@ TEST_F(HalfedgeMeshSuite, RichMeshDataSaveLoadMeshManifold) {
     for (size_t i = 0; i < mesh.nHalfedges(); i++) EXPECT_EQ(halfedgeValues[i], halfedgeValuesIn[i]);
   }
 }
+
+TEST_F(HalfedgeMeshSuite, RichMeshDataRewriteInPlace) {
+
+  auto asset = getAsset("lego.ply", false);
+  SurfaceMesh& mesh = *asset.mesh;
+  VertexPositionGeometry& geom = *asset.geometry;
+
+  VertexData<double> vertexValues(mesh);
+  fillRandom(vertexValues);
+  FaceData<double> faceValues(mesh);
+  fillRandom(faceValues);
+
+  RichSurfaceMeshData richData(mesh);
+  richData.addMeshConnectivity();
+  richData.addGeometry(geom);
+  richData.addVertexProperty("vertex_vals", vertexValues);
+  richData.write("test_archive.ply");
+
+  // Properties are read lazily from the file, so it is still in use while writing over it
+  std::unique_ptr<SurfaceMesh> meshIn;
+  std::unique_ptr<RichSurfaceMeshData> richDataIn;
+  std::tie(meshIn, richDataIn) = RichSurfaceMeshData::readMeshAndData("test_archive.ply");
+  richDataIn->addFaceProperty("face_vals", FaceData<double>(*meshIn, faceValues.raw()));
+  richDataIn->write("test_archive.ply");
+
+  // Afterwards the object reads from the new file, and it can be moved and written again
+  RichSurfaceMeshData movedData(std::move(*richDataIn));
+  FaceData<double> faceValuesMoved = movedData.getFaceProperty<double>("face_vals");
+  for (size_t i = 0; i < mesh.nFaces(); i++) EXPECT_EQ(faceValues[i], faceValuesMoved[i]);
+  movedData.write("test_archive.ply");
+
+  std::tie(meshIn, richDataIn) = RichSurfaceMeshData::readMeshAndData("test_archive.ply");
+  ASSERT_EQ(mesh.nFaces(), meshIn->nFaces());
+  VertexData<double> vertexValuesIn = richDataIn->getVertexProperty<double>("vertex_vals");
+  FaceData<double> faceValuesIn = richDataIn->getFaceProperty<double>("face_vals");
+  for (size_t i = 0; i < mesh.nVertices(); i++) EXPECT_EQ(vertexValues[i], vertexValuesIn[i]);
+  for (size_t i = 0; i < mesh.nFaces(); i++) EXPECT_EQ(faceValues[i], faceValuesIn[i]);
+  std::unique_ptr<VertexPositionGeometry> geomIn = richDataIn->getGeometry();
+  for (size_t i = 0; i < mesh.nVertices(); i++) EXPECT_EQ(geom.vertexPositions[i], geomIn->vertexPositions[i]);
+}
+
+// ============================================================
+// =============== Mesh archive
+// ============================================================
+
+TEST_F(HalfedgeMeshSuite, MeshArchiveSaveLoadMesh) {
+
+  for (auto& asset : {getAsset("lego.ply", false), getAsset("lego.ply", true)}) {
+
+    SurfaceMesh& mesh = *asset.mesh;
+    VertexPositionGeometry& geom = *asset.geometry;
+
+    HalfedgeData<double> halfedgeValues(mesh);
+    fillRandom(halfedgeValues);
+    FaceData<int32_t> faceValues(mesh);
+    for (Face f : mesh.faces()) faceValues[f] = -static_cast<int32_t>(f.getIndex());
+    BoundaryLoopData<Vector2> blValues(mesh, Vector2{1., 2.});
+
+    // Write the data to file
+    MeshArchive archive(mesh);
+    archive.addGeometry(geom);
+    archive.addElementProperty("he_vals", halfedgeValues);
+    archive.addElementProperty("f_vals", faceValues);
+    archive.addElementProperty("bl_vals", blValues);
+    archive.write("test_archive.gcmesh");
+
+    // Read the data back from file
+    std::unique_ptr<SurfaceMesh> meshIn;
+    std::unique_ptr<MeshArchive> archiveIn;
+    std::tie(meshIn, archiveIn) = MeshArchive::readMeshAndData("test_archive.gcmesh");
+
+    // The mesh comes back with the same type and connectivity
+    meshIn->validateConnectivity();
+    EXPECT_EQ(mesh.usesImplicitTwin(), meshIn->usesImplicitTwin());
+    ASSERT_EQ(mesh.nVertices(), meshIn->nVertices());
+    ASSERT_EQ(mesh.nHalfedges(), meshIn->nHalfedges());
+    ASSERT_EQ(mesh.nEdges(), meshIn->nEdges());
+    ASSERT_EQ(mesh.nFaces(), meshIn->nFaces());
+    ASSERT_EQ(mesh.nBoundaryLoops(), meshIn->nBoundaryLoops());
+    for (size_t i = 0; i < mesh.nHalfedges(); i++) {
+      EXPECT_EQ(mesh.halfedge(i).next().getIndex(), meshIn->halfedge(i).next().getIndex());
+      EXPECT_EQ(mesh.halfedge(i).twin().getIndex(), meshIn->halfedge(i).twin().getIndex());
+    }
+
+    // Check contained data and properties
+    std::unique_ptr<VertexPositionGeometry> geomIn = archiveIn->getGeometry();
+    for (size_t i = 0; i < mesh.nVertices(); i++) EXPECT_EQ(geom.vertexPositions[i], geomIn->vertexPositions[i]);
+    HalfedgeData<double> halfedgeValuesIn = archiveIn->getElementProperty<Halfedge, double>("he_vals");
+    for (size_t i = 0; i < mesh.nHalfedges(); i++) EXPECT_EQ(halfedgeValues[i], halfedgeValuesIn[i]);
+    FaceData<int32_t> faceValuesIn = archiveIn->getElementProperty<Face, int32_t>("f_vals");
+    for (size_t i = 0; i < mesh.nFaces(); i++) EXPECT_EQ(faceValues[i], faceValuesIn[i]);
+    BoundaryLoopData<Vector2> blValuesIn = archiveIn->getElementProperty<BoundaryLoop, Vector2>("bl_vals");
+    for (BoundaryLoop bl : meshIn->boundaryLoops()) EXPECT_EQ(blValuesIn[bl], (Vector2{1., 2.}));
+
+    // Reading with the wrong type or element fails
+    EXPECT_THROW((archiveIn->getElementProperty<Halfedge, float>("he_vals")), std::runtime_error);
+    EXPECT_THROW((archiveIn->getElementProperty<Edge, double>("he_vals")), std::runtime_error);
+
+    // Properties can also be opened on the original mesh
+    MeshArchive archiveOnMesh(mesh, "test_archive.gcmesh");
+    std::vector<std::string> expectedNames = {"he_vals", "f_vals", "bl_vals"};
+    EXPECT_EQ(archiveOnMesh.getPropertyNames(), expectedNames);
+    FaceData<int32_t> faceValuesOnMesh = archiveOnMesh.getElementProperty<Face, int32_t>("f_vals");
+    for (Face f : mesh.faces()) EXPECT_EQ(faceValues[f], faceValuesOnMesh[f]);
+  }
+
+  std::remove("test_archive.gcmesh");
+}
+
+TEST(MeshArchiveTests, SaveLoadMutatedMeshWithBoundary) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeGridMeshAndGeometry(7, 5);
+
+  // Splitting edges grows the element buffers, so the boundary loop no longer sits directly after the faces
+  for (size_t iE = 0; iE < 20; iE++) {
+    mesh->splitEdgeTriangular(mesh->edge(iE));
+  }
+  BoundaryLoopData<double> blValues(*mesh, 3.);
+
+  std::string path = "test_archive_mutated.gcmesh";
+  MeshArchive archive(*mesh);
+  archive.addElementProperty("bl_vals", blValues);
+  archive.write(path);
+
+  std::unique_ptr<ManifoldSurfaceMesh> meshIn;
+  std::unique_ptr<MeshArchive> archiveIn;
+  std::tie(meshIn, archiveIn) = MeshArchive::readManifoldMeshAndData(path);
+  meshIn->validateConnectivity();
+  ASSERT_EQ(mesh->nHalfedges(), meshIn->nHalfedges());
+  ASSERT_EQ(mesh->nFaces(), meshIn->nFaces());
+  ASSERT_EQ(meshIn->nBoundaryLoops(), 1);
+  EXPECT_EQ(mesh->getFaceVertexList(), meshIn->getFaceVertexList());
+  for (size_t i = 0; i < mesh->nHalfedges(); i++) {
+    EXPECT_EQ(mesh->halfedge(i).isInterior(), meshIn->halfedge(i).isInterior());
+  }
+  BoundaryLoopData<double> blValuesIn = archiveIn->getElementProperty<BoundaryLoop, double>("bl_vals");
+  EXPECT_EQ(blValuesIn[meshIn->boundaryLoop(0)], 3.);
+
+  std::remove(path.c_str());
+}
+
+TEST(MeshArchiveTests, DetectsCorruption) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeGridMeshAndGeometry(7, 5);
+
+  std::string path = "test_archive_corrupt.gcmesh";
+  MeshArchive archive(*mesh);
+  archive.addGeometry(*geometry);
+  archive.write(path);
+
+  // Flip one bit of the last position
+  {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(-1, std::ios::end);
+    char c = f.get();
+    f.seekp(-1, std::ios::end);
+    f.put(c ^ 1);
+  }
+
+  EXPECT_THROW(MeshArchive::readManifoldMeshAndData(path), std::runtime_error);
+
+  // Skipping verification loads the (damaged) data anyway
+  std::unique_ptr<ManifoldSurfaceMesh> meshIn;
+  std::unique_ptr<MeshArchive> archiveIn;
+  std::tie(meshIn, archiveIn) = MeshArchive::readManifoldMeshAndData(path, false);
+  EXPECT_EQ(meshIn->nBoundaryLoops(), 1);
+  EXPECT_NE(archiveIn->getGeometry()->vertexPositions[meshIn->nVertices() - 1],
+            geometry->vertexPositions[mesh->nVertices() - 1]);
+
+  std::remove(path.c_str());
+}
+
+// ============================================================
+// =============== Mesh compression
+// ============================================================
+
+TEST_F(HalfedgeMeshSuite, CompressedMeshRoundTrip) {
+  for (MeshAsset& a : manifoldSurfaceMeshes()) {
+    a.printThyName();
+    ManifoldSurfaceMesh& mesh = *a.manifoldMesh;
+    VertexPositionGeometry& geom = *a.geometry;
+
+    std::unique_ptr<ManifoldSurfaceMesh> meshIn;
+    std::unique_ptr<VertexPositionGeometry> geomIn;
+
+    // With the element order preserved, the face lists match exactly
+    MeshCompressionOptions options;
+    options.preserveElementOrder = true;
+    MeshCompressionStats stats;
+    std::vector<char> bytes = compressSurfaceMesh(mesh, geom, options, &stats);
+    EXPECT_EQ(stats.compressedBytes, bytes.size());
+    if (mesh.nFaces() > 100) EXPECT_GT(stats.compressionRatio, 1.); // (tiny meshes are dominated by the header)
+    std::tie(meshIn, geomIn) = decompressSurfaceMesh(bytes.data(), bytes.size());
+    EXPECT_EQ(mesh.getFaceVertexList(), meshIn->getFaceVertexList());
+    for (size_t i = 0; i < mesh.nVertices(); i++) {
+      EXPECT_LE(norm(geom.vertexPositions[i] - geomIn->vertexPositions[i]), 1.001 * stats.maxPositionError + 1e-12);
+    }
+
+    // Otherwise elements are renumbered, but the mesh is the same
+    options.preserveElementOrder = false;
+    bytes = compressSurfaceMesh(mesh, geom, options, &stats);
+    std::tie(meshIn, geomIn) = decompressSurfaceMesh(bytes.data(), bytes.size());
+    meshIn->validateConnectivity();
+    EXPECT_EQ(mesh.nVertices(), meshIn->nVertices());
+    EXPECT_EQ(mesh.nEdges(), meshIn->nEdges());
+    EXPECT_EQ(mesh.nFaces(), meshIn->nFaces());
+    EXPECT_EQ(mesh.nBoundaryLoops(), meshIn->nBoundaryLoops());
+    EXPECT_EQ(mesh.nConnectedComponents(), meshIn->nConnectedComponents());
+    EXPECT_EQ(mesh.eulerCharacteristic(), meshIn->eulerCharacteristic());
+  }
+}
+
+TEST(MeshCompressionTests, FileRoundTripAndErrors) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeGridMeshAndGeometry(40, 30);
+
+  // Through the meshio readers and writers
+  std::string path = "test_compressed.gcz";
+  writeSurfaceMesh(*mesh, *geometry, path);
+  std::unique_ptr<SurfaceMesh> meshIn;
+  std::unique_ptr<VertexPositionGeometry> geomIn;
+  std::tie(meshIn, geomIn) = readSurfaceMesh(path);
+  EXPECT_EQ(mesh->nFaces(), meshIn->nFaces());
+  EXPECT_EQ(mesh->nBoundaryLoops(), meshIn->nBoundaryLoops());
+
+  MeshCompressionOptions options;
+  options.positionBits = 0;
+  EXPECT_THROW(compressSurfaceMesh(*mesh, *geometry, options), std::runtime_error);
+
+  // Damaged data is rejected
+  std::vector<char> bytes = compressSurfaceMesh(*mesh, *geometry);
+  EXPECT_THROW(decompressSurfaceMesh(bytes.data(), bytes.size() - 1), std::runtime_error);
+  bytes[0] = 'X';
+  EXPECT_THROW(decompressSurfaceMesh(bytes.data(), bytes.size()), std::runtime_error);
+
+  std::remove(path.c_str());
+}
+
+// ============================================================
+// =============== Asynchronous writing
+// ============================================================
+
+TEST(MeshIOTests, AsyncWriteSnapshotsMesh) {
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeGridMeshAndGeometry(20, 10);
+  std::vector<std::vector<size_t>> faces = mesh->getFaceVertexList();
+  size_t nVertices = mesh->nVertices();
+  Vector3 p0 = geometry->vertexPositions[0];
+
+  std::string objPath = "test_async.obj";
+  std::string gczPath = "test_async.gcz";
+  std::future<void> objWrite = writeSurfaceMeshAsync(*mesh, *geometry, objPath);
+  std::future<void> gczWrite = writeSurfaceMeshAsync(*mesh, *geometry, gczPath);
+
+  // The mesh can be modified while the files are written
+  geometry->vertexPositions[0] = Vector3{10., 10., 10.};
+  Vertex vNew = mesh->insertVertex(mesh->face(0));
+  geometry->vertexPositions[vNew] = Vector3{0., 0., 0.};
+  objWrite.get();
+  gczWrite.get();
+
+  std::unique_ptr<SurfaceMesh> meshIn;
+  std::unique_ptr<VertexPositionGeometry> geomIn;
+  std::tie(meshIn, geomIn) = readSurfaceMesh(objPath);
+  EXPECT_EQ(faces, meshIn->getFaceVertexList());
+  EXPECT_LT(norm(geomIn->vertexPositions[0] - p0), 1e-12);
+
+  std::tie(meshIn, geomIn) = readSurfaceMesh(gczPath);
+  EXPECT_EQ(nVertices, meshIn->nVertices());
+  EXPECT_EQ(faces.size(), meshIn->nFaces());
+
+  // Errors are reported through the future
+  std::future<void> badWrite = writeSurfaceMeshAsync(*mesh, *geometry, "test_async.unknown_type");
+  EXPECT_ANY_THROW(badWrite.get());
+
+  // ... except for texture coordinates in a .gcz file, which are rejected right away
+  CornerData<Vector2> texCoords(*mesh, Vector2{0., 0.});
+  EXPECT_THROW(writeSurfaceMeshAsync(*mesh, *geometry, texCoords, "test_async_uv.gcz"), std::runtime_error);
+
+  std::remove(objPath.c_str());
+  std::remove(gczPath.c_str());
+}
@@ -3,6 +3,7 @@
 #include "geometrycentral/surface/manifold_surface_mesh.h"
 #include "geometrycentral/surface/meshio.h"
 #include "geometrycentral/surface/signpost_intrinsic_triangulation.h"
+#include "geometrycentral/surface/simple_idt.h"
 #include "geometrycentral/surface/transfer_functions.h"
 #include "geometrycentral/surface/vertex_position_geometry.h"
 
@@ -68,6 +69,54 @@ TEST_F(IntrinsicTriangulationSuite, DelaunayTriangulationsAgree) {
 }
 
 
+TEST_F(IntrinsicTriangulationSuite, ParallelFlipToDelaunay) {
+  for (const MeshAsset& a : {getAsset("fox.ply", true), getAsset("cat_head.obj", true)}) {
+    a.printThyName();
+    ManifoldSurfaceMesh& mesh = *a.manifoldMesh;
+    VertexPositionGeometry& origGeometry = *a.geometry;
+
+    // Faces as sorted vertex triples, to compare triangulations regardless of element indexing
+    auto faceSet = [](SurfaceMesh& m) {
+      std::vector<std::array<size_t, 3>> faces;
+      for (Face f : m.faces()) {
+        std::array<size_t, 3> tri{f.halfedge().vertex().getIndex(), f.halfedge().next().vertex().getIndex(),
+                                  f.halfedge().next().next().vertex().getIndex()};
+        std::sort(tri.begin(), tri.end());
+        faces.push_back(tri);
+      }
+      std::sort(faces.begin(), faces.end());
+      return faces;
+    };
+
+    SignpostIntrinsicTriangulation serialTri(mesh, origGeometry);
+    serialTri.flipToDelaunay();
+    std::vector<std::array<size_t, 3>> serialFaces = faceSet(serialTri.mesh);
+
+    SignpostIntrinsicTriangulation signpostTri(mesh, origGeometry);
+    IntegerCoordinatesIntrinsicTriangulation integerTri(mesh, origGeometry);
+    for (IntrinsicTriangulation* triPtr : std::vector<IntrinsicTriangulation*>{&signpostTri, &integerTri}) {
+      IntrinsicTriangulation& tri = *triPtr;
+      size_t nCallbacks = 0;
+      tri.edgeFlipCallbackList.push_back([&](Edge e) { nCallbacks++; });
+      tri.flipToDelaunay(3);
+      EXPECT_TRUE(tri.isDelaunay());
+      EXPECT_GT(nCallbacks, 0u);
+      EXPECT_EQ(faceSet(tri.mesh), serialFaces);
+    }
+
+    // Same for the simple length-based implementation
+    std::unique_ptr<ManifoldSurfaceMesh> serialMesh = mesh.copy();
+    std::unique_ptr<ManifoldSurfaceMesh> parallelMesh = mesh.copy();
+    origGeometry.requireEdgeLengths();
+    EdgeData<double> serialLengths = origGeometry.edgeLengths.reinterpretTo(*serialMesh);
+    EdgeData<double> parallelLengths = origGeometry.edgeLengths.reinterpretTo(*parallelMesh);
+    flipToDelaunay(*serialMesh, serialLengths);
+    size_t nParallelFlips = flipToDelaunay(*parallelMesh, parallelLengths, FlipType::Euclidean, 1e-6, 3);
+    EXPECT_GT(nParallelFlips, 0u);
+    EXPECT_EQ(faceSet(*parallelMesh), faceSet(*serialMesh));
+  }
+}
+
 TEST_F(IntrinsicTriangulationSuite, SignpostTrace) {
   for (const MeshAsset& a : {getAsset("fox.ply", true), getAsset("cat_head.obj", true)}) {
     a.printThyName();
@@ -272,6 +321,74 @@ TEST_F(IntrinsicTriangulationSuite, IntegerRefine) {
   }
 }
 
+TEST_F(IntrinsicTriangulationSuite, BatchedRefine) {
+  for (const MeshAsset& a : {getAsset("fox.ply", true), getAsset("cat_head.obj", true)}) {
+    a.printThyName();
+    ManifoldSurfaceMesh& mesh = *a.manifoldMesh;
+    VertexPositionGeometry& origGeometry = *a.geometry;
+
+    SignpostIntrinsicTriangulation signpostTri(mesh, origGeometry);
+    IntegerCoordinatesIntrinsicTriangulation integerTri(mesh, origGeometry);
+    for (IntrinsicTriangulation* tri : std::vector<IntrinsicTriangulation*>{&signpostTri, &integerTri}) {
+      tri->delaunayRefine(25., std::numeric_limits<double>::infinity(), INVALID_IND, 3);
+      EXPECT_TRUE(tri->isDelaunay());
+      EXPECT_GT(tri->mesh.nVertices(), tri->inputMesh.nVertices());
+      EXPECT_GE(tri->minAngleDegrees(), 25);
+    }
+
+    // Respects the insertion limit
+    SignpostIntrinsicTriangulation limitedTri(mesh, origGeometry);
+    limitedTri.delaunayRefine(25., std::numeric_limits<double>::infinity(), 10, 3);
+    EXPECT_LE(limitedTri.mesh.nVertices(), limitedTri.inputMesh.nVertices() + 10);
+  }
+}
+
+TEST_F(IntrinsicTriangulationSuite, CheckpointRollback) {
+  for (const MeshAsset& a : {getAsset("fox.ply", true), getAsset("cat_head.obj", true)}) {
+    a.printThyName();
+    ManifoldSurfaceMesh& mesh = *a.manifoldMesh;
+    VertexPositionGeometry& origGeometry = *a.geometry;
+
+    SignpostIntrinsicTriangulation signpostTri(mesh, origGeometry);
+    IntegerCoordinatesIntrinsicTriangulation integerTri(mesh, origGeometry);
+
+    for (IntrinsicTriangulation* triPtr : std::vector<IntrinsicTriangulation*>{&signpostTri, &integerTri}) {
+      IntrinsicTriangulation& tri = *triPtr;
+      EXPECT_FALSE(tri.hasCheckpoint());
+      EXPECT_THROW(tri.rollback(), std::runtime_error);
+
+      tri.flipToDelaunay();
+      tri.checkpoint();
+      EXPECT_TRUE(tri.hasCheckpoint());
+      size_t nV = tri.mesh.nVertices();
+      EdgeData<double> lengths = tri.edgeLengths;
+
+      // Refine, then go back and refine again: both refinements should be identical
+      std::vector<size_t> refinedCounts;
+      std::vector<double> refinedMinAngles;
+      for (int iRep = 0; iRep < 2; iRep++) {
+        tri.delaunayRefine();
+        EXPECT_GT(tri.mesh.nVertices(), nV);
+        refinedCounts.push_back(tri.mesh.nVertices());
+        refinedMinAngles.push_back(tri.minAngleDegrees());
+        tri.getCommonSubdivision(); // compresses the intrinsic mesh
+
+        tri.rollback();
+        EXPECT_EQ(tri.mesh.nVertices(), nV);
+        EXPECT_TRUE(tri.isDelaunay());
+        for (Edge e : tri.mesh.edges()) {
+          EXPECT_EQ(tri.edgeLengths[e], lengths[e]);
+        }
+        for (Vertex v : tri.mesh.vertices()) {
+          EXPECT_EQ(tri.vertexLocations[v].type, SurfacePointType::Vertex);
+        }
+      }
+      EXPECT_EQ(refinedCounts[0], refinedCounts[1]);
+      EXPECT_EQ(refinedMinAngles[0], refinedMinAngles[1]);
+    }
+  }
+}
+
 TEST_F(IntrinsicTriangulationSuite, SignpostCommonSubdivision) {
   for (const MeshAsset& a : {getAsset("fox.ply", true), getAsset("cat_head.obj", true)}) {
     a.printThyName();
@@ -323,6 +440,58 @@ TEST_F(IntrinsicTriangulationSuite, IntegerCommonSubdivision) {
   }
 }
 
+TEST_F(IntrinsicTriangulationSuite, ParallelCommonSubdivision) {
+  for (const MeshAsset& a : {getAsset("fox.ply", true), getAsset("cat_head.obj", true)}) {
+    a.printThyName();
+    ManifoldSurfaceMesh& mesh = *a.manifoldMesh;
+    VertexPositionGeometry& origGeometry = *a.geometry;
+
+    SignpostIntrinsicTriangulation serialSignpost(mesh, origGeometry);
+    SignpostIntrinsicTriangulation parallelSignpost(mesh, origGeometry);
+    IntegerCoordinatesIntrinsicTriangulation serialInteger(mesh, origGeometry);
+    IntegerCoordinatesIntrinsicTriangulation parallelInteger(mesh, origGeometry);
+    std::vector<std::pair<IntrinsicTriangulation*, IntrinsicTriangulation*>> pairs{
+        {&serialSignpost, &parallelSignpost}, {&serialInteger, &parallelInteger}};
+
+    for (const std::pair<IntrinsicTriangulation*, IntrinsicTriangulation*>& p : pairs) {
+      IntrinsicTriangulation& serialTri = *p.first;
+      IntrinsicTriangulation& parallelTri = *p.second;
+      serialTri.traceThreads = 1;
+      parallelTri.traceThreads = 3;
+      serialTri.delaunayRefine();
+      parallelTri.delaunayRefine();
+      ASSERT_EQ(serialTri.mesh.nVertices(), parallelTri.mesh.nVertices());
+
+      // The traces are the same
+      EdgeData<std::vector<SurfacePoint>> serialTraces = serialTri.traceAllIntrinsicEdgesAlongInput();
+      EdgeData<std::vector<SurfacePoint>> parallelTraces = parallelTri.traceAllIntrinsicEdgesAlongInput();
+      for (Edge e : serialTri.mesh.edges()) {
+        const std::vector<SurfacePoint>& serialTrace = serialTraces[e];
+        const std::vector<SurfacePoint>& parallelTrace = parallelTraces[parallelTri.mesh.edge(e.getIndex())];
+        ASSERT_EQ(serialTrace.size(), parallelTrace.size());
+        for (size_t i = 0; i < serialTrace.size(); i++) {
+          EXPECT_EQ(serialTrace[i].type, parallelTrace[i].type);
+          EXPECT_EQ(serialTrace[i].inSomeFace().face.getIndex(), parallelTrace[i].inSomeFace().face.getIndex());
+        }
+      }
+
+      // And so are the common subdivision meshes
+      CommonSubdivision& serialCS = serialTri.getCommonSubdivision();
+      CommonSubdivision& parallelCS = parallelTri.getCommonSubdivision();
+      serialCS.constructMesh(false);
+      parallelCS.constructMesh(false);
+      EXPECT_EQ(serialCS.mesh->nVertices(), parallelCS.mesh->nVertices());
+      EXPECT_EQ(serialCS.mesh->nFaces(), parallelCS.mesh->nFaces());
+
+      size_t nV, nE, nF;
+      std::tie(nV, nE, nF) = parallelCS.elementCounts();
+      EXPECT_EQ(parallelCS.mesh->nVertices(), nV);
+      EXPECT_EQ(parallelCS.mesh->nEdges(), nE);
+      EXPECT_EQ(parallelCS.mesh->nFaces(), nF);
+    }
+  }
+}
+
 // TODO test signpost and integer against each other to verify they give same results
 
 TEST_F(IntrinsicTriangulationSuite, CommonSubdivisionCompareIntegerSignpost) {
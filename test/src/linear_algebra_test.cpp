@@ -1,14 +1,15 @@
 #include "geometrycentral/numerical/linear_algebra_utilities.h"
 #include "geometrycentral/numerical/linear_solvers.h"
 #include "geometrycentral/surface/meshio.h"
-#include "geometrycentral/utilities/timing.h"
 
 #include "load_test_meshes.h"
 
 #include "gtest/gtest.h"
 
+#include <cstdio>
 #include <iostream>
 #include <random>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 
@@ -761,3 +762,89 @@ TEST_F(LinearAlgebraTestSuite, TestQRSolvers_wide) {
 }
 
 // TODO test eigenvalue routines
+
+TEST_F(LinearAlgebraTestSuite, BinaryMatrixIOTest) {
+
+  // A matrix with several compressed blocks
+  std::vector<Eigen::Triplet<double>> triplets;
+  size_t nRows = 50;
+  size_t nCols = 300000;
+  for (size_t iCol = 0; iCol < nCols; iCol++) {
+    triplets.emplace_back(iCol % nRows, iCol, randomFromRange<double>(-1., 1.));
+    triplets.emplace_back((7 * iCol + 3) % nRows, iCol, 0.5);
+  }
+  SparseMatrix<double> mat(nRows, nCols);
+  mat.setFromTriplets(triplets.begin(), triplets.end());
+
+  for (bool compress : {false, true}) {
+    for (bool rowMajor : {false, true}) {
+      BinaryMatrixOptions options;
+      options.compress = compress;
+      options.rowMajor = rowMajor;
+      std::stringstream stream;
+      saveSparseMatrixBinary(stream, mat, options);
+      SparseMatrix<double> loaded = loadSparseMatrixBinary<double>(stream);
+      ASSERT_EQ(loaded.rows(), mat.rows());
+      ASSERT_EQ(loaded.cols(), mat.cols());
+      EXPECT_EQ((loaded - mat).norm(), 0.);
+    }
+  }
+
+  { // complex values, and the wrong scalar type
+    SparseMatrix<std::complex<double>> cMat = buildSPDTestMatrix<std::complex<double>>();
+    BinaryMatrixOptions options;
+    options.compress = true;
+    std::stringstream stream;
+    saveSparseMatrixBinary(stream, cMat, options);
+    BinaryMatrixFile file(stream);
+    EXPECT_EQ(file.scalarTypeName(), "complex<double>");
+    EXPECT_EQ((file.getSparseMatrix<std::complex<double>>() - cMat).norm(), 0.);
+    EXPECT_THROW(file.getSparseMatrix<double>(), std::runtime_error);
+    EXPECT_THROW(file.getDenseMatrix<std::complex<double>>(), std::runtime_error);
+  }
+
+  { // dense
+    DenseMatrix<float> dMat(300, 300);
+    for (long int i = 0; i < dMat.size(); i++) dMat(i) = randomFromRange<float>(0., 1.);
+    for (bool compress : {false, true}) {
+      std::stringstream stream;
+      saveDenseMatrixBinary(stream, dMat, compress);
+      DenseMatrix<float> loaded = loadDenseMatrixBinary<float>(stream);
+      EXPECT_TRUE(loaded == dMat);
+    }
+
+    // Dense dimensions are not limited to 32 bits
+    DenseMatrix<float> tall(3000000000, 0);
+    std::stringstream stream;
+    saveDenseMatrixBinary(stream, tall);
+    DenseMatrix<float> loaded = loadDenseMatrixBinary<float>(stream);
+    EXPECT_EQ(loaded.rows(), tall.rows());
+    EXPECT_EQ(loaded.cols(), 0);
+  }
+
+  { // views of a mapped file
+    std::string filename = "test_matrix.gcmat";
+    saveSparseMatrixBinary(filename, mat);
+    {
+      BinaryMatrixFile file(filename);
+      EXPECT_FALSE(file.isCompressed());
+      EXPECT_EQ(file.nonZeros(), static_cast<size_t>(mat.nonZeros()));
+      Eigen::Map<const SparseMatrix<double>> view = file.sparseView<double>();
+      EXPECT_EQ((SparseMatrix<double>(view) - mat).norm(), 0.);
+    }
+    std::remove(filename.c_str());
+  }
+
+  { // corrupt data is rejected
+    BinaryMatrixOptions options;
+    options.compress = true;
+    std::stringstream stream;
+    saveSparseMatrixBinary(stream, mat, options);
+    std::string bytes = stream.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+    EXPECT_THROW(loadSparseMatrixBinary<double>(truncated), std::runtime_error);
+    bytes[100] ^= 0x55;
+    std::stringstream flipped(bytes);
+    EXPECT_THROW(loadSparseMatrixBinary<double>(flipped), std::runtime_error);
+  }
+}
@@ -1,6 +1,7 @@
 #include "geometrycentral/pointcloud/point_cloud.h"
 #include "geometrycentral/pointcloud/point_cloud_heat_solver.h"
 #include "geometrycentral/pointcloud/point_cloud_io.h"
+#include "geometrycentral/pointcloud/point_cloud_stream.h"
 #include "geometrycentral/pointcloud/point_position_frame_geometry.h"
 #include "geometrycentral/pointcloud/point_position_geometry.h"
 #include "geometrycentral/pointcloud/point_position_normal_geometry.h"
@@ -8,7 +9,9 @@
 
 #include "gtest/gtest.h"
 
+#include <cstdio>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 
@@ -195,6 +198,9 @@ TEST_F(PointCloudSuite, GeometryQuantity_Neighbors) {
       seenNeigh.insert(pN);
     }
   }
+
+  // The memory held by the neighbor lists is counted
+  EXPECT_GE(geom.quantitiesBufferBytes(), N * geom.kNeighborSize * sizeof(Point));
 }
 
 TEST_F(PointCloudSuite, GeometryQuantity_Normals) {
@@ -276,7 +282,9 @@ TEST_F(PointCloudSuite, GeometryQuantity_TuftedTriangulation) {
   std::tie(cloud, pos) = generateRandomCloud(N);
   PointPositionGeometry geom(*cloud, pos);
 
+  size_t bytesBefore = geom.quantitiesBufferBytes();
   geom.requireTuftedTriangulation();
+  EXPECT_GE(geom.quantitiesBufferBytes(), bytesBefore + geom.tuftedMesh->bufferBytes());
 
   // Check mesh connectivity
   EXPECT_EQ(geom.tuftedMesh->nVertices(), N);
@@ -504,3 +512,73 @@ TEST_F(PointCloudSuite, ReadWrite_obj) {
     EXPECT_NEAR(geom.positions[iP].z, newGeom->positions[iP].z, 1e-8);
   }
 }
+
+TEST_F(PointCloudSuite, ReadWrite_streamed) {
+  // Points with normals and colors
+  size_t N = 1000;
+  PointCloudChunk points;
+  for (size_t i = 0; i < N; i++) {
+    points.positions.push_back(Vector3{unitRandSeeded(), unitRandSeeded(), -1e5 * unitRandSeeded()});
+    points.normals.push_back(Vector3{unitRandSeeded(), unitRandSeeded(), unitRandSeeded()}.normalize());
+    points.colors.push_back({{static_cast<uint8_t>(i % 256), 7, 255}});
+  }
+
+  for (std::string filename : {"test_cloud_stream.ply", "test_cloud_stream.xyz"}) {
+    // Write in chunks
+    {
+      PointCloudWriter writer(filename, true, true);
+      for (size_t start = 0; start < N; start += 300) {
+        PointCloudChunk chunk;
+        for (size_t i = start; i < std::min(N, start + 300); i++) {
+          chunk.positions.push_back(points.positions[i]);
+          chunk.normals.push_back(points.normals[i]);
+          chunk.colors.push_back(points.colors[i]);
+        }
+        writer.writeChunk(chunk);
+      }
+      writer.close();
+      EXPECT_EQ(writer.nPointsWritten(), N);
+    }
+
+    // Read back in different chunks
+    PointCloudReader reader(filename);
+    EXPECT_TRUE(reader.hasNormals());
+    EXPECT_TRUE(reader.hasColors());
+    PointCloudChunk chunk;
+    size_t nRead = 0;
+    while (reader.readChunk(chunk, 128)) {
+      EXPECT_EQ(chunk.firstIndex, nRead);
+      EXPECT_LE(chunk.size(), 128);
+      for (size_t j = 0; j < chunk.size(); j++) {
+        size_t i = nRead + j;
+        EXPECT_EQ(chunk.positions[j], points.positions[i]); // exact, in both binary and text
+        EXPECT_NEAR(norm(chunk.normals[j] - points.normals[i]), 0., 1e-6);
+        EXPECT_EQ(chunk.colors[j], points.colors[i]);
+      }
+      nRead += chunk.size();
+    }
+    EXPECT_EQ(nRead, N);
+    EXPECT_EQ(reader.nPoints(), N);
+
+    // The in-memory readers use the same path
+    std::unique_ptr<PointCloud> cloud;
+    std::unique_ptr<PointPositionGeometry> geom;
+    std::tie(cloud, geom) = readPointCloud(filename);
+    EXPECT_EQ(cloud->nPoints(), N);
+
+    std::remove(filename.c_str());
+  }
+
+  // Comments, blank lines, and other separators in .xyz text
+  std::stringstream text("# a comment\n1 2 3\n\n  4,5,6\r\n7\t8 9");
+  PointCloudReader reader(text, "xyz");
+  PointCloudChunk chunk;
+  EXPECT_TRUE(reader.readChunk(chunk));
+  EXPECT_EQ(chunk.size(), 3);
+  EXPECT_EQ(chunk.positions[2], (Vector3{7., 8., 9.}));
+  EXPECT_FALSE(reader.readChunk(chunk));
+
+  std::stringstream badText("1 2 3\n4 5 x\n");
+  PointCloudReader badReader(badText, "xyz");
+  EXPECT_THROW(badReader.readChunk(chunk), std::runtime_error);
+}
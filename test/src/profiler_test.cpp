@@ -0,0 +1,106 @@
+#include "geometrycentral/utilities/profiler.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace geometrycentral;
+
+// These call the profiler directly rather than through the macros, so they run whether or not instrumentation is
+// compiled in to the library.
+
+namespace {
+
+void recordNestedZones() {
+  profiler::ScopedZone outer("outer");
+  for (int i = 0; i < 3; i++) {
+    profiler::ScopedZone inner("inner");
+    profiler::incrementCounter("inner calls");
+  }
+}
+
+const profiler::ZoneStatistics* findZone(const std::vector<profiler::ZoneStatistics>& stats, std::string path) {
+  for (const profiler::ZoneStatistics& s : stats) {
+    if (s.path == path) return &s;
+  }
+  return nullptr;
+}
+
+} // namespace
+
+TEST(ProfilerTest, NestedZones) {
+  profiler::clear();
+  recordNestedZones();
+
+  std::vector<profiler::ZoneStatistics> stats = profiler::getZoneStatistics();
+  const profiler::ZoneStatistics* outer = findZone(stats, "outer");
+  const profiler::ZoneStatistics* inner = findZone(stats, "outer/inner");
+  ASSERT_NE(outer, nullptr);
+  ASSERT_NE(inner, nullptr);
+  EXPECT_EQ(outer->depth, 0u);
+  EXPECT_EQ(outer->count, 1u);
+  EXPECT_EQ(inner->depth, 1u);
+  EXPECT_EQ(inner->count, 3u);
+  EXPECT_LE(outer->selfSeconds, outer->totalSeconds);
+  EXPECT_GE(outer->totalSeconds, inner->totalSeconds);
+  EXPECT_EQ(profiler::getCounters()["inner calls"], 3);
+
+  // Both exports mention the zones
+  std::ostringstream trace, summary;
+  profiler::writeChromeTrace(trace);
+  profiler::writeSummaryJSON(summary);
+  EXPECT_NE(trace.str().find("\"inner\""), std::string::npos);
+  EXPECT_NE(summary.str().find("outer/inner"), std::string::npos);
+
+  profiler::clear();
+  EXPECT_TRUE(profiler::getZoneStatistics().empty());
+  EXPECT_TRUE(profiler::getCounters().empty());
+}
+
+TEST(ProfilerTest, MergesThreads) {
+  profiler::clear();
+  std::vector<std::thread> threads;
+  for (int iThread = 0; iThread < 4; iThread++) {
+    threads.emplace_back(recordNestedZones);
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  // Data from threads which have exited is kept until the next clear()
+  std::vector<profiler::ZoneStatistics> stats = profiler::getZoneStatistics();
+  const profiler::ZoneStatistics* inner = findZone(stats, "outer/inner");
+  ASSERT_NE(inner, nullptr);
+  EXPECT_EQ(inner->count, 12u);
+  EXPECT_EQ(profiler::getCounters()["inner calls"], 12);
+  profiler::clear();
+}
+
+TEST(ProfilerTest, ZoneLimit) {
+  profiler::clear();
+  size_t oldMax = profiler::getMaxZones();
+  profiler::setMaxZones(2);
+
+  // The outer zone and the first inner zone are recorded; the rest are dropped, but counters still count
+  recordNestedZones();
+  std::vector<profiler::ZoneStatistics> stats = profiler::getZoneStatistics();
+  ASSERT_NE(findZone(stats, "outer"), nullptr);
+  ASSERT_NE(findZone(stats, "outer/inner"), nullptr);
+  EXPECT_EQ(findZone(stats, "outer/inner")->count, 1u);
+  EXPECT_EQ(profiler::getDroppedZoneCount(), 2u);
+  EXPECT_EQ(profiler::getCounters()["inner calls"], 3);
+
+  // Clearing starts over
+  profiler::clear();
+  EXPECT_EQ(profiler::getDroppedZoneCount(), 0u);
+  recordNestedZones();
+  stats = profiler::getZoneStatistics();
+  ASSERT_NE(findZone(stats, "outer/inner"), nullptr);
+  EXPECT_EQ(findZone(stats, "outer/inner")->count, 1u);
+
+  profiler::setMaxZones(oldMax);
+  profiler::clear();
+}
@@ -1,11 +1,27 @@
+#include "geometrycentral/surface/mapped_mesh_reader.h"
 #include "geometrycentral/surface/simple_polygon_mesh.h"
+#include "geometrycentral/utilities/binary_ply.h"
+#include "geometrycentral/utilities/formatted_output.h"
+#include "geometrycentral/utilities/vertex_welding.h"
 
 #include "load_test_meshes.h"
 
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 
 
@@ -31,3 +47,365 @@ TEST_F(SimplePolygonSuite, BasicTest) {
   }
 }
 
+
+TEST_F(SimplePolygonSuite, ObjIndexForms) {
+  std::stringstream in;
+  in << "# a comment\r\n"
+     << "v 0 0 0\r\n"
+     << "v 1.5 0 -2e-1\n"
+     << "v 0 1 0 # trailing comment\n"
+     << "v\t1 1 1\n"
+     << "vt 0.25 0.5\n"
+     << "vt 1 0\n"
+     << "vn 0 0 1\n"
+     << "o object\n"
+     << "f 1 2 3\n"
+     << "f 2/1 4/2 3/1\n"
+     << "f 1//1 2//1 \\\n 3//1\n"
+     << "f -4/-2/-1 -3/-1/-1 -1/-2/-1\n"
+     << "f 1 2 4\n"
+     << "f 1/1/ 2/2/ 3/1/";
+
+  SimplePolygonMesh mesh(in, "obj");
+
+  ASSERT_EQ(mesh.nVertices(), 4);
+  EXPECT_EQ(mesh.vertexCoordinates[1], (Vector3{1.5, 0., -0.2}));
+  EXPECT_EQ(mesh.vertexCoordinates[3], (Vector3{1., 1., 1.}));
+
+  std::vector<std::vector<size_t>> expectedPolygons = {{0, 1, 2}, {1, 3, 2}, {0, 1, 2}, {0, 1, 3}, {0, 1, 3}, {0, 1, 2}};
+  EXPECT_EQ(mesh.polygons, expectedPolygons);
+
+  ASSERT_EQ(mesh.paramCoordinates.size(), 3);
+  EXPECT_EQ(mesh.paramCoordinates[0][1], (Vector2{1., 0.}));
+  EXPECT_EQ(mesh.paramCoordinates[1][0], (Vector2{0.25, 0.5}));
+  EXPECT_EQ(mesh.paramCoordinates[1][1], (Vector2{1., 0.}));
+
+  std::stringstream badIn("v 0 0 0\nf 1 2 3\n");
+  EXPECT_THROW(SimplePolygonMesh(badIn, "obj"), std::runtime_error);
+
+  // An index which overflows is rejected, rather than wrapping around (here, to 3)
+  std::stringstream overflowIn("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 18446744073709551619\n");
+  EXPECT_THROW(SimplePolygonMesh(overflowIn, "obj"), std::runtime_error);
+}
+
+TEST_F(SimplePolygonSuite, ObjLargeFile) {
+  // Large enough to be split into several chunks, with relative indices pointing across chunk boundaries
+  size_t n = 200000;
+  std::stringstream absoluteIn, relativeIn;
+  absoluteIn << std::setprecision(17);
+  relativeIn << std::setprecision(17);
+  for (size_t i = 0; i < n; i++) {
+    double x = std::sqrt(i + 0.5);
+    absoluteIn << "v " << x << " " << -x << " " << x * 1e-7 << "\n";
+    relativeIn << "v " << x << " " << -x << " " << x * 1e-7 << "\n";
+    if (i >= 2) {
+      absoluteIn << "f " << i - 1 << " " << i << " " << i + 1 << "\n";
+      relativeIn << "f -3 -2 -1\n";
+    }
+  }
+
+  SimplePolygonMesh absoluteMesh(absoluteIn, "obj");
+  SimplePolygonMesh relativeMesh(relativeIn, "obj");
+
+  ASSERT_EQ(absoluteMesh.nVertices(), n);
+  ASSERT_EQ(absoluteMesh.nFaces(), n - 2);
+  EXPECT_EQ(absoluteMesh.polygons, relativeMesh.polygons);
+  for (size_t i = 0; i < n; i++) {
+    double x = std::sqrt(i + 0.5);
+    ASSERT_EQ(absoluteMesh.vertexCoordinates[i], (Vector3{x, -x, x * 1e-7}));
+  }
+}
+
+TEST_F(SimplePolygonSuite, MergeIdenticalVertices) {
+  // Many exact duplicates drawn from a small set of positions, in random order
+  std::mt19937 gen(17);
+  std::uniform_int_distribution<int> coordDist(-20, 20);
+  SimplePolygonMesh simpleMesh;
+  for (size_t i = 0; i < 300000; i++) {
+    double x = coordDist(gen) / 4.;
+    simpleMesh.vertexCoordinates.push_back(Vector3{x == 0 && i % 2 ? -0. : x, coordDist(gen) / 4., 1.});
+  }
+  for (size_t i = 0; i + 2 < simpleMesh.nVertices(); i += 3) simpleMesh.polygons.push_back({i, i + 1, i + 2});
+
+  // Reference: keep the first occurrence of each position
+  std::vector<Vector3> expectedPositions;
+  std::vector<size_t> expectedIndex;
+  std::map<std::tuple<double, double, double>, size_t> firstIndex;
+  for (Vector3 p : simpleMesh.vertexCoordinates) {
+    auto key = std::make_tuple(p.x, p.y, p.z); // -0. and 0. compare equal here too
+    if (firstIndex.find(key) == firstIndex.end()) {
+      firstIndex[key] = expectedPositions.size();
+      expectedPositions.push_back(p);
+    }
+    expectedIndex.push_back(firstIndex[key]);
+  }
+
+  // The parallel path gives the same result as a single thread, whatever the hardware
+  std::vector<Vector3> weldedPositions = simpleMesh.vertexCoordinates;
+  EXPECT_EQ(weldVertexPositions(weldedPositions, 0., 4), expectedIndex);
+  EXPECT_EQ(weldedPositions, expectedPositions);
+
+  SimplePolygonMesh weldedMesh = simpleMesh;
+  weldedMesh.mergeIdenticalVertices();
+  ASSERT_EQ(weldedMesh.vertexCoordinates, expectedPositions);
+  for (size_t iF = 0; iF < weldedMesh.nFaces(); iF++) {
+    for (size_t j = 0; j < 3; j++) {
+      ASSERT_EQ(weldedMesh.polygons[iF][j], expectedIndex[simpleMesh.polygons[iF][j]]);
+    }
+  }
+
+  // With a tolerance, positions in the same grid cell are merged
+  SimplePolygonMesh gridMesh;
+  gridMesh.vertexCoordinates = {{0.01, 0.02, 0.}, {0.09, 0.01, 0.}, {0.11, 0., 0.}, {0.02, 0.03, 0.}};
+  gridMesh.polygons = {{0, 1, 2}, {3, 2, 1}};
+  gridMesh.mergeIdenticalVertices(0.1);
+  std::vector<Vector3> expectedGridPositions = {{0.01, 0.02, 0.}, {0.11, 0., 0.}};
+  std::vector<std::vector<size_t>> expectedGridPolygons = {{0, 0, 1}, {0, 1, 0}};
+  EXPECT_EQ(gridMesh.vertexCoordinates, expectedGridPositions);
+  EXPECT_EQ(gridMesh.polygons, expectedGridPolygons);
+
+  // ... and those faces now have repeated vertices. Stripping them keeps the parameterization in sync.
+  gridMesh.polygons.push_back({0, 1, 2});
+  gridMesh.vertexCoordinates.push_back(Vector3{1., 1., 1.});
+  gridMesh.paramCoordinates = {{{0, 0}, {1, 0}, {1, 1}}, {{0, 1}, {1, 1}, {0, 0}}, {{2, 2}, {3, 3}, {4, 4}}};
+  gridMesh.stripFacesWithDuplicateVertices();
+  ASSERT_EQ(gridMesh.nFaces(), 1);
+  EXPECT_EQ(gridMesh.polygons[0], (std::vector<size_t>{0, 1, 2}));
+  EXPECT_EQ(gridMesh.paramCoordinates[0][2], (Vector2{4, 4}));
+}
+
+TEST_F(SimplePolygonSuite, WriteObjRoundTrip) {
+  // Enough faces to be formatted in several blocks, with awkward values and texture coordinates
+  std::mt19937_64 gen(3);
+  std::uniform_real_distribution<double> coordDist(-1e3, 1e3);
+  SimplePolygonMesh simpleMesh;
+  simpleMesh.vertexCoordinates = {{0.1, -0., 1e-300}, {1e22, 5e-324, -123456789.125}};
+  for (size_t i = 0; i < 100000; i++) {
+    simpleMesh.vertexCoordinates.push_back(Vector3{coordDist(gen), coordDist(gen) * 1e-9, std::sqrt(i)});
+  }
+  for (size_t i = 0; i + 3 < simpleMesh.nVertices(); i += 2) {
+    std::vector<size_t> face = {i, i + 1, i + 3};
+    if (i % 4 == 0) face.push_back(i + 2);
+    simpleMesh.polygons.push_back(face);
+    std::vector<Vector2> coords;
+    for (size_t j = 0; j < face.size(); j++) coords.push_back(Vector2{coordDist(gen), 0.5 * j});
+    simpleMesh.paramCoordinates.push_back(coords);
+  }
+
+  std::stringstream out;
+  simpleMesh.writeMesh(out, "obj");
+  SimplePolygonMesh readMesh(out, "obj");
+
+  EXPECT_EQ(readMesh.vertexCoordinates, simpleMesh.vertexCoordinates);
+  EXPECT_EQ(readMesh.polygons, simpleMesh.polygons);
+  ASSERT_EQ(readMesh.paramCoordinates.size(), simpleMesh.paramCoordinates.size());
+  for (size_t iF = 0; iF < readMesh.nFaces(); iF++) {
+    ASSERT_EQ(readMesh.paramCoordinates[iF], simpleMesh.paramCoordinates[iF]);
+  }
+}
+
+TEST_F(SimplePolygonSuite, WriteBinaryPly) {
+  SimplePolygonMesh simpleMesh;
+  simpleMesh.vertexCoordinates = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0.5, 0.5, 1. / 3.}};
+  simpleMesh.polygons = {{0, 3, 2, 1}, {0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {3, 0, 4}};
+
+  std::string path = "simple_polygon_mesh_test.ply";
+  simpleMesh.writeMesh(path);
+  MappedMeshData data;
+  bool loaded = readMappedMesh(path, "", data);
+  std::remove(path.c_str());
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(data.vertexCoordinates, simpleMesh.vertexCoordinates);
+  EXPECT_EQ(data.toPolygons(), simpleMesh.polygons);
+
+  // Texture coordinates are written as a second list on each face
+  simpleMesh.paramCoordinates.resize(simpleMesh.nFaces());
+  for (size_t iF = 0; iF < simpleMesh.nFaces(); iF++) {
+    for (size_t j = 0; j < simpleMesh.polygons[iF].size(); j++) {
+      simpleMesh.paramCoordinates[iF].push_back(Vector2{0.1 * iF, 0.25 * j});
+    }
+  }
+  std::stringstream out;
+  simpleMesh.writeMesh(out, "ply");
+  std::string bytes = out.str();
+  EXPECT_NE(bytes.find("property list uchar double texcoord\n"), std::string::npos);
+  size_t dataStart = bytes.find("end_header\n") + 11;
+  size_t expectedSize = 5 * 3 * 8 + 5 * 2 + 16 * (4 + 2 * 8);
+  EXPECT_EQ(bytes.size() - dataStart, expectedSize);
+}
+
+
+// ============================================================
+// =============== Formatted output tests
+// ============================================================
+
+TEST(FormattedOutputTests, FormatDouble) {
+  auto format = [](double val) {
+    char buffer[FORMAT_BUFFER_SIZE];
+    return std::string(buffer, formatDouble(buffer, val));
+  };
+  EXPECT_EQ(format(0.1), "0.1");
+  EXPECT_EQ(format(-2.), "-2");
+  EXPECT_EQ(format(0.), "0");
+  EXPECT_EQ(format(1.5e-7), "1.5e-7");
+  EXPECT_EQ(format(123456.25), "123456.25");
+  EXPECT_EQ(format(1e300), "1e300");
+  EXPECT_EQ(format(std::numeric_limits<double>::quiet_NaN()), "nan");
+  EXPECT_EQ(format(-std::numeric_limits<double>::infinity()), "-inf");
+
+  // Random bit patterns read back exactly
+  std::mt19937_64 gen(5);
+  for (size_t i = 0; i < 100000; i++) {
+    uint64_t bits = gen();
+    double val;
+    std::memcpy(&val, &bits, sizeof(double));
+    if (!std::isfinite(val)) continue;
+    ASSERT_EQ(std::strtod(format(val).c_str(), nullptr), val);
+  }
+
+  char buffer[FORMAT_BUFFER_SIZE];
+  EXPECT_EQ(std::string(buffer, formatInteger(buffer, 18446744073709551615ull)), "18446744073709551615");
+}
+
+
+// ============================================================
+// =============== Mapped mesh reader tests
+// ============================================================
+
+TEST(MappedMeshReaderTests, BinaryStlMatchesStreamReader) {
+  std::string path = std::string(GC_TEST_ASSETS_ABS_PATH) + "/stl_box_binary.stl";
+
+  MappedMeshData data;
+  ASSERT_TRUE(readMappedMesh(path, "", data));
+
+  SimplePolygonMesh simpleMesh(path);
+  simpleMesh.stripUnusedVertices();
+  simpleMesh.mergeIdenticalVertices();
+
+  EXPECT_EQ(data.faceDegree, 3);
+  EXPECT_EQ(data.vertexCoordinates, simpleMesh.vertexCoordinates);
+  EXPECT_EQ(data.toPolygons(), simpleMesh.polygons);
+
+  // Ascii files are left to the general-purpose reader
+  EXPECT_FALSE(readMappedMesh(std::string(GC_TEST_ASSETS_ABS_PATH) + "/stl_box_ascii.stl", "", data));
+}
+
+TEST(MappedMeshReaderTests, BinaryPly) {
+  // A square pyramid with mixed face degrees, extra properties, and an unreferenced vertex
+  std::string path = "mapped_mesh_reader_test.ply";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "ply\nformat binary_little_endian 1.0\ncomment test\n"
+        << "element vertex 6\nproperty double x\nproperty uchar red\nproperty float y\nproperty float z\n"
+        << "element face 5\nproperty int flags\nproperty list uchar uint vertex_indices\nproperty short tag\n"
+        << "end_header\n";
+    double pos[6][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {9, 9, 9}, {0.5, 0.5, 1}};
+    for (int i = 0; i < 6; i++) {
+      float y = pos[i][1], z = pos[i][2];
+      unsigned char red = 255;
+      out.write(reinterpret_cast<char*>(&pos[i][0]), 8);
+      out.write(reinterpret_cast<char*>(&red), 1);
+      out.write(reinterpret_cast<char*>(&y), 4);
+      out.write(reinterpret_cast<char*>(&z), 4);
+    }
+    std::vector<std::vector<uint32_t>> faces = {{0, 3, 2, 1}, {0, 1, 5}, {1, 2, 5}, {2, 3, 5}, {3, 0, 5}};
+    for (std::vector<uint32_t>& face : faces) {
+      int32_t flags = 7;
+      int16_t tag = -1;
+      unsigned char degree = face.size();
+      out.write(reinterpret_cast<char*>(&flags), 4);
+      out.write(reinterpret_cast<char*>(&degree), 1);
+      out.write(reinterpret_cast<char*>(face.data()), 4 * face.size());
+      out.write(reinterpret_cast<char*>(&tag), 2);
+    }
+  }
+
+  MappedMeshData data;
+  bool loaded = readMappedMesh(path, "", data);
+  std::remove(path.c_str());
+  ASSERT_TRUE(loaded);
+
+  ASSERT_EQ(data.nVertices(), 5);
+  EXPECT_EQ(data.vertexCoordinates[4], (Vector3{0.5, 0.5, 1.}));
+  std::vector<std::vector<size_t>> expectedPolygons = {{0, 3, 2, 1}, {0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {3, 0, 4}};
+  EXPECT_EQ(data.toPolygons(), expectedPolygons);
+
+  std::unique_ptr<ManifoldSurfaceMesh> mesh;
+  std::unique_ptr<VertexPositionGeometry> geometry;
+  std::tie(mesh, geometry) = makeManifoldSurfaceMeshAndGeometry(std::move(data));
+  EXPECT_EQ(mesh->nFaces(), 5);
+  EXPECT_EQ(mesh->eulerCharacteristic(), 2);
+  EXPECT_EQ(geometry->vertexPositions[mesh->vertex(2)], (Vector3{1., 1., 0.}));
+}
+
+
+// ============================================================
+// =============== Binary ply tests
+// ============================================================
+
+TEST(BinaryPlyTests, StreamWriterAndMappedFile) {
+  std::string path = "binary_ply_test.ply";
+  std::string copyPath = "binary_ply_test_copy.ply";
+
+  std::vector<float> x = {0, 1, 1, 0.5f};
+  std::vector<double> y = {0, 0, 1, 1. / 3.};
+  std::vector<std::vector<int32_t>> faces = {{0, 1, 2}, {0, 2, 3}, {3, 2, 1, 0}};
+  std::vector<int16_t> tags = {-1, 7, 300};
+  {
+    PlyStreamWriter writer;
+    writer.addComment("test file");
+    writer.addProperty<float>("vertex", "x", x);
+    writer.addProperty<double>("vertex", "y", y);
+    writer.addProperty<double>("vertex", "z", std::vector<double>(4, 2.));
+    writer.addListProperty<int32_t>("face", "vertex_indices", faces);
+    writer.addProperty<int16_t>("face", "tag", tags);
+    writer.addProperty<unsigned char>("edge", "flag", {1, 2});
+    EXPECT_THROW(writer.addProperty<double>("vertex", "w", {1.}), std::runtime_error);
+
+    std::ofstream out(path, std::ios::binary);
+    writer.write(out);
+  }
+
+  // Readable as a mesh...
+  MappedMeshData data;
+  ASSERT_TRUE(readMappedMesh(path, "", data));
+  EXPECT_EQ(data.vertexCoordinates[3], (Vector3{0.5, 1. / 3., 2.}));
+  std::vector<std::vector<size_t>> expectedPolygons = {{0, 1, 2}, {0, 2, 3}, {3, 2, 1, 0}};
+  EXPECT_EQ(data.toPolygons(), expectedPolygons);
+
+  // ... and property by property, with widening conversions only
+  std::shared_ptr<MappedPlyFile> file(new MappedPlyFile(path));
+  EXPECT_TRUE(MappedPlyFile::canRead(path));
+  EXPECT_EQ(file->getProperty<double>("vertex", "x"), std::vector<double>(x.begin(), x.end()));
+  EXPECT_THROW(file->getProperty<float>("vertex", "y"), std::runtime_error);
+  EXPECT_EQ(file->getProperty<int32_t>("face", "tag"), std::vector<int32_t>(tags.begin(), tags.end()));
+  EXPECT_THROW(file->getProperty<uint32_t>("face", "tag"), std::runtime_error);
+  EXPECT_EQ(file->getListProperty<int32_t>("face", "vertex_indices"), faces);
+  EXPECT_THROW(file->getProperty<int32_t>("face", "vertex_indices"), std::runtime_error);
+  EXPECT_EQ(file->getProperty<uint32_t>("edge", "flag"), (std::vector<uint32_t>{1, 2})); // after the face lists
+  EXPECT_THROW(file->getProperty<double>("vertex", "nope"), std::runtime_error);
+
+  // Copy the file over, replacing one property
+  {
+    PlyStreamWriter writer;
+    for (const PlyElement& elem : file->getElements()) {
+      for (const PlyProperty& prop : elem.properties) writer.addPropertyFromFile(file, elem.name, prop.name);
+    }
+    writer.addProperty<double>("vertex", "y", {5, 6, 7, 8});
+    EXPECT_EQ(writer.getProperty<double>("vertex", "y"), (std::vector<double>{5, 6, 7, 8}));
+    EXPECT_EQ(writer.getListProperty<int32_t>("face", "vertex_indices"), faces);
+
+    std::ofstream out(copyPath, std::ios::binary);
+    writer.write(out);
+  }
+  MappedPlyFile copy(copyPath);
+  EXPECT_EQ(copy.getProperty<float>("vertex", "x"), x);
+  EXPECT_EQ(copy.getProperty<double>("vertex", "y"), (std::vector<double>{5, 6, 7, 8}));
+  EXPECT_EQ(copy.getListProperty<int32_t>("face", "vertex_indices"), faces);
+  EXPECT_EQ(copy.getProperty<int16_t>("face", "tag"), tags);
+  EXPECT_EQ(copy.getProperty<unsigned char>("edge", "flag"), (std::vector<unsigned char>{1, 2}));
+
+  file.reset();
+  std::remove(path.c_str());
+  std::remove(copyPath.c_str());
+}